@@ -18,6 +18,7 @@
  */
 
 #include "imx_2d_device.h"
+#include "imx_2d_device_allocator.h"
 
 GST_DEBUG_CATEGORY (imx2ddevice_debug);
 #define GST_CAT_DEFAULT imx2ddevice_debug
@@ -46,6 +47,19 @@ extern gint imx_ocl_destroy(Imx2DDevice *device);
 extern gboolean imx_ocl_is_exist (void);
 #endif
 
+extern Imx2DDevice * imx_sw_create(Imx2DDeviceType  device_type);
+extern gint imx_sw_destroy(Imx2DDevice *device);
+extern gboolean imx_sw_is_exist (void);
+
+extern Imx2DDevice * imx_split_create(Imx2DDeviceType  device_type);
+extern gint imx_split_destroy(Imx2DDevice *device);
+extern gboolean imx_split_is_exist (void);
+extern const Imx2DDeviceInfo * imx_split_get_first_engine (void);
+
+extern Imx2DDevice * imx_2d_session_new (const Imx2DDeviceInfo *info);
+extern gboolean imx_2d_session_is (Imx2DDevice *device);
+extern gint imx_2d_session_free (Imx2DDevice *device);
+
 static const Imx2DDeviceInfo Imx2DDevices[] = {
 #ifdef USE_IPU
     { .name                     ="ipu",
@@ -82,6 +96,22 @@ static const Imx2DDeviceInfo Imx2DDevices[] = {
       .is_exist                 =imx_ocl_is_exist
     },
 #endif
+
+    /* bands of one operation on two of the devices above */
+    { .name                     ="split",
+      .device_type              =IMX_2D_DEVICE_SPLIT,
+      .create                   =imx_split_create,
+      .destroy                  =imx_split_destroy,
+      .is_exist                 =imx_split_is_exist
+    },
+
+    /* software fallback, keep it last so hardware devices are preferred */
+    { .name                     ="sw",
+      .device_type              =IMX_2D_DEVICE_SW,
+      .create                   =imx_sw_create,
+      .destroy                  =imx_sw_destroy,
+      .is_exist                 =imx_sw_is_exist
+    },
     {
       NULL
     }
@@ -99,13 +129,15 @@ const Imx2DDeviceInfo * imx_get_2d_devices(void)
   return &Imx2DDevices[0];
 }
 
+/* elements get a session on the device context shared by everyone using the
+ * same device type, the hardware is opened once for all of them */
 Imx2DDevice * imx_2d_device_create(Imx2DDeviceType  device_type)
 {
   const Imx2DDeviceInfo *dev_info = imx_get_2d_devices();
   while (dev_info->name) {
     if (dev_info->device_type == device_type) {
       if (dev_info->is_exist()) {
-        return dev_info->create(device_type);
+        return imx_2d_session_new(dev_info);
       } else {
         GST_ERROR("device %s not exist", dev_info->name);
         return NULL;
@@ -123,6 +155,11 @@ gint imx_2d_device_destroy(Imx2DDevice *device)
   if (!device)
     return -1;
 
+  gst_imx_2d_device_allocator_flush_device(device);
+
+  if (imx_2d_session_is(device))
+    return imx_2d_session_free(device);
+
   const Imx2DDeviceInfo *dev_info = imx_get_2d_devices();
   while (dev_info->name) {
     if (dev_info->device_type == device->device_type)
@@ -133,3 +170,92 @@ gint imx_2d_device_destroy(Imx2DDevice *device)
   GST_ERROR("Unknown 2D device type %d\n", device->device_type);
   return -1;
 }
+
+/* devices without asynchronous submission finish every operation before
+ * returning, their fence is always 0 and waiting is a no-op */
+gboolean imx_2d_device_set_async(Imx2DDevice *device, gboolean async)
+{
+  if (!device || !device->set_async)
+    return FALSE;
+
+  return device->set_async(device, async) == 0;
+}
+
+guint64 imx_2d_device_get_fence(Imx2DDevice *device)
+{
+  if (!device || !device->get_fence)
+    return 0;
+
+  return device->get_fence(device);
+}
+
+gint imx_2d_device_wait_fence(Imx2DDevice *device, guint64 fence)
+{
+  if (!device || !device->wait_fence || fence == 0)
+    return 0;
+
+  return device->wait_fence(device, fence);
+}
+
+/* type of the device doing the work, special cases tied to one kind of
+ * hardware go by this rather than device_type */
+Imx2DDeviceType imx_2d_device_get_engine_type(Imx2DDevice *device)
+{
+  if (device->get_engine_type)
+    return device->get_engine_type(device);
+
+  return device->device_type;
+}
+
+Imx2DDeviceType imx_2d_device_info_get_engine_type(const Imx2DDeviceInfo *info)
+{
+  const Imx2DDeviceInfo *engine;
+
+  if (info->device_type == IMX_2D_DEVICE_SPLIT) {
+    engine = imx_split_get_first_engine ();
+    if (engine)
+      return engine->device_type;
+  }
+
+  return info->device_type;
+}
+
+/* blend layers in order, the destination crop of each layer is applied to
+ * dst for the duration of its blend. Devices without a native batch path
+ * get one blend call per layer. */
+gint imx_2d_device_blend_batch(Imx2DDevice *device, Imx2DFrame *dst,
+                               Imx2DBlendLayer *layers, gint n_layers)
+{
+  Imx2DCrop crop;
+  gint i, blended = 0;
+
+  if (!device || !dst || !layers)
+    return -1;
+
+  if (n_layers <= 0)
+    return 0;
+
+  crop = dst->crop;
+  if (device->blend_batch) {
+    blended = device->blend_batch(device, dst, layers, n_layers);
+  } else {
+    for (i = 0; i < n_layers; i++) {
+      Imx2DBlendLayer *layer = &layers[i];
+
+      dst->crop = layer->dst_crop;
+      layer->ret = -1;
+      if (device->config_input(device, &layer->src.info) < 0
+          || device->set_rotate(device, layer->src.rotate) < 0
+          || device->set_deinterlace(device, IMX_2D_DEINTERLACE_NONE) < 0)
+        continue;
+
+      layer->ret = device->blend(device, dst, &layer->src);
+      if (layer->ret >= 0)
+        blended++;
+    }
+  }
+  dst->crop = crop;
+
+  GST_TRACE ("blended %d/%d layers", blended, n_layers);
+  return blended;
+}
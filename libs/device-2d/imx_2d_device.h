@@ -36,6 +36,8 @@ typedef enum {
   IMX_2D_DEVICE_PXP,
   IMX_2D_DEVICE_OCL,
   IMX_2D_DEVICE_GLES2,
+  IMX_2D_DEVICE_SW,
+  IMX_2D_DEVICE_SPLIT,
 } Imx2DDeviceType;
 
 typedef enum {
@@ -128,6 +130,13 @@ typedef struct _Imx2DFrame {
   gint                  alpha;
 } Imx2DFrame;
 
+/* one source of a batched blend, ret is filled with the blend result */
+typedef struct _Imx2DBlendLayer {
+  Imx2DFrame            src;
+  Imx2DCrop             dst_crop;
+  gint                  ret;
+} Imx2DBlendLayer;
+
 typedef struct _Imx2DDevice  Imx2DDevice;
 struct _Imx2DDevice {
   Imx2DDeviceType  device_type;
@@ -140,6 +149,8 @@ struct _Imx2DDevice {
   gint (*close)       (Imx2DDevice* device);
   gint (*alloc_mem)   (Imx2DDevice* device, PhyMemBlock *memblk);
   gint (*free_mem)    (Imx2DDevice* device, PhyMemBlock *memblk);
+  /* dst_mem is allocated by the device unless its vaddr is already set,
+   * which is the case for destinations recycled by the allocator */
   gint (*copy_mem)    (Imx2DDevice* device, PhyMemBlock *dst_mem,
                        PhyMemBlock *src_mem, guint offset, guint size);
   gint (*frame_copy)  (Imx2DDevice* device, PhyMemBlock *from, PhyMemBlock *to);
@@ -150,8 +161,28 @@ struct _Imx2DDevice {
   gint (*convert)   (Imx2DDevice* device, Imx2DFrame *dst, Imx2DFrame *src);
   gint (*blend)        (Imx2DDevice* device, Imx2DFrame *dst, Imx2DFrame *src);
   gint (*blend_finish) (Imx2DDevice* device);
+  /* G2D and SW fill dst->crop only, the other devices the whole frame,
+   * see imx_2d_device_get_engine_type for devices driving another one */
   gint (*fill)         (Imx2DDevice* device, Imx2DFrame *dst, guint RGBA8888);
 
+  /* optional asynchronous submission, once enabled convert/blend/fill and
+   * frame_copy may still be running when they return. get_fence gives a
+   * token for the last submitted operation, wait_fence blocks until it is
+   * complete. */
+  gint    (*set_async)  (Imx2DDevice* device, gboolean async);
+  guint64 (*get_fence)  (Imx2DDevice* device);
+  gint    (*wait_fence) (Imx2DDevice* device, guint64 fence);
+
+  /* optional, blend several sources into dst with one submission. Input
+   * and rotation are configured per layer from its src, the output must
+   * already be configured. Returns the number of layers blended */
+  gint (*blend_batch)  (Imx2DDevice* device, Imx2DFrame *dst,
+                        Imx2DBlendLayer *layers, gint n_layers);
+
+  /* optional, type of the device doing the work for devices that drive
+   * other ones, e.g. split or a session */
+  Imx2DDeviceType (*get_engine_type) (Imx2DDevice* device);
+
   gint                 (*get_capabilities)        (Imx2DDevice* device);
   GList*               (*get_supported_in_fmts)   (Imx2DDevice* device);
   GList*               (*get_supported_out_fmts)  (Imx2DDevice* device);
@@ -167,8 +198,29 @@ typedef struct _Imx2DDeviceInfo {
   gboolean      (*is_exist) (void);
 } Imx2DDeviceInfo;
 
+/* per session counters, times in microseconds */
+typedef struct _Imx2DSessionStats {
+  guint64 ops;
+  gint64  busy_time;
+  gint64  wait_time;
+  gint64  active_time;
+  guint   sessions;
+} Imx2DSessionStats;
+
 const Imx2DDeviceInfo * imx_get_2d_devices(void);
 Imx2DDevice * imx_2d_device_create(Imx2DDeviceType  device_type);
 gint imx_2d_device_destroy(Imx2DDevice *device);
+gboolean imx_2d_device_set_async(Imx2DDevice *device, gboolean async);
+guint64 imx_2d_device_get_fence(Imx2DDevice *device);
+gint imx_2d_device_wait_fence(Imx2DDevice *device, guint64 fence);
+gint imx_2d_device_blend_batch(Imx2DDevice *device, Imx2DFrame *dst,
+                               Imx2DBlendLayer *layers, gint n_layers);
+Imx2DDeviceType imx_2d_device_get_engine_type(Imx2DDevice *device);
+Imx2DDeviceType imx_2d_device_info_get_engine_type(const Imx2DDeviceInfo *info);
+gboolean imx_2d_device_get_session_stats(Imx2DDevice *device,
+                                         Imx2DSessionStats *stats);
+/* session counters as an "imx-2d-session-stats" structure for a read-only
+ * element property, NULL if device is not a session */
+GstStructure * imx_2d_device_get_session_stats_structure(Imx2DDevice *device);
 
 #endif /* __IMX_2D_DEVICE_H__ */
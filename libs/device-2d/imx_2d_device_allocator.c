@@ -17,6 +17,7 @@
  * Boston, MA 02111-1307, USA.
  */
 
+#include <string.h>
 #include "imx_2d_device_allocator.h"
 #include "imx_2d_device.h"
 
@@ -31,6 +32,10 @@ gst_imx_2d_device_allocator_init (GstImx2DDeviceAllocator * allocator);
 G_DEFINE_TYPE (GstImx2DDeviceAllocator, gst_imx_2d_device_allocator, \
                GST_TYPE_ALLOCATOR_PHYMEM);
 
+/* allocators with a device, flushed when the device goes away before them */
+static GList *live_allocators = NULL;
+G_LOCK_DEFINE_STATIC (live_allocators);
+
 static gint
 imx_2d_device_allocate (GstAllocatorPhyMem *allocator, PhyMemBlock *memblk)
 {
@@ -51,10 +56,129 @@ imx_2d_device_allocate (GstAllocatorPhyMem *allocator, PhyMemBlock *memblk)
   return -1;
 }
 
+/* recycling policy for copy destinations: blocks are matched by page
+ * count, at most COPY_POOL_MAX_BLOCKS or COPY_POOL_MAX_BYTES are kept and
+ * blocks idle for longer than COPY_POOL_IDLE_TIME go back to the device,
+ * from a system clock wait when no free or copy comes in to trim them */
+#define COPY_POOL_MAX_BLOCKS  8
+#define COPY_POOL_MAX_BYTES   (32 * 1024 * 1024)
+#define COPY_POOL_IDLE_TIME   (2 * G_USEC_PER_SEC)
+#define COPY_POOL_BUCKET(size) (((size) + 4095) / 4096)
+
+typedef struct {
+  PhyMemBlock block;
+  gint64 released;
+} PooledBlock;
+
+static void
+imx_2d_device_copy_pool_trim (GstImx2DDeviceAllocator *allocator, gint64 now,
+                              gboolean all)
+{
+  Imx2DDevice *dev = (Imx2DDevice*)(allocator->device);
+  PooledBlock *pb;
+
+  while ((pb = g_queue_peek_head (&allocator->pool))) {
+    if (!all && allocator->stats.pooled <= COPY_POOL_MAX_BLOCKS
+        && allocator->stats.pooled_bytes <= COPY_POOL_MAX_BYTES
+        && now - pb->released <= COPY_POOL_IDLE_TIME)
+      break;
+
+    g_queue_pop_head (&allocator->pool);
+    allocator->stats.pooled--;
+    allocator->stats.pooled_bytes -= pb->block.size;
+    allocator->stats.trimmed++;
+    GST_LOG ("trim pooled copy destination (%p), size (%d)",
+             pb->block.paddr, pb->block.size);
+    if (dev && dev->free_mem(dev, &pb->block) < 0)
+      GST_ERROR ("imx 2d device free pooled memory failed.");
+    g_slice_free (PooledBlock, pb);
+  }
+}
+
+static void
+imx_2d_device_copy_pool_schedule_trim (GstImx2DDeviceAllocator *allocator);
+
+/* called from the system clock thread */
+static gboolean
+imx_2d_device_copy_pool_trim_cb (GstClock *clock, GstClockTime time,
+                                 GstClockID id, gpointer user_data)
+{
+  GstImx2DDeviceAllocator *allocator = GST_IMX_2D_DEVICE_ALLOCATOR(user_data);
+
+  g_mutex_lock (&allocator->lock);
+  if (allocator->trim_id == id) {
+    gst_clock_id_unref (allocator->trim_id);
+    allocator->trim_id = NULL;
+    imx_2d_device_copy_pool_trim (allocator, g_get_monotonic_time (), FALSE);
+    imx_2d_device_copy_pool_schedule_trim (allocator);
+  }
+  g_mutex_unlock (&allocator->lock);
+
+  return TRUE;
+}
+
+/* called with the lock held, wakes up when the oldest pooled block has
+ * been idle for COPY_POOL_IDLE_TIME */
+static void
+imx_2d_device_copy_pool_schedule_trim (GstImx2DDeviceAllocator *allocator)
+{
+  PooledBlock *pb = g_queue_peek_head (&allocator->pool);
+  GstClock *clock;
+  gint64 idle;
+
+  if (allocator->trim_id || !pb || !allocator->pool_enabled)
+    return;
+
+  idle = pb->released + COPY_POOL_IDLE_TIME - g_get_monotonic_time ();
+  clock = gst_system_clock_obtain ();
+  allocator->trim_id = gst_clock_new_single_shot_id (clock,
+      gst_clock_get_time (clock) + MAX (idle + 1, 0) * GST_USECOND);
+  if (gst_clock_id_wait_async (allocator->trim_id,
+          imx_2d_device_copy_pool_trim_cb, gst_object_ref (allocator),
+          (GDestroyNotify) gst_object_unref) != GST_CLOCK_OK) {
+    GST_WARNING ("schedule copy destination pool trim failed");
+    gst_clock_id_unref (allocator->trim_id);
+    allocator->trim_id = NULL;
+  }
+  gst_object_unref (clock);
+}
+
+static void
+imx_2d_device_copy_pool_unschedule_trim (GstImx2DDeviceAllocator *allocator)
+{
+  if (!allocator->trim_id)
+    return;
+
+  gst_clock_id_unschedule (allocator->trim_id);
+  gst_clock_id_unref (allocator->trim_id);
+  allocator->trim_id = NULL;
+}
+
 static gint
 imx_2d_device_free (GstAllocatorPhyMem *allocator, PhyMemBlock *memblk)
 {
   GstImx2DDeviceAllocator *_allocator = GST_IMX_2D_DEVICE_ALLOCATOR(allocator);
+  gboolean recycle;
+
+  g_mutex_lock (&_allocator->lock);
+  recycle = g_hash_table_remove (_allocator->copies, memblk->vaddr)
+      && _allocator->pool_enabled;
+  if (recycle) {
+    PooledBlock *pb = g_slice_new (PooledBlock);
+    pb->block = *memblk;
+    pb->released = g_get_monotonic_time ();
+    g_queue_push_tail (&_allocator->pool, pb);
+    _allocator->stats.pooled++;
+    _allocator->stats.pooled_bytes += memblk->size;
+    GST_LOG ("pool copy destination (%p), size (%d)",
+             memblk->paddr, memblk->size);
+    imx_2d_device_copy_pool_trim (_allocator, pb->released, FALSE);
+    imx_2d_device_copy_pool_schedule_trim (_allocator);
+  }
+  g_mutex_unlock (&_allocator->lock);
+
+  if (recycle)
+    return 0;
 
   Imx2DDevice *dev = (Imx2DDevice*)(_allocator->device);
   if (dev) {
@@ -75,28 +199,88 @@ imx_2d_device_copy (GstAllocatorPhyMem *allocator, PhyMemBlock *dst_mem,
                     PhyMemBlock *src_mem, guint offset, guint size)
 {
   GstImx2DDeviceAllocator *_allocator = GST_IMX_2D_DEVICE_ALLOCATOR(allocator);
+  PooledBlock *hit = NULL;
+  GList *l;
+  guint need;
 
   Imx2DDevice *dev = (Imx2DDevice*)(_allocator->device);
-  if (dev) {
-    GST_LOG ("imx 2d device copy memory (%p)->(%p) of (%p)",
-        src_mem->paddr, dst_mem->paddr, allocator);
-    gint ret = dev->copy_mem(dev, dst_mem, src_mem, offset, size);
-    if (ret < 0)
-      GST_ERROR ("imx 2d device free memory failed (%d).", ret);
-    else
-      return 0;
+  if (!dev || offset > src_mem->size)
+    return -1;
+
+  need = MIN (size, src_mem->size - offset);
+
+  /* a recycled destination is passed to copy_mem already allocated */
+  g_mutex_lock (&_allocator->lock);
+  imx_2d_device_copy_pool_trim (_allocator, g_get_monotonic_time (), FALSE);
+  for (l = _allocator->pool.tail; l; l = l->prev) {
+    PooledBlock *pb = (PooledBlock *) l->data;
+    if (COPY_POOL_BUCKET (pb->block.size) == COPY_POOL_BUCKET (need)
+        && pb->block.size >= need) {
+      hit = pb;
+      g_queue_delete_link (&_allocator->pool, l);
+      _allocator->stats.pooled--;
+      _allocator->stats.pooled_bytes -= pb->block.size;
+      break;
+    }
   }
+  if (hit) {
+    *dst_mem = hit->block;
+    g_slice_free (PooledBlock, hit);
+    _allocator->stats.hits++;
+  } else {
+    memset (dst_mem, 0, sizeof (PhyMemBlock));
+    _allocator->stats.misses++;
+  }
+  g_mutex_unlock (&_allocator->lock);
 
-  return -1;
+  GST_LOG ("imx 2d device copy memory (%p)->(%p) of (%p)",
+      src_mem->paddr, dst_mem->paddr, allocator);
+  gint ret = dev->copy_mem(dev, dst_mem, src_mem, offset, size);
+  if (ret < 0) {
+    GST_ERROR ("imx 2d device copy memory failed (%d).", ret);
+    if (hit)
+      dev->free_mem(dev, dst_mem);
+    return -1;
+  }
+
+  g_mutex_lock (&_allocator->lock);
+  g_hash_table_add (_allocator->copies, dst_mem->vaddr);
+  g_mutex_unlock (&_allocator->lock);
+
+  return 0;
+}
+
+static void
+gst_imx_2d_device_allocator_finalize (GObject * object)
+{
+  GstImx2DDeviceAllocator *allocator = GST_IMX_2D_DEVICE_ALLOCATOR(object);
+
+  G_LOCK (live_allocators);
+  live_allocators = g_list_remove (live_allocators, allocator);
+  G_UNLOCK (live_allocators);
+
+  gst_imx_2d_device_allocator_flush ((GstAllocator *) allocator);
+  if (allocator->stats.hits + allocator->stats.misses)
+    GST_DEBUG ("copy destination pool of (%p): %" G_GUINT64_FORMAT " hits, %"
+        G_GUINT64_FORMAT " misses, %" G_GUINT64_FORMAT " trimmed", allocator,
+        allocator->stats.hits, allocator->stats.misses,
+        allocator->stats.trimmed);
+
+  g_hash_table_destroy (allocator->copies);
+  g_mutex_clear (&allocator->lock);
+
+  G_OBJECT_CLASS (gst_imx_2d_device_allocator_parent_class)->finalize (object);
 }
 
 static void
 gst_imx_2d_device_allocator_class_init (GstImx2DDeviceAllocatorClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstAllocatorPhyMemClass *parent_class;
 
   parent_class = (GstAllocatorPhyMemClass *) klass;
 
+  gobject_class->finalize = gst_imx_2d_device_allocator_finalize;
   parent_class->alloc_phymem = imx_2d_device_allocate;
   parent_class->free_phymem = imx_2d_device_free;
   parent_class->copy_phymem = imx_2d_device_copy;
@@ -105,7 +289,59 @@ gst_imx_2d_device_allocator_class_init (GstImx2DDeviceAllocatorClass * klass)
 static void
 gst_imx_2d_device_allocator_init (GstImx2DDeviceAllocator * allocator)
 {
-  return;
+  g_mutex_init (&allocator->lock);
+  allocator->copies = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_queue_init (&allocator->pool);
+  allocator->pool_enabled = TRUE;
+}
+
+void gst_imx_2d_device_allocator_flush (GstAllocator *allocator)
+{
+  GstImx2DDeviceAllocator *_allocator;
+
+  if (!allocator || !GST_IS_IMX_2D_DEVICE_ALLOCATOR (allocator))
+    return;
+
+  _allocator = GST_IMX_2D_DEVICE_ALLOCATOR(allocator);
+  g_mutex_lock (&_allocator->lock);
+  _allocator->pool_enabled = FALSE;
+  imx_2d_device_copy_pool_unschedule_trim (_allocator);
+  imx_2d_device_copy_pool_trim (_allocator, 0, TRUE);
+  g_mutex_unlock (&_allocator->lock);
+}
+
+/* the trim wait holds an allocator ref only, an allocator outliving its
+ * device must not trim into it */
+void gst_imx_2d_device_allocator_flush_device (gpointer device)
+{
+  GList *l;
+
+  if (!device)
+    return;
+
+  G_LOCK (live_allocators);
+  for (l = live_allocators; l; l = l->next) {
+    GstImx2DDeviceAllocator *allocator = (GstImx2DDeviceAllocator *) l->data;
+    if (allocator->device == device)
+      gst_imx_2d_device_allocator_flush ((GstAllocator *) allocator);
+  }
+  G_UNLOCK (live_allocators);
+}
+
+gboolean gst_imx_2d_device_allocator_get_copy_stats (GstAllocator *allocator,
+                                               GstImx2DCopyPoolStats *stats)
+{
+  GstImx2DDeviceAllocator *_allocator;
+
+  if (!allocator || !stats || !GST_IS_IMX_2D_DEVICE_ALLOCATOR (allocator))
+    return FALSE;
+
+  _allocator = GST_IMX_2D_DEVICE_ALLOCATOR(allocator);
+  g_mutex_lock (&_allocator->lock);
+  *stats = _allocator->stats;
+  g_mutex_unlock (&_allocator->lock);
+
+  return TRUE;
 }
 
 GstAllocator *gst_imx_2d_device_allocator_new (gpointer device)
@@ -117,6 +353,9 @@ GstAllocator *gst_imx_2d_device_allocator_new (gpointer device)
     GST_ERROR ("new imx 2d device allocator failed.\n");
   } else {
     allocator->device = device;
+    G_LOCK (live_allocators);
+    live_allocators = g_list_prepend (live_allocators, allocator);
+    G_UNLOCK (live_allocators);
     GST_DEBUG ("created imx 2d device allocator(%p).", allocator);
   }
 
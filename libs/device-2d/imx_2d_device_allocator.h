@@ -28,10 +28,32 @@
 #define GST_IMX_2D_DEVICE_ALLOCATOR(obj)             \
       (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_IMX_2D_DEVICE_ALLOCATOR,\
           GstImx2DDeviceAllocator))
+#define GST_IS_IMX_2D_DEVICE_ALLOCATOR(obj)          \
+      (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_IMX_2D_DEVICE_ALLOCATOR))
+
+/* copy destinations are recycled instead of being returned to the device,
+ * counters are cumulative except pooled and pooled_bytes */
+typedef struct _GstImx2DCopyPoolStats {
+  guint64 hits;
+  guint64 misses;
+  guint64 trimmed;
+  guint pooled;
+  gsize pooled_bytes;
+} GstImx2DCopyPoolStats;
 
 typedef struct _GstImx2DDeviceAllocator {
   GstAllocatorPhyMem parent;
   gpointer device;
+
+  GMutex lock;
+  /* vaddr of live copy destinations */
+  GHashTable *copies;
+  /* released copy destinations, oldest first */
+  GQueue pool;
+  gboolean pool_enabled;
+  /* system clock wait trimming the pool once its oldest block is idle */
+  GstClockID trim_id;
+  GstImx2DCopyPoolStats stats;
 } GstImx2DDeviceAllocator;
 
 typedef struct _GstImx2DDeviceAllocatorClass {
@@ -40,5 +62,12 @@ typedef struct _GstImx2DDeviceAllocatorClass {
 
 GType gst_imx_2d_device_allocator_get_type (void);
 GstAllocator *gst_imx_2d_device_allocator_new (gpointer device);
+/* free every pooled copy destination and stop pooling, to be called before
+ * the device is closed. Allocators of other types are left alone. */
+void gst_imx_2d_device_allocator_flush (GstAllocator *allocator);
+/* flush every allocator still bound to device, called when it is destroyed */
+void gst_imx_2d_device_allocator_flush_device (gpointer device);
+gboolean gst_imx_2d_device_allocator_get_copy_stats (GstAllocator *allocator,
+                                               GstImx2DCopyPoolStats *stats);
 
 #endif /* __GST_IMX_2D_DEVICE_ALLOCATOR_H__ */
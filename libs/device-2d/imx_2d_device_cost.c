@@ -0,0 +1,487 @@
+/* GStreamer IMX Video 2D Device measured cost model
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+#include "imx_2d_device_cost.h"
+
+GST_DEBUG_CATEGORY_EXTERN (imx2ddevice_debug);
+#define GST_CAT_DEFAULT imx2ddevice_debug
+
+#define IMX_2D_COST_VERSION       1
+#define IMX_2D_COST_CACHE_NAME    "imx-2d-device-cost.ini"
+#define IMX_2D_COST_MAX_DEVICES   8
+#define IMX_2D_COST_RUNS          3
+
+typedef struct {
+  GstVideoFormat in_fmt;
+  GstVideoFormat out_fmt;
+  gdouble base;       /* microseconds per operation */
+  gdouble per_pixel;  /* microseconds per output pixel */
+} Imx2DCostEntry;
+
+typedef struct {
+  gboolean loaded;
+  GArray *entries[IMX_2D_COST_OP_NUM];
+} Imx2DCostTable;
+
+/* formats most pipelines negotiate, tiled and 10 bit formats are left out */
+static const GstVideoFormat cost_formats[] = {
+  GST_VIDEO_FORMAT_NV12,
+  GST_VIDEO_FORMAT_I420,
+  GST_VIDEO_FORMAT_YUY2,
+  GST_VIDEO_FORMAT_RGBA,
+  GST_VIDEO_FORMAT_BGRx,
+  GST_VIDEO_FORMAT_RGB16,
+};
+
+static const struct {
+  guint w;
+  guint h;
+} cost_sizes[2] = { { 320, 240 }, { 1280, 720 } };
+
+static const gchar *cost_op_names[IMX_2D_COST_OP_NUM] = { "convert", "blend" };
+
+/* cost_lock guards the tables and is only held for lookups, prepare_lock
+ * serializes the loads and measurements */
+static GMutex cost_lock;
+static GMutex prepare_lock;
+static Imx2DCostTable cost_tables[IMX_2D_COST_MAX_DEVICES];
+/* device types with a prepare thread started, guarded by cost_lock */
+static gboolean cost_scheduled[IMX_2D_COST_MAX_DEVICES];
+
+static gchar *imx_2d_cost_cache_path (void)
+{
+  const gchar *path = g_getenv ("IMX_2D_COST_CACHE");
+
+  if (path && path[0])
+    return g_strdup (path);
+
+  return g_build_filename (g_get_user_cache_dir (), "gstreamer-1.0",
+                           IMX_2D_COST_CACHE_NAME, NULL);
+}
+
+static gchar *imx_2d_cost_key (Imx2DCostOp op, GstVideoFormat in_fmt,
+                               GstVideoFormat out_fmt)
+{
+  return g_strdup_printf ("%s-%s-%s", cost_op_names[op],
+                          gst_video_format_to_string (in_fmt),
+                          gst_video_format_to_string (out_fmt));
+}
+
+static gboolean imx_2d_cost_load (const Imx2DDeviceInfo *info,
+                                  Imx2DCostTable *table)
+{
+  GKeyFile *kf = g_key_file_new ();
+  gchar *path = imx_2d_cost_cache_path ();
+  gboolean ret = FALSE;
+  guint op, i, j;
+
+  if (!g_key_file_load_from_file (kf, path, G_KEY_FILE_NONE, NULL)
+      || g_key_file_get_integer (kf, info->name, "version", NULL)
+         != IMX_2D_COST_VERSION)
+    goto done;
+
+  for (op = 0; op < IMX_2D_COST_OP_NUM; op++) {
+    for (i = 0; i < G_N_ELEMENTS (cost_formats); i++) {
+      for (j = 0; j < G_N_ELEMENTS (cost_formats); j++) {
+        Imx2DCostEntry entry;
+        gchar *key = imx_2d_cost_key (op, cost_formats[i], cost_formats[j]);
+        gsize len = 0;
+        gdouble *val = g_key_file_get_double_list (kf, info->name, key,
+                                                   &len, NULL);
+        if (val && len == 2) {
+          entry.in_fmt = cost_formats[i];
+          entry.out_fmt = cost_formats[j];
+          entry.base = val[0];
+          entry.per_pixel = val[1];
+          g_array_append_val (table->entries[op], entry);
+        }
+        g_free (val);
+        g_free (key);
+      }
+    }
+  }
+  ret = TRUE;
+  GST_INFO ("loaded %s cost model from %s", info->name, path);
+
+done:
+  g_key_file_free (kf);
+  g_free (path);
+  return ret;
+}
+
+static void imx_2d_cost_save (const Imx2DDeviceInfo *info,
+                              Imx2DCostTable *table)
+{
+  GKeyFile *kf = g_key_file_new ();
+  gchar *path = imx_2d_cost_cache_path ();
+  gchar *dir = g_path_get_dirname (path);
+  GError *err = NULL;
+  guint op, i;
+
+  /* keep the groups of the other devices */
+  g_key_file_load_from_file (kf, path, G_KEY_FILE_KEEP_COMMENTS, NULL);
+  g_key_file_remove_group (kf, info->name, NULL);
+  g_key_file_set_integer (kf, info->name, "version", IMX_2D_COST_VERSION);
+
+  for (op = 0; op < IMX_2D_COST_OP_NUM; op++) {
+    for (i = 0; i < table->entries[op]->len; i++) {
+      Imx2DCostEntry *entry =
+          &g_array_index (table->entries[op], Imx2DCostEntry, i);
+      gdouble val[2] = { entry->base, entry->per_pixel };
+      gchar *key = imx_2d_cost_key (op, entry->in_fmt, entry->out_fmt);
+      g_key_file_set_double_list (kf, info->name, key, val, 2);
+      g_free (key);
+    }
+  }
+
+  g_mkdir_with_parents (dir, 0755);
+  if (!g_key_file_save_to_file (kf, path, &err)) {
+    GST_WARNING ("save 2D cost model to %s failed: %s", path, err->message);
+    g_error_free (err);
+  }
+
+  g_free (dir);
+  g_free (path);
+  g_key_file_free (kf);
+}
+
+static gboolean imx_2d_cost_has_format (GList *list, GstVideoFormat fmt)
+{
+  return g_list_find (list, (gpointer) fmt) != NULL;
+}
+
+static void imx_2d_cost_setup_frame (Imx2DFrame *frame, PhyMemBlock *mem,
+                                     GstVideoFormat fmt, guint w, guint h)
+{
+  GstVideoInfo vinfo;
+
+  gst_video_info_set_format (&vinfo, fmt, w, h);
+  memset (frame, 0, sizeof (Imx2DFrame));
+  frame->mem = mem;
+  frame->fd[0] = frame->fd[1] = frame->fd[2] = frame->fd[3] = -1;
+  frame->info.fmt = fmt;
+  frame->info.w = w;
+  frame->info.h = h;
+  frame->info.stride = GST_VIDEO_INFO_PLANE_STRIDE (&vinfo, 0);
+  frame->info.tile_type = IMX_2D_TILE_NULL;
+  frame->crop.w = w;
+  frame->crop.h = h;
+  frame->rotate = IMX_2D_ROTATION_0;
+  frame->interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
+  frame->alpha = 0xFF;
+}
+
+/* fastest of a few runs, in microseconds, or negative if unsupported */
+static gdouble imx_2d_cost_measure (Imx2DDevice *device, Imx2DCostOp op,
+                                    GstVideoFormat in_fmt,
+                                    GstVideoFormat out_fmt, guint w, guint h,
+                                    PhyMemBlock *src_mem, PhyMemBlock *dst_mem)
+{
+  Imx2DFrame src, dst;
+  PhyMemBlock src_blk = *src_mem, dst_blk = *dst_mem;
+  gint64 best = G_MAXINT64;
+  gint i, ret;
+
+  imx_2d_cost_setup_frame (&src, &src_blk, in_fmt, w, h);
+  imx_2d_cost_setup_frame (&dst, &dst_blk, out_fmt, w, h);
+
+  if (device->config_input (device, &src.info) < 0
+      || device->config_output (device, &dst.info) < 0
+      || device->set_rotate (device, IMX_2D_ROTATION_0) < 0
+      || device->set_deinterlace (device, IMX_2D_DEINTERLACE_NONE) < 0)
+    return -1;
+
+  /* first run is a warm up */
+  for (i = 0; i <= IMX_2D_COST_RUNS; i++) {
+    gint64 start = g_get_monotonic_time ();
+
+    if (op == IMX_2D_COST_OP_BLEND) {
+      ret = device->blend (device, &dst, &src);
+      if (ret >= 0)
+        ret = device->blend_finish (device);
+    } else {
+      ret = device->convert (device, &dst, &src);
+    }
+    if (ret >= 0)
+      ret = imx_2d_device_wait_fence (device, imx_2d_device_get_fence (device));
+    if (ret < 0)
+      return -1;
+
+    if (i > 0)
+      best = MIN (best, g_get_monotonic_time () - start);
+  }
+
+  return (gdouble) best;
+}
+
+static gboolean imx_2d_cost_calibrate (const Imx2DDeviceInfo *info,
+                                       Imx2DCostTable *table)
+{
+  Imx2DDevice *device;
+  PhyMemBlock src_mem, dst_mem;
+  GList *in_list, *out_list;
+  gint64 start = g_get_monotonic_time ();
+  guint op, i, j, k;
+
+  device = info->create (info->device_type);
+  if (!device)
+    return FALSE;
+  if (device->open (device) < 0) {
+    info->destroy (device);
+    return FALSE;
+  }
+
+  memset (&src_mem, 0, sizeof (PhyMemBlock));
+  memset (&dst_mem, 0, sizeof (PhyMemBlock));
+  src_mem.size = dst_mem.size = cost_sizes[1].w * cost_sizes[1].h * 4;
+  if (device->alloc_mem (device, &src_mem) < 0) {
+    device->close (device);
+    info->destroy (device);
+    return FALSE;
+  }
+  if (device->alloc_mem (device, &dst_mem) < 0) {
+    device->free_mem (device, &src_mem);
+    device->close (device);
+    info->destroy (device);
+    return FALSE;
+  }
+  if (src_mem.vaddr)
+    memset (src_mem.vaddr, 0x80, src_mem.size);
+
+  in_list = device->get_supported_in_fmts (device);
+  out_list = device->get_supported_out_fmts (device);
+
+  for (op = 0; op < IMX_2D_COST_OP_NUM; op++) {
+    if (op == IMX_2D_COST_OP_BLEND
+        && !(device->get_capabilities (device) & IMX_2D_DEVICE_CAP_BLEND))
+      continue;
+
+    for (i = 0; i < G_N_ELEMENTS (cost_formats); i++) {
+      if (!imx_2d_cost_has_format (in_list, cost_formats[i]))
+        continue;
+
+      for (j = 0; j < G_N_ELEMENTS (cost_formats); j++) {
+        Imx2DCostEntry entry;
+        gdouble t[2];
+        guint p[2];
+
+        if (!imx_2d_cost_has_format (out_list, cost_formats[j]))
+          continue;
+
+        for (k = 0; k < 2; k++) {
+          p[k] = cost_sizes[k].w * cost_sizes[k].h;
+          t[k] = imx_2d_cost_measure (device, op, cost_formats[i],
+                     cost_formats[j], cost_sizes[k].w, cost_sizes[k].h,
+                     &src_mem, &dst_mem);
+          if (t[k] < 0)
+            break;
+        }
+        if (k < 2)
+          continue;
+
+        /* two sizes give the fixed and the per pixel part */
+        entry.in_fmt = cost_formats[i];
+        entry.out_fmt = cost_formats[j];
+        entry.per_pixel = MAX (t[1] - t[0], 0) / (p[1] - p[0]);
+        entry.base = MAX (t[0] - entry.per_pixel * p[0], 0);
+        g_array_append_val (table->entries[op], entry);
+
+        GST_DEBUG ("%s %s %s -> %s: %.1f us + %.3f us/Kpixel", info->name,
+                   cost_op_names[op], gst_video_format_to_string (entry.in_fmt),
+                   gst_video_format_to_string (entry.out_fmt), entry.base,
+                   entry.per_pixel * 1000);
+      }
+    }
+  }
+
+  g_list_free (in_list);
+  g_list_free (out_list);
+  device->free_mem (device, &dst_mem);
+  device->free_mem (device, &src_mem);
+  device->close (device);
+  info->destroy (device);
+
+  GST_INFO ("calibrated %s in %" G_GINT64_FORMAT " ms", info->name,
+            (g_get_monotonic_time () - start) / 1000);
+  return TRUE;
+}
+
+/* called with cost_lock held */
+static Imx2DCostTable *imx_2d_cost_lookup_table (Imx2DDeviceType device_type)
+{
+  if (device_type >= IMX_2D_COST_MAX_DEVICES
+      || !cost_tables[device_type].loaded)
+    return NULL;
+
+  return &cost_tables[device_type];
+}
+
+void imx_2d_device_cost_prepare (Imx2DDeviceType device_type)
+{
+  const Imx2DDeviceInfo *info = imx_get_2d_devices ();
+  const gchar *calibrate = g_getenv ("IMX_2D_COST_CALIBRATE");
+  Imx2DCostTable table;
+  gboolean loaded;
+  guint op;
+
+  /* the split device only combines devices that are measured themselves */
+  if (device_type == IMX_2D_DEVICE_SPLIT) {
+    for (; info->name; info++) {
+      if (info->device_type != IMX_2D_DEVICE_SPLIT && info->is_exist ())
+        imx_2d_device_cost_prepare (info->device_type);
+    }
+    return;
+  }
+
+  if (device_type >= IMX_2D_COST_MAX_DEVICES)
+    return;
+
+  while (info->name && info->device_type != device_type)
+    info++;
+  if (!info->name || !info->is_exist ())
+    return;
+
+  g_mutex_lock (&prepare_lock);
+  g_mutex_lock (&cost_lock);
+  loaded = cost_tables[device_type].loaded;
+  g_mutex_unlock (&cost_lock);
+  if (loaded)
+    goto done;
+
+  memset (&table, 0, sizeof (Imx2DCostTable));
+  for (op = 0; op < IMX_2D_COST_OP_NUM; op++)
+    table.entries[op] = g_array_new (FALSE, FALSE, sizeof (Imx2DCostEntry));
+
+  if (g_strcmp0 (calibrate, "force") == 0 || !imx_2d_cost_load (info, &table)) {
+    if (g_strcmp0 (calibrate, "0") == 0) {
+      GST_INFO ("2D cost calibration disabled");
+    } else if (imx_2d_cost_calibrate (info, &table)) {
+      imx_2d_cost_save (info, &table);
+    } else {
+      GST_WARNING ("calibrate 2D device %s failed", info->name);
+    }
+  }
+
+  table.loaded = TRUE;
+  g_mutex_lock (&cost_lock);
+  cost_tables[device_type] = table;
+  g_mutex_unlock (&cost_lock);
+
+done:
+  g_mutex_unlock (&prepare_lock);
+}
+
+static gpointer imx_2d_cost_prepare_thread (gpointer data)
+{
+  Imx2DDeviceType device_type = GPOINTER_TO_INT (data);
+  gint64 start = g_get_monotonic_time ();
+
+  imx_2d_device_cost_prepare (device_type);
+  GST_DEBUG ("2D device %d cost prepared in background in %" G_GINT64_FORMAT
+             " ms", device_type, (g_get_monotonic_time () - start) / 1000);
+
+  return NULL;
+}
+
+void imx_2d_device_cost_prepare_async (Imx2DDeviceType device_type)
+{
+  GThread *thread;
+  gboolean scheduled;
+
+  if (device_type >= IMX_2D_COST_MAX_DEVICES)
+    return;
+
+  g_mutex_lock (&cost_lock);
+  scheduled = cost_scheduled[device_type];
+  cost_scheduled[device_type] = TRUE;
+  g_mutex_unlock (&cost_lock);
+  if (scheduled)
+    return;
+
+  thread = g_thread_try_new ("imx2dcost", imx_2d_cost_prepare_thread,
+                             GINT_TO_POINTER (device_type), NULL);
+  if (thread) {
+    g_thread_unref (thread);
+  } else {
+    GST_WARNING ("start 2D device %d cost preparation failed", device_type);
+    g_mutex_lock (&cost_lock);
+    cost_scheduled[device_type] = FALSE;
+    g_mutex_unlock (&cost_lock);
+  }
+}
+
+gdouble imx_2d_device_cost_get (Imx2DDeviceType device_type, Imx2DCostOp op,
+                                GstVideoFormat in_fmt, GstVideoFormat out_fmt,
+                                guint pixels)
+{
+  Imx2DCostTable *table;
+  gdouble cost = -1;
+  guint i;
+
+  if (op >= IMX_2D_COST_OP_NUM)
+    return -1;
+
+  g_mutex_lock (&cost_lock);
+  table = imx_2d_cost_lookup_table (device_type);
+  if (table) {
+    for (i = 0; i < table->entries[op]->len; i++) {
+      Imx2DCostEntry *entry =
+          &g_array_index (table->entries[op], Imx2DCostEntry, i);
+      if (entry->in_fmt == in_fmt && entry->out_fmt == out_fmt) {
+        cost = entry->base + entry->per_pixel * pixels;
+        break;
+      }
+    }
+  }
+  g_mutex_unlock (&cost_lock);
+
+  return cost;
+}
+
+const Imx2DDeviceInfo * imx_2d_device_cost_choose (Imx2DCostOp op,
+                                GstVideoFormat in_fmt, GstVideoFormat out_fmt,
+                                guint pixels, gdouble *cost)
+{
+  const Imx2DDeviceInfo *info = imx_get_2d_devices ();
+  const Imx2DDeviceInfo *best = NULL;
+  gdouble best_cost = -1;
+
+  while (info->name) {
+    if (info->is_exist ()) {
+      gdouble c = imx_2d_device_cost_get (info->device_type, op, in_fmt,
+                                          out_fmt, pixels);
+      if (c >= 0 && (!best || c < best_cost)) {
+        best = info;
+        best_cost = c;
+      }
+    }
+    info++;
+  }
+
+  if (best)
+    GST_DEBUG ("%s %s -> %s %u pixels: %s, %.1f us", cost_op_names[op],
+               gst_video_format_to_string (in_fmt),
+               gst_video_format_to_string (out_fmt), pixels, best->name,
+               best_cost);
+  if (cost)
+    *cost = best_cost;
+
+  return best;
+}
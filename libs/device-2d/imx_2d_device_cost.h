@@ -0,0 +1,61 @@
+/* GStreamer IMX Video 2D Device measured cost model
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __IMX_2D_DEVICE_COST_H__
+#define __IMX_2D_DEVICE_COST_H__
+
+#include "imx_2d_device.h"
+
+/* Each available device is benchmarked once for a set of representative
+ * (operation, input format, output format) tuples at two frame sizes, the
+ * result is kept as a fixed cost plus a per pixel cost. Measurements are
+ * cached in $IMX_2D_COST_CACHE, or imx-2d-device-cost.ini under the user
+ * cache directory. IMX_2D_COST_CALIBRATE=0 disables calibration, "force"
+ * ignores the cache. Calibration may take seconds, it only runs from
+ * imx_2d_device_cost_prepare(), the lookups read the tables prepared so far
+ * and never block on a measurement. */
+
+typedef enum {
+  IMX_2D_COST_OP_CONVERT,
+  IMX_2D_COST_OP_BLEND,
+  IMX_2D_COST_OP_NUM
+} Imx2DCostOp;
+
+/* load or measure the cost of a device, call it outside of any lock before
+ * the lookups, e.g. when the element starts. The split device prepares the
+ * devices it combines. */
+void imx_2d_device_cost_prepare (Imx2DDeviceType device_type);
+
+/* imx_2d_device_cost_prepare() on a thread of its own, started once per
+ * device type. The lookups fail until it is done, callers keep to the
+ * static complexity and loss values meanwhile. */
+void imx_2d_device_cost_prepare_async (Imx2DDeviceType device_type);
+
+/* estimated microseconds for one operation on pixels output pixels,
+ * negative if the tuple was not measured or the device not prepared */
+gdouble imx_2d_device_cost_get (Imx2DDeviceType device_type, Imx2DCostOp op,
+                                GstVideoFormat in_fmt, GstVideoFormat out_fmt,
+                                guint pixels);
+
+/* cheapest prepared device for the tuple, NULL if nothing was measured */
+const Imx2DDeviceInfo * imx_2d_device_cost_choose (Imx2DCostOp op,
+                                GstVideoFormat in_fmt, GstVideoFormat out_fmt,
+                                guint pixels, gdouble *cost);
+
+#endif /* __IMX_2D_DEVICE_COST_H__ */
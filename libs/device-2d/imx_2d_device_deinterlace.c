@@ -0,0 +1,385 @@
+/* GStreamer IMX Video 2D Device software deinterlacer
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DEINT_NEON 1
+#endif
+#include "imx_2d_device_deinterlace.h"
+
+GST_DEBUG_CATEGORY_EXTERN (imx2ddevice_debug);
+#define GST_CAT_DEFAULT imx2ddevice_debug
+
+#define DEINT_MAX_THREADS     4
+#define DEINT_MIN_STRIPE_ROWS 32
+#define DEINT_MAX_PLANES      3
+/* per byte difference to the previous frame below which a bottom field
+ * row is woven, the next DEINT_MOTION_RANGE values fade to bob */
+#define DEINT_MOTION_LOW      8
+#define DEINT_MOTION_RANGE    16
+
+typedef struct {
+  gsize offset;
+  guint stride;
+  guint rows;
+  guint bytes;
+} DeintPlane;
+
+struct _Imx2DDeinterlacer {
+  guint8 *prev;
+  gsize prev_size;
+  gboolean has_prev;
+};
+
+typedef struct {
+  Imx2DDeinterlaceMode mode;
+  const DeintPlane *plane;
+  const guint8 *src;
+  const guint8 *prev;
+  guint8 *dst;
+} DeintJob;
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  gint pending;
+} DeintBatch;
+
+typedef struct {
+  DeintJob *job;
+  guint start;
+  guint end;
+  DeintBatch *batch;
+} DeintStripe;
+
+static GThreadPool *deint_pool;
+static guint deint_threads = 1;
+
+static gint
+imx_2d_deinterlace_planes (const Imx2DVideoInfo *info, DeintPlane *planes)
+{
+  guint stride = info->stride, h = info->h;
+
+  planes[0].offset = 0;
+  planes[0].stride = stride;
+  planes[0].rows = h;
+
+  switch (info->fmt) {
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_NV21:
+      planes[0].bytes = info->w;
+      planes[1].offset = (gsize) stride * h;
+      planes[1].stride = stride;
+      planes[1].rows = h / 2;
+      planes[1].bytes = info->w;
+      return 2;
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_YV12:
+      planes[0].bytes = info->w;
+      planes[1].offset = (gsize) stride * h;
+      planes[1].stride = stride / 2;
+      planes[1].rows = h / 2;
+      planes[1].bytes = info->w / 2;
+      planes[2] = planes[1];
+      planes[2].offset = planes[1].offset + (gsize) (stride / 2) * (h / 2);
+      return 3;
+    case GST_VIDEO_FORMAT_YUY2:
+    case GST_VIDEO_FORMAT_UYVY:
+    case GST_VIDEO_FORMAT_YVYU:
+      planes[0].bytes = info->w * 2;
+      return 1;
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_BGRA:
+    case GST_VIDEO_FORMAT_ARGB:
+    case GST_VIDEO_FORMAT_ABGR:
+    case GST_VIDEO_FORMAT_RGBx:
+    case GST_VIDEO_FORMAT_BGRx:
+    case GST_VIDEO_FORMAT_xRGB:
+    case GST_VIDEO_FORMAT_xBGR:
+      planes[0].bytes = info->w * 4;
+      return 1;
+    default:
+      /* RGB16 and tiled layouts can't be filtered byte by byte */
+      return 0;
+  }
+}
+
+gboolean imx_2d_deinterlace_supported (GstVideoFormat fmt)
+{
+  Imx2DVideoInfo info;
+  DeintPlane planes[DEINT_MAX_PLANES];
+
+  memset (&info, 0, sizeof (Imx2DVideoInfo));
+  info.fmt = fmt;
+  info.w = info.h = info.stride = 16;
+  return imx_2d_deinterlace_planes (&info, planes) > 0;
+}
+
+gsize imx_2d_deinterlace_frame_size (const Imx2DVideoInfo *info)
+{
+  DeintPlane planes[DEINT_MAX_PLANES];
+  gint n = imx_2d_deinterlace_planes (info, planes);
+
+  if (n == 0 || info->tile_type != IMX_2D_TILE_NULL)
+    return 0;
+
+  return planes[n - 1].offset
+      + (gsize) planes[n - 1].stride * planes[n - 1].rows;
+}
+
+/* d = (a + b + 1) / 2 */
+static inline void
+deint_row_avg (guint8 * __restrict d, const guint8 * __restrict a,
+               const guint8 * __restrict b, guint n)
+{
+  guint i = 0;
+
+#ifdef DEINT_NEON
+  for (; i + 16 <= n; i += 16)
+    vst1q_u8 (d + i, vrhaddq_u8 (vld1q_u8 (a + i), vld1q_u8 (b + i)));
+#endif
+  for (; i < n; i++)
+    d[i] = (a[i] + b[i] + 1) >> 1;
+}
+
+/* d ~= (a + 2b + c) / 4 */
+static inline void
+deint_row_blend (guint8 * __restrict d, const guint8 * __restrict a,
+                 const guint8 * __restrict b, const guint8 * __restrict c,
+                 guint n)
+{
+  guint i = 0;
+
+#ifdef DEINT_NEON
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t ac = vrhaddq_u8 (vld1q_u8 (a + i), vld1q_u8 (c + i));
+    vst1q_u8 (d + i, vrhaddq_u8 (vld1q_u8 (b + i), ac));
+  }
+#endif
+  for (; i < n; i++)
+    d[i] = (b[i] + ((a[i] + c[i] + 1) >> 1) + 1) >> 1;
+}
+
+/* weave cur where it matches prev, fade to the average of the top field
+ * neighbours a and c as the difference grows */
+static inline void
+deint_row_adaptive (guint8 * __restrict d, const guint8 * __restrict a,
+                    const guint8 * __restrict cur,
+                    const guint8 * __restrict prev,
+                    const guint8 * __restrict c, guint n)
+{
+  guint i = 0;
+
+#ifdef DEINT_NEON
+  const uint8x16_t low = vdupq_n_u8 (DEINT_MOTION_LOW);
+  const uint8x16_t range = vdupq_n_u8 (DEINT_MOTION_RANGE);
+
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8 (cur + i);
+    uint8x16_t sp = vrhaddq_u8 (vld1q_u8 (a + i), vld1q_u8 (c + i));
+    uint8x16_t w = vminq_u8 (vqsubq_u8 (vabdq_u8 (v, vld1q_u8 (prev + i)),
+                                        low), range);
+    uint8x16_t iw = vsubq_u8 (range, w);
+    uint16x8_t lo = vmlal_u8 (vmull_u8 (vget_low_u8 (v), vget_low_u8 (iw)),
+                              vget_low_u8 (sp), vget_low_u8 (w));
+    uint16x8_t hi = vmlal_u8 (vmull_u8 (vget_high_u8 (v), vget_high_u8 (iw)),
+                              vget_high_u8 (sp), vget_high_u8 (w));
+    vst1q_u8 (d + i, vcombine_u8 (vrshrn_n_u16 (lo, 4), vrshrn_n_u16 (hi, 4)));
+  }
+#endif
+  for (; i < n; i++) {
+    gint m = ABS ((gint) cur[i] - (gint) prev[i]) - DEINT_MOTION_LOW;
+    gint w = CLAMP (m, 0, DEINT_MOTION_RANGE);
+    gint sp = (a[i] + c[i] + 1) >> 1;
+    d[i] = (cur[i] * (DEINT_MOTION_RANGE - w) + sp * w + 8) >> 4;
+  }
+}
+
+static void
+imx_2d_deinterlace_rows (DeintJob *job, guint start, guint end)
+{
+  const DeintPlane *p = job->plane;
+  const guint8 *src = job->src + p->offset;
+  const guint8 *prev = job->prev ? job->prev + p->offset : NULL;
+  guint8 *dst = job->dst + p->offset;
+  guint r;
+
+  for (r = start; r < end; r++) {
+    /* rows outside the plane mirror to the other neighbour */
+    const guint8 *above = src + (gsize) (r > 0 ? r - 1 : r + 1) * p->stride;
+    const guint8 *below = src +
+        (gsize) (r + 1 < p->rows ? r + 1 : r - 1) * p->stride;
+    const guint8 *cur = src + (gsize) r * p->stride;
+    guint8 *out = dst + (gsize) r * p->stride;
+
+    if (p->rows < 2) {
+      memcpy (out, cur, p->bytes);
+      continue;
+    }
+
+    if (job->mode == IMX_2D_DEINTERLACE_MID_MOTION) {
+      deint_row_blend (out, above, cur, below, p->bytes);
+    } else if (!(r & 1)) {
+      memcpy (out, cur, p->bytes);
+    } else if (job->mode == IMX_2D_DEINTERLACE_LOW_MOTION && prev) {
+      deint_row_adaptive (out, above, cur, prev + (gsize) r * p->stride,
+                          below, p->bytes);
+    } else {
+      deint_row_avg (out, above, below, p->bytes);
+    }
+  }
+}
+
+static void
+imx_2d_deinterlace_stripe_run (gpointer data, gpointer user_data)
+{
+  DeintStripe *stripe = (DeintStripe *) data;
+
+  imx_2d_deinterlace_rows (stripe->job, stripe->start, stripe->end);
+
+  g_mutex_lock (&stripe->batch->lock);
+  if (--stripe->batch->pending == 0)
+    g_cond_signal (&stripe->batch->cond);
+  g_mutex_unlock (&stripe->batch->lock);
+}
+
+static gpointer
+imx_2d_deinterlace_pool_init (gpointer data)
+{
+  deint_threads = CLAMP (g_get_num_processors (), 1, DEINT_MAX_THREADS);
+  if (deint_threads > 1)
+    deint_pool = g_thread_pool_new (imx_2d_deinterlace_stripe_run, NULL,
+                                    deint_threads - 1, FALSE, NULL);
+  if (!deint_pool)
+    deint_threads = 1;
+
+  GST_DEBUG ("software deinterlace with %u threads", deint_threads);
+  return NULL;
+}
+
+static void
+imx_2d_deinterlace_plane (DeintJob *job)
+{
+  DeintStripe stripes[DEINT_MAX_THREADS];
+  DeintBatch batch;
+  guint rows = job->plane->rows, n, size, i;
+
+  n = MIN (deint_threads, rows / DEINT_MIN_STRIPE_ROWS);
+  if (n <= 1) {
+    imx_2d_deinterlace_rows (job, 0, rows);
+    return;
+  }
+
+  /* even stripe size keeps both fields of a row pair in one stripe */
+  size = ALIGNTO ((rows + n - 1) / n, 2);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+
+  for (i = 0; i < n && i * size < rows; i++) {
+    stripes[i].job = job;
+    stripes[i].start = i * size;
+    stripes[i].end = MIN (rows, (i + 1) * size);
+    stripes[i].batch = &batch;
+  }
+  n = i;
+  batch.pending = n - 1;
+
+  for (i = 1; i < n; i++)
+    g_thread_pool_push (deint_pool, &stripes[i], NULL);
+  imx_2d_deinterlace_rows (job, stripes[0].start, stripes[0].end);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+}
+
+Imx2DDeinterlacer * imx_2d_deinterlacer_new (void)
+{
+  static GOnce pool_once = G_ONCE_INIT;
+
+  g_once (&pool_once, imx_2d_deinterlace_pool_init, NULL);
+  return g_slice_new0 (Imx2DDeinterlacer);
+}
+
+void imx_2d_deinterlacer_free (Imx2DDeinterlacer *deint)
+{
+  if (!deint)
+    return;
+
+  g_free (deint->prev);
+  g_slice_free (Imx2DDeinterlacer, deint);
+}
+
+void imx_2d_deinterlacer_reset (Imx2DDeinterlacer *deint)
+{
+  if (deint)
+    deint->has_prev = FALSE;
+}
+
+gint imx_2d_deinterlacer_process (Imx2DDeinterlacer *deint,
+                                  Imx2DDeinterlaceMode mode,
+                                  const Imx2DVideoInfo *info,
+                                  const guint8 *src, guint8 *dst)
+{
+  DeintPlane planes[DEINT_MAX_PLANES];
+  DeintJob job;
+  gsize size;
+  gint n, i;
+
+  if (!deint || !info || !src || !dst || mode == IMX_2D_DEINTERLACE_NONE)
+    return -1;
+
+  n = imx_2d_deinterlace_planes (info, planes);
+  size = imx_2d_deinterlace_frame_size (info);
+  if (n == 0 || size == 0)
+    return -1;
+
+  if (deint->prev_size != size) {
+    g_free (deint->prev);
+    deint->prev = g_malloc (size);
+    deint->prev_size = size;
+    deint->has_prev = FALSE;
+  }
+
+  job.mode = mode;
+  job.src = src;
+  job.dst = dst;
+  job.prev = deint->has_prev ? deint->prev : NULL;
+  for (i = 0; i < n; i++) {
+    job.plane = &planes[i];
+    imx_2d_deinterlace_plane (&job);
+  }
+
+  /* only the motion adaptive mode looks at the previous frame */
+  if (mode == IMX_2D_DEINTERLACE_LOW_MOTION) {
+    memcpy (deint->prev, src, size);
+    deint->has_prev = TRUE;
+  }
+
+  GST_TRACE ("deinterlaced %s %ux%u, mode %d",
+             gst_video_format_to_string (info->fmt), info->w, info->h, mode);
+
+  return 0;
+}
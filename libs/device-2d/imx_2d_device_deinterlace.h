@@ -0,0 +1,49 @@
+/* GStreamer IMX Video 2D Device software deinterlacer
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __IMX_2D_DEVICE_DEINTERLACE_H__
+#define __IMX_2D_DEVICE_DEINTERLACE_H__
+
+#include "imx_2d_device.h"
+
+/* Deinterlaces interleaved frames on the CPU for devices without
+ * IMX_2D_DEVICE_CAP_DEINTERLACE. The top field is kept and the bottom
+ * field rows are rebuilt:
+ *   IMX_2D_DEINTERLACE_HIGH_MOTION  bob, interpolated from the top field
+ *   IMX_2D_DEINTERLACE_MID_MOTION   linear blend of the two fields
+ *   IMX_2D_DEINTERLACE_LOW_MOTION   motion adaptive, weaves where the
+ *                                   bottom field did not change since the
+ *                                   previous frame and bobs elsewhere */
+
+typedef struct _Imx2DDeinterlacer Imx2DDeinterlacer;
+
+gboolean imx_2d_deinterlace_supported (GstVideoFormat fmt);
+/* bytes of a contiguous frame, 0 if the format is not supported */
+gsize imx_2d_deinterlace_frame_size (const Imx2DVideoInfo *info);
+
+Imx2DDeinterlacer * imx_2d_deinterlacer_new (void);
+void imx_2d_deinterlacer_free (Imx2DDeinterlacer *deint);
+/* forget the previous frame, after a seek or a format change */
+void imx_2d_deinterlacer_reset (Imx2DDeinterlacer *deint);
+gint imx_2d_deinterlacer_process (Imx2DDeinterlacer *deint,
+                                  Imx2DDeinterlaceMode mode,
+                                  const Imx2DVideoInfo *info,
+                                  const guint8 *src, guint8 *dst);
+
+#endif /* __IMX_2D_DEVICE_DEINTERLACE_H__ */
@@ -32,6 +32,12 @@ typedef struct _Imx2DDeviceG2d {
   void *g2d_handle;
   struct g2d_surfaceEx src;
   struct g2d_surfaceEx dst;
+  /* async mode defers g2d_finish until a fence is waited on */
+  gboolean async;
+  guint64 submitted;
+  guint64 completed;
+  /* set while a blend batch queues its blits */
+  gboolean batching;
 } Imx2DDeviceG2d;
 
 typedef struct {
@@ -161,6 +167,8 @@ static gint imx_g2d_close(Imx2DDevice *device)
   if (device) {
     Imx2DDeviceG2d *g2d = (Imx2DDeviceG2d *) (device->priv);
     if (g2d) {
+      if (g2d->submitted > g2d->completed)
+        g2d_finish (g2d->g2d_handle);
       g2d_close (g2d->g2d_handle);
       g_slice_free1(sizeof(Imx2DDeviceG2d), g2d);
     }
@@ -170,6 +178,66 @@ static gint imx_g2d_close(Imx2DDevice *device)
 }
 
 
+/* account one queued operation, in sync mode wait for it right away */
+static gint imx_g2d_submit(Imx2DDeviceG2d *g2d)
+{
+  gint ret = 0;
+
+  if (g2d->batching)
+    return 0;
+
+  g2d->submitted++;
+  if (g2d->async) {
+    ret = g2d_flush(g2d->g2d_handle);
+  } else {
+    ret = g2d_finish(g2d->g2d_handle);
+    g2d->completed = g2d->submitted;
+  }
+
+  return ret;
+}
+
+static gint imx_g2d_wait_fence(Imx2DDevice *device, guint64 fence)
+{
+  gint ret = 0;
+
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceG2d *g2d = (Imx2DDeviceG2d *) (device->priv);
+  if (fence > g2d->completed) {
+    /* g2d can only wait for everything queued on the handle */
+    ret = g2d_finish(g2d->g2d_handle);
+    g2d->completed = g2d->submitted;
+    GST_TRACE("waited fence %" G_GUINT64_FORMAT, fence);
+  }
+
+  return ret;
+}
+
+static guint64 imx_g2d_get_fence(Imx2DDevice *device)
+{
+  if (!device || !device->priv)
+    return 0;
+
+  Imx2DDeviceG2d *g2d = (Imx2DDeviceG2d *) (device->priv);
+  return g2d->submitted;
+}
+
+static gint imx_g2d_set_async(Imx2DDevice *device, gboolean async)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceG2d *g2d = (Imx2DDeviceG2d *) (device->priv);
+  if (g2d->async && !async)
+    imx_g2d_wait_fence(device, g2d->submitted);
+  g2d->async = async;
+  GST_DEBUG("g2d async submission %s", async ? "enabled" : "disabled");
+
+  return 0;
+}
+
 static gint
 imx_g2d_alloc_mem(Imx2DDevice *device, PhyMemBlock *memblk)
 {
@@ -220,16 +288,18 @@ static gint imx_g2d_copy_mem(Imx2DDevice* device, PhyMemBlock *dst_mem,
   if (!device || !device->priv)
     return -1;
 
-  dst_mem->size = src_mem->size;
+  if (!dst_mem->vaddr) {
+    dst_mem->size = src_mem->size;
 
-  pbuf = g2d_alloc (dst_mem->size, 0);
-  if (!pbuf) {
-    GST_ERROR ("g2d_alloc failed.");
-    return -1;
+    pbuf = g2d_alloc (dst_mem->size, 0);
+    if (!pbuf) {
+      GST_ERROR ("g2d_alloc failed.");
+      return -1;
+    }
+    dst_mem->vaddr = (gchar*) pbuf->buf_vaddr;
+    dst_mem->paddr = (gchar*) pbuf->buf_paddr;
+    dst_mem->user_data = (gpointer) pbuf;
   }
-  dst_mem->vaddr = (gchar*) pbuf->buf_vaddr;
-  dst_mem->paddr = (gchar*) pbuf->buf_paddr;
-  dst_mem->user_data = (gpointer) pbuf;
 
   Imx2DDeviceG2d *g2d = (Imx2DDeviceG2d *) (device->priv);
   g2d_handle = g2d->g2d_handle;
@@ -246,6 +316,7 @@ static gint imx_g2d_copy_mem(Imx2DDevice* device, PhyMemBlock *dst_mem,
   if (size > dst.buf_size)
     size = dst.buf_size;
 
+  /* memory copies back the allocator copy path, always synchronous */
   g2d_copy (g2d_handle, &dst, &src, size);
   g2d_finish(g2d_handle);
 
@@ -281,7 +352,7 @@ static gint imx_g2d_frame_copy(Imx2DDevice *device,
 
   ret = g2d_copy (g2d_handle, &dst, &src, dst.buf_size);
 
-  g2d_finish(g2d_handle);
+  ret |= imx_g2d_submit(g2d);
   GST_LOG("G2D frame memory (%p)->(%p)", from->paddr, to->paddr);
 
   return ret;
@@ -554,7 +625,7 @@ static gint imx_g2d_blit(Imx2DDevice *device,
     ret = g2d_blitEx(g2d_handle, &g2d->src, &g2d->dst);
   }
 
-  ret |= g2d_finish(g2d_handle);
+  ret |= imx_g2d_submit(g2d);
 
 err:
 
@@ -670,10 +741,48 @@ static gint imx_g2d_blend(Imx2DDevice *device, Imx2DFrame *dst, Imx2DFrame *src)
   return imx_g2d_blit(device, dst, src, TRUE);
 }
 
+/* queue every layer in the g2d command buffer and submit them together */
+static gint imx_g2d_blend_batch(Imx2DDevice *device, Imx2DFrame *dst,
+                                Imx2DBlendLayer *layers, gint n_layers)
+{
+  gint i, blended = 0;
+
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceG2d *g2d = (Imx2DDeviceG2d *) (device->priv);
+  g2d->batching = TRUE;
+  for (i = 0; i < n_layers; i++) {
+    Imx2DBlendLayer *layer = &layers[i];
+
+    dst->crop = layer->dst_crop;
+    layer->ret = imx_g2d_config_input(device, &layer->src.info);
+    if (layer->ret < 0)
+      continue;
+    imx_g2d_set_rotate(device, layer->src.rotate);
+    layer->ret = imx_g2d_blit(device, dst, &layer->src, TRUE);
+    if (layer->ret >= 0)
+      blended++;
+  }
+  g2d->batching = FALSE;
+
+  if (blended > 0 && imx_g2d_submit(g2d) < 0) {
+    GST_WARNING("g2d batch submission failed");
+    for (i = 0; i < n_layers; i++)
+      layers[i].ret = -1;
+    return 0;
+  }
+
+  return blended;
+}
+
 static gint imx_g2d_blend_finish(Imx2DDevice *device)
 {
-  //do nothing
-  return 0;
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceG2d *g2d = (Imx2DDeviceG2d *) (device->priv);
+  return imx_g2d_wait_fence(device, g2d->submitted);
 }
 
 static gint imx_g2d_fill_color(Imx2DDevice *device, Imx2DFrame *dst,
@@ -703,24 +812,27 @@ static gint imx_g2d_fill_color(Imx2DDevice *device, Imx2DFrame *dst,
 
   g2d->dst.base.clrcolor = RGBA8888;
   g2d->dst.base.planes[0] = (gint)(dst->mem->paddr);
-  g2d->dst.base.left = 0;
-  g2d->dst.base.top = 0;
-  g2d->dst.base.right = g2d->dst.base.width;
-  g2d->dst.base.bottom = g2d->dst.base.height;
+  /* only the destination crop is filled */
+  g2d->dst.base.left = CLAMP (dst->crop.x, 0, g2d->dst.base.width);
+  g2d->dst.base.top = CLAMP (dst->crop.y, 0, g2d->dst.base.height);
+  g2d->dst.base.right = MIN (dst->crop.x + (gint) dst->crop.w,
+      g2d->dst.base.width);
+  g2d->dst.base.bottom = MIN (dst->crop.y + (gint) dst->crop.h,
+      g2d->dst.base.height);
 
   GST_TRACE ("g2d clear : %dx%d,%d(%d,%d-%d,%d), format=%d",
       g2d->dst.base.width, g2d->dst.base.height, g2d->dst.base.stride, g2d->dst.base.left,
       g2d->dst.base.top, g2d->dst.base.right, g2d->dst.base.bottom, g2d->dst.base.format);
 
   ret = g2d_clear(g2d_handle, &g2d->dst.base);
-  ret |= g2d_finish(g2d_handle);
+  ret |= imx_g2d_submit(g2d);
 
   return ret;
 }
 
 Imx2DDevice * imx_g2d_create(Imx2DDeviceType  device_type)
 {
-  Imx2DDevice * device = g_slice_alloc(sizeof(Imx2DDevice));
+  Imx2DDevice * device = g_slice_alloc0(sizeof(Imx2DDevice));
   if (!device) {
     GST_ERROR("allocate device structure failed\n");
     return NULL;
@@ -741,6 +853,10 @@ Imx2DDevice * imx_g2d_create(Imx2DDeviceType  device_type)
   device->blend               = imx_g2d_blend;
   device->blend_finish        = imx_g2d_blend_finish;
   device->fill                = imx_g2d_fill_color;
+  device->set_async           = imx_g2d_set_async;
+  device->get_fence           = imx_g2d_get_fence;
+  device->wait_fence          = imx_g2d_wait_fence;
+  device->blend_batch         = imx_g2d_blend_batch;
   device->set_rotate          = imx_g2d_set_rotate;
   device->set_deinterlace     = imx_g2d_set_deinterlace;
   device->get_rotate          = imx_g2d_get_rotate;
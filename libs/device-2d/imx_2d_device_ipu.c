@@ -227,18 +227,22 @@ static gint imx_ipu_copy_mem(Imx2DDevice* device, PhyMemBlock *dst_mem,
   if (size > src_mem->size - offset)
     size = src_mem->size - offset;
 
-  dst_mem->user_data = NULL;
-  dst_mem->size = PAGE_ALIGN(size);
+  if (!dst_mem->vaddr) {
+    dst_mem->user_data = NULL;
+    dst_mem->size = PAGE_ALIGN(size);
 
-  mem = (dma_addr_t)(dst_mem->size);
-  if (ioctl(ipu->ipu_fd, IPU_ALLOC, &mem) < 0) {
-    GST_ERROR("IPU allocate %u bytes memory failed: %s", size, strerror(errno));
-    return -1;
-  }
+    mem = (dma_addr_t)(dst_mem->size);
+    if (ioctl(ipu->ipu_fd, IPU_ALLOC, &mem) < 0) {
+      GST_ERROR("IPU allocate %u bytes memory failed: %s", size, strerror(errno));
+      return -1;
+    }
 
-  dst_mem->paddr = (guchar *)mem;
-  dst_mem->vaddr = mmap(0, dst_mem->size, PROT_READ|PROT_WRITE, MAP_SHARED,
-                       ipu->ipu_fd, (dma_addr_t)(dst_mem->paddr));
+    dst_mem->paddr = (guchar *)mem;
+    dst_mem->vaddr = mmap(0, dst_mem->size, PROT_READ|PROT_WRITE, MAP_SHARED,
+                         ipu->ipu_fd, (dma_addr_t)(dst_mem->paddr));
+  } else if (size > dst_mem->size) {
+    size = dst_mem->size;
+  }
   memcpy(dst_mem->vaddr, src_mem->vaddr+offset, size);
 
   GST_DEBUG ("IPU copy from vaddr (%p), paddr (%p), size (%d) to "
@@ -1028,7 +1032,7 @@ static GList* imx_ipu_get_supported_out_fmts(Imx2DDevice* device)
 
 Imx2DDevice * imx_ipu_create(Imx2DDeviceType  device_type)
 {
-  Imx2DDevice * device = g_slice_alloc(sizeof(Imx2DDevice));
+  Imx2DDevice * device = g_slice_alloc0(sizeof(Imx2DDevice));
   if (!device) {
     GST_ERROR("allocate device structure failed\n");
     return NULL;
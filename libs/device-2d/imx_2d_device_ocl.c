@@ -557,7 +557,7 @@ static gint imx_ocl_fill_color (Imx2DDevice *device, Imx2DFrame *dst,
 
 Imx2DDevice * imx_ocl_create (Imx2DDeviceType  device_type)
 {
-  Imx2DDevice * device = g_slice_alloc(sizeof(Imx2DDevice));
+  Imx2DDevice * device = g_slice_alloc0(sizeof(Imx2DDevice));
   if (!device) {
     GST_ERROR("allocate device structure failed\n");
     return NULL;
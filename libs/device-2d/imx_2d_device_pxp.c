@@ -238,22 +238,27 @@ static gint imx_pxp_copy_mem(Imx2DDevice* device, PhyMemBlock *dst_mem,
   if (size > src_mem->size - offset)
     size = src_mem->size - offset;
 
-  struct pxp_mem_desc *mem = g_slice_alloc(sizeof(struct pxp_mem_desc));
-  if (!mem)
-    return -1;
+  if (!dst_mem->vaddr) {
+    struct pxp_mem_desc *mem = g_slice_alloc(sizeof(struct pxp_mem_desc));
+    if (!mem)
+      return -1;
 
-  memset(mem, 0, sizeof (struct pxp_mem_desc));
-  mem->size = size;
+    memset(mem, 0, sizeof (struct pxp_mem_desc));
+    mem->size = size;
 
-  gint ret = pxp_get_mem (mem);
-  if (ret < 0) {
-    GST_ERROR("PXP allocate %u bytes memory failed: %s", size, strerror(errno));
-    return -1;
-  }
+    gint ret = pxp_get_mem (mem);
+    if (ret < 0) {
+      GST_ERROR("PXP allocate %u bytes memory failed: %s", size, strerror(errno));
+      return -1;
+    }
 
-  dst_mem->vaddr = (guchar*) mem->virt_uaddr;
-  dst_mem->paddr = (guchar*) mem->phys_addr;
-  dst_mem->user_data = (gpointer) mem;
+    dst_mem->vaddr = (guchar*) mem->virt_uaddr;
+    dst_mem->paddr = (guchar*) mem->phys_addr;
+    dst_mem->size = size;
+    dst_mem->user_data = (gpointer) mem;
+  } else if (size > dst_mem->size) {
+    size = dst_mem->size;
+  }
 
   memcpy(dst_mem->vaddr, src_mem->vaddr+offset, size);
 
@@ -1023,7 +1028,7 @@ static GList* imx_pxp_get_supported_out_fmts(Imx2DDevice* device)
 
 Imx2DDevice * imx_pxp_create(Imx2DDeviceType  device_type)
 {
-  Imx2DDevice * device = g_slice_alloc(sizeof(Imx2DDevice));
+  Imx2DDevice * device = g_slice_alloc0(sizeof(Imx2DDevice));
   if (!device) {
     GST_ERROR("allocate device structure failed\n");
     return NULL;
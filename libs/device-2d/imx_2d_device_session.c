@@ -0,0 +1,761 @@
+/* GStreamer IMX Video 2D device sessions on shared device contexts
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * One context per device type holds the real device, opened once for all
+ * the sessions on it. A session is an Imx2DDevice of its own: it remembers
+ * its input/output configuration, rotation, deinterlace and async mode,
+ * and replays them on the shared device whenever another session used it
+ * in between. Operations of all sessions on a context are submitted one
+ * at a time under the context lock.
+ *
+ * Devices without IMX_2D_DEVICE_CAP_DEINTERLACE get the deinterlace modes
+ * from the software deinterlacer: an interleaved source is deinterlaced on
+ * the CPU into a session scratch buffer, which the device then converts as
+ * a progressive frame.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/dma-buf.h>
+#include "imx_2d_device.h"
+#include "imx_2d_device_deinterlace.h"
+
+GST_DEBUG_CATEGORY_EXTERN (imx2ddevice_debug);
+#define GST_CAT_DEFAULT imx2ddevice_debug
+
+typedef struct _Imx2DContext Imx2DContext;
+
+typedef struct {
+  Imx2DContext *ctx;
+  guint id;
+  gboolean opened;
+  Imx2DVideoInfo in_info;
+  Imx2DVideoInfo out_info;
+  gboolean in_set;
+  gboolean out_set;
+  Imx2DRotationMode rotate;
+  Imx2DDeinterlaceMode deinterlace;
+  gboolean async;
+  guint64 fence;
+  Imx2DSessionStats stats;
+  gint64 open_time;
+  /* software deinterlace for devices that can't do it */
+  gboolean soft_deinterlace;
+  Imx2DDeinterlacer *deint;
+  PhyMemBlock deint_mem;
+} Imx2DSession;
+
+struct _Imx2DContext {
+  const Imx2DDeviceInfo *info;
+  Imx2DDevice *device;
+  guint refcount;
+  guint opened;
+  gboolean async;
+  GMutex lock;
+  /* session whose configuration is programmed in the device */
+  Imx2DSession *owner;
+};
+
+static GMutex contexts_lock;
+static GList *contexts;
+static guint session_count;
+
+static gint imx_session_open (Imx2DDevice *device);
+
+/* take the context for a submission, the wait time goes to the session */
+static void imx_session_lock (Imx2DSession *session)
+{
+  gint64 start = g_get_monotonic_time ();
+
+  g_mutex_lock (&session->ctx->lock);
+  session->stats.wait_time += g_get_monotonic_time () - start;
+}
+
+/* called with the context lock held */
+static gint imx_session_apply (Imx2DSession *session)
+{
+  Imx2DContext *ctx = session->ctx;
+  Imx2DDevice *dev = ctx->device;
+
+  if (ctx->async != session->async) {
+    imx_2d_device_set_async (dev, session->async);
+    ctx->async = session->async;
+  }
+
+  if (ctx->owner == session)
+    return 0;
+
+  if ((session->in_set && dev->config_input (dev, &session->in_info) < 0)
+      || (session->out_set && dev->config_output (dev, &session->out_info) < 0)
+      || dev->set_rotate (dev, session->rotate) < 0
+      || dev->set_deinterlace (dev, session->soft_deinterlace ?
+                               IMX_2D_DEINTERLACE_NONE :
+                               session->deinterlace) < 0) {
+    GST_WARNING ("restore configuration of session %u failed", session->id);
+    ctx->owner = NULL;
+    return -1;
+  }
+
+  ctx->owner = session;
+  return 0;
+}
+
+static gint imx_session_open (Imx2DDevice *device)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint ret = 0;
+
+  if (session->opened)
+    return 0;
+
+  g_mutex_lock (&ctx->lock);
+  if (ctx->opened == 0)
+    ret = ctx->device->open (ctx->device);
+  if (ret == 0) {
+    ctx->opened++;
+    session->opened = TRUE;
+    session->open_time = g_get_monotonic_time ();
+    ctx->owner = NULL;
+  }
+  g_mutex_unlock (&ctx->lock);
+
+  GST_DEBUG ("session %u on %s opened, %u open sessions", session->id,
+             ctx->info->name, ctx->opened);
+
+  return ret;
+}
+
+static gint imx_session_close (Imx2DDevice *device)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint64 active;
+
+  if (!session->opened)
+    return 0;
+
+  g_mutex_lock (&ctx->lock);
+  if (session->async && ctx->async) {
+    imx_2d_device_wait_fence (ctx->device, session->fence);
+  }
+  if (ctx->owner == session)
+    ctx->owner = NULL;
+  if (session->deint_mem.vaddr) {
+    ctx->device->free_mem (ctx->device, &session->deint_mem);
+    memset (&session->deint_mem, 0, sizeof (PhyMemBlock));
+  }
+  if (--ctx->opened == 0) {
+    if (ctx->async) {
+      imx_2d_device_set_async (ctx->device, FALSE);
+      ctx->async = FALSE;
+    }
+    ctx->device->close (ctx->device);
+  }
+  session->opened = FALSE;
+  g_mutex_unlock (&ctx->lock);
+
+  imx_2d_deinterlacer_free (session->deint);
+  session->deint = NULL;
+
+  active = g_get_monotonic_time () - session->open_time;
+  GST_INFO ("session %u on %s: %" G_GUINT64_FORMAT " operations, busy %"
+            G_GINT64_FORMAT " us, waited %" G_GINT64_FORMAT " us, %.1f%% "
+            "utilization", session->id, ctx->info->name, session->stats.ops,
+            session->stats.busy_time, session->stats.wait_time,
+            active > 0 ? 100.0 * session->stats.busy_time / active : 0.0);
+
+  return 0;
+}
+
+static gint imx_session_alloc_mem (Imx2DDevice *device, PhyMemBlock *memblk)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DDevice *dev = session->ctx->device;
+  gint ret;
+
+  imx_session_lock (session);
+  ret = dev->alloc_mem (dev, memblk);
+  g_mutex_unlock (&session->ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_free_mem (Imx2DDevice *device, PhyMemBlock *memblk)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DDevice *dev = session->ctx->device;
+  gint ret;
+
+  imx_session_lock (session);
+  ret = dev->free_mem (dev, memblk);
+  g_mutex_unlock (&session->ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_copy_mem (Imx2DDevice *device, PhyMemBlock *dst_mem,
+                                  PhyMemBlock *src_mem, guint offset,
+                                  guint size)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DDevice *dev = session->ctx->device;
+  gint64 start;
+  gint ret;
+
+  imx_session_lock (session);
+  start = g_get_monotonic_time ();
+  ret = dev->copy_mem (dev, dst_mem, src_mem, offset, size);
+  session->stats.busy_time += g_get_monotonic_time () - start;
+  session->stats.ops++;
+  g_mutex_unlock (&session->ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_frame_copy (Imx2DDevice *device, PhyMemBlock *from,
+                                    PhyMemBlock *to)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DDevice *dev = session->ctx->device;
+  gint64 start;
+  gint ret;
+
+  imx_session_lock (session);
+  start = g_get_monotonic_time ();
+  imx_session_apply (session);
+  ret = dev->frame_copy (dev, from, to);
+  session->fence = imx_2d_device_get_fence (dev);
+  session->stats.busy_time += g_get_monotonic_time () - start;
+  session->stats.ops++;
+  g_mutex_unlock (&session->ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_config_input (Imx2DDevice *device,
+                                      Imx2DVideoInfo *in_info)
+{
+  if (!device || !device->priv || !in_info)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint ret;
+
+  /* applied right away so unsupported formats are reported here */
+  imx_session_lock (session);
+  imx_session_apply (session);
+  ret = ctx->device->config_input (ctx->device, in_info);
+  if (ret == 0) {
+    session->in_info = *in_info;
+    session->in_set = TRUE;
+  } else {
+    ctx->owner = NULL;
+  }
+  g_mutex_unlock (&ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_config_output (Imx2DDevice *device,
+                                       Imx2DVideoInfo *out_info)
+{
+  if (!device || !device->priv || !out_info)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint ret;
+
+  imx_session_lock (session);
+  imx_session_apply (session);
+  ret = ctx->device->config_output (ctx->device, out_info);
+  if (ret == 0) {
+    session->out_info = *out_info;
+    session->out_set = TRUE;
+  } else {
+    ctx->owner = NULL;
+  }
+  g_mutex_unlock (&ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_set_rotate (Imx2DDevice *device,
+                                    Imx2DRotationMode rot)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint ret;
+
+  imx_session_lock (session);
+  imx_session_apply (session);
+  ret = ctx->device->set_rotate (ctx->device, rot);
+  if (ret == 0)
+    session->rotate = rot;
+  else
+    ctx->owner = NULL;
+  g_mutex_unlock (&ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_set_deinterlace (Imx2DDevice *device,
+                                         Imx2DDeinterlaceMode mode)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint ret;
+
+  if (session->soft_deinterlace) {
+    if (mode != session->deinterlace)
+      imx_2d_deinterlacer_reset (session->deint);
+    session->deinterlace = mode;
+    return 0;
+  }
+
+  imx_session_lock (session);
+  imx_session_apply (session);
+  ret = ctx->device->set_deinterlace (ctx->device, mode);
+  if (ret == 0)
+    session->deinterlace = mode;
+  else
+    ctx->owner = NULL;
+  g_mutex_unlock (&ctx->lock);
+
+  return ret;
+}
+
+static Imx2DRotationMode imx_session_get_rotate (Imx2DDevice *device)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  return session->rotate;
+}
+
+static Imx2DDeinterlaceMode imx_session_get_deinterlace (Imx2DDevice *device)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  return session->deinterlace;
+}
+
+static gint imx_session_get_capabilities (Imx2DDevice *device)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DDevice *dev = session->ctx->device;
+  gint caps = dev->get_capabilities (dev);
+
+  if (session->soft_deinterlace)
+    caps |= IMX_2D_DEVICE_CAP_DEINTERLACE;
+
+  return caps;
+}
+
+static GList *imx_session_get_supported_in_fmts (Imx2DDevice *device)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DDevice *dev = session->ctx->device;
+  return dev->get_supported_in_fmts (dev);
+}
+
+static GList *imx_session_get_supported_out_fmts (Imx2DDevice *device)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DDevice *dev = session->ctx->device;
+  return dev->get_supported_out_fmts (dev);
+}
+
+typedef enum {
+  SESSION_OP_CONVERT,
+  SESSION_OP_BLEND,
+  SESSION_OP_BLEND_FINISH,
+  SESSION_OP_FILL
+} Imx2DSessionOp;
+
+static gint imx_session_submit (Imx2DDevice *device, Imx2DSessionOp op,
+                                Imx2DFrame *dst, Imx2DFrame *src,
+                                guint RGBA8888)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  Imx2DDevice *dev = ctx->device;
+  gint64 start;
+  gint ret = -1;
+
+  imx_session_lock (session);
+  start = g_get_monotonic_time ();
+  if (imx_session_apply (session) == 0) {
+    switch (op) {
+      case SESSION_OP_CONVERT:
+        ret = dev->convert (dev, dst, src);
+        break;
+      case SESSION_OP_BLEND:
+        ret = dev->blend (dev, dst, src);
+        break;
+      case SESSION_OP_BLEND_FINISH:
+        ret = dev->blend_finish (dev);
+        break;
+      case SESSION_OP_FILL:
+        ret = dev->fill ? dev->fill (dev, dst, RGBA8888) : -1;
+        break;
+    }
+    session->fence = imx_2d_device_get_fence (dev);
+  }
+  session->stats.busy_time += g_get_monotonic_time () - start;
+  session->stats.ops++;
+  g_mutex_unlock (&ctx->lock);
+
+  return ret;
+}
+
+/* deinterlace an interleaved source into the session scratch buffer, out
+ * then describes it as a progressive frame. FALSE leaves src untouched */
+static gboolean imx_session_deinterlace (Imx2DSession *session,
+                                         Imx2DFrame *src, Imx2DFrame *out,
+                                         PhyMemBlock *out_mem)
+{
+  Imx2DContext *ctx = session->ctx;
+  struct dma_buf_sync sync;
+  const guint8 *data = NULL;
+  gpointer map = NULL;
+  gboolean ret = FALSE;
+  gsize size;
+
+  if (!session->soft_deinterlace
+      || session->deinterlace == IMX_2D_DEINTERLACE_NONE
+      || src->interlace_type != IMX_2D_INTERLACE_INTERLEAVED)
+    return FALSE;
+
+  /* planes in separate buffers are left to the device */
+  size = imx_2d_deinterlace_frame_size (&src->info);
+  if (size == 0 || src->fd[1] >= 0)
+    return FALSE;
+
+  if (src->mem && src->mem->vaddr) {
+    data = (const guint8 *) src->mem->vaddr;
+  } else if (src->fd[0] >= 0) {
+    map = mmap (NULL, size, PROT_READ, MAP_SHARED, src->fd[0], 0);
+    if (map == MAP_FAILED) {
+      GST_WARNING ("map dmabuf fd %d failed: %s", src->fd[0], strerror (errno));
+      return FALSE;
+    }
+    sync.flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ;
+    ioctl (src->fd[0], DMA_BUF_IOCTL_SYNC, &sync);
+    data = (const guint8 *) map;
+  } else {
+    return FALSE;
+  }
+
+  if (session->deint_mem.size < size) {
+    imx_session_lock (session);
+    if (session->deint_mem.vaddr)
+      ctx->device->free_mem (ctx->device, &session->deint_mem);
+    memset (&session->deint_mem, 0, sizeof (PhyMemBlock));
+    session->deint_mem.size = size;
+    if (ctx->device->alloc_mem (ctx->device, &session->deint_mem) < 0) {
+      GST_WARNING ("allocate %" G_GSIZE_FORMAT " bytes for deinterlace failed",
+                   size);
+      memset (&session->deint_mem, 0, sizeof (PhyMemBlock));
+    }
+    g_mutex_unlock (&ctx->lock);
+  }
+
+  if (session->deint_mem.vaddr) {
+    if (!session->deint)
+      session->deint = imx_2d_deinterlacer_new ();
+    if (imx_2d_deinterlacer_process (session->deint, session->deinterlace,
+            &src->info, data, (guint8 *) session->deint_mem.vaddr) == 0) {
+      *out = *src;
+      *out_mem = session->deint_mem;
+      out->mem = out_mem;
+      out->fd[0] = out->fd[1] = out->fd[2] = out->fd[3] = -1;
+      out->interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
+      ret = TRUE;
+    }
+  }
+
+  if (map) {
+    sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ;
+    ioctl (src->fd[0], DMA_BUF_IOCTL_SYNC, &sync);
+    munmap (map, size);
+  }
+
+  return ret;
+}
+
+static gint imx_session_convert (Imx2DDevice *device, Imx2DFrame *dst,
+                                 Imx2DFrame *src)
+{
+  Imx2DFrame progressive;
+  PhyMemBlock mem;
+
+  if (device && device->priv && src
+      && imx_session_deinterlace ((Imx2DSession *) (device->priv), src,
+                                  &progressive, &mem))
+    return imx_session_submit (device, SESSION_OP_CONVERT, dst, &progressive,
+                               0);
+
+  return imx_session_submit (device, SESSION_OP_CONVERT, dst, src, 0);
+}
+
+static gint imx_session_blend (Imx2DDevice *device, Imx2DFrame *dst,
+                               Imx2DFrame *src)
+{
+  return imx_session_submit (device, SESSION_OP_BLEND, dst, src, 0);
+}
+
+static gint imx_session_blend_finish (Imx2DDevice *device)
+{
+  return imx_session_submit (device, SESSION_OP_BLEND_FINISH, NULL, NULL, 0);
+}
+
+static gint imx_session_fill (Imx2DDevice *device, Imx2DFrame *dst,
+                              guint RGBA8888)
+{
+  return imx_session_submit (device, SESSION_OP_FILL, dst, NULL, RGBA8888);
+}
+
+static gint imx_session_blend_batch (Imx2DDevice *device, Imx2DFrame *dst,
+                                     Imx2DBlendLayer *layers, gint n_layers)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint64 start;
+  gint ret = -1;
+
+  imx_session_lock (session);
+  start = g_get_monotonic_time ();
+  if (imx_session_apply (session) == 0) {
+    ret = imx_2d_device_blend_batch (ctx->device, dst, layers, n_layers);
+    session->fence = imx_2d_device_get_fence (ctx->device);
+  }
+  /* layers reprogram input and rotation, replay them next time */
+  ctx->owner = NULL;
+  session->stats.busy_time += g_get_monotonic_time () - start;
+  session->stats.ops++;
+  g_mutex_unlock (&ctx->lock);
+
+  return ret;
+}
+
+static gint imx_session_set_async (Imx2DDevice *device, gboolean async)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  if (!session->ctx->device->set_async)
+    return -1;
+
+  session->async = async;
+  return 0;
+}
+
+static guint64 imx_session_get_fence (Imx2DDevice *device)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  return session->fence;
+}
+
+static gint imx_session_wait_fence (Imx2DDevice *device, guint64 fence)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  Imx2DContext *ctx = session->ctx;
+  gint ret;
+
+  imx_session_lock (session);
+  ret = imx_2d_device_wait_fence (ctx->device, fence);
+  g_mutex_unlock (&ctx->lock);
+
+  return ret;
+}
+
+static Imx2DDeviceType imx_session_get_engine_type (Imx2DDevice *device)
+{
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  return imx_2d_device_get_engine_type (session->ctx->device);
+}
+
+static Imx2DContext *imx_context_get (const Imx2DDeviceInfo *info)
+{
+  Imx2DContext *ctx = NULL;
+  GList *l;
+
+  g_mutex_lock (&contexts_lock);
+  for (l = contexts; l; l = l->next) {
+    if (((Imx2DContext *) l->data)->info == info) {
+      ctx = (Imx2DContext *) l->data;
+      break;
+    }
+  }
+
+  if (!ctx) {
+    Imx2DDevice *dev = info->create (info->device_type);
+    if (dev) {
+      ctx = g_slice_alloc0 (sizeof(Imx2DContext));
+      ctx->info = info;
+      ctx->device = dev;
+      g_mutex_init (&ctx->lock);
+      contexts = g_list_prepend (contexts, ctx);
+      GST_DEBUG ("created shared %s context", info->name);
+    }
+  }
+  if (ctx)
+    ctx->refcount++;
+  g_mutex_unlock (&contexts_lock);
+
+  return ctx;
+}
+
+static void imx_context_unref (Imx2DContext *ctx)
+{
+  g_mutex_lock (&contexts_lock);
+  if (--ctx->refcount == 0) {
+    contexts = g_list_remove (contexts, ctx);
+    ctx->info->destroy (ctx->device);
+    g_mutex_clear (&ctx->lock);
+    GST_DEBUG ("released shared %s context", ctx->info->name);
+    g_slice_free1 (sizeof(Imx2DContext), ctx);
+  }
+  g_mutex_unlock (&contexts_lock);
+}
+
+Imx2DDevice * imx_2d_session_new (const Imx2DDeviceInfo *info)
+{
+  Imx2DContext *ctx = imx_context_get (info);
+  Imx2DSession *session;
+  Imx2DDevice *device;
+
+  if (!ctx) {
+    GST_ERROR ("create %s device failed", info->name);
+    return NULL;
+  }
+
+  device = g_slice_alloc0 (sizeof(Imx2DDevice));
+  session = g_slice_alloc0 (sizeof(Imx2DSession));
+  session->ctx = ctx;
+  session->id = g_atomic_int_add (&session_count, 1);
+  session->rotate = IMX_2D_ROTATION_0;
+  session->deinterlace = IMX_2D_DEINTERLACE_NONE;
+  session->soft_deinterlace = !(ctx->device->get_capabilities (ctx->device)
+                                & IMX_2D_DEVICE_CAP_DEINTERLACE);
+
+  device->device_type = info->device_type;
+  device->priv = (gpointer) session;
+
+  device->open                = imx_session_open;
+  device->close               = imx_session_close;
+  device->alloc_mem           = imx_session_alloc_mem;
+  device->free_mem            = imx_session_free_mem;
+  device->copy_mem            = imx_session_copy_mem;
+  device->frame_copy          = imx_session_frame_copy;
+  device->config_input        = imx_session_config_input;
+  device->config_output       = imx_session_config_output;
+  device->convert             = imx_session_convert;
+  device->blend               = imx_session_blend;
+  device->blend_finish        = imx_session_blend_finish;
+  if (ctx->device->fill)
+    device->fill              = imx_session_fill;
+  device->set_async           = imx_session_set_async;
+  device->get_fence           = imx_session_get_fence;
+  device->wait_fence          = imx_session_wait_fence;
+  device->blend_batch         = imx_session_blend_batch;
+  device->set_rotate          = imx_session_set_rotate;
+  device->set_deinterlace     = imx_session_set_deinterlace;
+  device->get_rotate          = imx_session_get_rotate;
+  device->get_deinterlace     = imx_session_get_deinterlace;
+  device->get_engine_type     = imx_session_get_engine_type;
+  device->get_capabilities    = imx_session_get_capabilities;
+  device->get_supported_in_fmts  = imx_session_get_supported_in_fmts;
+  device->get_supported_out_fmts = imx_session_get_supported_out_fmts;
+
+  return device;
+}
+
+gboolean imx_2d_session_is (Imx2DDevice *device)
+{
+  return device && device->open == imx_session_open;
+}
+
+gint imx_2d_session_free (Imx2DDevice *device)
+{
+  if (!imx_2d_session_is (device))
+    return -1;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  imx_session_close (device);
+  imx_context_unref (session->ctx);
+  g_slice_free1 (sizeof(Imx2DSession), session);
+  g_slice_free1 (sizeof(Imx2DDevice), device);
+
+  return 0;
+}
+
+gboolean imx_2d_device_get_session_stats (Imx2DDevice *device,
+                                          Imx2DSessionStats *stats)
+{
+  if (!imx_2d_session_is (device) || !stats)
+    return FALSE;
+
+  Imx2DSession *session = (Imx2DSession *) (device->priv);
+  g_mutex_lock (&session->ctx->lock);
+  *stats = session->stats;
+  stats->active_time = session->opened ?
+      g_get_monotonic_time () - session->open_time : 0;
+  stats->sessions = session->ctx->opened;
+  g_mutex_unlock (&session->ctx->lock);
+
+  return TRUE;
+}
+
+GstStructure * imx_2d_device_get_session_stats_structure (Imx2DDevice *device)
+{
+  Imx2DSessionStats stats;
+
+  if (!imx_2d_device_get_session_stats (device, &stats))
+    return NULL;
+
+  return gst_structure_new ("imx-2d-session-stats",
+      "ops", G_TYPE_UINT64, stats.ops,
+      "busy-time", G_TYPE_INT64, stats.busy_time,
+      "wait-time", G_TYPE_INT64, stats.wait_time,
+      "active-time", G_TYPE_INT64, stats.active_time,
+      "sessions", G_TYPE_UINT, stats.sessions, NULL);
+}
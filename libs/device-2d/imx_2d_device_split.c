@@ -0,0 +1,634 @@
+/* GStreamer IMX Video 2D device splitting work across two engines
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * The split device drives the first available hardware device and the next
+ * available device (hardware or software). convert and blend divide the
+ * destination crop into a top band for the first engine and a bottom band
+ * run on a worker thread by the second one. Band heights follow the
+ * measured throughput of each engine. A downscaled source is cut on a row
+ * that maps to a whole source row, so each band keeps the scale and
+ * sampling phase of a single pass. Vertical upscales run on the first
+ * engine alone. Everything else, memory included, is handled by the first
+ * engine alone.
+ */
+
+#include <string.h>
+#include "imx_2d_device.h"
+#include "imx_2d_device_cost.h"
+
+GST_DEBUG_CATEGORY_EXTERN (imx2ddevice_debug);
+#define GST_CAT_DEFAULT imx2ddevice_debug
+
+#define SPLIT_MIN_ROWS        64
+#define SPLIT_RATIO_MIN       0.05
+#define SPLIT_RATIO_MAX       0.95
+/* weight of the latest measurement in the split ratio */
+#define SPLIT_RATIO_SMOOTH    0.25
+
+typedef struct {
+  Imx2DFrame src;
+  Imx2DFrame dst;
+  PhyMemBlock src_mem;
+  PhyMemBlock dst_mem;
+  gboolean blend;
+  gint ret;
+  /* until the band is done, queued blends included */
+  gint64 time;
+  gboolean done;
+} SplitJob;
+
+typedef struct _Imx2DDeviceSplit {
+  const Imx2DDeviceInfo *info[2];
+  Imx2DDevice *engine[2];
+  gint capabilities[2];
+  gboolean opened;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+  SplitJob job;
+  /* whether the second engine accepted the current configuration */
+  gboolean in_ok;
+  gboolean out_ok;
+  GstVideoFormat in_fmt;
+  GstVideoFormat out_fmt;
+  Imx2DRotationMode rotate;
+  Imx2DDeinterlaceMode deinterlace;
+  /* share of destination rows given to the first engine */
+  gdouble ratio;
+  gboolean ratio_init;
+  /* the second engine failed a band of the current formats */
+  gboolean band_failed;
+  guint64 split_ops;
+  guint64 single_ops;
+} Imx2DDeviceSplit;
+
+static gboolean imx_split_find_engines (const Imx2DDeviceInfo *info[2])
+{
+  const Imx2DDeviceInfo *dev_info = imx_get_2d_devices ();
+
+  info[0] = info[1] = NULL;
+  while (dev_info->name) {
+    if (dev_info->device_type != IMX_2D_DEVICE_SPLIT && dev_info->is_exist ()) {
+      if (!info[0] && dev_info->device_type != IMX_2D_DEVICE_SW)
+        info[0] = dev_info;
+      else if (info[0] && !info[1])
+        info[1] = dev_info;
+    }
+    dev_info++;
+  }
+
+  return info[0] && info[1];
+}
+
+static void imx_split_job_run (gpointer data, gpointer user_data)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) user_data;
+  SplitJob *job = (SplitJob *) data;
+  Imx2DDevice *engine = split->engine[1];
+  gint64 start = g_get_monotonic_time ();
+
+  if (job->blend) {
+    job->ret = engine->blend (engine, &job->dst, &job->src);
+    if (job->ret >= 0)
+      job->ret = engine->blend_finish (engine);
+  } else
+    job->ret = engine->convert (engine, &job->dst, &job->src);
+  job->time = g_get_monotonic_time () - start;
+
+  g_mutex_lock (&split->lock);
+  job->done = TRUE;
+  g_cond_signal (&split->cond);
+  g_mutex_unlock (&split->lock);
+}
+
+static gint imx_split_open (Imx2DDevice *device)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  if (split->engine[0]->open (split->engine[0]) < 0) {
+    GST_ERROR ("open split engine %s failed", split->info[0]->name);
+    return -1;
+  }
+  if (split->engine[1]->open (split->engine[1]) < 0) {
+    GST_ERROR ("open split engine %s failed", split->info[1]->name);
+    split->engine[0]->close (split->engine[0]);
+    return -1;
+  }
+
+  split->pool = g_thread_pool_new (imx_split_job_run, split, 1, FALSE, NULL);
+  split->ratio = 0.5;
+  split->opened = TRUE;
+
+  GST_DEBUG ("split device opened on %s and %s", split->info[0]->name,
+             split->info[1]->name);
+
+  return 0;
+}
+
+static gint imx_split_close (Imx2DDevice *device)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  if (!split->opened)
+    return 0;
+
+  g_thread_pool_free (split->pool, FALSE, TRUE);
+  split->pool = NULL;
+  split->engine[1]->close (split->engine[1]);
+  split->engine[0]->close (split->engine[0]);
+  split->opened = FALSE;
+
+  GST_DEBUG ("split device closed, %" G_GUINT64_FORMAT " split and %"
+             G_GUINT64_FORMAT " single operations, ratio %.2f",
+             split->split_ops, split->single_ops, split->ratio);
+
+  return 0;
+}
+
+static gint imx_split_alloc_mem (Imx2DDevice *device, PhyMemBlock *memblk)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->alloc_mem (split->engine[0], memblk);
+}
+
+static gint imx_split_free_mem (Imx2DDevice *device, PhyMemBlock *memblk)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->free_mem (split->engine[0], memblk);
+}
+
+static gint imx_split_copy_mem (Imx2DDevice *device, PhyMemBlock *dst_mem,
+                                PhyMemBlock *src_mem, guint offset, guint size)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->copy_mem (split->engine[0], dst_mem, src_mem,
+                                     offset, size);
+}
+
+static gint imx_split_frame_copy (Imx2DDevice *device, PhyMemBlock *from,
+                                  PhyMemBlock *to)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->frame_copy (split->engine[0], from, to);
+}
+
+static gint imx_split_config_input (Imx2DDevice *device,
+                                    Imx2DVideoInfo *in_info)
+{
+  if (!device || !device->priv || !in_info)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  if (split->engine[0]->config_input (split->engine[0], in_info) < 0)
+    return -1;
+
+  split->in_ok = split->engine[1]->config_input (split->engine[1], in_info) == 0;
+  if (split->in_fmt != in_info->fmt)
+    split->ratio_init = split->band_failed = FALSE;
+  split->in_fmt = in_info->fmt;
+
+  return 0;
+}
+
+static gint imx_split_config_output (Imx2DDevice *device,
+                                     Imx2DVideoInfo *out_info)
+{
+  if (!device || !device->priv || !out_info)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  if (split->engine[0]->config_output (split->engine[0], out_info) < 0)
+    return -1;
+
+  split->out_ok =
+      split->engine[1]->config_output (split->engine[1], out_info) == 0;
+  if (split->out_fmt != out_info->fmt)
+    split->ratio_init = split->band_failed = FALSE;
+  split->out_fmt = out_info->fmt;
+
+  return 0;
+}
+
+static gint imx_split_set_rotate (Imx2DDevice *device, Imx2DRotationMode rot)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  split->rotate = rot;
+  split->engine[1]->set_rotate (split->engine[1], rot);
+  return split->engine[0]->set_rotate (split->engine[0], rot);
+}
+
+static gint imx_split_set_deinterlace (Imx2DDevice *device,
+                                       Imx2DDeinterlaceMode mode)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  split->deinterlace = mode;
+  split->engine[1]->set_deinterlace (split->engine[1], mode);
+  return split->engine[0]->set_deinterlace (split->engine[0], mode);
+}
+
+static Imx2DRotationMode imx_split_get_rotate (Imx2DDevice *device)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->get_rotate (split->engine[0]);
+}
+
+static Imx2DDeinterlaceMode imx_split_get_deinterlace (Imx2DDevice *device)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->get_deinterlace (split->engine[0]);
+}
+
+static Imx2DDeviceType imx_split_get_engine_type (Imx2DDevice *device)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return imx_2d_device_get_engine_type (split->engine[0]);
+}
+
+static gint imx_split_get_capabilities (Imx2DDevice *device)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->get_capabilities (split->engine[0]);
+}
+
+static GList *imx_split_get_supported_in_fmts (Imx2DDevice *device)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->get_supported_in_fmts (split->engine[0]);
+}
+
+static GList *imx_split_get_supported_out_fmts (Imx2DDevice *device)
+{
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  return split->engine[0]->get_supported_out_fmts (split->engine[0]);
+}
+
+/* destination rows kept together in one band, two luma rows share each
+ * chroma row of a 4:2:0 format, so the boundary stays on whole chroma
+ * row pairs */
+static guint imx_split_row_align (GstVideoFormat fmt)
+{
+  const GstVideoFormatInfo *finfo = gst_video_format_get_info (fmt);
+  guint i, vsub = 0;
+
+  if (!finfo)
+    return 2;
+
+  for (i = 0; i < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); i++)
+    vsub = MAX (vsub, GST_VIDEO_FORMAT_INFO_H_SUB (finfo, i));
+
+  return 2 << vsub;
+}
+
+/* Pick the band boundary on an absolute destination row that is a multiple
+ * of dst_align, so the engines never write the same chroma row, and whose
+ * source row is exact and a multiple of src_align. Both bands then map
+ * their source to their destination with the scale and the sampling phase
+ * of the whole crop, and the filter of a downscale never reaches across
+ * the seam. An upscale samples the source row on the other side of the
+ * seam for the rows next to it, which a band crop can not give it. */
+static gboolean imx_split_band (const Imx2DCrop *dst, guint dst_align,
+                                const Imx2DCrop *src, guint src_align,
+                                gdouble ratio, guint *dst_rows,
+                                guint *src_rows)
+{
+  guint a = dst->h, b = src->h, t, step_d, step_s, n;
+  gint k0, d, k;
+
+  if (dst->h < 2 * SPLIT_MIN_ROWS || dst->y < 0 || src->y < 0
+      || src->h < dst->h)
+    return FALSE;
+
+  /* boundaries with an exact source row are multiples of step_d */
+  while (b) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  step_d = dst->h / a;
+  step_s = src->h / a;
+  n = a;
+
+  k0 = (gint) (dst->h * ratio / step_d + 0.5);
+  for (d = 0; d < (gint) n; d++) {
+    gint cand[2] = { k0 - d, k0 + d };
+    gint i;
+
+    for (i = 0; i < (d ? 2 : 1); i++) {
+      guint rows;
+
+      k = cand[i];
+      if (k < 1 || k >= (gint) n)
+        continue;
+      rows = k * step_d;
+      if (rows < SPLIT_MIN_ROWS || rows > dst->h - SPLIT_MIN_ROWS
+          || (dst->y + rows) % dst_align
+          || (src->y + k * step_s) % src_align)
+        continue;
+
+      *dst_rows = rows;
+      *src_rows = k * step_s;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+static void imx_split_init_ratio (Imx2DDeviceSplit *split, gboolean blend,
+                                  guint pixels)
+{
+  Imx2DCostOp op = blend ? IMX_2D_COST_OP_BLEND : IMX_2D_COST_OP_CONVERT;
+  gdouble c0, c1;
+
+  split->ratio_init = TRUE;
+  c0 = imx_2d_device_cost_get (split->info[0]->device_type, op,
+                               split->in_fmt, split->out_fmt, pixels);
+  c1 = imx_2d_device_cost_get (split->info[1]->device_type, op,
+                               split->in_fmt, split->out_fmt, pixels);
+  if (c0 > 0 && c1 > 0)
+    split->ratio = CLAMP (c1 / (c0 + c1), SPLIT_RATIO_MIN, SPLIT_RATIO_MAX);
+
+  GST_DEBUG ("initial split ratio %.2f (%s %.1f us, %s %.1f us)",
+             split->ratio, split->info[0]->name, c0, split->info[1]->name, c1);
+}
+
+static void imx_split_update_ratio (Imx2DDeviceSplit *split, guint rows0,
+                                    gint64 time0, guint rows1, gint64 time1)
+{
+  gdouble r0, r1, measured;
+
+  if (time0 <= 0 || time1 <= 0)
+    return;
+
+  r0 = (gdouble) rows0 / time0;
+  r1 = (gdouble) rows1 / time1;
+  measured = r0 / (r0 + r1);
+  split->ratio = split->ratio * (1 - SPLIT_RATIO_SMOOTH)
+      + measured * SPLIT_RATIO_SMOOTH;
+  split->ratio = CLAMP (split->ratio, SPLIT_RATIO_MIN, SPLIT_RATIO_MAX);
+
+  GST_LOG ("split %u/%u rows in %" G_GINT64_FORMAT "/%" G_GINT64_FORMAT
+           " us, ratio %.2f", rows0, rows1, time0, time1, split->ratio);
+}
+
+static gint imx_split_run_single (Imx2DDevice *engine, Imx2DFrame *dst,
+                                  Imx2DFrame *src, gboolean blend)
+{
+  if (blend)
+    return engine->blend (engine, dst, src);
+  return engine->convert (engine, dst, src);
+}
+
+static gint imx_split_run (Imx2DDevice *device, Imx2DFrame *dst,
+                           Imx2DFrame *src, gboolean blend)
+{
+  Imx2DCrop src_crop, dst_crop;
+  guint src_rows, dst_rows;
+  gint64 start, time0;
+  gint ret;
+
+  if (!device || !device->priv || !dst || !src || !dst->mem || !src->mem)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  Imx2DDevice *engine0 = split->engine[0];
+  SplitJob *job = &split->job;
+
+  if (!split->in_ok || !split->out_ok
+      || split->rotate != IMX_2D_ROTATION_0
+      || split->deinterlace != IMX_2D_DEINTERLACE_NONE
+      || src->interlace_type != IMX_2D_INTERLACE_PROGRESSIVE
+      || (blend && !(split->capabilities[1] & IMX_2D_DEVICE_CAP_BLEND))
+      || split->band_failed) {
+    split->single_ops++;
+    return imx_split_run_single (engine0, dst, src, blend);
+  }
+
+  if (!split->ratio_init)
+    imx_split_init_ratio (split, blend, dst->crop.w * dst->crop.h);
+
+  if (!imx_split_band (&dst->crop, imx_split_row_align (split->out_fmt),
+                       &src->crop, imx_split_row_align (split->in_fmt),
+                       split->ratio, &dst_rows, &src_rows)) {
+    split->single_ops++;
+    return imx_split_run_single (engine0, dst, src, blend);
+  }
+
+  src_crop = src->crop;
+  dst_crop = dst->crop;
+
+  /* bottom band goes to the second engine on private copies, so the two
+   * engines never write the same PhyMemBlock */
+  job->src = *src;
+  job->src_mem = *src->mem;
+  job->src.mem = &job->src_mem;
+  job->src.crop.y = src_crop.y + src_rows;
+  job->src.crop.h = src_crop.h - src_rows;
+  job->dst = *dst;
+  job->dst_mem = *dst->mem;
+  job->dst.mem = &job->dst_mem;
+  job->dst.crop.y = dst_crop.y + dst_rows;
+  job->dst.crop.h = dst_crop.h - dst_rows;
+  job->blend = blend;
+  job->done = FALSE;
+  g_thread_pool_push (split->pool, job, NULL);
+
+  src->crop.h = src_rows;
+  dst->crop.h = dst_rows;
+  /* a blend may only be queued until blend_finish, the band is timed to
+   * its completion so the ratio follows the real throughput */
+  start = g_get_monotonic_time ();
+  ret = imx_split_run_single (engine0, dst, src, blend);
+  if (blend && ret >= 0)
+    ret = engine0->blend_finish (engine0);
+  time0 = g_get_monotonic_time () - start;
+  src->crop = src_crop;
+  dst->crop = dst_crop;
+
+  g_mutex_lock (&split->lock);
+  while (!job->done)
+    g_cond_wait (&split->cond, &split->lock);
+  g_mutex_unlock (&split->lock);
+
+  if (job->ret < 0) {
+    /* e.g. software engine given memory it can not map, redo on engine0
+     * and stop splitting until the formats change */
+    GST_WARNING ("%s failed on its band, run it on %s", split->info[1]->name,
+                 split->info[0]->name);
+    split->band_failed = TRUE;
+    src->crop = job->src.crop;
+    dst->crop = job->dst.crop;
+    ret |= imx_split_run_single (engine0, dst, src, blend);
+    src->crop = src_crop;
+    dst->crop = dst_crop;
+    split->single_ops++;
+    return ret;
+  }
+
+  imx_split_update_ratio (split, dst_rows, time0, dst_crop.h - dst_rows,
+                          job->time);
+  split->split_ops++;
+
+  return ret;
+}
+
+static gint imx_split_convert (Imx2DDevice *device, Imx2DFrame *dst,
+                               Imx2DFrame *src)
+{
+  return imx_split_run (device, dst, src, FALSE);
+}
+
+static gint imx_split_blend (Imx2DDevice *device, Imx2DFrame *dst,
+                             Imx2DFrame *src)
+{
+  return imx_split_run (device, dst, src, TRUE);
+}
+
+static gint imx_split_blend_finish (Imx2DDevice *device)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  gint ret = split->engine[1]->blend_finish (split->engine[1]);
+  return ret | split->engine[0]->blend_finish (split->engine[0]);
+}
+
+static gint imx_split_fill_color (Imx2DDevice *device, Imx2DFrame *dst,
+                                  guint RGBA8888)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  if (!split->engine[0]->fill)
+    return -1;
+
+  return split->engine[0]->fill (split->engine[0], dst, RGBA8888);
+}
+
+Imx2DDevice * imx_split_create (Imx2DDeviceType  device_type)
+{
+  const Imx2DDeviceInfo *info[2];
+  Imx2DDeviceSplit *split;
+  Imx2DDevice * device;
+
+  if (!imx_split_find_engines (info)) {
+    GST_ERROR ("split device needs two 2D devices");
+    return NULL;
+  }
+
+  device = g_slice_alloc0 (sizeof(Imx2DDevice));
+  if (!device) {
+    GST_ERROR("allocate device structure failed\n");
+    return NULL;
+  }
+
+  split = g_slice_alloc0 (sizeof(Imx2DDeviceSplit));
+  split->info[0] = info[0];
+  split->info[1] = info[1];
+  split->engine[0] = info[0]->create (info[0]->device_type);
+  split->engine[1] = info[1]->create (info[1]->device_type);
+  if (!split->engine[0] || !split->engine[1]) {
+    if (split->engine[0])
+      info[0]->destroy (split->engine[0]);
+    if (split->engine[1])
+      info[1]->destroy (split->engine[1]);
+    g_slice_free1 (sizeof(Imx2DDeviceSplit), split);
+    g_slice_free1 (sizeof(Imx2DDevice), device);
+    return NULL;
+  }
+  split->capabilities[0] =
+      split->engine[0]->get_capabilities (split->engine[0]);
+  split->capabilities[1] =
+      split->engine[1]->get_capabilities (split->engine[1]);
+  g_mutex_init (&split->lock);
+  g_cond_init (&split->cond);
+
+  device->device_type = device_type;
+  device->priv = (gpointer) split;
+
+  device->open                = imx_split_open;
+  device->close               = imx_split_close;
+  device->alloc_mem           = imx_split_alloc_mem;
+  device->free_mem            = imx_split_free_mem;
+  device->copy_mem            = imx_split_copy_mem;
+  device->frame_copy          = imx_split_frame_copy;
+  device->config_input        = imx_split_config_input;
+  device->config_output       = imx_split_config_output;
+  device->convert             = imx_split_convert;
+  device->blend               = imx_split_blend;
+  device->blend_finish        = imx_split_blend_finish;
+  device->fill                = imx_split_fill_color;
+  device->set_rotate          = imx_split_set_rotate;
+  device->set_deinterlace     = imx_split_set_deinterlace;
+  device->get_rotate          = imx_split_get_rotate;
+  device->get_deinterlace     = imx_split_get_deinterlace;
+  device->get_engine_type     = imx_split_get_engine_type;
+  device->get_capabilities    = imx_split_get_capabilities;
+  device->get_supported_in_fmts  = imx_split_get_supported_in_fmts;
+  device->get_supported_out_fmts = imx_split_get_supported_out_fmts;
+
+  return device;
+}
+
+gint imx_split_destroy (Imx2DDevice *device)
+{
+  if (!device)
+    return -1;
+
+  Imx2DDeviceSplit *split = (Imx2DDeviceSplit *) (device->priv);
+  if (split) {
+    split->info[0]->destroy (split->engine[0]);
+    split->info[1]->destroy (split->engine[1]);
+    g_mutex_clear (&split->lock);
+    g_cond_clear (&split->cond);
+    g_slice_free1 (sizeof(Imx2DDeviceSplit), split);
+  }
+  g_slice_free1 (sizeof(Imx2DDevice), device);
+
+  return 0;
+}
+
+gboolean imx_split_is_exist (void)
+{
+  const Imx2DDeviceInfo *info[2];
+
+  return imx_split_find_engines (info);
+}
+
+/* the device whose type the split device takes for its special cases */
+const Imx2DDeviceInfo * imx_split_get_first_engine (void)
+{
+  const Imx2DDeviceInfo *info[2];
+
+  imx_split_find_engines (info);
+  return info[0];
+}
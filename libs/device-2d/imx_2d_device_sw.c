@@ -0,0 +1,1379 @@
+/* GStreamer IMX Software 2D Device
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * CPU fallback for boards without a free 2D engine. Every pixel goes through
+ * a 4 byte intermediate (A, R, G, B or A, Y, U, V): source rows are unpacked,
+ * scaled/rotated, color converted and packed or blended into the
+ * destination. Rows are split in horizontal stripes over a thread pool, the
+ * color conversion and blending kernels have NEON/SSE2 versions next to the
+ * C reference.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <linux/dma-buf.h>
+#include "imx_2d_device.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SW_USE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SW_USE_SSE2
+#endif
+
+GST_DEBUG_CATEGORY_EXTERN (imx2ddevice_debug);
+#define GST_CAT_DEFAULT imx2ddevice_debug
+
+#define SW_MAX_THREADS 4
+#define SW_MIN_STRIPE_ROWS 16
+
+#define SW_ROUND(x) ((x) < 0 ? (x) - 0.5 : (x) + 0.5)
+#define SW_DIV255(x) ((((x) + 128) + (((x) + 128) >> 8)) >> 8)
+
+typedef enum {
+  SW_KIND_RGB32,
+  SW_KIND_RGB24,
+  SW_KIND_RGB16,
+  SW_KIND_YUV422,
+  SW_KIND_I420,
+  SW_KIND_NV12
+} SwFmtKind;
+
+typedef struct {
+  GstVideoFormat gst_video_format;
+  SwFmtKind kind;
+  gboolean yuv;
+  /* RGB32/RGB24: byte of R, G, B, A (-1 no alpha)
+   * YUV422: byte of Y0, U, Y1, V
+   * I420: plane of U and V
+   * NV12: byte of U and V in the chroma pair */
+  gint off[4];
+  guint bpp;
+} SwFmtMap;
+
+static SwFmtMap sw_fmts_map[] = {
+    {GST_VIDEO_FORMAT_RGBA,  SW_KIND_RGB32,  FALSE, {0, 1, 2, 3},   32},
+    {GST_VIDEO_FORMAT_BGRA,  SW_KIND_RGB32,  FALSE, {2, 1, 0, 3},   32},
+    {GST_VIDEO_FORMAT_ARGB,  SW_KIND_RGB32,  FALSE, {1, 2, 3, 0},   32},
+    {GST_VIDEO_FORMAT_ABGR,  SW_KIND_RGB32,  FALSE, {3, 2, 1, 0},   32},
+    {GST_VIDEO_FORMAT_RGBx,  SW_KIND_RGB32,  FALSE, {0, 1, 2, -1},  32},
+    {GST_VIDEO_FORMAT_BGRx,  SW_KIND_RGB32,  FALSE, {2, 1, 0, -1},  32},
+    {GST_VIDEO_FORMAT_xRGB,  SW_KIND_RGB32,  FALSE, {1, 2, 3, -1},  32},
+    {GST_VIDEO_FORMAT_xBGR,  SW_KIND_RGB32,  FALSE, {3, 2, 1, -1},  32},
+    {GST_VIDEO_FORMAT_RGB,   SW_KIND_RGB24,  FALSE, {0, 1, 2, -1},  24},
+    {GST_VIDEO_FORMAT_BGR,   SW_KIND_RGB24,  FALSE, {2, 1, 0, -1},  24},
+    {GST_VIDEO_FORMAT_RGB16, SW_KIND_RGB16,  FALSE, {0, 0, 0, -1},  16},
+    {GST_VIDEO_FORMAT_YUY2,  SW_KIND_YUV422, TRUE,  {0, 1, 2, 3},   16},
+    {GST_VIDEO_FORMAT_UYVY,  SW_KIND_YUV422, TRUE,  {1, 0, 3, 2},   16},
+    {GST_VIDEO_FORMAT_YVYU,  SW_KIND_YUV422, TRUE,  {0, 3, 2, 1},   16},
+    {GST_VIDEO_FORMAT_I420,  SW_KIND_I420,   TRUE,  {1, 2, 0, 0},   12},
+    {GST_VIDEO_FORMAT_YV12,  SW_KIND_I420,   TRUE,  {2, 1, 0, 0},   12},
+    {GST_VIDEO_FORMAT_NV12,  SW_KIND_NV12,   TRUE,  {0, 1, 0, 0},   12},
+    {GST_VIDEO_FORMAT_NV21,  SW_KIND_NV12,   TRUE,  {1, 0, 0, 0},   12},
+    {GST_VIDEO_FORMAT_UNKNOWN, 0,            FALSE, {0, 0, 0, 0},   0}
+};
+
+/* out = clamp ((64 * c + m . in) >> 12), offsets folded into c */
+typedef struct {
+  gint16 m[3][3];
+  gint16 c[3];
+} SwCsc;
+
+typedef struct {
+  const SwFmtMap *map;
+  guint8 *plane[3];
+  gint stride[3];
+  guint w;
+  guint h;
+} SwImage;
+
+typedef struct {
+  gint fd;
+  gpointer addr;
+  gsize size;
+  gboolean write;
+} SwMapping;
+
+typedef struct _Imx2DDeviceSw {
+  gint capabilities;
+  Imx2DVideoInfo in_info;
+  Imx2DVideoInfo out_info;
+  const SwFmtMap *in_map;
+  const SwFmtMap *out_map;
+  Imx2DRotationMode rotate;
+  GThreadPool *pool;
+  guint n_threads;
+  /* source crop unpacked once when scaling or rotating */
+  guint8 *src_buf;
+  gsize src_buf_size;
+} Imx2DDeviceSw;
+
+typedef void (*SwStripeFunc) (gpointer ctx, gint start, gint end);
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  gint pending;
+} SwBatch;
+
+typedef struct {
+  SwStripeFunc func;
+  gpointer ctx;
+  gint start;
+  gint end;
+  SwBatch *batch;
+} SwStripe;
+
+typedef struct {
+  SwImage src;
+  SwImage dst;
+  /* source crop */
+  gint src_x;
+  gint src_y;
+  guint src_w;
+  guint src_h;
+  /* full destination crop, the sampling grid */
+  gint dst_x;
+  gint dst_y;
+  guint dst_w;
+  guint dst_h;
+  /* part of the destination crop inside the surface */
+  gint clip_x;
+  gint clip_y;
+  guint clip_w;
+  guint clip_h;
+  /* unpacked source seen in destination orientation */
+  guint8 *buf;
+  const guint8 *vbase;
+  gssize vxs;
+  gssize vys;
+  guint vw;
+  guint vh;
+  gboolean direct;
+  gboolean area;
+  gssize *xoff0;
+  gssize *xoff1;
+  guint *xw;
+  SwCsc csc;
+  gboolean need_csc;
+  gboolean blend;
+  guint alpha;
+  /* fill */
+  guint8 color[4];
+} SwRender;
+
+static const SwFmtMap * imx_sw_get_format (GstVideoFormat format)
+{
+  const SwFmtMap *map = sw_fmts_map;
+  while (map->bpp > 0) {
+    if (map->gst_video_format == format)
+      return map;
+    map++;
+  };
+
+  GST_ERROR ("sw : format (%s) is not supported.",
+              gst_video_format_to_string(format));
+
+  return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+/* color conversion */
+
+static void
+imx_sw_csc_init (SwCsc * csc, gboolean to_rgb, Imx2DColorimetry colorimetry)
+{
+  gdouble kr = 0.299, kb = 0.114, kg;
+  gdouble ys = 255.0 / 219.0, cs = 255.0 / 224.0, yoff = 16.0;
+  gdouble m[3][3], c[3], in_off[3];
+  gint i, j;
+
+  switch (colorimetry.matrix) {
+    case IMX_2D_COLOR_MATRIX_BT709:
+      kr = 0.2126; kb = 0.0722;
+      break;
+    case IMX_2D_COLOR_MATRIX_BT2020:
+      kr = 0.2627; kb = 0.0593;
+      break;
+    default:
+      break;
+  }
+  kg = 1.0 - kr - kb;
+
+  if (colorimetry.range == IMX_2D_COLOR_RANGE_FULL) {
+    ys = cs = 1.0;
+    yoff = 0.0;
+  }
+
+  if (to_rgb) {
+    /* Y U V -> R G B */
+    m[0][0] = ys; m[0][1] = 0.0;                        m[0][2] = cs * 2 * (1 - kr);
+    m[1][0] = ys; m[1][1] = -cs * 2 * kb * (1 - kb) / kg; m[1][2] = -cs * 2 * kr * (1 - kr) / kg;
+    m[2][0] = ys; m[2][1] = cs * 2 * (1 - kb);          m[2][2] = 0.0;
+    c[0] = c[1] = c[2] = 0.0;
+    in_off[0] = yoff; in_off[1] = in_off[2] = 128.0;
+  } else {
+    /* R G B -> Y U V */
+    m[0][0] = kr / ys;                    m[0][1] = kg / ys;                    m[0][2] = kb / ys;
+    m[1][0] = -kr / (2 * (1 - kb) * cs);  m[1][1] = -kg / (2 * (1 - kb) * cs);  m[1][2] = 0.5 / cs;
+    m[2][0] = 0.5 / cs;                   m[2][1] = -kg / (2 * (1 - kr) * cs);  m[2][2] = -kb / (2 * (1 - kr) * cs);
+    c[0] = yoff; c[1] = c[2] = 128.0;
+    in_off[0] = in_off[1] = in_off[2] = 0.0;
+  }
+
+  for (i = 0; i < 3; i++) {
+    gdouble k = c[i] * 4096.0 + 2048.0;
+    for (j = 0; j < 3; j++) {
+      csc->m[i][j] = (gint16) SW_ROUND (m[i][j] * 4096.0);
+      k -= csc->m[i][j] * in_off[j];
+    }
+    csc->c[i] = (gint16) SW_ROUND (k / 64.0);
+  }
+}
+
+static void
+imx_sw_csc_row_c (const SwCsc * csc, guint8 * p, gint n)
+{
+  gint i, k;
+
+  for (i = 0; i < n; i++, p += 4) {
+    gint in0 = p[1], in1 = p[2], in2 = p[3];
+    for (k = 0; k < 3; k++) {
+      gint v = (64 * csc->c[k] + csc->m[k][0] * in0 + csc->m[k][1] * in1
+          + csc->m[k][2] * in2) >> 12;
+      p[1 + k] = CLAMP (v, 0, 255);
+    }
+  }
+}
+
+#ifdef SW_USE_SSE2
+static void
+imx_sw_csc_row (const SwCsc * csc, guint8 * p, gint n)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i cmask = _mm_set_epi16 (-1, -1, -1, 0, -1, -1, -1, 0);
+  const __m128i one = _mm_set_epi16 (0, 0, 0, 64, 0, 0, 0, 64);
+  const __m128i amask = _mm_set1_epi32 (0xff);
+  __m128i coef[3];
+  gint i, k;
+
+  for (k = 0; k < 3; k++)
+    coef[k] = _mm_set_epi16 (csc->m[k][2], csc->m[k][1], csc->m[k][0],
+        csc->c[k], csc->m[k][2], csc->m[k][1], csc->m[k][0], csc->c[k]);
+
+  for (i = 0; i + 4 <= n; i += 4, p += 16) {
+    __m128i px = _mm_loadu_si128 ((const __m128i *) p);
+    __m128i lo = _mm_or_si128 (_mm_and_si128 (_mm_unpacklo_epi8 (px, zero),
+            cmask), one);
+    __m128i hi = _mm_or_si128 (_mm_and_si128 (_mm_unpackhi_epi8 (px, zero),
+            cmask), one);
+    __m128i ch[3], v01, v2a, v, ac0, c12;
+
+    for (k = 0; k < 3; k++) {
+      __m128i tl = _mm_madd_epi16 (lo, coef[k]);
+      __m128i th = _mm_madd_epi16 (hi, coef[k]);
+      tl = _mm_add_epi32 (tl, _mm_shuffle_epi32 (tl, _MM_SHUFFLE (2, 3, 0, 1)));
+      th = _mm_add_epi32 (th, _mm_shuffle_epi32 (th, _MM_SHUFFLE (2, 3, 0, 1)));
+      tl = _mm_shuffle_epi32 (tl, _MM_SHUFFLE (3, 1, 2, 0));
+      th = _mm_shuffle_epi32 (th, _MM_SHUFFLE (3, 1, 2, 0));
+      ch[k] = _mm_srai_epi32 (_mm_unpacklo_epi64 (tl, th), 12);
+    }
+
+    /* bytes c0 x4, c1 x4, c2 x4, a x4 then interleave back */
+    v01 = _mm_packs_epi32 (ch[0], ch[1]);
+    v2a = _mm_packs_epi32 (ch[2], _mm_and_si128 (px, amask));
+    v = _mm_packus_epi16 (v01, v2a);
+    ac0 = _mm_unpacklo_epi8 (_mm_srli_si128 (v, 12), v);
+    c12 = _mm_unpacklo_epi8 (_mm_srli_si128 (v, 4), _mm_srli_si128 (v, 8));
+    _mm_storeu_si128 ((__m128i *) p, _mm_unpacklo_epi16 (ac0, c12));
+  }
+
+  imx_sw_csc_row_c (csc, p, n - i);
+}
+#elif defined(SW_USE_NEON)
+static void
+imx_sw_csc_row (const SwCsc * csc, guint8 * p, gint n)
+{
+  gint i, k;
+
+  for (i = 0; i + 8 <= n; i += 8, p += 32) {
+    uint8x8x4_t v = vld4_u8 (p);
+    uint8x8x4_t out;
+    int16x8_t x0 = vreinterpretq_s16_u16 (vmovl_u8 (v.val[1]));
+    int16x8_t x1 = vreinterpretq_s16_u16 (vmovl_u8 (v.val[2]));
+    int16x8_t x2 = vreinterpretq_s16_u16 (vmovl_u8 (v.val[3]));
+
+    out.val[0] = v.val[0];
+    for (k = 0; k < 3; k++) {
+      int32x4_t lo = vdupq_n_s32 (64 * csc->c[k]);
+      int32x4_t hi = lo;
+      lo = vmlal_n_s16 (lo, vget_low_s16 (x0), csc->m[k][0]);
+      hi = vmlal_n_s16 (hi, vget_high_s16 (x0), csc->m[k][0]);
+      lo = vmlal_n_s16 (lo, vget_low_s16 (x1), csc->m[k][1]);
+      hi = vmlal_n_s16 (hi, vget_high_s16 (x1), csc->m[k][1]);
+      lo = vmlal_n_s16 (lo, vget_low_s16 (x2), csc->m[k][2]);
+      hi = vmlal_n_s16 (hi, vget_high_s16 (x2), csc->m[k][2]);
+      out.val[k + 1] = vqmovn_u16 (vcombine_u16 (vqshrun_n_s32 (lo, 12),
+              vqshrun_n_s32 (hi, 12)));
+    }
+    vst4_u8 (p, out);
+  }
+
+  imx_sw_csc_row_c (csc, p, n - i);
+}
+#else
+#define imx_sw_csc_row imx_sw_csc_row_c
+#endif
+
+/* ---------------------------------------------------------------------- */
+/* source over destination, alpha scaled by the global alpha */
+
+static void
+imx_sw_blend_row_c (const guint8 * s, guint8 * d, gint n, guint alpha)
+{
+  gint i, k;
+
+  for (i = 0; i < n; i++, s += 4, d += 4) {
+    guint a = SW_DIV255 (s[0] * alpha);
+    guint inv = 255 - a;
+    d[0] = SW_DIV255 (255 * a + d[0] * inv);
+    for (k = 1; k < 4; k++)
+      d[k] = SW_DIV255 (s[k] * a + d[k] * inv);
+  }
+}
+
+#ifdef SW_USE_SSE2
+static inline __m128i
+imx_sw_div255_sse2 (__m128i x)
+{
+  __m128i t = _mm_add_epi16 (x, _mm_set1_epi16 (128));
+  return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+}
+
+static inline __m128i
+imx_sw_blend_half_sse2 (__m128i s, __m128i d, __m128i alpha)
+{
+  const __m128i amask = _mm_set_epi16 (0, 0, 0, 255, 0, 0, 0, 255);
+  __m128i a = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s, 0), 0);
+  __m128i inv;
+
+  a = imx_sw_div255_sse2 (_mm_mullo_epi16 (a, alpha));
+  inv = _mm_sub_epi16 (_mm_set1_epi16 (255), a);
+  s = _mm_or_si128 (s, amask);
+  return imx_sw_div255_sse2 (_mm_add_epi16 (_mm_mullo_epi16 (s, a),
+          _mm_mullo_epi16 (d, inv)));
+}
+
+static void
+imx_sw_blend_row (const guint8 * s, guint8 * d, gint n, guint alpha)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i ga = _mm_set1_epi16 (alpha);
+  gint i;
+
+  for (i = 0; i + 4 <= n; i += 4, s += 16, d += 16) {
+    __m128i sp = _mm_loadu_si128 ((const __m128i *) s);
+    __m128i dp = _mm_loadu_si128 ((const __m128i *) d);
+    __m128i lo = imx_sw_blend_half_sse2 (_mm_unpacklo_epi8 (sp, zero),
+        _mm_unpacklo_epi8 (dp, zero), ga);
+    __m128i hi = imx_sw_blend_half_sse2 (_mm_unpackhi_epi8 (sp, zero),
+        _mm_unpackhi_epi8 (dp, zero), ga);
+    _mm_storeu_si128 ((__m128i *) d, _mm_packus_epi16 (lo, hi));
+  }
+
+  imx_sw_blend_row_c (s, d, n - i, alpha);
+}
+#elif defined(SW_USE_NEON)
+static inline uint8x8_t
+imx_sw_div255_neon (uint16x8_t x)
+{
+  uint16x8_t t = vaddq_u16 (x, vdupq_n_u16 (128));
+  return vaddhn_u16 (t, vshrq_n_u16 (t, 8));
+}
+
+static void
+imx_sw_blend_row (const guint8 * s, guint8 * d, gint n, guint alpha)
+{
+  const uint8x8_t ga = vdup_n_u8 (alpha);
+  const uint8x8_t full = vdup_n_u8 (255);
+  gint i, k;
+
+  for (i = 0; i + 8 <= n; i += 8, s += 32, d += 32) {
+    uint8x8x4_t sv = vld4_u8 (s);
+    uint8x8x4_t dv = vld4_u8 (d);
+    uint8x8_t a = imx_sw_div255_neon (vmull_u8 (sv.val[0], ga));
+    uint8x8_t inv = vsub_u8 (full, a);
+
+    dv.val[0] = imx_sw_div255_neon (vmlal_u8 (vmull_u8 (full, a),
+            dv.val[0], inv));
+    for (k = 1; k < 4; k++)
+      dv.val[k] = imx_sw_div255_neon (vmlal_u8 (vmull_u8 (sv.val[k], a),
+              dv.val[k], inv));
+    vst4_u8 (d, dv);
+  }
+
+  imx_sw_blend_row_c (s, d, n - i, alpha);
+}
+#else
+#define imx_sw_blend_row imx_sw_blend_row_c
+#endif
+
+/* ---------------------------------------------------------------------- */
+/* format access, one row of w pixels starting at (x, y) */
+
+static void
+imx_sw_unpack_row (const SwImage * img, gint y, gint x, gint w, guint8 * out)
+{
+  const SwFmtMap *map = img->map;
+  const guint8 *p = img->plane[0] + (gsize) y * img->stride[0];
+  const guint8 *u, *v;
+  gint i;
+
+  switch (map->kind) {
+    case SW_KIND_RGB32:
+      p += x * 4;
+      for (i = 0; i < w; i++, p += 4, out += 4) {
+        out[0] = map->off[3] < 0 ? 255 : p[map->off[3]];
+        out[1] = p[map->off[0]];
+        out[2] = p[map->off[1]];
+        out[3] = p[map->off[2]];
+      }
+      break;
+    case SW_KIND_RGB24:
+      p += x * 3;
+      for (i = 0; i < w; i++, p += 3, out += 4) {
+        out[0] = 255;
+        out[1] = p[map->off[0]];
+        out[2] = p[map->off[1]];
+        out[3] = p[map->off[2]];
+      }
+      break;
+    case SW_KIND_RGB16:
+      p += x * 2;
+      for (i = 0; i < w; i++, p += 2, out += 4) {
+        guint16 c = p[0] | (p[1] << 8);
+        out[0] = 255;
+        out[1] = ((c >> 11) << 3) | (c >> 13);
+        out[2] = (((c >> 5) & 0x3f) << 2) | ((c >> 9) & 0x3);
+        out[3] = ((c & 0x1f) << 3) | ((c >> 2) & 0x7);
+      }
+      break;
+    case SW_KIND_YUV422:
+      for (i = 0; i < w; i++, out += 4) {
+        const guint8 *pair = p + ((x + i) >> 1) * 4;
+        out[0] = 255;
+        out[1] = pair[((x + i) & 1) ? map->off[2] : map->off[0]];
+        out[2] = pair[map->off[1]];
+        out[3] = pair[map->off[3]];
+      }
+      break;
+    case SW_KIND_I420:
+      u = img->plane[map->off[0]] + (gsize) (y >> 1) * img->stride[map->off[0]];
+      v = img->plane[map->off[1]] + (gsize) (y >> 1) * img->stride[map->off[1]];
+      for (i = 0; i < w; i++, out += 4) {
+        out[0] = 255;
+        out[1] = p[x + i];
+        out[2] = u[(x + i) >> 1];
+        out[3] = v[(x + i) >> 1];
+      }
+      break;
+    case SW_KIND_NV12:
+      u = img->plane[1] + (gsize) (y >> 1) * img->stride[1];
+      for (i = 0; i < w; i++, out += 4) {
+        const guint8 *pair = u + ((x + i) >> 1) * 2;
+        out[0] = 255;
+        out[1] = p[x + i];
+        out[2] = pair[map->off[0]];
+        out[3] = pair[map->off[1]];
+      }
+      break;
+  }
+}
+
+/* chroma of 4:2:x formats is the average of the horizontal pair, 4:2:0
+ * chroma is taken from the even rows */
+static void
+imx_sw_pack_row (SwImage * img, gint y, gint x, gint w, const guint8 * in)
+{
+  const SwFmtMap *map = img->map;
+  guint8 *p = img->plane[0] + (gsize) y * img->stride[0];
+  guint8 *u, *v;
+  gint i;
+
+  switch (map->kind) {
+    case SW_KIND_RGB32:
+      p += x * 4;
+      for (i = 0; i < w; i++, p += 4, in += 4) {
+        p[map->off[0]] = in[1];
+        p[map->off[1]] = in[2];
+        p[map->off[2]] = in[3];
+        p[map->off[3] < 0 ? 6 - map->off[0] - map->off[1] - map->off[2]
+            : map->off[3]] = map->off[3] < 0 ? 0xff : in[0];
+      }
+      break;
+    case SW_KIND_RGB24:
+      p += x * 3;
+      for (i = 0; i < w; i++, p += 3, in += 4) {
+        p[map->off[0]] = in[1];
+        p[map->off[1]] = in[2];
+        p[map->off[2]] = in[3];
+      }
+      break;
+    case SW_KIND_RGB16:
+      p += x * 2;
+      for (i = 0; i < w; i++, p += 2, in += 4) {
+        guint16 c = ((in[1] >> 3) << 11) | ((in[2] >> 2) << 5) | (in[3] >> 3);
+        p[0] = c & 0xff;
+        p[1] = c >> 8;
+      }
+      break;
+    case SW_KIND_YUV422:
+      for (i = 0; i < w; i++, in += 4) {
+        guint8 *pair = p + ((x + i) >> 1) * 4;
+        if ((x + i) & 1) {
+          pair[map->off[2]] = in[1];
+          continue;
+        }
+        pair[map->off[0]] = in[1];
+        if (i + 1 < w) {
+          pair[map->off[1]] = (in[2] + in[6] + 1) >> 1;
+          pair[map->off[3]] = (in[3] + in[7] + 1) >> 1;
+        } else {
+          pair[map->off[1]] = in[2];
+          pair[map->off[3]] = in[3];
+        }
+      }
+      break;
+    case SW_KIND_I420:
+      u = img->plane[map->off[0]] + (gsize) (y >> 1) * img->stride[map->off[0]];
+      v = img->plane[map->off[1]] + (gsize) (y >> 1) * img->stride[map->off[1]];
+      for (i = 0; i < w; i++, in += 4) {
+        p[x + i] = in[1];
+        if ((y & 1) || ((x + i) & 1))
+          continue;
+        if (i + 1 < w) {
+          u[(x + i) >> 1] = (in[2] + in[6] + 1) >> 1;
+          v[(x + i) >> 1] = (in[3] + in[7] + 1) >> 1;
+        } else {
+          u[(x + i) >> 1] = in[2];
+          v[(x + i) >> 1] = in[3];
+        }
+      }
+      break;
+    case SW_KIND_NV12:
+      u = img->plane[1] + (gsize) (y >> 1) * img->stride[1];
+      for (i = 0; i < w; i++, in += 4) {
+        guint8 *pair = u + ((x + i) >> 1) * 2;
+        p[x + i] = in[1];
+        if ((y & 1) || ((x + i) & 1))
+          continue;
+        if (i + 1 < w) {
+          pair[map->off[0]] = (in[2] + in[6] + 1) >> 1;
+          pair[map->off[1]] = (in[3] + in[7] + 1) >> 1;
+        } else {
+          pair[map->off[0]] = in[2];
+          pair[map->off[1]] = in[3];
+        }
+      }
+      break;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+/* frame memory */
+
+static guint8 *
+imx_sw_map_fd (gint fd, gboolean write, SwMapping * m)
+{
+  struct dma_buf_sync sync;
+  off_t size;
+  gpointer addr;
+
+  size = lseek (fd, 0, SEEK_END);
+  if (size <= 0) {
+    GST_ERROR ("can't get size of dmabuf fd %d", fd);
+    return NULL;
+  }
+
+  addr = mmap (NULL, size, write ? (PROT_READ | PROT_WRITE) : PROT_READ,
+      MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    GST_ERROR ("mmap dmabuf fd %d failed: %s", fd, strerror (errno));
+    return NULL;
+  }
+
+  sync.flags = DMA_BUF_SYNC_START | (write ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ);
+  ioctl (fd, DMA_BUF_IOCTL_SYNC, &sync);
+
+  m->fd = fd;
+  m->addr = addr;
+  m->size = size;
+  m->write = write;
+
+  return (guint8 *) addr;
+}
+
+static void
+imx_sw_unmap (SwMapping * maps)
+{
+  struct dma_buf_sync sync;
+  gint i;
+
+  for (i = 0; i < 3; i++) {
+    if (!maps[i].addr)
+      continue;
+    sync.flags = DMA_BUF_SYNC_END
+        | (maps[i].write ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ);
+    ioctl (maps[i].fd, DMA_BUF_IOCTL_SYNC, &sync);
+    munmap (maps[i].addr, maps[i].size);
+    maps[i].addr = NULL;
+  }
+}
+
+static gint
+imx_sw_image_init (SwImage * img, const SwFmtMap * map, Imx2DVideoInfo * info,
+    Imx2DFrame * frame, SwMapping * maps, gboolean write)
+{
+  guint min_stride;
+  gint i;
+
+  memset (img, 0, sizeof (SwImage));
+  for (i = 0; i < 3; i++)
+    maps[i].addr = NULL;
+
+  img->map = map;
+  img->w = info->w;
+  img->h = info->h;
+
+  if (frame->mem && frame->mem->vaddr)
+    img->plane[0] = frame->mem->vaddr;
+  else if (frame->fd[0] >= 0)
+    img->plane[0] = imx_sw_map_fd (frame->fd[0], write, &maps[0]);
+  if (!img->plane[0]) {
+    GST_ERROR ("sw : no CPU access to frame memory");
+    return -1;
+  }
+
+  min_stride = map->kind == SW_KIND_I420 || map->kind == SW_KIND_NV12 ?
+      info->w : info->w * map->bpp / 8;
+  img->stride[0] = MAX (info->stride, min_stride);
+
+  switch (map->kind) {
+    case SW_KIND_NV12:
+      img->stride[1] = img->stride[0];
+      img->plane[1] = img->plane[0] + (gsize) img->stride[0] * info->h;
+      break;
+    case SW_KIND_I420:
+      img->stride[1] = img->stride[2] = img->stride[0] / 2;
+      img->plane[1] = img->plane[0] + (gsize) img->stride[0] * info->h;
+      img->plane[2] = img->plane[1] + (gsize) img->stride[1] * ((info->h + 1) / 2);
+      break;
+    default:
+      return 0;
+  }
+
+  /* multi planar dmabuf, one fd per plane */
+  for (i = 1; i < 3; i++) {
+    if (frame->fd[i] < 0 || !img->plane[i])
+      continue;
+    img->plane[i] = imx_sw_map_fd (frame->fd[i], write, &maps[i]);
+    if (!img->plane[i]) {
+      imx_sw_unmap (maps);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* stripes */
+
+static void
+imx_sw_stripe_run (gpointer data, gpointer user_data)
+{
+  SwStripe *stripe = (SwStripe *) data;
+
+  stripe->func (stripe->ctx, stripe->start, stripe->end);
+
+  g_mutex_lock (&stripe->batch->lock);
+  if (--stripe->batch->pending == 0)
+    g_cond_signal (&stripe->batch->cond);
+  g_mutex_unlock (&stripe->batch->lock);
+}
+
+/* luma rows sharing one chroma row, a stripe boundary between them would
+ * have two threads read, modify and write the same chroma row */
+static gint
+imx_sw_row_align (const SwFmtMap * map)
+{
+  return (map->kind == SW_KIND_I420 || map->kind == SW_KIND_NV12) ? 2 : 1;
+}
+
+/* run func over rows in stripes, stripes start on absolute rows origin +
+ * start that are multiples of align */
+static void
+imx_sw_run_stripes (Imx2DDeviceSw * sw, SwStripeFunc func, gpointer ctx,
+    gint origin, gint rows, gint align)
+{
+  SwStripe stripes[SW_MAX_THREADS];
+  SwBatch batch;
+  gint n, size, i, start, end;
+
+  n = MIN ((gint) sw->n_threads, rows / SW_MIN_STRIPE_ROWS);
+  if (n <= 1 || !sw->pool) {
+    func (ctx, 0, rows);
+    return;
+  }
+
+  size = (rows + n - 1) / n;
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.pending = 0;
+
+  for (i = 0, start = 0; i < n && start < rows; i++, start = end) {
+    end = ALIGNTO (origin + (i + 1) * size, align) - origin;
+    end = i == n - 1 ? rows : MIN (rows, end);
+    stripes[i].func = func;
+    stripes[i].ctx = ctx;
+    stripes[i].start = start;
+    stripes[i].end = end;
+    stripes[i].batch = &batch;
+  }
+  n = i;
+  batch.pending = n - 1;
+
+  for (i = 1; i < n; i++)
+    g_thread_pool_push (sw->pool, &stripes[i], NULL);
+  func (ctx, stripes[0].start, stripes[0].end);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+}
+
+/* ---------------------------------------------------------------------- */
+/* scaling and rotation */
+
+static void
+imx_sw_unpack_stripe (gpointer ctx, gint start, gint end)
+{
+  SwRender *r = (SwRender *) ctx;
+  gint y;
+
+  for (y = start; y < end; y++)
+    imx_sw_unpack_row (&r->src, r->src_y + y, r->src_x, r->src_w,
+        r->buf + (gsize) y * r->src_w * 4);
+}
+
+/* walk the unpacked source so that x/y follow the destination axes */
+static void
+imx_sw_setup_view (SwRender * r, Imx2DRotationMode rotate)
+{
+  gssize row = (gssize) r->src_w * 4;
+  guint w = r->src_w, h = r->src_h;
+
+  r->vw = w;
+  r->vh = h;
+  switch (rotate) {
+    case IMX_2D_ROTATION_90:
+      r->vw = h; r->vh = w;
+      r->vbase = r->buf + (gssize) (h - 1) * row;
+      r->vxs = -row; r->vys = 4;
+      break;
+    case IMX_2D_ROTATION_180:
+      r->vbase = r->buf + (gssize) (h - 1) * row + (w - 1) * 4;
+      r->vxs = -4; r->vys = -row;
+      break;
+    case IMX_2D_ROTATION_270:
+      r->vw = h; r->vh = w;
+      r->vbase = r->buf + (w - 1) * 4;
+      r->vxs = row; r->vys = -4;
+      break;
+    case IMX_2D_ROTATION_HFLIP:
+      r->vbase = r->buf + (w - 1) * 4;
+      r->vxs = -4; r->vys = row;
+      break;
+    case IMX_2D_ROTATION_VFLIP:
+      r->vbase = r->buf + (gssize) (h - 1) * row;
+      r->vxs = 4; r->vys = -row;
+      break;
+    default:
+      r->vbase = r->buf;
+      r->vxs = 4; r->vys = row;
+      break;
+  }
+}
+
+/* bilinear: sample centre in 8 bit fixed point, area: first source pixel
+ * and pixel count */
+static void
+imx_sw_sample_pos (guint i, guint src, guint dst, gboolean area,
+    guint * p0, guint * p1)
+{
+  if (area) {
+    *p0 = (guint64) i * src / dst;
+    *p1 = MAX (*p0 + 1, (guint) ((guint64) (i + 1) * src / dst)) - *p0;
+  } else {
+    gint64 pos = ((gint64) (2 * i + 1) * src * 256) / (2 * dst) - 128;
+    pos = CLAMP (pos, 0, (gint64) (src - 1) * 256);
+    *p0 = pos >> 8;
+    *p1 = pos & 0xff;
+  }
+}
+
+static void
+imx_sw_setup_columns (SwRender * r)
+{
+  guint i, p0, p1;
+
+  r->xoff0 = g_new (gssize, r->clip_w);
+  r->xoff1 = g_new (gssize, r->clip_w);
+  r->xw = g_new (guint, r->clip_w);
+
+  for (i = 0; i < r->clip_w; i++) {
+    imx_sw_sample_pos (r->clip_x - r->dst_x + i, r->vw, r->dst_w, r->area,
+        &p0, &p1);
+    r->xoff0[i] = (gssize) p0 * r->vxs;
+    if (r->area) {
+      r->xw[i] = p1;
+    } else {
+      r->xoff1[i] = (gssize) MIN (p0 + 1, r->vw - 1) * r->vxs;
+      r->xw[i] = p1;
+    }
+  }
+}
+
+static void
+imx_sw_sample_row (SwRender * r, guint ry, guint8 * out)
+{
+  guint y0, wy, i, k;
+
+  imx_sw_sample_pos (ry, r->vh, r->dst_h, r->area, &y0, &wy);
+
+  if (r->area) {
+    for (i = 0; i < r->clip_w; i++, out += 4) {
+      guint sum[4] = { 0, 0, 0, 0 };
+      guint n = r->xw[i] * wy, yy, xx;
+      for (yy = 0; yy < wy; yy++) {
+        const guint8 *p = r->vbase + (gssize) (y0 + yy) * r->vys + r->xoff0[i];
+        for (xx = 0; xx < r->xw[i]; xx++, p += r->vxs)
+          for (k = 0; k < 4; k++)
+            sum[k] += p[k];
+      }
+      for (k = 0; k < 4; k++)
+        out[k] = (sum[k] + n / 2) / n;
+    }
+  } else {
+    const guint8 *r0 = r->vbase + (gssize) y0 * r->vys;
+    const guint8 *r1 = r->vbase + (gssize) MIN (y0 + 1, r->vh - 1) * r->vys;
+    for (i = 0; i < r->clip_w; i++, out += 4) {
+      const guint8 *p00 = r0 + r->xoff0[i], *p01 = r0 + r->xoff1[i];
+      const guint8 *p10 = r1 + r->xoff0[i], *p11 = r1 + r->xoff1[i];
+      guint wx = r->xw[i];
+      for (k = 0; k < 4; k++) {
+        guint top = p00[k] * (256 - wx) + p01[k] * wx;
+        guint bot = p10[k] * (256 - wx) + p11[k] * wx;
+        out[k] = (top * (256 - wy) + bot * wy + 32768) >> 16;
+      }
+    }
+  }
+}
+
+static void
+imx_sw_render_stripe (gpointer ctx, gint start, gint end)
+{
+  SwRender *r = (SwRender *) ctx;
+  guint8 *row = g_malloc (r->clip_w * 4);
+  guint8 *drow = r->blend ? g_malloc (r->clip_w * 4) : NULL;
+  gint y;
+
+  for (y = start; y < end; y++) {
+    gint oy = r->clip_y + y;
+    guint ry = oy - r->dst_y;
+
+    if (r->direct)
+      imx_sw_unpack_row (&r->src, r->src_y + ry,
+          r->src_x + (r->clip_x - r->dst_x), r->clip_w, row);
+    else
+      imx_sw_sample_row (r, ry, row);
+
+    if (r->need_csc)
+      imx_sw_csc_row (&r->csc, row, r->clip_w);
+
+    if (r->blend) {
+      imx_sw_unpack_row (&r->dst, oy, r->clip_x, r->clip_w, drow);
+      imx_sw_blend_row (row, drow, r->clip_w, r->alpha);
+      imx_sw_pack_row (&r->dst, oy, r->clip_x, r->clip_w, drow);
+    } else {
+      imx_sw_pack_row (&r->dst, oy, r->clip_x, r->clip_w, row);
+    }
+  }
+
+  g_free (drow);
+  g_free (row);
+}
+
+/* ---------------------------------------------------------------------- */
+/* device interfaces */
+
+static gint imx_sw_open (Imx2DDevice *device)
+{
+  if (!device)
+    return -1;
+
+  Imx2DDeviceSw *sw = g_slice_alloc (sizeof(Imx2DDeviceSw));
+  if (!sw) {
+    GST_ERROR ("allocate sw structure failed\n");
+    return -1;
+  }
+
+  memset (sw, 0, sizeof (Imx2DDeviceSw));
+  sw->n_threads = CLAMP (g_get_num_processors (), 1, SW_MAX_THREADS);
+  if (sw->n_threads > 1)
+    sw->pool = g_thread_pool_new (imx_sw_stripe_run, NULL, sw->n_threads - 1,
+        FALSE, NULL);
+  device->priv = (gpointer) sw;
+
+  GST_DEBUG ("sw device opened with %d threads", sw->n_threads);
+
+  return 0;
+}
+
+static gint imx_sw_close (Imx2DDevice *device)
+{
+  if (!device)
+    return -1;
+
+  Imx2DDeviceSw *sw = (Imx2DDeviceSw *) (device->priv);
+  if (sw) {
+    if (sw->pool)
+      g_thread_pool_free (sw->pool, FALSE, TRUE);
+    g_free (sw->src_buf);
+    g_slice_free1 (sizeof(Imx2DDeviceSw), sw);
+  }
+  device->priv = NULL;
+
+  return 0;
+}
+
+static gint
+imx_sw_alloc_mem (Imx2DDevice *device, PhyMemBlock *memblk)
+{
+  gpointer ptr = NULL;
+
+  if (!device || !memblk)
+    return -1;
+
+  memblk->size = PAGE_ALIGN (memblk->size);
+  if (posix_memalign (&ptr, getpagesize (), memblk->size) != 0) {
+    GST_ERROR ("sw allocate %u bytes memory failed", memblk->size);
+    return -1;
+  }
+
+  memblk->vaddr = ptr;
+  memblk->paddr = NULL;
+  memblk->user_data = NULL;
+
+  return 0;
+}
+
+static gint imx_sw_free_mem (Imx2DDevice *device, PhyMemBlock *memblk)
+{
+  if (!device || !memblk)
+    return -1;
+
+  free (memblk->vaddr);
+  memblk->vaddr = NULL;
+  memblk->paddr = NULL;
+  memblk->size = 0;
+
+  return 0;
+}
+
+static gint imx_sw_copy_mem (Imx2DDevice* device, PhyMemBlock *dst_mem,
+                             PhyMemBlock *src_mem, guint offset, guint size)
+{
+  if (!device || !dst_mem || !src_mem || offset > src_mem->size)
+    return -1;
+
+  if (!dst_mem->vaddr) {
+    dst_mem->size = src_mem->size;
+    if (imx_sw_alloc_mem (device, dst_mem) < 0)
+      return -1;
+  }
+
+  if (size > src_mem->size - offset)
+    size = src_mem->size - offset;
+  if (size > dst_mem->size)
+    size = dst_mem->size;
+  memcpy (dst_mem->vaddr, src_mem->vaddr + offset, size);
+
+  return 0;
+}
+
+static gint imx_sw_frame_copy (Imx2DDevice *device,
+                               PhyMemBlock *from, PhyMemBlock *to)
+{
+  if (!device || !from || !to || !from->vaddr || !to->vaddr)
+    return -1;
+
+  memcpy (to->vaddr, from->vaddr, MIN (from->size, to->size));
+
+  return 0;
+}
+
+static gint imx_sw_config_input (Imx2DDevice *device, Imx2DVideoInfo* in_info)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSw *sw = (Imx2DDeviceSw *) (device->priv);
+  if (in_info->tile_type != IMX_2D_TILE_NULL) {
+    GST_ERROR ("sw : tiled input is not supported");
+    return -1;
+  }
+
+  sw->in_map = imx_sw_get_format (in_info->fmt);
+  if (!sw->in_map)
+    return -1;
+
+  memcpy (&sw->in_info, in_info, sizeof (Imx2DVideoInfo));
+  GST_TRACE ("input format = %s", gst_video_format_to_string (in_info->fmt));
+
+  return 0;
+}
+
+static gint imx_sw_config_output (Imx2DDevice *device, Imx2DVideoInfo* out_info)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSw *sw = (Imx2DDeviceSw *) (device->priv);
+  sw->out_map = imx_sw_get_format (out_info->fmt);
+  if (!sw->out_map)
+    return -1;
+
+  memcpy (&sw->out_info, out_info, sizeof (Imx2DVideoInfo));
+  GST_TRACE ("output format = %s", gst_video_format_to_string (out_info->fmt));
+
+  return 0;
+}
+
+static gint imx_sw_blit (Imx2DDevice *device,
+                         Imx2DFrame *dst, Imx2DFrame *src, gboolean alpha_en)
+{
+  SwMapping src_maps[3], dst_maps[3];
+  SwRender r;
+  gsize size;
+  gint ret = 0;
+
+  if (!device || !device->priv || !dst || !src)
+    return -1;
+
+  Imx2DDeviceSw *sw = (Imx2DDeviceSw *) (device->priv);
+  if (!sw->in_map || !sw->out_map)
+    return -1;
+
+  memset (&r, 0, sizeof (SwRender));
+
+  /* clip the source crop to the surface */
+  r.src_x = MAX (src->crop.x, 0);
+  r.src_y = MAX (src->crop.y, 0);
+  if (r.src_x >= (gint) sw->in_info.w || r.src_y >= (gint) sw->in_info.h) {
+    GST_WARNING ("input crop outside of source");
+    return -1;
+  }
+  r.src_w = MIN (src->crop.w, sw->in_info.w - r.src_x);
+  r.src_h = MIN (src->crop.h, sw->in_info.h - r.src_y);
+
+  /* the sampling grid keeps the full output crop, only the part inside the
+   * destination surface is rendered */
+  r.dst_x = dst->crop.x;
+  r.dst_y = dst->crop.y;
+  r.dst_w = dst->crop.w;
+  r.dst_h = dst->crop.h;
+  r.clip_x = MAX (r.dst_x, 0);
+  r.clip_y = MAX (r.dst_y, 0);
+  if (r.src_w == 0 || r.src_h == 0 || r.dst_w == 0 || r.dst_h == 0
+      || r.clip_x >= (gint) MIN (sw->out_info.w, r.dst_x + r.dst_w)
+      || r.clip_y >= (gint) MIN (sw->out_info.h, r.dst_y + r.dst_h)) {
+    GST_WARNING ("output crop outside of destination");
+    return -1;
+  }
+  r.clip_w = MIN (sw->out_info.w, r.dst_x + r.dst_w) - r.clip_x;
+  r.clip_h = MIN (sw->out_info.h, r.dst_y + r.dst_h) - r.clip_y;
+
+  r.blend = alpha_en && (src->alpha < 0xFF
+      || (sw->in_map->kind == SW_KIND_RGB32 && sw->in_map->off[3] >= 0));
+  r.alpha = CLAMP (src->alpha, 0, 255);
+
+  if (sw->in_map->yuv != sw->out_map->yuv) {
+    r.need_csc = TRUE;
+    imx_sw_csc_init (&r.csc, sw->in_map->yuv, sw->in_map->yuv ?
+        sw->in_info.colorimetry : sw->out_info.colorimetry);
+  }
+
+  if (imx_sw_image_init (&r.src, sw->in_map, &sw->in_info, src, src_maps,
+          FALSE) < 0)
+    return -1;
+  if (imx_sw_image_init (&r.dst, sw->out_map, &sw->out_info, dst, dst_maps,
+          TRUE) < 0) {
+    imx_sw_unmap (src_maps);
+    return -1;
+  }
+
+  GST_TRACE ("sw src : %dx%d,%d(%d,%d %dx%d) dst : %dx%d,%d(%d,%d %dx%d) "
+      "rotate %d blend %d alpha %d", sw->in_info.w, sw->in_info.h,
+      r.src.stride[0], r.src_x, r.src_y, r.src_w, r.src_h, sw->out_info.w,
+      sw->out_info.h, r.dst.stride[0], r.clip_x, r.clip_y, r.clip_w, r.clip_h,
+      sw->rotate, r.blend, r.alpha);
+
+  r.direct = sw->rotate == IMX_2D_ROTATION_0 && r.src_w == r.dst_w
+      && r.src_h == r.dst_h;
+
+  if (!r.direct) {
+    size = (gsize) r.src_w * r.src_h * 4;
+    if (size > sw->src_buf_size) {
+      g_free (sw->src_buf);
+      sw->src_buf = g_try_malloc (size);
+      sw->src_buf_size = sw->src_buf ? size : 0;
+    }
+    if (!sw->src_buf) {
+      GST_ERROR ("sw : allocate %" G_GSIZE_FORMAT " bytes failed", size);
+      ret = -1;
+      goto done;
+    }
+
+    r.buf = sw->src_buf;
+    imx_sw_run_stripes (sw, imx_sw_unpack_stripe, &r, 0, r.src_h, 2);
+    imx_sw_setup_view (&r, sw->rotate);
+    r.area = r.vw >= 2 * r.dst_w || r.vh >= 2 * r.dst_h;
+    imx_sw_setup_columns (&r);
+  }
+
+  imx_sw_run_stripes (sw, imx_sw_render_stripe, &r, r.clip_y, r.clip_h,
+      imx_sw_row_align (sw->out_map));
+
+done:
+  g_free (r.xoff0);
+  g_free (r.xoff1);
+  g_free (r.xw);
+  imx_sw_unmap (dst_maps);
+  imx_sw_unmap (src_maps);
+
+  GST_TRACE ("finish\n");
+  return ret;
+}
+
+static gint imx_sw_convert (Imx2DDevice *device,
+                            Imx2DFrame *dst, Imx2DFrame *src)
+{
+  return imx_sw_blit (device, dst, src, FALSE);
+}
+
+static gint imx_sw_blend (Imx2DDevice *device, Imx2DFrame *dst, Imx2DFrame *src)
+{
+  return imx_sw_blit (device, dst, src, TRUE);
+}
+
+static gint imx_sw_blend_finish (Imx2DDevice *device)
+{
+  /* every blend is complete when it returns */
+  return 0;
+}
+
+static void
+imx_sw_fill_stripe (gpointer ctx, gint start, gint end)
+{
+  SwRender *r = (SwRender *) ctx;
+  guint8 *row = g_malloc (r->clip_w * 4);
+  guint i;
+  gint y;
+
+  for (i = 0; i < r->clip_w; i++)
+    memcpy (row + i * 4, r->color, 4);
+
+  for (y = start; y < end; y++)
+    imx_sw_pack_row (&r->dst, r->clip_y + y, r->clip_x, r->clip_w, row);
+
+  g_free (row);
+}
+
+static gint imx_sw_fill_color (Imx2DDevice *device, Imx2DFrame *dst,
+                               guint RGBA8888)
+{
+  SwMapping dst_maps[3];
+  SwRender r;
+
+  if (!device || !device->priv || !dst)
+    return -1;
+
+  Imx2DDeviceSw *sw = (Imx2DDeviceSw *) (device->priv);
+  if (!sw->out_map)
+    return -1;
+
+  memset (&r, 0, sizeof (SwRender));
+  if (imx_sw_image_init (&r.dst, sw->out_map, &sw->out_info, dst, dst_maps,
+          TRUE) < 0)
+    return -1;
+
+  r.color[0] = (RGBA8888 >> 24) & 0xff;
+  r.color[1] = RGBA8888 & 0xff;
+  r.color[2] = (RGBA8888 >> 8) & 0xff;
+  r.color[3] = (RGBA8888 >> 16) & 0xff;
+  if (sw->out_map->yuv) {
+    imx_sw_csc_init (&r.csc, FALSE, sw->out_info.colorimetry);
+    imx_sw_csc_row_c (&r.csc, r.color, 1);
+  }
+
+  /* only the destination crop is filled */
+  r.clip_x = CLAMP (dst->crop.x, 0, (gint) sw->out_info.w);
+  r.clip_y = CLAMP (dst->crop.y, 0, (gint) sw->out_info.h);
+  r.clip_w = MIN (dst->crop.x + (gint) dst->crop.w,
+      (gint) sw->out_info.w) - r.clip_x;
+  r.clip_h = MIN (dst->crop.y + (gint) dst->crop.h,
+      (gint) sw->out_info.h) - r.clip_y;
+  if ((gint) r.clip_w <= 0 || (gint) r.clip_h <= 0) {
+    imx_sw_unmap (dst_maps);
+    return 0;
+  }
+
+  GST_TRACE ("sw clear : %dx%d,%d(%d,%d-%dx%d) color 0x%08x",
+      sw->out_info.w, sw->out_info.h, r.dst.stride[0], r.clip_x, r.clip_y,
+      r.clip_w, r.clip_h, RGBA8888);
+
+  imx_sw_run_stripes (sw, imx_sw_fill_stripe, &r, r.clip_y, r.clip_h,
+      imx_sw_row_align (sw->out_map));
+  imx_sw_unmap (dst_maps);
+
+  return 0;
+}
+
+static gint imx_sw_set_rotate (Imx2DDevice *device, Imx2DRotationMode rot)
+{
+  if (!device || !device->priv)
+    return -1;
+
+  Imx2DDeviceSw *sw = (Imx2DDeviceSw *) (device->priv);
+  sw->rotate = rot;
+  return 0;
+}
+
+static gint imx_sw_set_deinterlace (Imx2DDevice *device,
+                                    Imx2DDeinterlaceMode mode)
+{
+  return 0;
+}
+
+static Imx2DRotationMode imx_sw_get_rotate (Imx2DDevice* device)
+{
+  if (!device || !device->priv)
+    return IMX_2D_ROTATION_0;
+
+  Imx2DDeviceSw *sw = (Imx2DDeviceSw *) (device->priv);
+  return sw->rotate;
+}
+
+static Imx2DDeinterlaceMode imx_sw_get_deinterlace (Imx2DDevice* device)
+{
+  return IMX_2D_DEINTERLACE_NONE;
+}
+
+static gint imx_sw_get_capabilities (Imx2DDevice* device)
+{
+  gint capabilities = IMX_2D_DEVICE_CAP_SCALE | IMX_2D_DEVICE_CAP_CSC
+                      | IMX_2D_DEVICE_CAP_ROTATE | IMX_2D_DEVICE_CAP_ALPHA
+                      | IMX_2D_DEVICE_CAP_BLEND;
+
+  return capabilities;
+}
+
+static GList* imx_sw_get_supported_fmts (Imx2DDevice* device)
+{
+  GList* list = NULL;
+  const SwFmtMap *map = sw_fmts_map;
+
+  while (map->bpp > 0) {
+    list = g_list_append (list, (gpointer) (map->gst_video_format));
+    map++;
+  }
+
+  return list;
+}
+
+Imx2DDevice * imx_sw_create (Imx2DDeviceType  device_type)
+{
+  Imx2DDevice * device = g_slice_alloc0(sizeof(Imx2DDevice));
+  if (!device) {
+    GST_ERROR("allocate device structure failed\n");
+    return NULL;
+  }
+
+  device->device_type = device_type;
+  device->priv = NULL;
+
+  device->open                = imx_sw_open;
+  device->close               = imx_sw_close;
+  device->alloc_mem           = imx_sw_alloc_mem;
+  device->free_mem            = imx_sw_free_mem;
+  device->copy_mem            = imx_sw_copy_mem;
+  device->frame_copy          = imx_sw_frame_copy;
+  device->config_input        = imx_sw_config_input;
+  device->config_output       = imx_sw_config_output;
+  device->convert             = imx_sw_convert;
+  device->blend               = imx_sw_blend;
+  device->blend_finish        = imx_sw_blend_finish;
+  device->fill                = imx_sw_fill_color;
+  device->set_rotate          = imx_sw_set_rotate;
+  device->set_deinterlace     = imx_sw_set_deinterlace;
+  device->get_rotate          = imx_sw_get_rotate;
+  device->get_deinterlace     = imx_sw_get_deinterlace;
+  device->get_capabilities    = imx_sw_get_capabilities;
+  device->get_supported_in_fmts  = imx_sw_get_supported_fmts;
+  device->get_supported_out_fmts = imx_sw_get_supported_fmts;
+
+  return device;
+}
+
+gint imx_sw_destroy (Imx2DDevice *device)
+{
+  if (!device)
+    return -1;
+
+  g_slice_free1 (sizeof(Imx2DDevice), device);
+
+  return 0;
+}
+
+gboolean imx_sw_is_exist (void)
+{
+  return TRUE;
+}
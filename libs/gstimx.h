@@ -20,6 +20,8 @@
 #ifndef __IMX_H__
 #define __IMX_H__
 
+#include <gst/gst.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -27,6 +29,10 @@ extern "C" {
 unsigned long phy_addr_from_fd(int dmafd);
 unsigned long phy_addr_from_vaddr(void *vaddr, int size);
 
+/* cached lookup for dmabuf memory, the entry is dropped with the memory */
+unsigned long phy_addr_from_dmabuf_memory(GstMemory *mem);
+void phy_addr_cache_get_stats(guint64 *hits, guint64 *misses, guint *entries);
+
 
 #ifdef __cplusplus
 }
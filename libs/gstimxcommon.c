@@ -28,18 +28,65 @@
 #ifdef USE_ION
 #include <linux/ion.h>
 #endif
+#include <sys/stat.h>
+#include <gst/allocators/gstdmabuf.h>
 const char *dev_ion = "/dev/ion";
 
-unsigned long phy_addr_from_fd(int dmafd)
+/* physical addresses of dmabufs looked up through a GstMemory, keyed by the
+ * dmabuf inode so every element importing the same buffer shares the entry.
+ * An entry lives as long as one of the memories it was looked up for. A
+ * bare fd has nothing to tie an entry to, phy_addr_from_fd() always asks the
+ * kernel and callers holding the memory go through the cache instead. */
+typedef struct {
+  dev_t dev;
+  ino_t ino;
+  unsigned long paddr;
+  guint refcount;
+} PhyAddrEntry;
+
+/* phy_cache_lock guards the table, the counters are atomic so that hits
+ * through the memory qdata stay lock free */
+static GMutex phy_cache_lock;
+static GHashTable *phy_cache;
+static gsize phy_cache_hits;
+static gsize phy_cache_misses;
+
+static guint phy_addr_entry_hash (gconstpointer key)
 {
-  int ret, fd;
+  const PhyAddrEntry *entry = (const PhyAddrEntry *) key;
+  return (guint) entry->ino ^ ((guint) entry->dev << 16);
+}
+
+static gboolean phy_addr_entry_equal (gconstpointer a, gconstpointer b)
+{
+  const PhyAddrEntry *ea = (const PhyAddrEntry *) a;
+  const PhyAddrEntry *eb = (const PhyAddrEntry *) b;
+  return ea->ino == eb->ino && ea->dev == eb->dev;
+}
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(4, 14, 0) && defined (USE_ION)
+/* opened once and kept for the life of the process */
+static int ion_fd_get (void)
+{
+  static gsize ion_fd_init = 0;
+  static int ion_fd = -1;
+
+  if (g_once_init_enter (&ion_fd_init)) {
+    ion_fd = open(dev_ion, O_RDWR | O_CLOEXEC);
+    g_once_init_leave (&ion_fd_init, 1);
+  }
+
+  return ion_fd;
+}
+#endif
+
+static unsigned long phy_addr_query_fd (int dmafd)
+{
+  int ret;
 
-  if (dmafd < 0)
-    return NULL;
-  
 #if LINUX_VERSION_CODE < KERNEL_VERSION(4, 14, 0)
 #ifdef USE_ION
-  fd = open(dev_ion, O_RDWR);
+  int fd = ion_fd_get ();
   if(fd < 0) {
     return NULL;
   }
@@ -56,7 +103,6 @@ unsigned long phy_addr_from_fd(int dmafd)
   };
 
   ret = ioctl(fd, ION_IOC_CUSTOM, &custom);
-  close(fd);
   if (ret < 0)
     return NULL;
 
@@ -75,6 +121,101 @@ unsigned long phy_addr_from_fd(int dmafd)
 #endif
 }
 
+unsigned long phy_addr_from_fd(int dmafd)
+{
+  if (dmafd < 0)
+    return NULL;
+
+  return phy_addr_query_fd (dmafd);
+}
+
+static void phy_addr_entry_release (gpointer data)
+{
+  PhyAddrEntry *entry = (PhyAddrEntry *) data;
+
+  g_mutex_lock (&phy_cache_lock);
+  if (--entry->refcount == 0)
+    g_hash_table_remove (phy_cache, entry);
+  g_mutex_unlock (&phy_cache_lock);
+}
+
+unsigned long phy_addr_from_dmabuf_memory(GstMemory *mem)
+{
+  static GQuark quark = 0;
+  PhyAddrEntry *entry, key = { 0 };
+  struct stat st;
+  int dmafd;
+
+  if (!mem || !gst_is_dmabuf_memory (mem))
+    return NULL;
+
+  if (!quark)
+    quark = g_quark_from_static_string ("imx-phyaddr-entry");
+
+  /* recycled pool buffers end here without any syscall */
+  entry = gst_mini_object_get_qdata (GST_MINI_OBJECT (mem), quark);
+  if (entry) {
+    g_atomic_pointer_add (&phy_cache_hits, 1);
+    return entry->paddr;
+  }
+
+  dmafd = gst_dmabuf_memory_get_fd (mem);
+  if (dmafd < 0 || fstat (dmafd, &st) < 0)
+    return NULL;
+
+  key.dev = st.st_dev;
+  key.ino = st.st_ino;
+
+  g_mutex_lock (&phy_cache_lock);
+  if (!phy_cache)
+    phy_cache = g_hash_table_new_full (phy_addr_entry_hash,
+        phy_addr_entry_equal, g_free, NULL);
+
+  entry = (PhyAddrEntry *) g_hash_table_lookup (phy_cache, &key);
+  if (entry) {
+    g_atomic_pointer_add (&phy_cache_hits, 1);
+  } else {
+    unsigned long paddr;
+
+    g_atomic_pointer_add (&phy_cache_misses, 1);
+    g_mutex_unlock (&phy_cache_lock);
+    paddr = phy_addr_query_fd (dmafd);
+    if (!paddr)
+      return NULL;
+    g_mutex_lock (&phy_cache_lock);
+
+    /* another thread may have added it meanwhile */
+    entry = (PhyAddrEntry *) g_hash_table_lookup (phy_cache, &key);
+    if (!entry) {
+      entry = g_new0 (PhyAddrEntry, 1);
+      entry->dev = key.dev;
+      entry->ino = key.ino;
+      entry->paddr = paddr;
+      g_hash_table_add (phy_cache, entry);
+    }
+  }
+  entry->refcount++;
+  g_mutex_unlock (&phy_cache_lock);
+
+  gst_mini_object_set_qdata (GST_MINI_OBJECT (mem), quark, entry,
+      phy_addr_entry_release);
+
+  return entry->paddr;
+}
+
+void phy_addr_cache_get_stats(guint64 *hits, guint64 *misses, guint *entries)
+{
+  if (hits)
+    *hits = (gsize) g_atomic_pointer_get (&phy_cache_hits);
+  if (misses)
+    *misses = (gsize) g_atomic_pointer_get (&phy_cache_misses);
+
+  g_mutex_lock (&phy_cache_lock);
+  if (entries)
+    *entries = phy_cache ? g_hash_table_size (phy_cache) : 0;
+  g_mutex_unlock (&phy_cache_lock);
+}
+
 unsigned long phy_addr_from_vaddr(void *vaddr, int size)
 {
 #ifdef USE_ION
@@ -84,7 +225,7 @@ unsigned long phy_addr_from_vaddr(void *vaddr, int size)
     return NULL;
   
 #if LINUX_VERSION_CODE < KERNEL_VERSION(4, 14, 0)
-  fd = open(dev_ion, O_RDWR);
+  fd = ion_fd_get ();
   if(fd < 0) {
     return NULL;
   }
@@ -101,7 +242,6 @@ unsigned long phy_addr_from_vaddr(void *vaddr, int size)
   };
 
   ret = ioctl(fd, ION_IOC_CUSTOM, &custom);
-  close(fd);
   if (ret < 0)
     return NULL;
 
@@ -207,8 +207,10 @@ void imx_video_overlay_composition_deinit(GstImxVideoOverlayComposition *vcomp)
   if (vcomp) {
     if (vcomp->tmp_buf)
       gst_buffer_unref(vcomp->tmp_buf);
-    if (vcomp->allocator)
+    if (vcomp->allocator) {
+      gst_imx_2d_device_allocator_flush (vcomp->allocator);
       gst_object_unref (vcomp->allocator);
+    }
 
     vcomp->tmp_buf = NULL;
     vcomp->allocator = NULL;
@@ -581,6 +583,11 @@ gint imx_video_overlay_composition_composite(
         n_mem = gst_buffer_n_memory (in_buf);
         for (i = 0; i < n_mem; i++)
           src.fd[i] = gst_dmabuf_memory_get_fd (gst_buffer_peek_memory (in_buf, i));
+        src_mem.paddr = (guint8 *) phy_addr_from_dmabuf_memory (
+            gst_buffer_peek_memory (in_buf, 0));
+        if (n_mem > 1)
+          src_mem.user_data = (gpointer) phy_addr_from_dmabuf_memory (
+              gst_buffer_peek_memory (in_buf, 1));
       } else
         src.mem = gst_buffer_query_phymem_block (in_buf);
       src.alpha = 0xFF;
@@ -0,0 +1,414 @@
+/* Downscaled secondary frame produced by IMX 2D devices
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* This lib lets a producer (e.g. the VPU decoder) attach a small copy of the
+ * frame it just produced, scaled by a 2D device directly from the physical
+ * source, so thumbnail or analytics branches don't need a second full size
+ * map/scale of every frame. The copy travels as a GstImxThumbnailMeta on the
+ * full size buffer and keeps its own reference on the downscaled buffer.
+ */
+
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/allocators/gstdmabufmeta.h>
+#include <gst/allocators/gstphymemmeta.h>
+#ifdef USE_DMABUFHEAPS
+#include <gst/allocators/gstdmabufheaps.h>
+#endif
+#ifdef USE_ION
+#include <gst/allocators/gstionmemory.h>
+#endif
+#include "imxthumbnailmeta.h"
+#include "../device-2d/imx_2d_device_allocator.h"
+
+GST_DEBUG_CATEGORY_STATIC(thumbnail_meta);
+#define GST_CAT_DEFAULT thumbnail_meta
+
+static gboolean
+gst_imx_thumbnail_meta_init (GstMeta * meta, gpointer params,
+    GstBuffer * buffer)
+{
+  GstImxThumbnailMeta *tmeta = (GstImxThumbnailMeta *) meta;
+
+  tmeta->buffer = NULL;
+  return TRUE;
+}
+
+static void
+gst_imx_thumbnail_meta_free (GstMeta * meta, GstBuffer * buffer)
+{
+  GstImxThumbnailMeta *tmeta = (GstImxThumbnailMeta *) meta;
+
+  if (tmeta->buffer)
+    gst_buffer_unref (tmeta->buffer);
+  tmeta->buffer = NULL;
+}
+
+static gboolean
+gst_imx_thumbnail_meta_transform (GstBuffer * dest, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstImxThumbnailMeta *smeta = (GstImxThumbnailMeta *) meta;
+
+  /* only follow plain copies, a scaled or converted frame no longer matches */
+  if (GST_META_TRANSFORM_IS_COPY (type) && smeta->buffer) {
+    if (!gst_buffer_add_imx_thumbnail_meta (dest, smeta->buffer))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+GType
+gst_imx_thumbnail_meta_api_get_type (void)
+{
+  static volatile GType type;
+  static const gchar *tags[] = { GST_META_TAG_VIDEO_STR, NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstImxThumbnailMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+const GstMetaInfo *
+gst_imx_thumbnail_meta_get_info (void)
+{
+  static const GstMetaInfo *meta_info = NULL;
+
+  if (g_once_init_enter ((GstMetaInfo **) & meta_info)) {
+    const GstMetaInfo *mi = gst_meta_register (GST_IMX_THUMBNAIL_META_API_TYPE,
+        "GstImxThumbnailMeta",
+        sizeof (GstImxThumbnailMeta),
+        gst_imx_thumbnail_meta_init,
+        gst_imx_thumbnail_meta_free,
+        gst_imx_thumbnail_meta_transform);
+    g_once_init_leave ((GstMetaInfo **) & meta_info, (GstMetaInfo *) mi);
+  }
+  return meta_info;
+}
+
+GstImxThumbnailMeta *
+gst_buffer_add_imx_thumbnail_meta (GstBuffer * buffer, GstBuffer * thumbnail)
+{
+  GstImxThumbnailMeta *tmeta;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (GST_IS_BUFFER (thumbnail), NULL);
+
+  tmeta = (GstImxThumbnailMeta *) gst_buffer_add_meta (buffer,
+      GST_IMX_THUMBNAIL_META_INFO, NULL);
+  if (tmeta)
+    tmeta->buffer = gst_buffer_ref (thumbnail);
+
+  return tmeta;
+}
+
+static gboolean
+is_fmt_in_list (GList *list, GstVideoFormat fmt)
+{
+  GList *l;
+  for (l=list; l; l=l->next) {
+    if (fmt == (GstVideoFormat)l->data)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static Imx2DDevice *
+imx_thumbnail_open_device (GstVideoFormat fmt)
+{
+  const Imx2DDeviceInfo *dev_info = imx_get_2d_devices();
+  Imx2DDevice *device;
+  GList *list;
+  gboolean support;
+
+  while (dev_info->name) {
+    if (!dev_info->is_exist()) {
+      dev_info++;
+      continue;
+    }
+
+    device = imx_2d_device_create(dev_info->device_type);
+    if (!device) {
+      dev_info++;
+      continue;
+    }
+
+    if (device->open(device) < 0) {
+      imx_2d_device_destroy(device);
+      dev_info++;
+      continue;
+    }
+
+    list = device->get_supported_out_fmts(device);
+    support = (device->get_capabilities(device) & IMX_2D_DEVICE_CAP_SCALE)
+              && is_fmt_in_list(list, fmt);
+    g_list_free(list);
+
+    if (support) {
+      GST_INFO ("thumbnail uses %s device", dev_info->name);
+      return device;
+    }
+
+    device->close(device);
+    imx_2d_device_destroy(device);
+    dev_info++;
+  }
+
+  return NULL;
+}
+
+gboolean imx_thumbnail_init (GstImxThumbnail *thumb, GstVideoFormat fmt,
+                             guint width, guint height)
+{
+  GstStructure *config;
+  GstCaps *caps;
+  static gint debug_init = 0;
+
+  if (debug_init == 0) {
+    GST_DEBUG_CATEGORY_INIT (thumbnail_meta, "imxthumbnailmeta", 0,
+                             "IMX downscaled secondary frame meta");
+    debug_init = 1;
+  }
+
+  memset (thumb, 0, sizeof(GstImxThumbnail));
+  if (width == 0 || height == 0)
+    return FALSE;
+
+  thumb->device = imx_thumbnail_open_device (fmt);
+  if (!thumb->device) {
+    GST_WARNING ("no 2D device can scale to %s",
+                 gst_video_format_to_string(fmt));
+    return FALSE;
+  }
+
+#ifdef USE_DMABUFHEAPS
+  thumb->allocator = gst_dmabufheaps_allocator_obtain ();
+#endif
+#ifdef USE_ION
+  if (!thumb->allocator)
+    thumb->allocator = gst_ion_allocator_obtain ();
+#endif
+  /* obtain ion allocator will fail on imx6 and 7D */
+  if (!thumb->allocator)
+    thumb->allocator = gst_imx_2d_device_allocator_new((gpointer)(thumb->device));
+
+  if (!thumb->allocator) {
+    GST_WARNING ("create allocator for thumbnail failed");
+    imx_thumbnail_deinit (thumb);
+    return FALSE;
+  }
+
+  gst_video_info_set_format (&thumb->info, fmt, width, height);
+  gst_video_alignment_reset (&thumb->align);
+  thumb->align.padding_right = ALIGNTO (width, ALIGNMENT) - width;
+  thumb->align.padding_bottom =
+      ALIGNTO (height, ALIGNMENT) - height;
+  gst_video_info_align (&thumb->info, &thumb->align);
+
+  caps = gst_video_info_to_caps (&thumb->info);
+  thumb->pool = gst_video_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (thumb->pool);
+  gst_buffer_pool_config_set_params (config, caps, thumb->info.size, 2, 0);
+  gst_buffer_pool_config_set_allocator (config, thumb->allocator, NULL);
+  gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+  gst_buffer_pool_config_add_option (config,
+                                     GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+  gst_buffer_pool_config_set_video_alignment (config, &thumb->align);
+  gst_caps_unref (caps);
+
+  if (!gst_buffer_pool_set_config (thumb->pool, config)
+      || !gst_buffer_pool_set_active (thumb->pool, TRUE)) {
+    GST_WARNING ("set up thumbnail buffer pool failed");
+    imx_thumbnail_deinit (thumb);
+    return FALSE;
+  }
+
+  GST_INFO ("thumbnail %s %dx%d", gst_video_format_to_string(fmt),
+            width, height);
+
+  return TRUE;
+}
+
+void imx_thumbnail_deinit (GstImxThumbnail *thumb)
+{
+  if (!thumb)
+    return;
+
+  if (thumb->frames)
+    GST_INFO ("thumbnail: %" G_GUINT64_FORMAT " frames, average %"
+              G_GINT64_FORMAT " us", thumb->frames,
+              thumb->total_time / (gint64)thumb->frames);
+
+  if (thumb->pool) {
+    gst_buffer_pool_set_active (thumb->pool, FALSE);
+    gst_object_unref (thumb->pool);
+  }
+  if (thumb->allocator) {
+    gst_imx_2d_device_allocator_flush (thumb->allocator);
+    gst_object_unref (thumb->allocator);
+  }
+
+  if (thumb->device) {
+    thumb->device->close(thumb->device);
+    imx_2d_device_destroy(thumb->device);
+  }
+
+  memset (thumb, 0, sizeof(GstImxThumbnail));
+}
+
+gboolean imx_thumbnail_is_active (GstImxThumbnail *thumb)
+{
+  return thumb && thumb->device && thumb->pool;
+}
+
+gboolean imx_thumbnail_attach (GstImxThumbnail *thumb, GstBuffer *frame,
+                               GstVideoInfo *info, GstVideoAlignment *align)
+{
+  Imx2DDevice *device;
+  Imx2DFrame src = {0}, dst = {0};
+  PhyMemBlock src_mem = {0}, dst_mem = {0};
+  GstPhyMemMeta *phymemmeta;
+  GstVideoCropMeta *crop;
+  GstDmabufMeta *dmabuf_meta;
+  GstBuffer *outbuf = NULL;
+  guint i, n_mem;
+  gint64 start;
+
+  if (!imx_thumbnail_is_active (thumb) || !frame || !info)
+    return FALSE;
+
+  device = thumb->device;
+
+  /* compressed tiles are only understood by the display path */
+  dmabuf_meta = gst_buffer_get_dmabuf_meta (frame);
+  if (dmabuf_meta && dmabuf_meta->drm_modifier != 0) {
+    GST_LOG ("skip thumbnail for modifier 0x%" G_GINT64_MODIFIER "x",
+             dmabuf_meta->drm_modifier);
+    return FALSE;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (thumb->pool, &outbuf, NULL)
+      != GST_FLOW_OK) {
+    GST_WARNING ("acquire thumbnail buffer failed");
+    return FALSE;
+  }
+
+  start = g_get_monotonic_time ();
+
+  src.info.fmt = GST_VIDEO_INFO_FORMAT(info);
+  src.info.w = GST_VIDEO_INFO_WIDTH(info);
+  src.info.h = GST_VIDEO_INFO_HEIGHT(info);
+  phymemmeta = GST_PHY_MEM_META_GET (frame);
+  if (phymemmeta) {
+    src.info.w += phymemmeta->x_padding;
+    src.info.h += phymemmeta->y_padding;
+  } else if (align) {
+    src.info.w += align->padding_left + align->padding_right;
+    src.info.h += align->padding_top + align->padding_bottom;
+  }
+  src.info.stride = GST_VIDEO_INFO_PLANE_STRIDE(info, 0);
+  if (GST_VIDEO_INFO_FORMAT(info) == GST_VIDEO_FORMAT_NV12_8L128
+      || GST_VIDEO_INFO_FORMAT(info) == GST_VIDEO_FORMAT_NV12_10BE_8L128)
+    src.info.tile_type = IMX_2D_TILE_AMHPION;
+
+  dst.info.fmt = GST_VIDEO_INFO_FORMAT(&thumb->info);
+  dst.info.w = GST_VIDEO_INFO_WIDTH(&thumb->info) + thumb->align.padding_right;
+  dst.info.h = GST_VIDEO_INFO_HEIGHT(&thumb->info) + thumb->align.padding_bottom;
+  dst.info.stride = GST_VIDEO_INFO_PLANE_STRIDE(&thumb->info, 0);
+
+  if (device->config_input(device, &src.info) < 0
+      || device->config_output(device, &dst.info) < 0) {
+    GST_WARNING ("config thumbnail %s -> %s failed",
+                 gst_video_format_to_string(src.info.fmt),
+                 gst_video_format_to_string(dst.info.fmt));
+    gst_buffer_unref (outbuf);
+    return FALSE;
+  }
+
+  src.fd[0] = src.fd[1] = src.fd[2] = src.fd[3] = -1;
+  if (gst_is_dmabuf_memory (gst_buffer_peek_memory (frame, 0))) {
+    src.mem = &src_mem;
+    n_mem = gst_buffer_n_memory (frame);
+    for (i = 0; i < n_mem && i < 4; i++)
+      src.fd[i] = gst_dmabuf_memory_get_fd (gst_buffer_peek_memory (frame, i));
+    src_mem.paddr = (guint8 *) phy_addr_from_dmabuf_memory (
+        gst_buffer_peek_memory (frame, 0));
+    if (n_mem > 1)
+      src_mem.user_data = (gpointer) phy_addr_from_dmabuf_memory (
+          gst_buffer_peek_memory (frame, 1));
+  } else
+    src.mem = gst_buffer_query_phymem_block (frame);
+  src.alpha = 0xFF;
+  src.rotate = IMX_2D_ROTATION_0;
+  src.interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
+  src.crop.x = 0;
+  src.crop.y = 0;
+  src.crop.w = GST_VIDEO_INFO_WIDTH(info);
+  src.crop.h = GST_VIDEO_INFO_HEIGHT(info);
+
+  crop = gst_buffer_get_video_crop_meta (frame);
+  if (crop && crop->x < src.crop.w && crop->y < src.crop.h) {
+    src.crop.x = crop->x;
+    src.crop.y = crop->y;
+    src.crop.w = MIN(crop->width, GST_VIDEO_INFO_WIDTH(info) - crop->x);
+    src.crop.h = MIN(crop->height, GST_VIDEO_INFO_HEIGHT(info) - crop->y);
+  }
+
+  dst.fd[0] = dst.fd[1] = dst.fd[2] = dst.fd[3] = -1;
+  if (gst_is_dmabuf_memory (gst_buffer_peek_memory (outbuf, 0))) {
+    dst.mem = &dst_mem;
+    n_mem = gst_buffer_n_memory (outbuf);
+    for (i = 0; i < n_mem && i < 4; i++)
+      dst.fd[i] = gst_dmabuf_memory_get_fd (gst_buffer_peek_memory (outbuf, i));
+    dst_mem.paddr = (guint8 *) phy_addr_from_dmabuf_memory (
+        gst_buffer_peek_memory (outbuf, 0));
+  } else
+    dst.mem = gst_buffer_query_phymem_block (outbuf);
+  dst.alpha = 0xFF;
+  dst.rotate = IMX_2D_ROTATION_0;
+  dst.interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
+  dst.crop.x = 0;
+  dst.crop.y = 0;
+  dst.crop.w = GST_VIDEO_INFO_WIDTH(&thumb->info);
+  dst.crop.h = GST_VIDEO_INFO_HEIGHT(&thumb->info);
+
+  if (!src.mem || !dst.mem
+      || device->set_rotate(device, IMX_2D_ROTATION_0) < 0
+      || device->set_deinterlace(device, IMX_2D_DEINTERLACE_NONE) < 0
+      || device->convert(device, &dst, &src) < 0) {
+    GST_WARNING ("thumbnail conversion failed");
+    gst_buffer_unref (outbuf);
+    return FALSE;
+  }
+
+  thumb->total_time += g_get_monotonic_time () - start;
+  thumb->frames++;
+
+  GST_BUFFER_PTS (outbuf) = GST_BUFFER_PTS (frame);
+  GST_BUFFER_DURATION (outbuf) = GST_BUFFER_DURATION (frame);
+  gst_buffer_add_imx_thumbnail_meta (frame, outbuf);
+  gst_buffer_unref (outbuf);
+
+  GST_TRACE ("thumbnail attached to %p, crop (%d,%d %dx%d)", frame,
+             src.crop.x, src.crop.y, src.crop.w, src.crop.h);
+
+  return TRUE;
+}
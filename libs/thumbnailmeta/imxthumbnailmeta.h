@@ -0,0 +1,66 @@
+/* Downscaled secondary frame produced by IMX 2D devices
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __IMXTHUMBNAILMETA_H__
+#define __IMXTHUMBNAILMETA_H__
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include "gstimxcommon.h"
+#include "../device-2d/imx_2d_device.h"
+
+G_BEGIN_DECLS
+
+#define GST_IMX_THUMBNAIL_META_API_TYPE (gst_imx_thumbnail_meta_api_get_type())
+#define GST_IMX_THUMBNAIL_META_INFO  (gst_imx_thumbnail_meta_get_info())
+
+#define gst_buffer_get_imx_thumbnail_meta(b) \
+  ((GstImxThumbnailMeta*)gst_buffer_get_meta((b),GST_IMX_THUMBNAIL_META_API_TYPE))
+
+/* the downscaled copy of a frame, buffer carries a GstVideoMeta */
+typedef struct _GstImxThumbnailMeta {
+  GstMeta meta;
+  GstBuffer *buffer;
+} GstImxThumbnailMeta;
+
+typedef struct _GstImxThumbnail {
+  Imx2DDevice *device;
+  GstAllocator *allocator;
+  GstBufferPool *pool;
+  GstVideoInfo info;
+  GstVideoAlignment align;
+  guint64 frames;
+  gint64 total_time;
+} GstImxThumbnail;
+
+GType gst_imx_thumbnail_meta_api_get_type (void);
+const GstMetaInfo *gst_imx_thumbnail_meta_get_info (void);
+GstImxThumbnailMeta *gst_buffer_add_imx_thumbnail_meta (GstBuffer *buffer,
+                                                        GstBuffer *thumbnail);
+
+gboolean imx_thumbnail_init (GstImxThumbnail *thumb, GstVideoFormat fmt,
+                             guint width, guint height);
+void imx_thumbnail_deinit (GstImxThumbnail *thumb);
+gboolean imx_thumbnail_is_active (GstImxThumbnail *thumb);
+gboolean imx_thumbnail_attach (GstImxThumbnail *thumb, GstBuffer *frame,
+                               GstVideoInfo *info, GstVideoAlignment *align);
+
+G_END_DECLS
+
+#endif /* __IMXTHUMBNAILMETA_H__ */
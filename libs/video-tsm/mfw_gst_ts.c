@@ -36,6 +36,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include "mfw_gst_ts.h"
 
@@ -112,14 +114,44 @@ enum
 
 #define TSM_RECEIVED_NUNBER 512
 
+#define TSM_SLOT_NONE (-1)
+
+#define TSM_LOCK(tsm)\
+  do {\
+    if ((tsm)->lock_enabled)\
+      pthread_mutex_lock (&(tsm)->lock);\
+  } while (0)
+
+#define TSM_UNLOCK(tsm)\
+  do {\
+    if ((tsm)->lock_enabled)\
+      pthread_mutex_unlock (&(tsm)->lock);\
+  } while (0)
+
+/* ring distance of a slot from tx, this is the scan order of the ts buffer */
+#define TSM_SLOT_DISTANCE(tsm, slot)\
+    (((slot)>=(tsm->tx))?((slot)-(tsm->tx)):(tsm->ts_buf_size-(tsm->tx)+(slot)))
+
+#define TSM_KEY_HASH(tsm, key)\
+    ((int)((((uintptr_t)(key))>>4)^(((uintptr_t)(key))>>12)) & (tsm->key_bucket_mask))
+
 
 typedef struct
 {
   TSM_TIMESTAMP ts;
   unsigned long long age;
   void *key;
+  int heap_pos;                 /* index in ts_heap */
+  int key_prev;                 /* slots of the same key bucket, ring order */
+  int key_next;
 } TSMControl;
 
+typedef struct
+{
+  int head;
+  int tail;
+} TSMKeyBucket;
+
 typedef struct _TSMReceivedEntry
 {
   TSM_TIMESTAMP ts;
@@ -163,6 +195,10 @@ typedef struct _TSManager
   TSM_TIMESTAMP dur_history_total;
   TSM_TIMESTAMP dur_history_buf[TSM_HISTORY_SIZE];
   TSMControl *ts_buf;
+  int *ts_heap;                 //min heap of ts_buf slots, MODE_AI only
+  int heap_cnt;
+  TSMKeyBucket *key_buckets;    //key to ts_buf slot lookup, MODE_AI only
+  int key_bucket_mask;
   unsigned long long age;
   int tx_cnt;
   int rx_cnt;
@@ -171,9 +207,31 @@ typedef struct _TSManager
   int big_cnt;
 
   TSMRecivedCtl rctl;
+
+  pthread_mutex_t lock;
+  int lock_enabled;
+  TSMStatistics stats;
 } TSManager;
 
 
+/* deviation of one frame duration from the adaptive interval, in steps of
+ * 1/16 interval doubling per histogram bucket */
+static void
+tsm_stats_add_duration (TSManager * tsm, TSM_TIMESTAMP dur)
+{
+  TSM_TIMESTAMP interval = TSM_ADAPTIVE_INTERVAL (tsm);
+  TSM_TIMESTAMP dev = TSM_ABS (dur, interval);
+  TSM_TIMESTAMP step = interval >> 4;
+  int i = 0;
+
+  while ((i < TSM_JITTER_HISTOGRAM_SIZE - 1) && (dev >= step)) {
+    step <<= 1;
+    i++;
+  }
+  tsm->stats.jitter_histogram[i]++;
+}
+
+
 static void
 tsm_free_received_entry (TSMRecivedCtl * rctl, TSMReceivedEntry * entry)
 {
@@ -208,6 +266,201 @@ tsm_new_received_entry (TSMRecivedCtl * rctl)
 }
 
 
+/*
+ * ts_buf slots of MODE_AI are indexed by a min heap ordered by timestamp,
+ * ties are broken by ring distance from tx. This is the same order the
+ * linear scan from tx to rx used to pick the output timestamp, so the
+ * minimum can be fetched without walking the whole ring.
+ */
+static int
+tsm_slot_less (TSManager * tsm, int a, int b)
+{
+  if (tsm->ts_buf[a].ts != tsm->ts_buf[b].ts)
+    return (tsm->ts_buf[a].ts < tsm->ts_buf[b].ts);
+  return (TSM_SLOT_DISTANCE (tsm, a) < TSM_SLOT_DISTANCE (tsm, b));
+}
+
+
+static void
+tsm_heap_set (TSManager * tsm, int pos, int slot)
+{
+  tsm->ts_heap[pos] = slot;
+  tsm->ts_buf[slot].heap_pos = pos;
+}
+
+
+static void
+tsm_heap_sift_up (TSManager * tsm, int pos)
+{
+  int slot = tsm->ts_heap[pos];
+
+  while (pos > 0) {
+    int parent = (pos - 1) >> 1;
+    if (!tsm_slot_less (tsm, slot, tsm->ts_heap[parent]))
+      break;
+    tsm_heap_set (tsm, pos, tsm->ts_heap[parent]);
+    pos = parent;
+  }
+  tsm_heap_set (tsm, pos, slot);
+}
+
+
+static void
+tsm_heap_sift_down (TSManager * tsm, int pos)
+{
+  int slot = tsm->ts_heap[pos];
+
+  while (1) {
+    int child = (pos << 1) + 1;
+    if (child >= tsm->heap_cnt)
+      break;
+    if ((child + 1 < tsm->heap_cnt)
+        && tsm_slot_less (tsm, tsm->ts_heap[child + 1], tsm->ts_heap[child]))
+      child++;
+    if (!tsm_slot_less (tsm, tsm->ts_heap[child], slot))
+      break;
+    tsm_heap_set (tsm, pos, tsm->ts_heap[child]);
+    pos = child;
+  }
+  tsm_heap_set (tsm, pos, slot);
+}
+
+
+static void
+tsm_heap_push (TSManager * tsm, int slot)
+{
+  tsm_heap_set (tsm, tsm->heap_cnt++, slot);
+  tsm_heap_sift_up (tsm, tsm->heap_cnt - 1);
+}
+
+
+static void
+tsm_heap_remove (TSManager * tsm, int slot)
+{
+  int pos = tsm->ts_buf[slot].heap_pos;
+  int last = tsm->ts_heap[--tsm->heap_cnt];
+
+  if (last != slot) {
+    tsm_heap_set (tsm, pos, last);
+    tsm_heap_sift_up (tsm, pos);
+    tsm_heap_sift_down (tsm, tsm->ts_buf[last].heap_pos);
+  }
+}
+
+
+/*
+ * Slots with a valid key are chained per hash bucket in ring order, so the
+ * first slot carrying a key is found without scanning from tx.
+ */
+static void
+tsm_key_link (TSManager * tsm, int slot)
+{
+  TSMKeyBucket *bucket;
+  int dist, next, prev = TSM_SLOT_NONE;
+
+  if (!TSM_KEY_IS_VALID (tsm->ts_buf[slot].key))
+    return;
+
+  bucket = &tsm->key_buckets[TSM_KEY_HASH (tsm, tsm->ts_buf[slot].key)];
+  dist = TSM_SLOT_DISTANCE (tsm, slot);
+  next = bucket->head;
+  while ((next != TSM_SLOT_NONE) && (TSM_SLOT_DISTANCE (tsm, next) < dist)) {
+    prev = next;
+    next = tsm->ts_buf[next].key_next;
+  }
+
+  tsm->ts_buf[slot].key_prev = prev;
+  tsm->ts_buf[slot].key_next = next;
+  if (prev != TSM_SLOT_NONE)
+    tsm->ts_buf[prev].key_next = slot;
+  else
+    bucket->head = slot;
+  if (next != TSM_SLOT_NONE)
+    tsm->ts_buf[next].key_prev = slot;
+  else
+    bucket->tail = slot;
+}
+
+
+static void
+tsm_key_unlink (TSManager * tsm, int slot)
+{
+  TSMKeyBucket *bucket;
+  TSMControl *c = &tsm->ts_buf[slot];
+
+  if (!TSM_KEY_IS_VALID (c->key))
+    return;
+
+  bucket = &tsm->key_buckets[TSM_KEY_HASH (tsm, c->key)];
+  if (c->key_prev != TSM_SLOT_NONE)
+    tsm->ts_buf[c->key_prev].key_next = c->key_next;
+  else
+    bucket->head = c->key_next;
+  if (c->key_next != TSM_SLOT_NONE)
+    tsm->ts_buf[c->key_next].key_prev = c->key_prev;
+  else
+    bucket->tail = c->key_prev;
+}
+
+
+static int
+tsm_key_lookup (TSManager * tsm, void *key)
+{
+  int slot = tsm->key_buckets[TSM_KEY_HASH (tsm, key)].head;
+
+  while ((slot != TSM_SLOT_NONE) && (tsm->ts_buf[slot].key != key))
+    slot = tsm->ts_buf[slot].key_next;
+
+  return slot;
+}
+
+
+static void
+tsm_reset_index (TSManager * tsm)
+{
+  int i;
+
+  tsm->heap_cnt = 0;
+  for (i = 0; i <= tsm->key_bucket_mask; i++) {
+    tsm->key_buckets[i].head = tsm->key_buckets[i].tail = TSM_SLOT_NONE;
+  }
+}
+
+
+/*
+ * Pick the slot the linear scan from tx would have picked: the earliest
+ * minimum timestamp among slots up to and including the first one carrying
+ * key, or among all slots if key is not found.
+ */
+static int
+tsm_find_output_slot (TSManager * tsm, void *key)
+{
+  int index, stop, i;
+
+  if (tsm->heap_cnt == 0)
+    return TSM_SLOT_NONE;
+
+  index = tsm->ts_heap[0];
+  if (!TSM_KEY_IS_VALID (key))
+    return index;
+
+  stop = tsm_key_lookup (tsm, key);
+  if ((stop == TSM_SLOT_NONE)
+      || (TSM_SLOT_DISTANCE (tsm, stop) >= TSM_SLOT_DISTANCE (tsm, index)))
+    return index;
+
+  /* key found before the global minimum, only scan up to the key */
+  i = index = tsm->tx;
+  while (i != stop) {
+    i = ((i + 1) % tsm->ts_buf_size);
+    if (tsm->ts_buf[i].ts < tsm->ts_buf[index].ts)
+      index = i;
+  }
+
+  return index;
+}
+
+
 void
 TSManagerReceive2 (void *handle, TSM_TIMESTAMP timestamp, int size)
 {
@@ -223,6 +476,7 @@ TSManagerReceive2 (void *handle, TSM_TIMESTAMP timestamp, int size)
       TSM_TIME_ARGS (timestamp), size);
 
   if (tsm) {
+    TSM_LOCK (tsm);
     if (size > 0) {
       TSMRecivedCtl *rctl = &tsm->rctl;
       TSMReceivedEntry *e = tsm_new_received_entry (rctl);
@@ -244,6 +498,7 @@ TSManagerReceive2 (void *handle, TSM_TIMESTAMP timestamp, int size)
     } else {
       TSManagerReceive (handle, timestamp);
     }
+    TSM_UNLOCK (tsm);
   }
 }
 
@@ -291,7 +546,9 @@ TSManagerFlush2 (void *handle, int size)
 {
   TSManager *tsm = (TSManager *) handle;
   if (tsm) {
+    TSM_LOCK (tsm);
     TSManagerGetLastTimeStamp (&tsm->rctl, size, 0);
+    TSM_UNLOCK (tsm);
   }
 
 }
@@ -316,6 +573,7 @@ _TSManagerReceive (void *handle, TSM_TIMESTAMP timestamp, void *key)
   TSManager *tsm = (TSManager *) handle;
 
   if (tsm) {
+    TSM_LOCK (tsm);
     if (TSM_TS_IS_VALID (timestamp) && (tsm->rx_cnt))
       tsm->valid_ts_received = 1;
     tsm->rx_cnt++;
@@ -338,6 +596,7 @@ _TSManagerReceive (void *handle, TSM_TIMESTAMP timestamp, void *key)
                 && (timestamp - tsm->last_ts_received > tsm->discont_threshold)) {
               tsm->suspicious_ts = timestamp;
               timestamp = TSM_TIMESTAMP_NONE;
+              tsm->stats.discontinuities++;
             }
           }
         }
@@ -347,7 +606,10 @@ _TSManagerReceive (void *handle, TSM_TIMESTAMP timestamp, void *key)
           tsm->ts_buf[tsm->rx].ts = timestamp;
           tsm->ts_buf[tsm->rx].age = tsm->age + TSM_PLUS_AGE (tsm);
           tsm->ts_buf[tsm->rx].key = key;
+          tsm_heap_push (tsm, tsm->rx);
+          tsm_key_link (tsm, tsm->rx);
           tsm->last_ts_received = timestamp;
+          tsm->stats.received++;
 #ifdef DEBUG
           //printf("age should %lld %lld\n", tsm->age, tsm->ts_buf[tsm->rx].age);
           //printf("++++++ distance = %d  tx=%d, rx=%d, invalid count=%d\n", TSM_DISTANCE(tsm), tsm->tx, tsm->rx,tsm->invalid_ts_count);
@@ -355,8 +617,13 @@ _TSManagerReceive (void *handle, TSM_TIMESTAMP timestamp, void *key)
           tsm->rx = ((tsm->rx + 1) % tsm->ts_buf_size);
         } else {
           tsm->invalid_ts_count++;
+          tsm->stats.invalid++;
         }
       } else if (tsm->mode == MODE_FIFO) {
+        if (TSM_TS_IS_VALID (timestamp))
+          tsm->stats.received++;
+        else
+          tsm->stats.invalid++;
         tsm->ts_buf[tsm->rx].ts = timestamp;
         tsm->rx = ((tsm->rx + 1) % tsm->ts_buf_size);
       }
@@ -366,6 +633,7 @@ _TSManagerReceive (void *handle, TSM_TIMESTAMP timestamp, void *key)
     } else {
       TSM_ERROR ("Too many timestamps recieved!! (cnt=%d)\n", tsm->cnt);
     }
+    TSM_UNLOCK (tsm);
   }
 }
 
@@ -379,10 +647,12 @@ TSManagerValid2 (void *handle, int size, void *key)
 
   if (tsm) {
     TSM_TIMESTAMP ts;
+    TSM_LOCK (tsm);
     ts = TSManagerGetLastTimeStamp (&tsm->rctl, size, 1);
     TSM_VERBOSE ("TSManagerGetLastTimeStamp: %" TSM_TIME_FORMAT "\n",
         TSM_TIME_ARGS (ts));
     _TSManagerReceive (tsm, ts, key);
+    TSM_UNLOCK (tsm);
   }
 }
 
@@ -411,14 +681,13 @@ static TSM_TIMESTAMP
 _TSManagerSend2 (void *handle, void *key, int send)
 {
   TSManager *tsm = (TSManager *) handle;
-  int i;
   int index = -1;
   TSM_TIMESTAMP ts0 = 0, tstmp = TSM_TIMESTAMP_NONE;
   unsigned long long age = 0;
   TSM_TIMESTAMP half_interval;
 
   if (tsm) {
-    i = tsm->tx;
+    TSM_LOCK (tsm);
     half_interval = TSM_ADAPTIVE_INTERVAL (tsm) >> 1;
     if (send) {
       tsm->tx_cnt++;
@@ -438,34 +707,31 @@ _TSManagerSend2 (void *handle, void *key, int send)
           tstmp = tsm->last_ts_sent;
         }
 
-        while (i != tsm->rx) {
-          if (index >= 0) {
-            if (tsm->ts_buf[i].ts < ts0) {
-              ts0 = tsm->ts_buf[i].ts;
-              age = tsm->ts_buf[i].age;
-              index = i;
-            }
-          } else {
-            ts0 = tsm->ts_buf[i].ts;
-            age = tsm->ts_buf[i].age;
-            index = i;
-          }
-          if ((TSM_KEY_IS_VALID (key)) && (key == tsm->ts_buf[i].key))
-            break;
-          i = ((i + 1) % tsm->ts_buf_size);
-        }
+        index = tsm_find_output_slot (tsm, key);
         if (index >= 0) {
+          ts0 = tsm->ts_buf[index].ts;
+          age = tsm->ts_buf[index].age;
           if ((tsm->invalid_ts_count) && (ts0 >= ((tstmp) + half_interval))
               && (age > tsm->age)) {
             /* use calculated ts0 */
             if (send) {
               tsm->invalid_ts_count--;
+              tsm->stats.interpolated++;
             }
           } else {
 
             if (send) {
+              tsm_heap_remove (tsm, index);
+              tsm_key_unlink (tsm, index);
               if (index != tsm->tx) {
-                tsm->ts_buf[index] = tsm->ts_buf[tsm->tx];
+                /* move the entry at tx into the freed slot */
+                tsm_key_unlink (tsm, tsm->tx);
+                tsm->ts_buf[index].ts = tsm->ts_buf[tsm->tx].ts;
+                tsm->ts_buf[index].age = tsm->ts_buf[tsm->tx].age;
+                tsm->ts_buf[index].key = tsm->ts_buf[tsm->tx].key;
+                tsm_heap_set (tsm, tsm->ts_buf[tsm->tx].heap_pos, index);
+                tsm_heap_sift_down (tsm, tsm->ts_buf[index].heap_pos);
+                tsm_key_link (tsm, index);
               }
               tsm->tx = ((tsm->tx + 1) % tsm->ts_buf_size);
 
@@ -483,6 +749,7 @@ _TSManagerSend2 (void *handle, void *key, int send)
         } else {
           if (send) {
             tsm->invalid_ts_count--;
+            tsm->stats.interpolated++;
           }
         }
 
@@ -499,11 +766,14 @@ _TSManagerSend2 (void *handle, void *key, int send)
             TSM_WARNING ("Jitter1:%" TSM_TIME_FORMAT " %" TSM_TIME_FORMAT "\n",
                 TSM_TIME_ARGS (ts0),
                 TSM_TIME_ARGS (TSM_ADAPTIVE_INTERVAL (tsm) * 3 / 2));
+            if (send)
+              tsm->stats.jitter++;
           } else if (ts0 == 0) {
             TSM_WARNING ("Jitter:%" TSM_TIME_FORMAT "\n", TSM_TIME_ARGS (ts0));
           }
 
           if (send) {
+            tsm_stats_add_duration (tsm, ts0);
             if ((ts0 < TSM_ADAPTIVE_INTERVAL (tsm) * 5) || (tsm->big_cnt > 3)) {
               tsm->big_cnt = 0;
               tsm->dur_history_total -=
@@ -536,6 +806,7 @@ _TSManagerSend2 (void *handle, void *key, int send)
       }
 
       if (send) {
+        tsm->stats.sent++;
         TSM_LOG ("--Send %d:%" TSM_TIME_FORMAT ", int:%" TSM_TIME_FORMAT
             ", avg:%" TSM_TIME_FORMAT " inkey %p\n", tsm->tx_cnt,
             TSM_TIME_ARGS (tstmp), TSM_TIME_ARGS (ts0),
@@ -552,6 +823,8 @@ _TSManagerSend2 (void *handle, void *key, int send)
         if (send) {
           tsm->first_tx = 0;
           tsm->last_ts_sent = tstmp;
+          tsm->stats.sent++;
+          tsm->stats.interpolated++;
         }
       }
       TSM_ERROR ("Too many timestamps send!!\n");
@@ -561,6 +834,7 @@ _TSManagerSend2 (void *handle, void *key, int send)
       tsm->cnt--;
       tsm->invalid_ts_count--;
     }
+    TSM_UNLOCK (tsm);
 
   }
 
@@ -602,8 +876,9 @@ resyncTSManager (void *handle, TSM_TIMESTAMP synctime, TSMGR_MODE mode)
   TSManager *tsm = (TSManager *) handle;
   if (tsm) {
     TSMRecivedCtl *rctl = &tsm->rctl;
-    TSMReceivedEntry *e = rctl->head;
+    TSMReceivedEntry *e;
 
+    TSM_LOCK (tsm);
     while ((e = rctl->head)) {
       rctl->head = e->next;
       tsm_free_received_entry (rctl, e);
@@ -620,6 +895,7 @@ resyncTSManager (void *handle, TSM_TIMESTAMP synctime, TSMGR_MODE mode)
       tsm->last_ts_sent = synctime;
 
     tsm->tx = tsm->rx = 0;
+    tsm_reset_index (tsm);
     tsm->invalid_ts_count = 0;
     tsm->mode = mode;
     tsm->age = 0;
@@ -627,6 +903,7 @@ resyncTSManager (void *handle, TSM_TIMESTAMP synctime, TSMGR_MODE mode)
     tsm->valid_ts_received = 0;
 
     tsm->big_cnt = 0;
+    TSM_UNLOCK (tsm);
   }
 }
 
@@ -653,14 +930,29 @@ createTSManager (int ts_buf_size)
   }
   // printf("debug = %s \n ++++++++++++++++++++++++++++",debug);
   if (tsm) {
+    pthread_mutexattr_t attr;
+
     memset (tsm, 0, sizeof (TSManager));
+    pthread_mutexattr_init (&attr);
+    pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init (&tsm->lock, &attr);
+    pthread_mutexattr_destroy (&attr);
     if (ts_buf_size <= 0) {
       ts_buf_size = TSM_DEFAULT_TS_BUFFER_SIZE;
     }
     tsm->ts_buf_size = ts_buf_size;
-    tsm->ts_buf = malloc (sizeof (TSMControl) * ts_buf_size);
-
-    if (tsm->ts_buf == NULL) {
+    /* MODE_FIFO sends past rx read slots never received into */
+    tsm->ts_buf = calloc (ts_buf_size, sizeof (TSMControl));
+    tsm->ts_heap = malloc (sizeof (int) * ts_buf_size);
+
+    tsm->key_bucket_mask = 1;
+    while (tsm->key_bucket_mask < ts_buf_size)
+      tsm->key_bucket_mask <<= 1;
+    tsm->key_buckets = malloc (sizeof (TSMKeyBucket) * tsm->key_bucket_mask);
+    tsm->key_bucket_mask--;
+
+    if ((tsm->ts_buf == NULL) || (tsm->ts_heap == NULL)
+        || (tsm->key_buckets == NULL)) {
       goto fail;
     }
 
@@ -679,6 +971,13 @@ fail:
     if (tsm->ts_buf) {
       free (tsm->ts_buf);
     }
+    if (tsm->ts_heap) {
+      free (tsm->ts_heap);
+    }
+    if (tsm->key_buckets) {
+      free (tsm->key_buckets);
+    }
+    pthread_mutex_destroy (&tsm->lock);
     free (tsm);
     tsm = NULL;
   }
@@ -696,11 +995,18 @@ destroyTSManager (void *handle)
     if (tsm->ts_buf) {
       free (tsm->ts_buf);
     }
+    if (tsm->ts_heap) {
+      free (tsm->ts_heap);
+    }
+    if (tsm->key_buckets) {
+      free (tsm->key_buckets);
+    }
 
     while ((rmem = rctl->memory)) {
       rctl->memory = rmem->next;
       free (rmem);
     }
+    pthread_mutex_destroy (&tsm->lock);
     free (tsm);
     tsm = NULL;
   }
@@ -720,8 +1026,10 @@ setTSManagerFrameRate (void *handle, int fps_n, int fps_d)
   // TSM_TIMESTAMP ts = TSM_SECOND / framerate;
 
   if (tsm) {
+    TSM_LOCK (tsm);
     TSM_BUFFER_SET (tsm->dur_history_buf, ts, TSM_HISTORY_SIZE);
     tsm->dur_history_total = (ts << TSM_HISTORY_POWER);
+    TSM_UNLOCK (tsm);
     if (debug)
       TSM_LOG ("Set frame intrval:%" TSM_TIME_FORMAT "\n", TSM_TIME_ARGS (ts));
   }
@@ -734,7 +1042,9 @@ getTSManagerFrameInterval (void *handle)
   TSManager *tsm = (TSManager *) handle;
   TSM_TIMESTAMP ts = 0;
   if (tsm) {
+    TSM_LOCK (tsm);
     ts = TSM_ADAPTIVE_INTERVAL (tsm);
+    TSM_UNLOCK (tsm);
   }
   return ts;
 }
@@ -746,7 +1056,9 @@ getTSManagerPosition (void *handle)
   TSManager *tsm = (TSManager *) handle;
   TSM_TIMESTAMP ts = 0;
   if (tsm) {
+    TSM_LOCK (tsm);
     ts = tsm->last_ts_sent;
+    TSM_UNLOCK (tsm);
   }
   return ts;
 }
@@ -758,7 +1070,36 @@ getTSManagerPreBufferCnt (void *handle)
   int i = 0;
   TSManager *tsm = (TSManager *) handle;
   if (tsm) {
+    TSM_LOCK (tsm);
     i = tsm->rctl.cnt;
+    TSM_UNLOCK (tsm);
   }
   return i;
 }
+
+
+void
+setTSManagerLocking (void *handle, int enable)
+{
+  TSManager *tsm = (TSManager *) handle;
+  if (tsm) {
+    tsm->lock_enabled = (enable != 0);
+  }
+}
+
+
+void
+getTSManagerStatistics (void *handle, TSMStatistics * stats)
+{
+  TSManager *tsm = (TSManager *) handle;
+  if (stats == NULL)
+    return;
+
+  memset (stats, 0, sizeof (TSMStatistics));
+  if (tsm) {
+    TSM_LOCK (tsm);
+    *stats = tsm->stats;
+    stats->frame_interval = TSM_ADAPTIVE_INTERVAL (tsm);
+    TSM_UNLOCK (tsm);
+  }
+}
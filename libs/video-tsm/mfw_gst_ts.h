@@ -55,6 +55,27 @@ typedef enum
 #define TSM_TIMESTAMP_NONE ((long long)(-1))
 #define TSM_KEY_NONE ((void *)0)
 
+#define TSM_JITTER_HISTOGRAM_SIZE 8
+
+/*
+ * Timestamp manager telemetry, accumulated since creation.
+ *
+ * jitter_histogram counts output frame durations by their deviation from the
+ * adaptive frame interval: bucket 0 is below 1/16 interval, each following
+ * bucket doubles the bound, the last one holds everything above.
+ */
+typedef struct
+{
+  unsigned long long received;          /* valid timestamps received */
+  unsigned long long invalid;           /* invalid or discarded timestamps received */
+  unsigned long long sent;              /* timestamps sent */
+  unsigned long long interpolated;      /* sent timestamps calculated from frame interval */
+  unsigned long long discontinuities;   /* received timestamps jumping over the threshold */
+  unsigned long long jitter;            /* sent durations above 1.5 frame interval */
+  unsigned long long jitter_histogram[TSM_JITTER_HISTOGRAM_SIZE];
+  TSM_TIMESTAMP frame_interval;         /* current adaptive frame interval */
+} TSMStatistics;
+
 /**
  * GST_CLOCK_TIME_IS_VALID:
  * @time: clock time to validate
@@ -162,6 +183,27 @@ extern "C"
  */
   EXTERN TSM_TIMESTAMP getTSManagerPosition (void *handle);
   EXTERN int getTSManagerPreBufferCnt (void *handle);
+/*!
+ * This function enable locking of timestamp handler, needed when other
+ * threads query the handler while it is used for decoding
+ *
+ * @param	handle		handle of timestamp manager.
+ *
+ * @param	enable		non zero to enable locking
+ *
+ * @return
+ */
+  EXTERN void setTSManagerLocking (void *handle, int enable);
+/*!
+ * This function get the telemetry of timestamp handler
+ *
+ * @param	handle		handle of timestamp manager.
+ *
+ * @param	stats		returned statistics
+ *
+ * @return
+ */
+  EXTERN void getTSManagerStatistics (void *handle, TSMStatistics * stats);
 
 #ifdef __cplusplus
 }
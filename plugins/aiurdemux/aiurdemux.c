@@ -145,6 +145,11 @@ static GstsutilsOptionEntry g_aiurdemux_option_table[] = {
             G_TYPE_INT,
             G_STRUCT_OFFSET (AiurDemuxOption, low_latency_tolerance),
          "-1", "-1", G_MAXINT_STR},
+    {PROP_THUMBNAIL_COUNT, "thumbnail-count", "thumbnail count",
+            "thumbnail mode: only push this many evenly spaced sync samples of the first video track then EOS (0 to disable)",
+            G_TYPE_UINT,
+            G_STRUCT_OFFSET (AiurDemuxOption, thumbnail_count),
+          "0", "0", "1024"},
   {-1, NULL, NULL, NULL, 0, 0, NULL}    /* terminator */
 };
 
@@ -309,6 +314,9 @@ static GstFlowReturn
 aiurdemux_send_stream_eos (GstAiurDemux * demux, AiurDemuxStream * stream);
 static GstFlowReturn
 aiurdemux_send_stream_eos_all (GstAiurDemux * demux);
+static void aiurdemux_thumbnail_prepare (GstAiurDemux * demux);
+static GstFlowReturn aiurdemux_thumbnail_next (GstAiurDemux * demux,
+    AiurDemuxStream * stream);
 
 static GstFlowReturn aiurdemux_push_pad_buffer (GstAiurDemux * demux, AiurDemuxStream * stream,
     GstBuffer * buffer);
@@ -558,6 +566,7 @@ static GstStateChangeReturn gst_aiurdemux_change_state (GstElement * element,
       gst_segment_init (&demux->segment, GST_FORMAT_TIME);
 
       demux->play_mode = AIUR_PLAY_MODE_NORMAL;
+      demux->thumbnail_sent = 0;
       demux->valid_mask = 0;
       demux->n_streams = 0;
       demux->n_video_streams = 0;
@@ -1486,6 +1495,9 @@ static GstFlowReturn aiurdemux_loop_state_header (GstAiurDemux * demux)
         IParser->seek(handle,i,&start_time_us,SEEK_FLAG_NO_LATER);
     }
 
+    if (demux->option.thumbnail_count)
+        aiurdemux_thumbnail_prepare (demux);
+
     if (parser_result == PARSER_SUCCESS && demux->n_streams > 0) {
         GST_LOG_OBJECT(demux,"aiurdemux_loop_state_header next MOVIE");
         demux->state = AIURDEMUX_STATE_MOVIE;
@@ -1827,7 +1839,9 @@ static GstFlowReturn aiurdemux_loop_state_movie (GstAiurDemux * demux)
       stream->send_codec_data = TRUE;
     }
     //push buffer to pad
-    if (demux->interleave_queue_size) {
+    //thumbnail mode has a single track to interleave, its samples are pushed
+    //right away so that each counted sample has reached the pad
+    if (demux->interleave_queue_size && !demux->option.thumbnail_count) {
      stream->buf_queue_size += gst_buffer_get_size(stream->buffer);
      if (stream->buf_queue_size > stream->buf_queue_size_max) {
        stream->buf_queue_size_max = stream->buf_queue_size;
@@ -1844,6 +1858,10 @@ static GstFlowReturn aiurdemux_loop_state_movie (GstAiurDemux * demux)
 
     ret = aiurdemux_combine_flows (demux, stream, ret);
 
+    if (demux->option.thumbnail_count && stream->type == MEDIA_VIDEO
+        && ret == GST_FLOW_OK)
+      ret = aiurdemux_thumbnail_next (demux, stream);
+
   GST_LOG_OBJECT (demux, "STATE MOVIE END ret=%d",ret);
 
 bail:
@@ -3345,7 +3363,8 @@ readend:
       GST_BUFFER_FLAG_SET (stream->buffer, GST_BUFFER_FLAG_DELTA_UNIT);
     }
 
-  if (demux->play_mode != AIUR_PLAY_MODE_NORMAL && stream->buffer) {
+  if ((demux->play_mode != AIUR_PLAY_MODE_NORMAL
+          || demux->option.thumbnail_count) && stream->buffer) {
       GST_BUFFER_FLAG_SET (stream->buffer, GST_BUFFER_FLAG_DISCONT);
     }
   }
@@ -4055,6 +4074,73 @@ done:
   return ret;
 }
 
+/* thumbnail mode keeps only the first video track, other tracks end at once
+ * so downstream can preroll without waiting for audio */
+static void
+aiurdemux_thumbnail_prepare (GstAiurDemux * demux)
+{
+  AiurDemuxStream *video = NULL;
+  gint n;
+
+  demux->thumbnail_sent = 0;
+
+  for (n = 0; n < demux->n_streams; n++) {
+    AiurDemuxStream *stream = demux->streams[n];
+
+    if (stream->type == MEDIA_VIDEO && video == NULL) {
+      video = stream;
+      continue;
+    }
+    MARK_STREAM_EOS (demux, stream);
+  }
+
+  GST_INFO_OBJECT (demux, "thumbnail mode: %d sync samples from %s",
+      demux->option.thumbnail_count,
+      video ? GST_OBJECT_NAME (video->pad) : "no video track");
+}
+
+/* called after each video sample pushed to the pad in thumbnail mode, the
+ * interleave queue is bypassed so the count matches what downstream got.
+ * Jump to the sync sample at the next evenly spaced position or finish */
+static GstFlowReturn
+aiurdemux_thumbnail_next (GstAiurDemux * demux, AiurDemuxStream * stream)
+{
+  AiurCoreInterface *IParser = demux->core_interface;
+  FslParserHandle handle = demux->core_handle;
+  GstClockTime position;
+  guint64 usSeekTime;
+  int32 core_ret;
+
+  demux->thumbnail_sent++;
+
+  if (demux->thumbnail_sent >= demux->option.thumbnail_count
+      || !demux->seekable
+      || !GST_CLOCK_TIME_IS_VALID (demux->movie_duration)) {
+    GST_INFO_OBJECT (demux, "thumbnail mode: %d sync samples sent",
+        demux->thumbnail_sent);
+    aiurdemux_send_stream_eos_all (demux);
+    return GST_FLOW_EOS;
+  }
+
+  position = gst_util_uint64_scale (demux->movie_duration,
+      demux->thumbnail_sent, demux->option.thumbnail_count);
+  usSeekTime = AIUR_GSTTS_2_CORETS (position);
+
+  core_ret = IParser->seek (handle, stream->track_idx, &usSeekTime,
+      SEEK_FLAG_NO_EARLIER);
+  if (core_ret != PARSER_SUCCESS) {
+    GST_INFO_OBJECT (demux, "thumbnail mode: no sync sample after %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (position));
+    aiurdemux_send_stream_eos_all (demux);
+    return GST_FLOW_EOS;
+  }
+
+  GST_DEBUG_OBJECT (demux, "thumbnail %d at %" GST_TIME_FORMAT,
+      demux->thumbnail_sent, GST_TIME_ARGS (AIUR_CORETS_2_GSTTS (usSeekTime)));
+
+  return GST_FLOW_OK;
+}
+
 static void aiurdemux_reset_stream (GstAiurDemux * demux, AiurDemuxStream * stream)
 {
     stream->valid = TRUE;
@@ -97,6 +97,7 @@ enum
   PROP_INDEX_ENABLED,
   PROP_DISABLE_VORBIS_CODEC_DATA,
   PROP_LOW_LATENCY_TOLERANCE,
+  PROP_THUMBNAIL_COUNT,
 };
 
 
@@ -149,6 +150,7 @@ typedef struct _AiurDemuxOption
   gboolean merge_h264_codec_data;
   gboolean disable_vorbis_codec_data;
   gint low_latency_tolerance;
+  guint thumbnail_count;
 } AiurDemuxOption;
 
 
@@ -318,6 +320,7 @@ struct _GstAiurDemux
     AiurDemuxPlayMode play_mode;
     
     guint32 interleave_queue_size;
+    guint32 thumbnail_sent;
 
     GstSegment segment;
     guint32 segment_seqnum;
@@ -132,6 +132,7 @@
 #endif
 #include "gstimxcompositor.h"
 #include "gstimxcompositorpad.h"
+#include "imx_2d_device_cost.h"
 
 //#define USE_GST_VIDEO_SAMPLE_CONVERT  //bad performance
 
@@ -140,6 +141,10 @@
 #define IMX_COMPOSITOR_OUTPUT_POOL_MIN_BUFFERS   3
 #define IMX_COMPOSITOR_OUTPUT_POOL_MAX_BUFFERS   30
 #define IMX_COMPOSITOR_COMPOMETA_DEFAULT         FALSE
+#define IMX_COMPOSITOR_MAX_FILL_RECTS            8
+#define IMX_COMPOSITOR_MAX_DAMAGE_RECTS          16
+#define IMX_COMPOSITOR_DAMAGE_TRACKING_DEFAULT   FALSE
+#define IMX_COMPOSITOR_BLEND_CHUNK               4
 
 #define IMX_COMPOSITOR_CSC_LOSS_FACTOR          5 // 0 ~ 10
 #define IMX_COMPOSITOR_CSC_COMPLEX_FACTOR (10 - IMX_COMPOSITOR_CSC_LOSS_FACTOR)
@@ -178,7 +183,11 @@ enum {
 #endif
   PROP_IMXCOMPOSITOR_BACKGROUND_ENABLE,
   PROP_IMXCOMPOSITOR_BACKGROUND_COLOR,
-  PROP_IMXCOMPOSITOR_COMPOSITION_META_ENABLE
+  PROP_IMXCOMPOSITOR_COMPOSITION_META_ENABLE,
+  PROP_IMXCOMPOSITOR_DEVICE_SELECTION,
+  PROP_IMXCOMPOSITOR_SKIPPED_PIXELS,
+  PROP_IMXCOMPOSITOR_DAMAGE_TRACKING,
+  PROP_IMXCOMPOSITOR_DEVICE_STATS
 };
 
 static GstElementClass *parent_class = NULL;
@@ -187,21 +196,49 @@ static void gst_imxcompositor_finalize (GObject * object)
 {
   GstImxCompositor *imxcomp = (GstImxCompositor *)(object);
   GstStructure *config;
-  GstImxCompositorClass *klass =
-        (GstImxCompositorClass *) G_OBJECT_GET_CLASS (imxcomp);
+  guint i;
+
+  if (imxcomp->frames)
+    GST_INFO ("composed %" G_GUINT64_FORMAT " frames, %.2f submissions and %"
+        G_GINT64_FORMAT " us per frame", imxcomp->frames,
+        (gdouble) imxcomp->submissions / imxcomp->frames,
+        imxcomp->total_time / (gint64) imxcomp->frames);
+  if (imxcomp->frames)
+    GST_INFO ("object lock waited %" G_GINT64_FORMAT " us and held %"
+        G_GINT64_FORMAT " us per frame", imxcomp->lock_wait_time /
+        (gint64) imxcomp->frames, imxcomp->lock_hold_time /
+        (gint64) imxcomp->frames);
+  if (imxcomp->prepared_pads)
+    GST_INFO ("prepared %" G_GUINT64_FORMAT " pads, %.2f us per pad",
+        imxcomp->prepared_pads,
+        (gdouble) imxcomp->prepare_time / imxcomp->prepared_pads);
+  if (imxcomp->frames)
+    GST_INFO ("pad layout rebuilt %" G_GUINT64_FORMAT " times in %"
+        G_GUINT64_FORMAT " frames", imxcomp->layout_rebuilds, imxcomp->frames);
+  if (imxcomp->total_pixels)
+    GST_INFO ("skipped %" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT
+        " pixels hidden by opaque pads", imxcomp->skipped_pixels,
+        imxcomp->total_pixels);
 
   imx_video_overlay_composition_deinit(&imxcomp->video_comp);
+  g_free (imxcomp->selection);
+  for (i = 0; i < IMX_COMPOSITOR_DAMAGE_HISTORY; i++)
+    if (imxcomp->damage.history[i])
+      g_array_free (imxcomp->damage.history[i], TRUE);
+  g_array_free (imxcomp->damage.layout, TRUE);
+  if (imxcomp->layout_pads)
+    g_ptr_array_unref (imxcomp->layout_pads);
 
   GST_IMX_COMPOSITOR_UNREF_POOL (imxcomp->out_pool);
   if (imxcomp->allocator) {
+    gst_imx_2d_device_allocator_flush (imxcomp->allocator);
     gst_object_unref (imxcomp->allocator);
     imxcomp->allocator = NULL;
   }
 
   if (imxcomp->device) {
     imxcomp->device->close(imxcomp->device);
-    if (klass->in_plugin)
-      klass->in_plugin->destroy(imxcomp->device);
+    imx_2d_device_destroy(imxcomp->device);
     imxcomp->device = NULL;
   }
 
@@ -224,6 +261,23 @@ gst_imxcompositor_get_property (GObject * object,
     case PROP_IMXCOMPOSITOR_COMPOSITION_META_ENABLE:
       g_value_set_boolean(value, imxcomp->composition_meta_enable);
       break;
+    case PROP_IMXCOMPOSITOR_DEVICE_SELECTION:
+      GST_OBJECT_LOCK (imxcomp);
+      g_value_set_string(value, imxcomp->selection);
+      GST_OBJECT_UNLOCK (imxcomp);
+      break;
+    case PROP_IMXCOMPOSITOR_SKIPPED_PIXELS:
+      GST_OBJECT_LOCK (imxcomp);
+      g_value_set_uint64(value, imxcomp->skipped_pixels);
+      GST_OBJECT_UNLOCK (imxcomp);
+      break;
+    case PROP_IMXCOMPOSITOR_DAMAGE_TRACKING:
+      g_value_set_boolean(value, imxcomp->damage_tracking);
+      break;
+    case PROP_IMXCOMPOSITOR_DEVICE_STATS:
+      g_value_take_boxed(value,
+          imx_2d_device_get_session_stats_structure(imxcomp->device));
+      break;
 #if 0
     case PROP_IMXCOMPOSITOR_OUTPUT_WIDTH:
       g_value_set_uint (value, imxcomp->width);
@@ -254,6 +308,9 @@ gst_imxcompositor_set_property (GObject * object,
     case PROP_IMXCOMPOSITOR_COMPOSITION_META_ENABLE:
       imxcomp->composition_meta_enable = g_value_get_boolean(value);
       break;
+    case PROP_IMXCOMPOSITOR_DAMAGE_TRACKING:
+      imxcomp->damage_tracking = g_value_get_boolean(value);
+      break;
 #if 0
     case PROP_IMXCOMPOSITOR_OUTPUT_WIDTH:
       imxcomp->width = g_value_get_uint (value);
@@ -351,6 +408,32 @@ gst_imxcompositor_create_bufferpool(GstImxCompositor *imxcomp,
   return pool;
 }
 
+/* output format selection reads the measured blend costs under the object
+ * lock, measure the device here */
+static gboolean
+gst_imxcompositor_start (GstAggregator * agg)
+{
+  GstImxCompositor *imxcomp = (GstImxCompositor *) (agg);
+
+  /* measuring may take seconds, the format choice keeps to the static
+   * complexity until it is done */
+  if (imxcomp->device)
+    imx_2d_device_cost_prepare_async (imxcomp->device->device_type);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->start (agg);
+}
+
+static gboolean
+gst_imxcompositor_sink_event (GstAggregator * agg, GstAggregatorPad * bpad,
+    GstEvent * event)
+{
+  /* the pad geometry depends on the input size */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS)
+    GST_IMX_COMPOSITOR_LAYOUT_CHANGED (agg);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->sink_event (agg, bpad, event);
+}
+
 static gboolean
 gst_imxcompositor_sink_query (GstAggregator * agg, GstAggregatorPad * bpad,
     GstQuery * query)
@@ -658,7 +741,11 @@ static GstVideoFormat find_best_src_format(GstAggregator *vagg, GstCaps *o_caps)
 #define COMPLEX_SCALE_FACTOR    1
 
   GList *l;
+  GstImxCompositor *imxcomp = (GstImxCompositor *) (vagg);
   gint factor_min = G_MAXINT32;
+  gint64 best_loss = G_MAXINT64;
+  gdouble best_cost = -1;
+  gboolean best_measured = FALSE;
   GstVideoFormat best_fmt = GST_VIDEO_FORMAT_UNKNOWN;
 
   if (!(GST_ELEMENT (vagg)->sinkpads)) {
@@ -680,6 +767,9 @@ static GstVideoFormat find_best_src_format(GstAggregator *vagg, GstCaps *o_caps)
     const gchar *fmt = gst_structure_get_string(s, "format");
     GstVideoFormat o_fmt = gst_video_format_from_string(fmt);
     gint factor = 0;
+    gint64 loss_total = 0;
+    gdouble cost_total = 0;
+    gboolean measured = imxcomp->device != NULL;
     GstVideoFormat i_fmt;
 
     for (l = GST_ELEMENT (vagg)->sinkpads; l; l = l->next) {
@@ -713,15 +803,49 @@ static GstVideoFormat find_best_src_format(GstAggregator *vagg, GstCaps *o_caps)
       loss = resol * get_format_csc_loss(i_fmt, o_fmt);
       factor += IMX_COMPOSITOR_CSC_LOSS_FACTOR * loss;
       factor += IMX_COMPOSITOR_CSC_COMPLEX_FACTOR * complex;
+
+      loss_total += loss;
+      if (measured) {
+        gdouble cost = imx_2d_device_cost_get(imxcomp->device->device_type,
+            IMX_2D_COST_OP_BLEND, i_fmt, o_fmt, resol);
+        if (cost < 0)
+          measured = FALSE;
+        else
+          cost_total += cost;
+      }
     }
-    GST_LOG("fmt %s factor %d", fmt, factor);
-    if (factor < factor_min) {
+    GST_LOG("fmt %s factor %d, measured %d cost %.1f us", fmt, factor,
+        measured, cost_total);
+
+    /* when the blend of every pad was measured on this device, the measured
+     * time replaces the static complexity and only breaks loss ties */
+    gboolean better;
+    if (measured && best_measured)
+      better = loss_total < best_loss
+          || (loss_total == best_loss && cost_total < best_cost);
+    else
+      better = factor < factor_min;
+
+    if (better) {
       best_fmt = o_fmt;
       factor_min = factor;
+      best_loss = loss_total;
+      best_cost = measured ? cost_total : -1;
+      best_measured = measured;
     }
   }
   GST_OBJECT_UNLOCK (vagg);
 
+  if (best_fmt != GST_VIDEO_FORMAT_UNKNOWN) {
+    gchar *selection = g_strdup_printf("%s, %.1f us measured per frame",
+        gst_video_format_to_string(best_fmt), best_cost);
+    GST_INFO_OBJECT (vagg, "format selection: %s", selection);
+    GST_OBJECT_LOCK (vagg);
+    g_free (imxcomp->selection);
+    imxcomp->selection = selection;
+    GST_OBJECT_UNLOCK (vagg);
+  }
+
   return best_fmt;
 }
 
@@ -790,6 +914,7 @@ gst_imxcompositor_negotiated_caps (GstAggregator * vagg, GstCaps * caps)
   GstAggregator *agg = GST_AGGREGATOR (imxcomp);
 
   GST_DEBUG("negotiated caps: %" GST_PTR_FORMAT, caps);
+  GST_IMX_COMPOSITOR_LAYOUT_CHANGED (imxcomp);
 
   if (imxcomp->self_out_pool) {
     GstCaps *pool_caps;
@@ -1137,28 +1262,46 @@ static gint gst_imxcompositor_config_dst(GstImxCompositor *imxcomp,
   return 0;
 }
 
+/* what a pad draws in the current composition, copied under the object
+ * lock so the blend runs without it */
+typedef struct {
+  /* referenced by the cached layout_pads */
+  GstImxCompositorPad *pad;
+  /* prepared buffer, NULL if the pad draws nothing */
+  GstBuffer *buffer;
+  /* input buffer and its timestamp, identify the frame for damage tracking */
+  gconstpointer input;
+  GstClockTime pts;
+  GstVideoRectangle src_crop;
+  GstVideoRectangle dst_crop;
+  gdouble alpha;
+  gint rotate;
+} GstImxCompositorPadState;
+
+typedef struct {
+  /* pads in z-order */
+  GstImxCompositorPadState *pads;
+  guint n_pads;
+  guint background;
+  gboolean background_enable;
+  gboolean composition_meta_enable;
+  gboolean damage_tracking;
+  /* statistics of this composition, merged into the element at its end */
+  guint64 total_pixels;
+  guint64 skipped_pixels;
+} GstImxCompositorLayout;
+
 static gint gst_imxcompositor_config_src(GstImxCompositor *imxcomp,
-    GstImxCompositorPad *pad, Imx2DFrame *src)
+    GstImxCompositorPadState *state, Imx2DFrame *src)
 {
+  GstImxCompositorPad *pad = state->pad;
   GstVideoAggregatorPad *ppad = (GstVideoAggregatorPad *)pad;
   GstVideoMeta *video_meta;
-  GstBuffer *pad_buffer = NULL;
+  GstBuffer *pad_buffer = state->buffer;
   guint i, n_mem;
   GstDmabufMeta *dmabuf_meta;
   gint64 drm_modifier = 0;
 
-#if GST_CHECK_VERSION(1, 16, 0)
-  GstVideoFrame * aggregated_frame = gst_video_aggregator_pad_get_prepared_frame (ppad);
-  if (!aggregated_frame) {
-    pad_buffer = gst_video_aggregator_pad_get_current_buffer (ppad);
-  } else {
-    pad_buffer = aggregated_frame->buffer;
-  }
-#else
-  GstVideoFrame * aggregated_frame = ppad->aggregated_frame;
-  pad_buffer = aggregated_frame->buffer;
-#endif
-
   video_meta = gst_buffer_get_video_meta (pad_buffer);
   if (video_meta) {
   src->info.fmt = GST_VIDEO_INFO_FORMAT(&(ppad->info));
@@ -1205,12 +1348,8 @@ static gint gst_imxcompositor_config_src(GstImxCompositor *imxcomp,
   GST_LOG_OBJECT (pad, "Input: %s, %dx%d(%d), crop(%d,%d,%d,%d)",
       GST_VIDEO_FORMAT_INFO_NAME(ppad->info.finfo),
       src->info.w, src->info.h, src->info.stride,
-      pad->src_crop.x, pad->src_crop.y, pad->src_crop.w, pad->src_crop.h);
-
-  if (imxcomp->device->config_input(imxcomp->device, &src->info) < 0) {
-    GST_ERROR_OBJECT (pad, "config input failed");
-    return -1;
-  }
+      state->src_crop.x, state->src_crop.y, state->src_crop.w,
+      state->src_crop.h);
 
   src->fd[0] = src->fd[1] =src->fd[2] = src->fd[3] = -1;
   if (gst_is_dmabuf_memory (gst_buffer_peek_memory (pad_buffer, 0))) {
@@ -1219,13 +1358,13 @@ static gint gst_imxcompositor_config_src(GstImxCompositor *imxcomp,
       src->fd[i] = gst_dmabuf_memory_get_fd (gst_buffer_peek_memory (pad_buffer, i));
   } else 
     src->mem = gst_buffer_query_phymem_block (pad_buffer);
-  src->alpha = (gint)(pad->alpha * 255);
-  src->rotate = pad->rotate;
+  src->alpha = (gint)(state->alpha * 255);
+  src->rotate = state->rotate;
   src->interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
-  src->crop.x = pad->src_crop.x;
-  src->crop.y = pad->src_crop.y;
-  src->crop.w = pad->src_crop.w;
-  src->crop.h = pad->src_crop.h;
+  src->crop.x = state->src_crop.x;
+  src->crop.y = state->src_crop.y;
+  src->crop.w = state->src_crop.w;
+  src->crop.h = state->src_crop.h;
 
   return 0;
 }
@@ -1464,8 +1603,13 @@ static gint imxcompositor_pad_zorder_compare (gconstpointer a, gconstpointer b)
 static guint8 *
 _get_cached_phyaddr (GstMemory * mem)
 {
-    return gst_mini_object_get_qdata (GST_MINI_OBJECT (mem),
+    guint8 *paddr = gst_mini_object_get_qdata (GST_MINI_OBJECT (mem),
               g_quark_from_static_string ("phyaddr"));
+
+    /* dmabufs seen by any element share one process wide cache */
+    if (!paddr && gst_is_dmabuf_memory (mem))
+      paddr = (guint8 *) phy_addr_from_dmabuf_memory (mem);
+    return paddr;
 }
 
 static void
@@ -1475,28 +1619,693 @@ _set_cached_phyaddr (GstMemory * mem, guint8 * phyadd)
                 g_quark_from_static_string ("phyaddr"), phyadd, NULL);
 }
 
+typedef struct {
+  GstImxCompositorPad *pad;
+  GstBuffer *buffer;
+  PhyMemBlock mem;
+} GstImxCompositorLayer;
+
+/* rectangles of region left after removing cover, each one splits into the
+ * bands above and below cover and the parts left and right of it */
+static GArray *
+gst_imxcompositor_region_subtract (GArray * region,
+    const GstVideoRectangle * cover)
+{
+  GArray *out = g_array_sized_new (FALSE, FALSE, sizeof (GstVideoRectangle),
+      region->len + 4);
+  GstVideoRectangle r, p;
+  gint x0, y0, x1, y1;
+  guint i;
+
+  for (i = 0; i < region->len; i++) {
+    r = g_array_index (region, GstVideoRectangle, i);
+    x0 = MAX (r.x, cover->x);
+    y0 = MAX (r.y, cover->y);
+    x1 = MIN (r.x + r.w, cover->x + cover->w);
+    y1 = MIN (r.y + r.h, cover->y + cover->h);
+
+    if (x0 >= x1 || y0 >= y1) {
+      g_array_append_val (out, r);
+      continue;
+    }
+
+    if (y0 > r.y) {
+      p.x = r.x; p.y = r.y; p.w = r.w; p.h = y0 - r.y;
+      g_array_append_val (out, p);
+    }
+    if (y1 < r.y + r.h) {
+      p.x = r.x; p.y = y1; p.w = r.w; p.h = r.y + r.h - y1;
+      g_array_append_val (out, p);
+    }
+    if (x0 > r.x) {
+      p.x = r.x; p.y = y0; p.w = x0 - r.x; p.h = y1 - y0;
+      g_array_append_val (out, p);
+    }
+    if (x1 < r.x + r.w) {
+      p.x = x1; p.y = y0; p.w = r.x + r.w - x1; p.h = y1 - y0;
+      g_array_append_val (out, p);
+    }
+  }
+
+  g_array_free (region, TRUE);
+  return out;
+}
+
+static guint64
+gst_imxcompositor_region_area (GArray * region)
+{
+  guint64 area = 0;
+  guint i;
+
+  for (i = 0; i < region->len; i++) {
+    GstVideoRectangle *r = &g_array_index (region, GstVideoRectangle, i);
+    area += (guint64) r->w * r->h;
+  }
+
+  return area;
+}
+
+static GArray *
+gst_imxcompositor_output_region (const Imx2DFrame * dst)
+{
+  GArray *region = g_array_new (FALSE, FALSE, sizeof (GstVideoRectangle));
+  GstVideoRectangle out;
+
+  out.x = dst->crop.x;
+  out.y = dst->crop.y;
+  out.w = dst->crop.w;
+  out.h = dst->crop.h;
+  g_array_append_val (region, out);
+
+  return region;
+}
+
+static GstBuffer *
+gst_imxcompositor_pad_buffer (GstVideoAggregatorPad * ppad)
+{
+#if GST_CHECK_VERSION(1, 16, 0)
+  GstVideoFrame * aggregated_frame = gst_video_aggregator_pad_get_prepared_frame (ppad);
+  if (!aggregated_frame)
+    return gst_video_aggregator_pad_get_current_buffer (ppad);
+  return aggregated_frame->buffer;
+#else
+  return ppad->aggregated_frame ? ppad->aggregated_frame->buffer : NULL;
+#endif
+}
+
+/* buffer a pad draws in this composition, NULL if it draws nothing */
+static GstBuffer *
+gst_imxcompositor_pad_drawn_buffer (GstVideoAggregatorPad * ppad)
+{
+  GstImxCompositorPad *pad = GST_IMXCOMPOSITOR_PAD (ppad);
+  GstBuffer *pad_buffer = gst_imxcompositor_pad_buffer (ppad);
+
+  if (pad_buffer == NULL || pad->ignore_composite
+      || pad->dst_crop.w <= 0 || pad->dst_crop.h <= 0
+      || (gst_buffer_get_size (pad_buffer) == 0 &&
+          GST_BUFFER_FLAG_IS_SET (pad_buffer, GST_BUFFER_FLAG_GAP)))
+    return NULL;
+
+  return pad_buffer;
+}
+
+/* Copy what every pad draws under the object lock, the pad list, its
+ * z-order and the pad properties. The blits then run without the lock, an
+ * application moving a pad or changing its z-order no longer waits for a
+ * whole composition. The z-ordered pad list is kept between compositions
+ * and only rebuilt when a pad is added or removed or the layout cookie
+ * moved. */
+static void
+gst_imxcompositor_snapshot_layout (GstImxCompositor * imxcomp,
+    GstImxCompositorLayout * layout)
+{
+  GstVideoAggregator *vagg = (GstVideoAggregator *) imxcomp;
+  GstImxCompositorPadState *state;
+  GstBuffer *pad_buffer;
+  GList *l, *pads;
+  gint64 start, locked;
+  guint i, cookie;
+
+  start = g_get_monotonic_time ();
+  GST_OBJECT_LOCK (vagg);
+  locked = g_get_monotonic_time ();
+
+#if !GST_CHECK_VERSION(1, 16, 0)
+  /* no request pad hook follows the zorder here, check the cached order */
+  for (i = 1; imxcomp->layout_pads && i < imxcomp->layout_pads->len; i++) {
+    if (imxcompositor_pad_zorder_compare (
+            g_ptr_array_index (imxcomp->layout_pads, i - 1),
+            g_ptr_array_index (imxcomp->layout_pads, i)) > 0) {
+      GST_IMX_COMPOSITOR_LAYOUT_CHANGED (imxcomp);
+      break;
+    }
+  }
+#endif
+
+  cookie = (guint) g_atomic_int_get (&imxcomp->layout_cookie);
+  if (!imxcomp->layout_pads || imxcomp->layout_built != cookie
+      || imxcomp->layout_pads_cookie != GST_ELEMENT (vagg)->pads_cookie) {
+    //re-order by zorder of pad
+    pads = g_list_copy (GST_ELEMENT (vagg)->sinkpads);
+#if !GST_CHECK_VERSION(1, 16, 0)
+    pads = g_list_sort (pads, imxcompositor_pad_zorder_compare);
+#endif
+    if (imxcomp->layout_pads)
+      g_ptr_array_unref (imxcomp->layout_pads);
+    imxcomp->layout_pads = g_ptr_array_new_full (g_list_length (pads),
+        (GDestroyNotify) gst_object_unref);
+    for (l = pads; l; l = l->next)
+      g_ptr_array_add (imxcomp->layout_pads, gst_object_ref (l->data));
+    g_list_free (pads);
+
+    imxcomp->layout_built = cookie;
+    imxcomp->layout_pads_cookie = GST_ELEMENT (vagg)->pads_cookie;
+    imxcomp->layout_rebuilds++;
+    GST_DEBUG_OBJECT (imxcomp, "layout rebuilt with %u pads",
+        imxcomp->layout_pads->len);
+  }
+
+  memset (layout, 0, sizeof (GstImxCompositorLayout));
+  layout->n_pads = imxcomp->layout_pads->len;
+  layout->pads = g_new0 (GstImxCompositorPadState, layout->n_pads);
+  layout->background = imxcomp->background;
+  layout->background_enable = imxcomp->background_enable;
+  layout->composition_meta_enable = imxcomp->composition_meta_enable;
+  layout->damage_tracking = imxcomp->damage_tracking;
+
+  for (i = 0; i < layout->n_pads; i++) {
+    GstVideoAggregatorPad *ppad = g_ptr_array_index (imxcomp->layout_pads, i);
+    GstImxCompositorPad *pad = GST_IMXCOMPOSITOR_PAD (ppad);
+
+    state = &layout->pads[i];
+    state->pad = pad;
+
+    pad_buffer = gst_imxcompositor_pad_drawn_buffer (ppad);
+    if (!pad_buffer)
+      continue;
+
+    /* the prepared frame may be a staging copy reused for every input
+     * buffer, the damage tracking identifies the input itself */
+#if GST_CHECK_VERSION(1, 16, 0)
+    state->input = gst_video_aggregator_pad_get_current_buffer (ppad);
+#else
+    state->input = ppad->buffer;
+#endif
+    state->pts = state->input ?
+        GST_BUFFER_PTS ((GstBuffer *) state->input) : GST_CLOCK_TIME_NONE;
+    state->buffer = gst_buffer_ref (pad_buffer);
+    state->src_crop = pad->src_crop;
+    state->dst_crop = pad->dst_crop;
+    GST_OBJECT_LOCK (pad);
+    state->alpha = pad->alpha;
+    state->rotate = pad->rotate;
+    GST_OBJECT_UNLOCK (pad);
+  }
+
+  GST_OBJECT_UNLOCK (vagg);
+
+  imxcomp->lock_wait_time += locked - start;
+  imxcomp->lock_hold_time += g_get_monotonic_time () - locked;
+}
+
+static void
+gst_imxcompositor_clear_layout (GstImxCompositorLayout * layout)
+{
+  guint i;
+
+  for (i = 0; i < layout->n_pads; i++) {
+    if (layout->pads[i].buffer)
+      gst_buffer_unref (layout->pads[i].buffer);
+  }
+  g_free (layout->pads);
+  layout->pads = NULL;
+  layout->n_pads = 0;
+}
+
+/* Visibility of the z-ordered pads. A pad is opaque when it is drawn with
+ * full alpha from a format without alpha channel. Walking from the top,
+ * a pad is hidden when the opaque pads above it cover its whole area, and
+ * what remains of area once every opaque pad is removed is the part of the
+ * background that needs a fill. Pads not flagged in redraw are kept from
+ * the previous composition. Returns the hidden flag of every pad and the
+ * uncovered background in bg, area is consumed. */
+static gboolean *
+gst_imxcompositor_cull_pads (GstImxCompositorLayout * layout,
+    const gboolean * redraw, GArray * area, GArray ** bg)
+{
+  gboolean *hidden = g_new0 (gboolean, layout->n_pads);
+  GArray *opaque = g_array_new (FALSE, FALSE, sizeof (GstVideoRectangle));
+  GArray *region;
+  GstVideoRectangle *rect;
+  guint i, j;
+  guint64 size;
+
+  for (i = layout->n_pads; i > 0; i--) {
+    GstImxCompositorPadState *state = &layout->pads[i - 1];
+    GstVideoAggregatorPad *ppad = GST_VIDEO_AGGREGATOR_PAD (state->pad);
+
+    if (!state->buffer)
+      continue;
+
+    region = g_array_new (FALSE, FALSE, sizeof (GstVideoRectangle));
+    g_array_append_val (region, state->dst_crop);
+    for (j = 0; j < opaque->len && region->len > 0; j++)
+      region = gst_imxcompositor_region_subtract (region,
+          &g_array_index (opaque, GstVideoRectangle, j));
+    hidden[i - 1] = (region->len == 0);
+    g_array_free (region, TRUE);
+
+    size = (guint64) state->dst_crop.w * state->dst_crop.h;
+    layout->total_pixels += size;
+    if (hidden[i - 1]) {
+      GST_LOG_OBJECT (state->pad, "hidden by the pads above it");
+      layout->skipped_pixels += size;
+      continue;
+    }
+    if (redraw && !redraw[i - 1])
+      layout->skipped_pixels += size;
+
+    if (state->alpha >= 1.0
+        && !GST_VIDEO_FORMAT_INFO_HAS_ALPHA (ppad->info.finfo))
+      g_array_append_val (opaque, state->dst_crop);
+  }
+
+  region = area;
+  for (j = 0; j < opaque->len && region->len > 0; j++) {
+    rect = &g_array_index (opaque, GstVideoRectangle, j);
+    region = gst_imxcompositor_region_subtract (region, rect);
+  }
+  g_array_free (opaque, TRUE);
+
+  *bg = region;
+  return hidden;
+}
+
+/* devices whose fill is limited to the destination crop */
+static gboolean
+gst_imxcompositor_fills_crop (Imx2DDevice * device)
+{
+  Imx2DDeviceType engine = imx_2d_device_get_engine_type (device);
+
+  return device->fill && (engine == IMX_2D_DEVICE_G2D
+      || engine == IMX_2D_DEVICE_SW);
+}
+
+/* pixels sharing one chroma sample of the output, 2x2 for 4:2:0 and 2x1 for
+ * 4:2:2. A fill covering part of such a group leaves its chroma stale (the
+ * SW device packs chroma from even rows and columns only) or up to the
+ * engine, so fill rectangles must cover whole groups. */
+static void
+gst_imxcompositor_chroma_grid (const Imx2DFrame * dst, gint * xs, gint * ys)
+{
+  const GstVideoFormatInfo *finfo = gst_video_format_get_info (dst->info.fmt);
+
+  *xs = *ys = 1;
+  if (finfo && GST_VIDEO_FORMAT_INFO_IS_YUV (finfo)
+      && GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo) > 1) {
+    *xs = 1 << GST_VIDEO_FORMAT_INFO_W_SUB (finfo, 1);
+    *ys = 1 << GST_VIDEO_FORMAT_INFO_H_SUB (finfo, 1);
+  }
+}
+
+/* grow r to whole chroma groups, without leaving the output crop. Returns
+ * FALSE if r had to grow. */
+static gboolean
+gst_imxcompositor_rect_to_chroma_grid (GstVideoRectangle * r,
+    const Imx2DCrop * crop, gint xs, gint ys)
+{
+  gint x0 = MAX (r->x / xs * xs, crop->x);
+  gint y0 = MAX (r->y / ys * ys, crop->y);
+  gint x1 = MIN ((r->x + r->w + xs - 1) / xs * xs, crop->x + (gint) crop->w);
+  gint y1 = MIN ((r->y + r->h + ys - 1) / ys * ys, crop->y + (gint) crop->h);
+  gboolean aligned = (x0 == r->x && y0 == r->y
+      && x1 == r->x + r->w && y1 == r->y + r->h);
+
+  r->x = x0;
+  r->y = y0;
+  r->w = x1 - x0;
+  r->h = y1 - y0;
+
+  return aligned;
+}
+
+static gboolean
+gst_imxcompositor_region_on_chroma_grid (GArray * region,
+    const Imx2DFrame * dst)
+{
+  GstVideoRectangle r;
+  gint xs, ys;
+  guint i;
+
+  gst_imxcompositor_chroma_grid (dst, &xs, &ys);
+  if (xs == 1 && ys == 1)
+    return TRUE;
+
+  for (i = 0; i < region->len; i++) {
+    r = g_array_index (region, GstVideoRectangle, i);
+    if (!gst_imxcompositor_rect_to_chroma_grid (&r, &dst->crop, xs, ys))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+typedef struct {
+  gconstpointer pad;
+  gconstpointer buffer;
+  GstClockTime pts;
+  GstVideoRectangle src_crop;
+  GstVideoRectangle dst_crop;
+  gdouble alpha;
+  gint rotate;
+  /* position of the pad in the z-ordered list */
+  guint index;
+} GstImxCompositorDamageEntry;
+
+static gboolean
+gst_imxcompositor_rect_intersects (const GstVideoRectangle * a,
+    const GstVideoRectangle * b)
+{
+  return a->x < b->x + b->w && b->x < a->x + a->w
+      && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static gboolean
+gst_imxcompositor_damage_entry_equal (const GstImxCompositorDamageEntry * a,
+    const GstImxCompositorDamageEntry * b)
+{
+  return a->pad == b->pad && a->buffer == b->buffer && a->pts == b->pts
+      && a->alpha == b->alpha && a->rotate == b->rotate
+      && memcmp (&a->src_crop, &b->src_crop, sizeof (GstVideoRectangle)) == 0
+      && memcmp (&a->dst_crop, &b->dst_crop, sizeof (GstVideoRectangle)) == 0;
+}
+
+/* Damage tracking. Every composition records what changed since the one
+ * before it: the old and new rectangles of each pad that got a new buffer,
+ * moved, changed alpha or rotation, appeared or went away. An output
+ * buffer keeps the composition it was last drawn with, tagged on its
+ * memory, so only the union of the damage since then needs redrawing.
+ * That region grows by the full rectangle of every pad it touches, until
+ * it is closed, so the pads drawn into it are blended over freshly drawn
+ * content only. Returns the region and the pads to redraw, or NULL when
+ * the whole output has to be composed. */
+static GArray *
+gst_imxcompositor_damage_region (GstImxCompositor * imxcomp,
+    GstImxCompositorLayout * layout, Imx2DFrame * dst, GstBuffer * outbuf,
+    gboolean ** redraw)
+{
+  GstImxCompositorDamage *damage = &imxcomp->damage;
+  GArray *drawn, *changed = NULL, *region;
+  GstImxCompositorDamageEntry entry, *a, *b;
+  gboolean full, grown;
+  guint i, n, seq, age;
+
+  seq = ++damage->seq;
+  drawn = g_array_sized_new (FALSE, FALSE,
+      sizeof (GstImxCompositorDamageEntry), layout->n_pads);
+
+  for (i = 0; i < layout->n_pads; i++) {
+    GstImxCompositorPadState *state = &layout->pads[i];
+
+    if (!state->buffer)
+      continue;
+
+    entry.pad = state->pad;
+    entry.buffer = state->input;
+    entry.pts = state->pts;
+    entry.src_crop = state->src_crop;
+    entry.dst_crop = state->dst_crop;
+    entry.alpha = state->alpha;
+    entry.rotate = state->rotate;
+    entry.index = i;
+    g_array_append_val (drawn, entry);
+  }
+
+  full = !layout->damage_tracking
+      || memcmp (&damage->info, &dst->info, sizeof (Imx2DVideoInfo)) != 0
+      || memcmp (&damage->crop, &dst->crop, sizeof (Imx2DCrop)) != 0
+      || damage->background != layout->background
+      || damage->background_enable != layout->background_enable
+      || (layout->background_enable
+          && !gst_imxcompositor_fills_crop (imxcomp->device));
+
+  if (!full) {
+    /* compare the pads position by position, a pad moving in z-order
+     * damages everything between its old and new position */
+    changed = g_array_new (FALSE, FALSE, sizeof (GstVideoRectangle));
+    n = MAX (drawn->len, damage->layout->len);
+    for (i = 0; i < n; i++) {
+      a = i < damage->layout->len ?
+          &g_array_index (damage->layout, GstImxCompositorDamageEntry, i) : NULL;
+      b = i < drawn->len ?
+          &g_array_index (drawn, GstImxCompositorDamageEntry, i) : NULL;
+      if (a && b && gst_imxcompositor_damage_entry_equal (a, b))
+        continue;
+      if (a)
+        g_array_append_val (changed, a->dst_crop);
+      if (b)
+        g_array_append_val (changed, b->dst_crop);
+    }
+  }
+
+  i = seq % IMX_COMPOSITOR_DAMAGE_HISTORY;
+  if (damage->history[i])
+    g_array_free (damage->history[i], TRUE);
+  damage->history[i] = changed;
+  g_array_free (damage->layout, TRUE);
+  damage->layout = drawn;
+  damage->info = dst->info;
+  damage->crop = dst->crop;
+  damage->background = layout->background;
+  damage->background_enable = layout->background_enable;
+
+  if (full)
+    return NULL;
+
+  /* damage since the output buffer was composed */
+  age = GPOINTER_TO_UINT (gst_mini_object_get_qdata (
+          GST_MINI_OBJECT (gst_buffer_peek_memory (outbuf, 0)),
+          g_quark_from_static_string ("imxcompositor-seq")));
+  if (age == 0)
+    return NULL;
+  age = seq - age;
+  if (age == 0 || age > IMX_COMPOSITOR_DAMAGE_HISTORY)
+    return NULL;
+
+  region = g_array_new (FALSE, FALSE, sizeof (GstVideoRectangle));
+  for (n = seq - age + 1; n != seq + 1; n++) {
+    changed = damage->history[n % IMX_COMPOSITOR_DAMAGE_HISTORY];
+    if (!changed) {
+      g_array_free (region, TRUE);
+      return NULL;
+    }
+    g_array_append_vals (region, changed->data, changed->len);
+  }
+
+  *redraw = g_new0 (gboolean, layout->n_pads);
+  do {
+    grown = FALSE;
+    for (i = 0; i < drawn->len; i++) {
+      b = &g_array_index (drawn, GstImxCompositorDamageEntry, i);
+      if ((*redraw)[b->index])
+        continue;
+      for (n = 0; n < region->len; n++) {
+        if (gst_imxcompositor_rect_intersects (&b->dst_crop,
+                &g_array_index (region, GstVideoRectangle, n))) {
+          (*redraw)[b->index] = TRUE;
+          g_array_append_val (region, b->dst_crop);
+          grown = TRUE;
+          break;
+        }
+      }
+    }
+  } while (grown && region->len <= IMX_COMPOSITOR_MAX_DAMAGE_RECTS);
+
+  if (region->len > IMX_COMPOSITOR_MAX_DAMAGE_RECTS) {
+    g_array_free (region, TRUE);
+    g_free (*redraw);
+    *redraw = NULL;
+    return NULL;
+  }
+
+  GST_LOG ("output buffer composed %u frames ago, redraw %u rectangles",
+      age, region->len);
+  return region;
+}
+
+/* fill what the pads leave of the background, in pieces on the devices
+ * that fill the destination crop only */
+static void
+gst_imxcompositor_draw_background (GstImxCompositor * imxcomp,
+    GstImxCompositorLayout * layout, Imx2DFrame * dst, GArray * bg)
+{
+  Imx2DDevice *device = imxcomp->device;
+  guint64 area = (guint64) dst->crop.w * dst->crop.h;
+  guint64 bg_area = gst_imxcompositor_region_area (bg);
+  Imx2DCrop crop = dst->crop;
+  guint i;
+
+  layout->total_pixels += area;
+
+  if (bg->len == 0) {
+    GST_LOG ("background completely obscured, not drawn");
+    layout->skipped_pixels += area;
+    return;
+  }
+
+  if (gst_imxcompositor_fills_crop (device)
+      && bg->len <= IMX_COMPOSITOR_MAX_FILL_RECTS) {
+    gint xs, ys;
+
+    gst_imxcompositor_chroma_grid (dst, &xs, &ys);
+    for (i = 0; i < bg->len; i++) {
+      GstVideoRectangle r = g_array_index (bg, GstVideoRectangle, i);
+
+      /* what grows into the pads is blended over right after, a damage
+       * region only gets here already on the grid */
+      gst_imxcompositor_rect_to_chroma_grid (&r, &crop, xs, ys);
+      dst->crop.x = r.x;
+      dst->crop.y = r.y;
+      dst->crop.w = r.w;
+      dst->crop.h = r.h;
+      if (device->fill (device, dst, layout->background) < 0)
+        break;
+      imxcomp->submissions++;
+    }
+    dst->crop = crop;
+
+    if (i == bg->len) {
+      GST_LOG ("background filled in %u rectangles", bg->len);
+      if (bg_area < area)
+        layout->skipped_pixels += area - bg_area;
+      return;
+    }
+  }
+
+  if (device->fill) {
+    if(device->fill (device, dst, layout->background) < 0) {
+      GST_LOG("fill color background by device failed");
+      gst_imxcompositor_fill_background(dst, layout->background);
+    } else {
+      imxcomp->submissions++;
+    }
+  } else {
+    GST_LOG("device has no fill interface");
+    gst_imxcompositor_fill_background(dst, layout->background);
+  }
+}
+
+/* blend the pending layers in one device submission, then cache physical
+ * addresses and composite overlay metas of the layers that went through */
+static guint
+gst_imxcompositor_blend_layers (GstImxCompositor * imxcomp,
+    GstImxCompositorLayout * layout, GstBuffer * outbuf, Imx2DFrame * dst,
+    Imx2DBlendLayer * layers, GstImxCompositorLayer * infos, guint n_layers)
+{
+  Imx2DDevice *device = imxcomp->device;
+  guint i, blended = 0;
+
+  if (n_layers == 0)
+    return 0;
+
+  if (imx_2d_device_blend_batch(device, dst, layers, n_layers) < 0) {
+    GST_WARNING_OBJECT (imxcomp, "frame blend batch fail");
+    return 0;
+  }
+  imxcomp->submissions++;
+
+  for (i = 0; i < n_layers; i++) {
+    Imx2DFrame *src = &layers[i].src;
+    GstImxCompositorPad *pad = infos[i].pad;
+    GstBuffer *pad_buffer = infos[i].buffer;
+
+    if (layers[i].ret < 0) {
+      GST_WARNING_OBJECT (pad, "frame blend fail");
+      continue;
+    }
+
+    if (!_get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 0)))
+      _set_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 0), src->mem->paddr);
+    if (src->fd[1] >= 0 && !_get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 1)))
+      _set_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 1), src->mem->user_data);
+    if (!_get_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0)))
+      _set_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0), dst->mem->paddr);
+
+    blended++;
+
+    if (layout->composition_meta_enable &&
+      imx_video_overlay_composition_has_meta(pad_buffer)) {
+      VideoCompositionVideoInfo in_v, out_v;
+      memset (&in_v, 0, sizeof(VideoCompositionVideoInfo));
+      memset (&out_v, 0, sizeof(VideoCompositionVideoInfo));
+      in_v.buf = pad_buffer;
+      in_v.fmt = src->info.fmt;
+      in_v.width = src->info.w;
+      in_v.height = src->info.h;
+      in_v.stride = src->info.stride;
+      in_v.rotate = src->rotate;
+      in_v.crop_x = src->crop.x;
+      in_v.crop_y = src->crop.y;
+      in_v.crop_w = src->crop.w;
+      in_v.crop_h = src->crop.h;
+
+      out_v.mem = dst->mem;
+      out_v.fmt = dst->info.fmt;
+      out_v.width = dst->info.w;
+      out_v.height = dst->info.h;
+      out_v.stride = dst->info.stride;
+      out_v.rotate = IMX_2D_ROTATION_0;
+      out_v.crop_x = layers[i].dst_crop.x;
+      out_v.crop_y = layers[i].dst_crop.y;
+      out_v.crop_w = layers[i].dst_crop.w;
+      out_v.crop_h = layers[i].dst_crop.h;
+
+      memcpy(&out_v.align, &(imxcomp->out_align), sizeof(GstVideoAlignment));
+
+      gint cnt = imx_video_overlay_composition_composite(&imxcomp->video_comp,
+                                                        &in_v, &out_v, FALSE);
+
+      if (cnt >= 0)
+        GST_DEBUG ("processed %d video overlay composition buffers", cnt);
+      else
+        GST_WARNING ("video overlay composition meta handling failed");
+    }
+  }
+
+  return blended;
+}
+
 static GstFlowReturn
 gst_imxcompositor_aggregate_frames (GstVideoAggregator * vagg,
                                     GstBuffer * outbuf)
 {
-  GList *l;
   GstImxCompositor *imxcomp = (GstImxCompositor *) (vagg);
   Imx2DDevice *device = imxcomp->device;
-  GstFlowReturn ret;
-  Imx2DFrame src = {0}, dst = {0};
-  PhyMemBlock src_mem = {0}, dst_mem = {0};
-  guint aggregated = 0;
+  Imx2DFrame dst = {0};
+  PhyMemBlock dst_mem = {0};
+  Imx2DBlendLayer *layers;
+  GstImxCompositorLayer *infos;
+  GstImxCompositorLayout layout;
+  guint aggregated = 0, submitted = 0, n_layers = 0, i;
+  gboolean *hidden, *redraw = NULL, complete = TRUE;
+  GArray *area, *bg;
+  guint64 submissions;
+  gint64 start, prepare;
   GstMapInfo map;
   gboolean need_unmap = FALSE;
 
   if (!device)
     return GST_FLOW_ERROR;
 
+  start = g_get_monotonic_time ();
+  submissions = imxcomp->submissions;
+
   dst.mem = &dst_mem;
   if (gst_imxcompositor_config_dst(imxcomp, outbuf, &dst) < 0)
     return GST_FLOW_ERROR;
 
-  if (!dst.mem->vaddr && device->device_type == IMX_2D_DEVICE_PXP) {
+  if (!dst.mem->vaddr
+      && imx_2d_device_get_engine_type (device) == IMX_2D_DEVICE_PXP) {
     if(gst_buffer_map (outbuf, &map, GST_MAP_WRITE)) {
       dst.mem->vaddr = map.data;
       dst.mem->size = map.size;
@@ -1505,142 +2314,108 @@ gst_imxcompositor_aggregate_frames (GstVideoAggregator * vagg,
     }
   }
 
-  GST_OBJECT_LOCK (vagg);
+  gst_imxcompositor_snapshot_layout (imxcomp, &layout);
+
+  area = gst_imxcompositor_damage_region (imxcomp, &layout, &dst,
+      outbuf, &redraw);
+  hidden = gst_imxcompositor_cull_pads (&layout, redraw,
+      area ? area : gst_imxcompositor_output_region (&dst), &bg);
+
+  /* too scattered to fill in pieces, or pieces splitting chroma samples
+   * that would have to grow into pads not redrawn, compose the whole output */
+  if (redraw && layout.background_enable
+      && (bg->len > IMX_COMPOSITOR_MAX_FILL_RECTS
+          || !gst_imxcompositor_region_on_chroma_grid (bg, &dst))) {
+    g_free (redraw);
+    g_free (hidden);
+    g_array_free (bg, TRUE);
+    redraw = NULL;
+    layout.total_pixels = layout.skipped_pixels = 0;
+    hidden = gst_imxcompositor_cull_pads (&layout, NULL,
+        gst_imxcompositor_output_region (&dst), &bg);
+  }
 
-  /* TODO: If the frames to be composited completely obscure the background,
-   * don't bother drawing the background at all. */
-  if (imxcomp->background_enable) {
-    if (device->fill) {
-      if(device->fill (device, &dst, imxcomp->background) < 0) {
-        GST_LOG("fill color background by device failed");
-        gst_imxcompositor_fill_background(&dst, imxcomp->background);
-      }
-    } else {
-      GST_LOG("device has no fill interface");
-      gst_imxcompositor_fill_background(&dst, imxcomp->background);
-    }
+  if (layout.background_enable) {
+    gst_imxcompositor_draw_background (imxcomp, &layout, &dst, bg);
   } else {
     //gst_imxcompositor_fill_background(&dst, DEFAULT_IMXCOMPOSITOR_BACKGROUND);
   }
+  g_array_free (bg, TRUE);
 
-  //re-order by zorder of pad
-  GList *pads = g_list_copy(GST_ELEMENT (vagg)->sinkpads);
-#if !GST_CHECK_VERSION(1, 16, 0)
-  pads = g_list_sort(pads, imxcompositor_pad_zorder_compare);
-#endif
+  layers = g_new0 (Imx2DBlendLayer, layout.n_pads);
+  infos = g_new0 (GstImxCompositorLayer, layout.n_pads);
 
-  for (l = pads; l; l = l->next) {
-    GstVideoAggregatorPad *ppad = l->data;
-    GstImxCompositorPad *pad = GST_IMXCOMPOSITOR_PAD (ppad);
-    GstBuffer *pad_buffer = NULL;
+  if (!dst.mem->paddr)
+    dst.mem->paddr = _get_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0));
 
-#if GST_CHECK_VERSION(1, 16, 0)
-    GstVideoFrame * aggregated_frame = gst_video_aggregator_pad_get_prepared_frame (ppad);
-    if (!aggregated_frame) {
-      pad_buffer = gst_video_aggregator_pad_get_current_buffer (ppad);
-    } else {
-      pad_buffer = aggregated_frame->buffer;
-    }
-#else
-    GstVideoFrame * aggregated_frame = ppad->aggregated_frame;
-    pad_buffer = aggregated_frame->buffer;
-#endif
+  /* all pads share the output buffer, so they are blended as one batch. The
+   * batch is cut after a pad carrying overlay composition meta, its overlay
+   * has to land on the output before the pads above it are blended. An
+   * async device gets the layers in chunks, it blends the first ones while
+   * the next ones are prepared. */
+  for (i = 0; i < layout.n_pads; i++) {
+    GstImxCompositorPadState *state = &layout.pads[i];
+    GstBuffer *pad_buffer = state->buffer;
 
-    if (pad_buffer != NULL && !pad->ignore_composite) {
-      if (gst_buffer_get_size (pad_buffer) == 0 &&
-          GST_BUFFER_FLAG_IS_SET (pad_buffer, GST_BUFFER_FLAG_GAP)) {
-        continue;
-      }
-      src.mem = &src_mem;
-      memset (src.mem, 0, sizeof(PhyMemBlock));
-        GST_WARNING_OBJECT (pad, "set rotate failed %p\n", pad_buffer);
-      if (gst_imxcompositor_config_src(imxcomp, pad, &src) < 0) {
-        continue;
-      }
+    if (pad_buffer == NULL || hidden[i] || (redraw && !redraw[i]))
+      continue;
 
-      if (device->set_rotate(device, src.rotate) < 0) {
-        GST_WARNING_OBJECT (pad, "set rotate failed");
-        continue;
-      }
-      if (device->set_deinterlace(device, IMX_2D_DEINTERLACE_NONE) < 0) {
-        GST_WARNING_OBJECT (pad, "set deinterlace mode failed");
-        continue;
-      }
+    Imx2DBlendLayer *layer = &layers[n_layers];
+    GstImxCompositorLayer *info = &infos[n_layers];
 
-      //update destination location and size
-      dst.crop.x = pad->dst_crop.x;
-      dst.crop.y = pad->dst_crop.y;
-      dst.crop.w = pad->dst_crop.w;
-      dst.crop.h = pad->dst_crop.h;
-
-      if (!src.mem->paddr)
-        src.mem->paddr = _get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 0));
-      if (!src.mem->user_data && src.fd[1] >= 0)
-        src.mem->user_data = _get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 1));
-      if (!dst.mem->paddr)
-        dst.mem->paddr = _get_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0));
-
-      if (device->blend(device, &dst, &src) < 0) {
-        GST_WARNING_OBJECT (pad, "frame blend fail");
-        continue;
-      }
+    prepare = g_get_monotonic_time ();
+    memset (layer, 0, sizeof(Imx2DBlendLayer));
+    memset (info, 0, sizeof(GstImxCompositorLayer));
+    layer->src.mem = &info->mem;
+    if (gst_imxcompositor_config_src(imxcomp, state, &layer->src) < 0) {
+      complete = FALSE;
+      continue;
+    }
 
-      if (!_get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 0)))
-        _set_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 0), src.mem->paddr);
-      if (src.fd[1] >= 0 && !_get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 1)))
-        _set_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 1), src.mem->user_data);
-      if (!_get_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0)))
-        _set_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0), dst.mem->paddr);
-
-      aggregated++;
-
-      if (imxcomp->composition_meta_enable &&
-        imx_video_overlay_composition_has_meta(pad_buffer)) {
-        VideoCompositionVideoInfo in_v, out_v;
-        memset (&in_v, 0, sizeof(VideoCompositionVideoInfo));
-        memset (&out_v, 0, sizeof(VideoCompositionVideoInfo));
-        in_v.buf = pad_buffer;
-        in_v.fmt = src.info.fmt;
-        in_v.width = src.info.w;
-        in_v.height = src.info.h;
-        in_v.stride = src.info.stride;
-        in_v.rotate = src.rotate;
-        in_v.crop_x = src.crop.x;
-        in_v.crop_y = src.crop.y;
-        in_v.crop_w = src.crop.w;
-        in_v.crop_h = src.crop.h;
-
-        out_v.mem = dst.mem;
-        out_v.fmt = dst.info.fmt;
-        out_v.width = dst.info.w;
-        out_v.height = dst.info.h;
-        out_v.stride = dst.info.stride;
-        out_v.rotate = IMX_2D_ROTATION_0;
-        out_v.crop_x = dst.crop.x;
-        out_v.crop_y = dst.crop.y;
-        out_v.crop_w = dst.crop.w;
-        out_v.crop_h = dst.crop.h;
-
-        memcpy(&out_v.align, &(imxcomp->out_align), sizeof(GstVideoAlignment));
-
-        gint cnt = imx_video_overlay_composition_composite(&imxcomp->video_comp,
-                                                          &in_v, &out_v, FALSE);
-
-        if (cnt >= 0)
-          GST_DEBUG ("processed %d video overlay composition buffers", cnt);
-        else
-          GST_WARNING ("video overlay composition meta handling failed");
-      }
+    //destination location and size of this pad
+    layer->dst_crop.x = state->dst_crop.x;
+    layer->dst_crop.y = state->dst_crop.y;
+    layer->dst_crop.w = state->dst_crop.w;
+    layer->dst_crop.h = state->dst_crop.h;
+
+    if (!layer->src.mem->paddr)
+      layer->src.mem->paddr = _get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 0));
+    if (!layer->src.mem->user_data && layer->src.fd[1] >= 0)
+      layer->src.mem->user_data = _get_cached_phyaddr (gst_buffer_peek_memory (pad_buffer, 1));
+
+    info->pad = state->pad;
+    info->buffer = pad_buffer;
+    n_layers++;
+    imxcomp->prepare_time += g_get_monotonic_time () - prepare;
+    imxcomp->prepared_pads++;
+
+    if ((layout.composition_meta_enable &&
+          imx_video_overlay_composition_has_meta(pad_buffer))
+        || (imxcomp->async && n_layers == IMX_COMPOSITOR_BLEND_CHUNK)) {
+      aggregated += gst_imxcompositor_blend_layers (imxcomp, &layout, outbuf,
+          &dst, layers, infos, n_layers);
+      submitted += n_layers;
+      n_layers = 0;
     }
   }
 
-  g_list_free(pads);
+  aggregated += gst_imxcompositor_blend_layers (imxcomp, &layout, outbuf,
+      &dst, layers, infos, n_layers);
+  submitted += n_layers;
+  if (aggregated < submitted)
+    complete = FALSE;
+
+  g_free (layers);
+  g_free (infos);
+  g_free (hidden);
+  g_free (redraw);
 
-  if (imxcomp->background_enable &&
-      device->device_type == IMX_2D_DEVICE_PXP && aggregated == 0) {
+  if (layout.background_enable &&
+      imx_2d_device_get_engine_type (device) == IMX_2D_DEVICE_PXP
+      && aggregated == 0) {
     /* PXP can't fill background without blending something */
     /* fill the background color by software */
-    gst_imxcompositor_fill_background(&dst, imxcomp->background);
+    gst_imxcompositor_fill_background(&dst, layout.background);
   }
 
   if (need_unmap)
@@ -1649,10 +2424,35 @@ gst_imxcompositor_aggregate_frames (GstVideoAggregator * vagg,
   GST_LOG("Aggregated %d frames", aggregated);
   if (aggregated > 0 && device->blend_finish(device) < 0) {
     GST_ERROR ("frame blend finish fail");
+    complete = FALSE;
   }
+  /* a background fill alone may still be queued on an async device */
+  if (imx_2d_device_wait_fence(device, imx_2d_device_get_fence(device)) < 0) {
+    GST_ERROR ("wait for 2D device fence fail");
+    complete = FALSE;
+  }
+
+  /* only a fully composed output can be redrawn from the damage since, a
+   * failed one is composed again in full next time */
+  if (layout.damage_tracking)
+    gst_mini_object_set_qdata (
+        GST_MINI_OBJECT (gst_buffer_peek_memory (outbuf, 0)),
+        g_quark_from_static_string ("imxcompositor-seq"),
+        complete ? GUINT_TO_POINTER (imxcomp->damage.seq) : NULL, NULL);
 
+  gst_imxcompositor_clear_layout (&layout);
+
+  GST_OBJECT_LOCK (vagg);
+  imxcomp->total_pixels += layout.total_pixels;
+  imxcomp->skipped_pixels += layout.skipped_pixels;
   GST_OBJECT_UNLOCK (vagg);
 
+  imxcomp->frames++;
+  imxcomp->total_time += g_get_monotonic_time () - start;
+  GST_LOG ("frame composed with %" G_GUINT64_FORMAT " submissions in %"
+      G_GINT64_FORMAT " us", imxcomp->submissions - submissions,
+      g_get_monotonic_time () - start);
+
   return GST_FLOW_OK;
 }
 
@@ -1687,6 +2487,15 @@ static GstCaps* imx_compositor_caps_from_fmt_list(GList* list, gboolean is_input
 }
 
 #if GST_CHECK_VERSION (1, 16, 0)
+/* the zorder property belongs to the base pad class, it is only seen
+ * through its notification */
+static void
+gst_imxcompositor_pad_zorder_changed (GObject * pad, GParamSpec * pspec,
+    gpointer user_data)
+{
+  GST_IMX_COMPOSITOR_LAYOUT_CHANGED (user_data);
+}
+
 static GstPad *
 gst_imxcompositor_request_new_pad (GstElement * element, GstPadTemplate * templ,
     const gchar * req_name, const GstCaps * caps)
@@ -1700,6 +2509,9 @@ gst_imxcompositor_request_new_pad (GstElement * element, GstPadTemplate * templ,
   if (newpad == NULL)
     goto could_not_create;
 
+  g_signal_connect (newpad, "notify::zorder",
+      G_CALLBACK (gst_imxcompositor_pad_zorder_changed), element);
+
   gst_child_proxy_child_added (GST_CHILD_PROXY (element), G_OBJECT (newpad),
       GST_OBJECT_NAME (newpad));
 
@@ -1840,6 +2652,8 @@ gst_imxcompositor_class_init (GstImxCompositorClass * klass)
   agg_class->sinkpads_type = GST_TYPE_IMXCOMPOSITOR_PAD;
   videoaggregator_class->negotiated_caps = gst_imxcompositor_negotiated_caps;
 #endif
+  agg_class->start = gst_imxcompositor_start;
+  agg_class->sink_event = gst_imxcompositor_sink_event;
   agg_class->sink_query = gst_imxcompositor_sink_query;
   agg_class->src_query = gst_imxcompositor_src_query;
 
@@ -1871,6 +2685,35 @@ gst_imxcompositor_class_init (GstImxCompositorClass * klass)
         IMX_COMPOSITOR_COMPOMETA_DEFAULT,
         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class,
+      PROP_IMXCOMPOSITOR_DEVICE_SELECTION,
+      g_param_spec_string("device-selection", "Device selection",
+        "Output format chosen at negotiation and its measured blend cost",
+        NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class,
+      PROP_IMXCOMPOSITOR_SKIPPED_PIXELS,
+      g_param_spec_uint64("skipped-pixels", "Skipped pixels",
+        "Number of output and pad pixels not drawn because opaque pads "
+        "cover them or they are unchanged since the output buffer was last "
+        "composed",
+        0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class,
+      PROP_IMXCOMPOSITOR_DAMAGE_TRACKING,
+      g_param_spec_boolean("damage-tracking", "Damage tracking",
+        "Only redraw the parts of a recycled output buffer that changed "
+        "since it was composed, downstream must not modify output buffers",
+        IMX_COMPOSITOR_DAMAGE_TRACKING_DEFAULT,
+        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class,
+      PROP_IMXCOMPOSITOR_DEVICE_STATS,
+      g_param_spec_boxed("device-stats", "Device statistics",
+        "2D device session counters: operations, busy, wait and active "
+        "time in microseconds, and sessions sharing the device",
+        GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
 #if 0
   g_object_class_install_property (gobject_class,
       PROP_IMXCOMPOSITOR_OUTPUT_WIDTH,
@@ -1890,11 +2733,16 @@ gst_imxcompositor_init (GstImxCompositor * imxcomp)
 {
   imxcomp->background = DEFAULT_IMXCOMPOSITOR_BACKGROUND;
   imxcomp->background_enable = TRUE;
+  imxcomp->damage_tracking = IMX_COMPOSITOR_DAMAGE_TRACKING_DEFAULT;
+  imxcomp->layout_cookie = 1;
+  imxcomp->layout_pads = NULL;
+  imxcomp->damage.layout = g_array_new (FALSE, FALSE,
+      sizeof (GstImxCompositorDamageEntry));
   GstImxCompositorClass *klass =
       (GstImxCompositorClass *) G_OBJECT_GET_CLASS (imxcomp);
 
   if (klass->in_plugin)
-    imxcomp->device = klass->in_plugin->create(klass->in_plugin->device_type);
+    imxcomp->device = imx_2d_device_create(klass->in_plugin->device_type);
 
   if (imxcomp->device) {
     if (imxcomp->device->open(imxcomp->device) < 0) {
@@ -1905,6 +2753,7 @@ gst_imxcompositor_init (GstImxCompositor * imxcomp)
       imxcomp->out_pool_update = TRUE;
       imxcomp->allocator = NULL;
       imxcomp->capabilities =imxcomp->device->get_capabilities(imxcomp->device);
+      imxcomp->async = imx_2d_device_set_async(imxcomp->device, TRUE);
       memset (&imxcomp->out_align, 0, sizeof(GstVideoAlignment));
       imxcomp->composition_meta_enable = IMX_COMPOSITOR_COMPOMETA_DEFAULT;
       imx_video_overlay_composition_init(&imxcomp->video_comp, imxcomp->device);
@@ -1935,6 +2784,7 @@ static gboolean gst_imx_compositor_register (GstPlugin * plugin)
 #endif
 
   GType type;
+  guint rank;
   gchar *t_name;
 
   const Imx2DDeviceInfo *in_plugin = imx_get_2d_devices();
@@ -1977,7 +2827,11 @@ static gboolean gst_imx_compositor_register (GstPlugin * plugin)
 #endif
     }
 
-    if (!gst_element_register (plugin, t_name, IMX_GST_PLUGIN_RANK, type)) {
+    /* split and sw stand in for the real engines, never autoplug them */
+    rank = (in_plugin->device_type == IMX_2D_DEVICE_SPLIT
+        || in_plugin->device_type == IMX_2D_DEVICE_SW) ?
+        GST_RANK_NONE : IMX_GST_PLUGIN_RANK;
+    if (!gst_element_register (plugin, t_name, rank, type)) {
       GST_ERROR ("Failed to register %s", t_name);
       g_free (t_name);
       return FALSE;
@@ -34,6 +34,28 @@ G_BEGIN_DECLS
 typedef struct _GstImxCompositor GstImxCompositor;
 typedef struct _GstImxCompositorClass GstImxCompositorClass;
 
+/* compositions whose damage is remembered, an output buffer last composed
+ * longer ago than that is redrawn completely */
+#define IMX_COMPOSITOR_DAMAGE_HISTORY   4
+
+/* a pad property, the caps of a pad or of the output, or the z-order
+ * changed, the cached pad order and pad geometry are recomputed */
+#define GST_IMX_COMPOSITOR_LAYOUT_CHANGED(comp) \
+    g_atomic_int_inc (&((GstImxCompositor *) (comp))->layout_cookie)
+
+/* output damage tracking, see gst_imxcompositor_damage_region */
+typedef struct {
+  guint seq;
+  /* pads drawn by the last composition, in z-order */
+  GArray *layout;
+  /* damaged rectangles of the last compositions, NULL if all changed */
+  GArray *history[IMX_COMPOSITOR_DAMAGE_HISTORY];
+  Imx2DVideoInfo info;
+  Imx2DCrop crop;
+  guint background;
+  gboolean background_enable;
+} GstImxCompositorDamage;
+
 struct _GstImxCompositor
 {
   GstVideoAggregator videoaggregator;
@@ -50,6 +72,30 @@ struct _GstImxCompositor
   gint capabilities;
   GstImxVideoOverlayComposition video_comp;
   gboolean composition_meta_enable;
+  guint64 frames;
+  guint64 submissions;
+  gint64 total_time;
+  /* pixels left out by the visibility pass and pixels it considered */
+  guint64 skipped_pixels;
+  guint64 total_pixels;
+  gboolean damage_tracking;
+  GstImxCompositorDamage damage;
+  /* device queues blits, layers are submitted in chunks */
+  gboolean async;
+  /* time spent waiting for and holding the object lock per composition */
+  gint64 lock_wait_time;
+  gint64 lock_hold_time;
+  /* time spent preparing the pads for the device */
+  gint64 prepare_time;
+  guint64 prepared_pads;
+  /* bumped by GST_IMX_COMPOSITOR_LAYOUT_CHANGED */
+  gint layout_cookie;
+  /* sink pads in z-order, valid for layout_built and layout_pads_cookie */
+  GPtrArray *layout_pads;
+  guint layout_built;
+  guint32 layout_pads_cookie;
+  guint64 layout_rebuilds;
+  gchar *selection;
 };
 
 struct _GstImxCompositorClass
@@ -97,6 +97,7 @@ gst_imxcompositor_pad_get_property (GObject * object, guint prop_id,
 {
   GstImxCompositorPad *pad = GST_IMXCOMPOSITOR_PAD (object);
 
+  GST_OBJECT_LOCK (pad);
   switch (prop_id) {
     case PROP_IMXCOMPOSITOR_PAD_XPOS:
       g_value_set_int (value, pad->xpos);
@@ -114,15 +115,7 @@ gst_imxcompositor_pad_get_property (GObject * object, guint prop_id,
       g_value_set_enum (value, pad->rotate);
       break;
     case PROP_IMXCOMPOSITOR_PAD_ALPHA:
-    {
-      GstImxCompositor* comp = (GstImxCompositor*)gst_pad_get_parent(pad);
-      if (comp->capabilities & IMX_2D_DEVICE_CAP_ALPHA) {
-        g_value_set_double (value, pad->alpha);
-      } else {
-        g_value_set_double (value, 1.0);
-        g_print("!This device don't support alpha blending!\n");
-      }
-    }
+      g_value_set_double (value, pad->alpha);
       break;
     case PROP_IMXCOMPOSITOR_PAD_KEEP_RATIO:
       g_value_set_boolean(value, pad->keep_ratio);
@@ -131,14 +124,25 @@ gst_imxcompositor_pad_get_property (GObject * object, guint prop_id,
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  GST_OBJECT_UNLOCK (pad);
 }
 
+/* The pad fields are read by the compositor under the pad object lock, the
+ * compositor itself is not locked so a property change does not wait for the
+ * composition in progress. */
 static void
 gst_imxcompositor_pad_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstImxCompositorPad *pad = GST_IMXCOMPOSITOR_PAD (object);
+  GstImxCompositor* comp = (GstImxCompositor*)gst_pad_get_parent(pad);
+  gboolean update_conversion = FALSE;
+  gint capabilities = IMX_2D_DEVICE_CAP_ALPHA;
 
+  if (comp)
+    capabilities = comp->capabilities;
+
+  GST_OBJECT_LOCK (pad);
   switch (prop_id) {
     case PROP_IMXCOMPOSITOR_PAD_XPOS:
       pad->xpos = g_value_get_int (value);
@@ -147,31 +151,21 @@ gst_imxcompositor_pad_set_property (GObject * object, guint prop_id,
       pad->ypos = g_value_get_int (value);
       break;
     case PROP_IMXCOMPOSITOR_PAD_ALPHA:
-    {
-      GstImxCompositor* comp = (GstImxCompositor*)gst_pad_get_parent(pad);
-      if (comp->capabilities & IMX_2D_DEVICE_CAP_ALPHA) {
+      if (capabilities & IMX_2D_DEVICE_CAP_ALPHA) {
         pad->alpha = g_value_get_double (value);
       } else {
         pad->alpha = 1.0;
         g_print("!This device don't support alpha blending, "
             "pad alpha setting will be ignored!\n");
       }
-      gst_object_unref(comp);
-    }
       break;
     case PROP_IMXCOMPOSITOR_PAD_WIDTH:
       pad->width = g_value_get_int (value);
-#if GST_CHECK_VERSION(1, 16, 0)
-      gst_video_aggregator_convert_pad_update_conversion_info
-          (GST_VIDEO_AGGREGATOR_CONVERT_PAD (pad));
-#endif
+      update_conversion = TRUE;
       break;
     case PROP_IMXCOMPOSITOR_PAD_HEIGHT:
       pad->height = g_value_get_int (value);
-#if GST_CHECK_VERSION(1, 16, 0)
-      gst_video_aggregator_convert_pad_update_conversion_info
-          (GST_VIDEO_AGGREGATOR_CONVERT_PAD (pad));
-#endif
+      update_conversion = TRUE;
       break;
     case PROP_IMXCOMPOSITOR_PAD_ROTATE:
       pad->rotate = g_value_get_enum (value);
@@ -183,6 +177,19 @@ gst_imxcompositor_pad_set_property (GObject * object, guint prop_id,
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  GST_OBJECT_UNLOCK (pad);
+
+  if (update_conversion) {
+#if GST_CHECK_VERSION(1, 16, 0)
+    gst_video_aggregator_convert_pad_update_conversion_info
+        (GST_VIDEO_AGGREGATOR_CONVERT_PAD (pad));
+#endif
+  }
+
+  if (comp) {
+    GST_IMX_COMPOSITOR_LAYOUT_CHANGED (comp);
+    gst_object_unref(comp);
+  }
 }
 
 static void
@@ -318,6 +325,8 @@ gst_imxcompositor_pad_create_conversion_info (GstVideoAggregatorConvertPad * pad
     cpad->info = *conversion_info;
     GST_DEBUG_OBJECT (pad, "This pad will not need scale");
   }
+
+  GST_IMX_COMPOSITOR_LAYOUT_CHANGED (comp);
 }
 #else
 static gboolean
@@ -372,6 +381,7 @@ gst_imxcompositor_pad_set_info (GstVideoAggregatorPad * pad,
     cpad->info = *current_info;
     GST_DEBUG_OBJECT (pad, "This pad will not need conversion");
   }
+  GST_IMX_COMPOSITOR_LAYOUT_CHANGED (comp);
   g_free (colorimetry);
   g_free (best_colorimetry);
 
@@ -404,41 +414,53 @@ clamp_rectangle (GstVideoRectangle rect, gint outer_width, gint outer_height)
   return clamped;
 }
 
-#if GST_CHECK_VERSION(1, 16, 0)
+/* Source and destination rectangles of the pad, from its position, size,
+ * rotation and keep-ratio, the input crop and the output size. They only
+ * change with the compositor layout cookie or the crop meta of the input,
+ * so the last result is reused as long as both stay the same. Returns FALSE
+ * when the pad draws nothing. */
 static gboolean
-gst_imxcompositor_pad_prepare_frame (GstVideoAggregatorPad * pad, GstVideoAggregator * vagg,
-      GstBuffer * buffer, GstVideoFrame * prepared_frame)
+gst_imxcompositor_pad_update_geometry (GstVideoAggregator * vagg,
+    GstImxCompositorPad * cpad, GstBuffer * buffer)
 {
   GstImxCompositor *imxcomp = (GstImxCompositor *)(vagg);
-  GstImxCompositorPad *cpad = (GstImxCompositorPad *)(pad);
-  GstVideoFrame frame;
-  gint width, height;
-  GstVideoRectangle video_area;
-  GstVideoRectangle clamp;
-  gint o_width, o_height;
+  GstVideoAggregatorPad *pad = (GstVideoAggregatorPad *)(cpad);
+  GstVideoRectangle video_area, clamp, crop = {0};
   GstVideoCropMeta *in_crop = NULL;
+  gint width, height, o_width, o_height;
+  guint cookie;
 
-  cpad->ignore_composite = TRUE;
+  cookie = (guint) g_atomic_int_get (&imxcomp->layout_cookie);
+  in_crop = gst_buffer_get_video_crop_meta(buffer);
+  if (in_crop != NULL) {
+    crop.x = in_crop->x;
+    crop.y = in_crop->y;
+    crop.w = in_crop->width;
+    crop.h = in_crop->height;
+  }
 
-  gst_imxcompositor_pad_get_output_size (vagg, cpad, &width, &height);
+  if (cpad->geometry_cookie == cookie
+      && cpad->geometry_has_crop == (in_crop != NULL)
+      && memcmp (&cpad->geometry_crop, &crop, sizeof (GstVideoRectangle)) == 0)
+    return cpad->geometry_visible;
 
-  if (cpad->alpha == 0.0) {
-    GST_DEBUG_OBJECT (vagg, "Pad has alpha 0.0, not converting frame");
-    return TRUE;
-  }
+  cpad->geometry_cookie = cookie;
+  cpad->geometry_has_crop = (in_crop != NULL);
+  cpad->geometry_crop = crop;
+  cpad->geometry_visible = FALSE;
+
+  gst_imxcompositor_pad_get_output_size (vagg, cpad, &width, &height);
 
   cpad->src_crop.x = 0;
   cpad->src_crop.y = 0;
   cpad->src_crop.w = GST_VIDEO_INFO_WIDTH (&pad->info);
   cpad->src_crop.h = GST_VIDEO_INFO_HEIGHT (&pad->info);
 
-  in_crop = gst_buffer_get_video_crop_meta(buffer);
   if (in_crop != NULL) {
     GST_LOG_OBJECT (pad, "input crop meta: (%d, %d, %d, %d)",
         in_crop->x, in_crop->y, in_crop->width, in_crop->height);
-    if ((in_crop->x >= cpad->src_crop.w) || (in_crop->y >= cpad->src_crop.h)) {
-      return TRUE;
-    }
+    if ((in_crop->x >= cpad->src_crop.w) || (in_crop->y >= cpad->src_crop.h))
+      return FALSE;
 
     cpad->src_crop.x = in_crop->x;
     cpad->src_crop.y = in_crop->y;
@@ -489,7 +511,7 @@ gst_imxcompositor_pad_prepare_frame (GstVideoAggregatorPad * pad, GstVideoAggreg
   if (clamp.w == 0 || clamp.h == 0) {
     GST_DEBUG_OBJECT (vagg, "Resulting frame is zero-width or zero-height "
         "(w: %i, h: %i), skipping", clamp.w, clamp.h);
-    return TRUE;
+    return FALSE;
   }
 
   cpad->dst_crop = clamp;
@@ -500,8 +522,37 @@ gst_imxcompositor_pad_prepare_frame (GstVideoAggregatorPad * pad, GstVideoAggreg
   cpad->src_crop.w = cpad->dst_crop.w * cpad->src_crop.w / video_area.w;
   cpad->src_crop.h = cpad->dst_crop.h * cpad->src_crop.h / video_area.h;
 
+  GST_LOG_OBJECT (pad, "geometry updated, src (%d,%d,%d,%d) dst (%d,%d,%d,%d)",
+      cpad->src_crop.x, cpad->src_crop.y, cpad->src_crop.w, cpad->src_crop.h,
+      cpad->dst_crop.x, cpad->dst_crop.y, cpad->dst_crop.w, cpad->dst_crop.h);
+  cpad->geometry_visible = TRUE;
+  return TRUE;
+}
+
+#if GST_CHECK_VERSION(1, 16, 0)
+static gboolean
+gst_imxcompositor_pad_prepare_frame (GstVideoAggregatorPad * pad, GstVideoAggregator * vagg,
+      GstBuffer * buffer, GstVideoFrame * prepared_frame)
+{
+  GstImxCompositor *imxcomp = (GstImxCompositor *)(vagg);
+  GstImxCompositorPad *cpad = (GstImxCompositorPad *)(pad);
+  GstVideoFrame frame;
+
+  cpad->ignore_composite = TRUE;
+
+  if (cpad->alpha == 0.0) {
+    GST_DEBUG_OBJECT (vagg, "Pad has alpha 0.0, not converting frame");
+    return TRUE;
+  }
+
+  if (!gst_imxcompositor_pad_update_geometry (vagg, cpad, buffer))
+    return TRUE;
+
 #ifdef ENABLE_OBSCURED_CHECKING
   gboolean frame_obscured = FALSE;
+  GstVideoRectangle clamp = cpad->dst_crop;
+  gint o_width = GST_VIDEO_INFO_WIDTH (&vagg->info);
+  gint o_height = GST_VIDEO_INFO_HEIGHT (&vagg->info);
   GList *l;
 
   GST_OBJECT_LOCK (vagg);
@@ -667,102 +718,28 @@ gst_imxcompositor_pad_prepare_frame (GstVideoAggregatorPad * pad,
   GstImxCompositor *imxcomp = (GstImxCompositor *)(vagg);
   GstImxCompositorPad *cpad = (GstImxCompositorPad *)(pad);
   GstVideoFrame *frame;
-  gint width, height;
-  GstVideoRectangle video_area;
-  GstVideoRectangle clamp;
-  gint o_width, o_height;
-  GstVideoCropMeta *in_crop = NULL;
 
   if (!pad->buffer)
     return TRUE;
 
   cpad->ignore_composite = FALSE;
 
-  gst_imxcompositor_pad_get_output_size (vagg, cpad, &width, &height);
-
   if (cpad->alpha == 0.0) {
     GST_DEBUG_OBJECT (vagg, "Pad has alpha 0.0, not converting frame");
     pad->aggregated_frame = NULL;
     return TRUE;
   }
 
-  cpad->src_crop.x = 0;
-  cpad->src_crop.y = 0;
-  cpad->src_crop.w = GST_VIDEO_INFO_WIDTH (&pad->info);
-  cpad->src_crop.h = GST_VIDEO_INFO_HEIGHT (&pad->info);
-
-  in_crop = gst_buffer_get_video_crop_meta(pad->buffer);
-  if (in_crop != NULL) {
-    GST_LOG_OBJECT (pad, "input crop meta: (%d, %d, %d, %d)",
-        in_crop->x, in_crop->y, in_crop->width, in_crop->height);
-    if ((in_crop->x >= cpad->src_crop.w) || (in_crop->y >= cpad->src_crop.h)) {
-      pad->aggregated_frame = NULL;
-      return TRUE;
-    }
-
-    cpad->src_crop.x = in_crop->x;
-    cpad->src_crop.y = in_crop->y;
-    cpad->src_crop.w = MIN(in_crop->width, (cpad->src_crop.w - in_crop->x));
-    cpad->src_crop.h = MIN(in_crop->height, (cpad->src_crop.h - in_crop->y));
-  }
-
-  video_area.x = cpad->xpos;
-  video_area.y = cpad->ypos;
-  video_area.w = width;
-  video_area.h = height;
-
-  if (cpad->keep_ratio) {
-    GstVideoRectangle s_rect, d_rect, result;
-    s_rect.x = s_rect.y = 0;
-    s_rect.w = cpad->src_crop.w;
-    s_rect.h = cpad->src_crop.h;
-    d_rect.x = d_rect.y = 0;
-    d_rect.w = width;
-    d_rect.h = height;
-    if (cpad->rotate == IMX_2D_ROTATION_90 ||
-        cpad->rotate == IMX_2D_ROTATION_270) {
-      gint tmp = d_rect.w;
-      d_rect.w = d_rect.h;
-      d_rect.h = tmp;
-    }
-
-    gst_video_sink_center_rect (s_rect, d_rect, &result, TRUE);
-
-    if (cpad->rotate == IMX_2D_ROTATION_90 ||
-        cpad->rotate == IMX_2D_ROTATION_270) {
-      video_area.x += result.y;
-      video_area.y += result.x;
-      video_area.w = result.h;
-      video_area.h = result.w;
-    } else {
-      video_area.x += result.x;
-      video_area.y += result.y;
-      video_area.w = result.w;
-      video_area.h = result.h;
-    }
-  }
-
-  o_width = GST_VIDEO_INFO_WIDTH (&vagg->info);
-  o_height = GST_VIDEO_INFO_HEIGHT (&vagg->info);
-  clamp = clamp_rectangle (video_area, o_width, o_height);
-
-  if (clamp.w == 0 || clamp.h == 0) {
-    GST_DEBUG_OBJECT (vagg, "Resulting frame is zero-width or zero-height "
-        "(w: %i, h: %i), skipping", clamp.w, clamp.h);
+  if (!gst_imxcompositor_pad_update_geometry (vagg, cpad, pad->buffer)) {
     pad->aggregated_frame = NULL;
     return TRUE;
   }
 
-  cpad->dst_crop = clamp;
-  cpad->src_crop.x = cpad->src_crop.x +
-         (cpad->dst_crop.x - video_area.x) * cpad->src_crop.w / video_area.w;
-  cpad->src_crop.y = cpad->src_crop.y +
-         (cpad->dst_crop.y - video_area.y) * cpad->src_crop.h / video_area.h;
-  cpad->src_crop.w = cpad->dst_crop.w * cpad->src_crop.w / video_area.w;
-  cpad->src_crop.h = cpad->dst_crop.h * cpad->src_crop.h / video_area.h;
-
 #ifdef ENABLE_OBSCURED_CHECKING
   gboolean frame_obscured = FALSE;
+  GstVideoRectangle clamp = cpad->dst_crop;
+  gint o_width = GST_VIDEO_INFO_WIDTH (&vagg->info);
+  gint o_height = GST_VIDEO_INFO_HEIGHT (&vagg->info);
   GList *l;
 
   GST_OBJECT_LOCK (vagg);
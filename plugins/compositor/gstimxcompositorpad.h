@@ -71,6 +71,13 @@ struct _GstImxCompositorPad
   gdouble alpha;
   gboolean keep_ratio;
   gboolean ignore_composite;
+
+  /* src_crop and dst_crop were computed for this layout cookie and input
+   * crop, see gst_imxcompositor_pad_update_geometry */
+  guint geometry_cookie;
+  gboolean geometry_has_crop;
+  GstVideoRectangle geometry_crop;
+  gboolean geometry_visible;
 };
 
 struct _GstImxCompositorPadClass
@@ -485,7 +485,6 @@ gst_imx_fbdevsink_show_frame (GstVideoSink * videosink, GstBuffer * buf)
   GstMemory *in_mem;
   GstVideoCropMeta *cropmeta = NULL;
   guintptr phys_addr = 0;;
-  gint dma_fd;
 
   fbdevsink = GST_IMX_FBDEVSINK (videosink);
  
@@ -509,8 +508,7 @@ gst_imx_fbdevsink_show_frame (GstVideoSink * videosink, GstBuffer * buf)
   if (gst_buffer_is_phymem (buf)) { 
     phys_addr = gst_phys_memory_get_phys_addr (in_mem);
   } else if (gst_is_dmabuf_memory (in_mem)){
-    dma_fd = gst_dmabuf_memory_get_fd (in_mem);
-    phys_addr = phy_addr_from_fd (dma_fd);
+    phys_addr = phy_addr_from_dmabuf_memory (in_mem);
   } else { /* allocate dmabuf from buffer pool */
     GstBuffer *temp = NULL;
     GstVideoFrame frame1, frame2;
@@ -561,8 +559,7 @@ gst_imx_fbdevsink_show_frame (GstVideoSink * videosink, GstBuffer * buf)
     gst_buffer_unref (buf);
     buf = temp;
     in_mem = gst_buffer_peek_memory (buf, 0);
-    dma_fd = gst_dmabuf_memory_get_fd (in_mem);
-    phys_addr = phy_addr_from_fd (dma_fd);
+    phys_addr = phy_addr_from_dmabuf_memory (in_mem);
   }
 
   /* config video geo and direction */
@@ -35,8 +35,14 @@
 #endif
 #include <gst/allocators/gstphymemmeta.h>
 #include "gstimxvideoconvert.h"
+#include "gstimxvideoconvertmulti.h"
+#include "imx_2d_device_cost.h"
 
 #define IMX_VCT_IN_POOL_MAX_BUFFERS   30
+/* staged frames timed before choosing the staging depth */
+#define IMX_VCT_STAGING_PROBE_FRAMES  16
+/* pipeline the staging copy only if it saves at least 1/N of a frame */
+#define IMX_VCT_STAGING_MIN_GAIN      8
 
 #define GST_IMX_VCT_PARAMS_QDATA   g_quark_from_static_string("imxvct-params")
 
@@ -70,7 +76,11 @@ enum {
   PROP_DEINTERLACE_MODE,
   PROP_COMPOSITION_META_ENABLE,
   PROP_COMPOSITION_META_IN_PLACE,
-  PROP_VIDEOCROP_META_ENABLE
+  PROP_VIDEOCROP_META_ENABLE,
+  PROP_DEVICE_SELECTION,
+  PROP_STAGED_FRAMES,
+  PROP_PASSTHROUGH_FRAMES,
+  PROP_DEVICE_STATS
 };
 
 static GstElementClass *parent_class = NULL;
@@ -183,6 +193,25 @@ static void gst_imx_video_convert_get_property (GObject * object,
     case PROP_VIDEOCROP_META_ENABLE:
       g_value_set_boolean(value, imxvct->videocrop_meta_enable);
       break;
+    case PROP_DEVICE_SELECTION:
+      GST_OBJECT_LOCK (imxvct);
+      g_value_set_string(value, imxvct->selection);
+      GST_OBJECT_UNLOCK (imxvct);
+      break;
+    case PROP_STAGED_FRAMES:
+      GST_OBJECT_LOCK (imxvct);
+      g_value_set_uint64(value, imxvct->staged_frames);
+      GST_OBJECT_UNLOCK (imxvct);
+      break;
+    case PROP_PASSTHROUGH_FRAMES:
+      GST_OBJECT_LOCK (imxvct);
+      g_value_set_uint64(value, imxvct->passthrough_frames);
+      GST_OBJECT_UNLOCK (imxvct);
+      break;
+    case PROP_DEVICE_STATS:
+      g_value_take_boxed(value,
+          imx_2d_device_get_session_stats_structure(device));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -193,23 +222,27 @@ static void gst_imx_video_convert_finalize (GObject * object)
 {
   GstImxVideoConvert *imxvct = (GstImxVideoConvert *) (object);
   GstStructure *config;
-  GstImxVideoConvertClass *klass =
-        (GstImxVideoConvertClass *) G_OBJECT_GET_CLASS (imxvct);
+  guint64 hits, misses;
+  guint entries;
+
+  phy_addr_cache_get_stats (&hits, &misses, &entries);
+  GST_INFO ("physical address cache: %" G_GUINT64_FORMAT " hits, %"
+      G_GUINT64_FORMAT " misses, %u entries", hits, misses, entries);
 
   imx_video_overlay_composition_deinit(&imxvct->video_comp);
+  g_free (imxvct->selection);
 
-  GST_IMX_CONVERT_UNREF_BUFFER (imxvct->in_buf);
   GST_IMX_CONVERT_UNREF_POOL (imxvct->in_pool);
   GST_IMX_CONVERT_UNREF_POOL (imxvct->self_out_pool);
   if (imxvct->allocator) {
+    gst_imx_2d_device_allocator_flush (imxvct->allocator);
     gst_object_unref (imxvct->allocator);
     imxvct->allocator = NULL;
   }
 
   if (imxvct->device) {
     imxvct->device->close(imxvct->device);
-    if (klass->in_plugin)
-      klass->in_plugin->destroy(imxvct->device);
+    imx_2d_device_destroy(imxvct->device);
     imxvct->device = NULL;
   }
 
@@ -219,6 +252,7 @@ static void gst_imx_video_convert_finalize (GObject * object)
 static gboolean
 imx_video_convert_src_event(GstBaseTransform *transform, GstEvent *event)
 {
+  GstImxVideoConvert *imxvct = (GstImxVideoConvert *) (transform);
   gdouble a;
   GstStructure *structure;
   GstVideoFilter *filter = GST_VIDEO_FILTER_CAST(transform);
@@ -250,6 +284,15 @@ imx_video_convert_src_event(GstBaseTransform *transform, GstEvent *event)
         }
       }
       break;
+    case GST_EVENT_RECONFIGURE:
+      /* base transform skips the allocation query while in passthrough,
+       * leave it so decide_allocation checks the videocrop meta again */
+      if (imxvct->crop_passthrough
+          && gst_base_transform_is_passthrough(transform)) {
+        GST_DEBUG_OBJECT(imxvct, "reconfigure, query videocrop meta again");
+        gst_base_transform_set_passthrough(transform, FALSE);
+      }
+      break;
     default:
       break;
   }
@@ -287,8 +330,8 @@ static GstCaps* imx_video_convert_transform_caps(GstBaseTransform *transform,
       gst_structure_set(st, "width", GST_TYPE_INT_RANGE, 8, G_MAXINT32,
           "height", GST_TYPE_INT_RANGE, 8, G_MAXINT32, NULL);
     } else {
-      if (imxvct->device->device_type == IMX_2D_DEVICE_G2D ||
-          imxvct->device->device_type == IMX_2D_DEVICE_PXP)
+      Imx2DDeviceType engine = imx_2d_device_get_engine_type (imxvct->device);
+      if (engine == IMX_2D_DEVICE_G2D || engine == IMX_2D_DEVICE_PXP)
         gst_structure_set(st, "width", GST_TYPE_INT_RANGE, 16, G_MAXINT32,
             "height", GST_TYPE_INT_RANGE, 16, G_MAXINT32, NULL);
       else
@@ -375,7 +418,7 @@ static gint get_format_conversion_loss(GstBaseTransform * base,
       return 0;
     else if (in_name != GST_VIDEO_FORMAT_NV12_10LE40
         && out_name == GST_VIDEO_FORMAT_NV12) {
-      if (device->device_type != IMX_2D_DEVICE_OCL) {
+      if (imx_2d_device_get_engine_type (device) != IMX_2D_DEVICE_OCL) {
         return G_MAXINT32;
       }
     }
@@ -445,30 +488,71 @@ static gint get_format_conversion_loss(GstBaseTransform * base,
 }
 #endif
 
-static GstCaps* imx_video_convert_caps_from_fmt_list(GList* list)
+GstCaps* imx_video_convert_caps_from_fmt_list(GList* list)
 {
-  gint i;
-  GstCaps *caps = NULL;
+  GstCaps *caps = gst_caps_new_empty();
+  GList *l;
 
-  for (i=0; i<g_list_length (list); i++) {
-    GstVideoFormat fmt = (GstVideoFormat)g_list_nth_data(list, i);
+  for (l = list; l; l = l->next) {
+    GstVideoFormat fmt = (GstVideoFormat)GPOINTER_TO_INT(l->data);
+    gst_caps_append (caps, gst_caps_new_simple("video/x-raw",
+          "format", G_TYPE_STRING, gst_video_format_to_string(fmt), NULL));
+  }
 
-    if (caps) {
-      GstCaps *newcaps = gst_caps_new_simple("video/x-raw",
-          "format", G_TYPE_STRING, gst_video_format_to_string(fmt), NULL);
-      gst_caps_append (caps, newcaps);
-    } else {
-      caps = gst_caps_new_simple("video/x-raw",
-          "format", G_TYPE_STRING, gst_video_format_to_string(fmt), NULL);
-    }
+  if (gst_caps_is_empty (caps)) {
+    gst_caps_unref (caps);
+    return gst_caps_new_empty_simple ("video/x-raw");
   }
 
-  caps = gst_caps_simplify(caps);
+  return gst_caps_simplify(caps);
+}
 
-  imx_video_overlay_composition_add_caps(caps);
+#ifdef COMPARE_CONVERT_LOSS
+/* lower loss wins, the measured conversion time of this device breaks ties */
+static gboolean imx_video_convert_is_better_format(GstImxVideoConvert *imxvct,
+    GstVideoFormat in_fmt, GstVideoFormat out_fmt, guint pixels, gint loss,
+    gint *min_loss, gdouble *min_cost)
+{
+  gdouble cost;
+
+  if (loss == G_MAXINT32 || loss > *min_loss)
+    return FALSE;
 
-  return caps;
+  cost = imx_2d_device_cost_get(imxvct->device->device_type,
+                                IMX_2D_COST_OP_CONVERT, in_fmt, out_fmt, pixels);
+  GST_LOG("%s -> %s, loss = %d, measured cost = %.1f us",
+      gst_video_format_to_string(in_fmt), gst_video_format_to_string(out_fmt),
+      loss, cost);
+
+  if (loss == *min_loss && (cost < 0 || (*min_cost >= 0 && cost >= *min_cost)))
+    return FALSE;
+
+  *min_loss = loss;
+  *min_cost = cost;
+  return TRUE;
+}
+
+static void imx_video_convert_update_selection(GstImxVideoConvert *imxvct,
+    GstVideoFormat in_fmt, GstVideoFormat out_fmt, guint pixels, gdouble cost)
+{
+  const Imx2DDeviceInfo *best;
+  gdouble best_cost = -1;
+  gchar *selection;
+
+  best = imx_2d_device_cost_choose(IMX_2D_COST_OP_CONVERT, in_fmt, out_fmt,
+                                   pixels, &best_cost);
+  selection = g_strdup_printf("%s -> %s, %.1f us measured, cheapest device %s"
+      " (%.1f us)", gst_video_format_to_string(in_fmt),
+      gst_video_format_to_string(out_fmt), cost, best ? best->name : "none",
+      best_cost);
+  GST_INFO_OBJECT(imxvct, "format selection: %s", selection);
+
+  GST_OBJECT_LOCK (imxvct);
+  g_free (imxvct->selection);
+  imxvct->selection = selection;
+  GST_OBJECT_UNLOCK (imxvct);
 }
+#endif
 
 static guint imx_video_convert_fixate_format_caps(GstBaseTransform *transform,
                                             GstCaps *caps, GstCaps *othercaps)
@@ -506,6 +590,7 @@ static guint imx_video_convert_fixate_format_caps(GstBaseTransform *transform,
     GList* list = device->get_supported_out_fmts(device);
     GstCaps *out_caps = imx_video_convert_caps_from_fmt_list(list);
     g_list_free(list);
+    imx_video_overlay_composition_add_caps(out_caps);
 
     new_caps = gst_caps_intersect_full(othercaps, out_caps,
                                        GST_CAPS_INTERSECT_FIRST);
@@ -517,8 +602,13 @@ static guint imx_video_convert_fixate_format_caps(GstBaseTransform *transform,
 #ifdef COMPARE_CONVERT_LOSS
   GstVideoFormat in_fmt;
   gint min_loss = G_MAXINT32;
-  gint loss;
-  guint i, j;
+  gdouble min_cost = -1;
+  gint loss, w = 0, h = 0;
+  guint i, j, pixels;
+
+  gst_structure_get_int(ins, "width", &w);
+  gst_structure_get_int(ins, "height", &h);
+  pixels = w * h;
 
   fmt_name = gst_structure_get_string(ins, "format");
   if (!fmt_name) {
@@ -544,10 +634,9 @@ static guint imx_video_convert_fixate_format_caps(GstBaseTransform *transform,
         if (G_VALUE_HOLDS_STRING(val)) {
           out_fmt = gst_video_format_from_string(g_value_get_string(val));
           loss = get_format_conversion_loss(transform, in_fmt, out_fmt);
-          if (loss < min_loss) {
+          if (imx_video_convert_is_better_format(imxvct, in_fmt, out_fmt,
+                  pixels, loss, &min_loss, &min_cost))
             out_info = gst_video_format_get_info(out_fmt);
-            min_loss = loss;
-          }
 
           if (min_loss == 0)
             break;
@@ -556,15 +645,18 @@ static guint imx_video_convert_fixate_format_caps(GstBaseTransform *transform,
     } else if (G_VALUE_HOLDS_STRING(format)) {
       out_fmt = gst_video_format_from_string(g_value_get_string(format));
       loss = get_format_conversion_loss(transform, in_fmt, out_fmt);
-      if (loss < min_loss) {
+      if (imx_video_convert_is_better_format(imxvct, in_fmt, out_fmt,
+              pixels, loss, &min_loss, &min_cost))
         out_info = gst_video_format_get_info(out_fmt);
-        min_loss = loss;
-      }
     }
 
     if (min_loss == 0)
       break;
   }
+
+  if (out_info)
+    imx_video_convert_update_selection(imxvct, in_fmt,
+        GST_VIDEO_FORMAT_INFO_FORMAT(out_info), pixels, min_cost);
 #else
   format =
       gst_structure_get_value(gst_caps_get_structure(new_caps, 0), "format");
@@ -939,7 +1031,7 @@ gst_imx_video_convert_filter_meta (GstBaseTransform * trans, GstQuery * query,
   return TRUE;
 }
 
-static void
+void
 imx_video_convert_set_pool_alignment(GstCaps *caps, GstBufferPool *pool)
 {
   GstVideoInfo info;
@@ -991,6 +1083,27 @@ imx_video_convert_buffer_pool_is_ok (GstBufferPool * pool, GstCaps * newcaps,
   return ret;
 }
 
+gboolean
+imx_video_convert_obtain_allocator(Imx2DDevice *device,
+                                   GstAllocator **allocator)
+{
+  if (!*allocator) {
+#ifdef USE_DMABUFHEAPS
+    *allocator = gst_dmabufheaps_allocator_obtain ();
+#endif
+#ifdef USE_ION
+    if (!*allocator) {
+      *allocator = gst_ion_allocator_obtain ();
+    }
+#endif
+  }
+
+  if (!*allocator)
+    *allocator = gst_imx_2d_device_allocator_new((gpointer)device);
+
+  return *allocator != NULL;
+}
+
 static GstBufferPool*
 gst_imx_video_convert_create_bufferpool(GstImxVideoConvert *imxvct,
                     GstCaps *caps, guint size, guint min, guint max)
@@ -1000,22 +1113,7 @@ gst_imx_video_convert_create_bufferpool(GstImxVideoConvert *imxvct,
 
   pool = gst_video_buffer_pool_new ();
   if (pool) {
-    if (!imxvct->allocator) {
-#ifdef USE_DMABUFHEAPS
-      imxvct->allocator = gst_dmabufheaps_allocator_obtain ();
-#endif
-#ifdef USE_ION
-      if (!imxvct->allocator) {
-        imxvct->allocator = gst_ion_allocator_obtain ();
-      }
-#endif
-    }
-
-    if (!imxvct->allocator)
-      imxvct->allocator =
-          gst_imx_2d_device_allocator_new((gpointer)(imxvct->device));
-
-    if (!imxvct->allocator) {
+    if (!imx_video_convert_obtain_allocator(imxvct->device, &imxvct->allocator)) {
       GST_ERROR ("new imx video convert allocator failed.");
       gst_buffer_pool_set_active (pool, FALSE);
       gst_object_unref (pool);
@@ -1084,8 +1182,8 @@ imx_video_convert_propose_allocation(GstBaseTransform *transform,
       return FALSE;
 
     size = GST_VIDEO_INFO_SIZE (&info);
-    GST_IMX_CONVERT_UNREF_BUFFER (imxvct->in_buf);
     GST_IMX_CONVERT_UNREF_POOL(imxvct->in_pool);
+    imxvct->plan.staged_pool = NULL;
     GST_DEBUG_OBJECT(imxvct, "creating new input pool");
     pool = gst_imx_video_convert_create_bufferpool(imxvct, caps, size, 1,
                                                    IMX_VCT_IN_POOL_MAX_BUFFERS);
@@ -1100,12 +1198,16 @@ imx_video_convert_propose_allocation(GstBaseTransform *transform,
 
       gst_query_add_allocation_pool (query, pool, size, 1,
                                      IMX_VCT_IN_POOL_MAX_BUFFERS);
-      gst_query_add_allocation_param (query, imxvct->allocator, NULL);
     } else {
       return FALSE;
     }
   }
 
+  /* upstream that keeps its own pool can still allocate from the physical
+   * memory allocator and avoid the staging copy */
+  if (imx_video_convert_obtain_allocator(imxvct->device, &imxvct->allocator))
+    gst_query_add_allocation_param (query, imxvct->allocator, NULL);
+
   gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
   gst_query_add_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE, NULL);
 
@@ -1189,6 +1291,14 @@ static gboolean imx_video_convert_decide_allocation(GstBaseTransform *transform,
   imxvct->out_pool = pool;
   gst_buffer_pool_config_get_params (config, &outcaps, &size, &min, &max);
 
+  /* only the crop differs between input and output, forward the meta
+   * instead of converting when downstream can apply it */
+  if (imxvct->crop_passthrough && gst_query_find_allocation_meta (query,
+          GST_VIDEO_CROP_META_API_TYPE, NULL)) {
+    GST_DEBUG_OBJECT(imxvct, "downstream applies videocrop meta, passthrough");
+    gst_base_transform_set_passthrough(transform, TRUE);
+  }
+
   GST_DEBUG_OBJECT(imxvct, "pool config:  outcaps: %" GST_PTR_FORMAT "  "
       "size: %u  min buffers: %u  max buffers: %u", outcaps, size, min, max);
   gst_structure_free (config);
@@ -1218,6 +1328,18 @@ static gboolean imx_video_convert_set_info(GstVideoFilter *filter,
   if (!device)
     return FALSE;
 
+  /* time the input staging again for the new format */
+  if (imxvct->staging_depth > 1)
+    gst_element_post_message (GST_ELEMENT (imxvct),
+        gst_message_new_latency (GST_OBJECT (imxvct)));
+  imxvct->staging_depth = 1;
+  imxvct->staging_probes = 0;
+  imxvct->reconfigure_sent = FALSE;
+  imxvct->plan.valid = FALSE;
+  imxvct->plan.staged_pool = NULL;
+  imxvct->copy_time = 0;
+  imxvct->convert_time = 0;
+
   ins = gst_caps_get_structure(in, 0);
   outs = gst_caps_get_structure(out, 0);
 
@@ -1267,9 +1389,14 @@ static gboolean imx_video_convert_set_info(GstVideoFilter *filter,
     }
   }
 
-  /* FIXME: find a way to detect videocrop meta */
-  if (imxvct->videocrop_meta_enable)
+  /* the buffers may carry a videocrop meta, convert until the allocation
+   * query tells whether downstream applies it, see decide_allocation */
+  imxvct->crop_passthrough = FALSE;
+  if (imxvct->videocrop_meta_enable) {
+    imxvct->crop_passthrough =
+        gst_base_transform_is_passthrough((GstBaseTransform*)filter);
     gst_base_transform_set_passthrough((GstBaseTransform*)filter, FALSE);
+  }
 
   imxvct->pool_config_update = TRUE;
 
@@ -1281,8 +1408,13 @@ static gboolean imx_video_convert_set_info(GstVideoFilter *filter,
 static guint8 *
 _get_cached_phyaddr (GstMemory * mem)
 {
-    return gst_mini_object_get_qdata (GST_MINI_OBJECT (mem),
+    guint8 *paddr = gst_mini_object_get_qdata (GST_MINI_OBJECT (mem),
               g_quark_from_static_string ("phyaddr"));
+
+    /* dmabufs seen by any element share one process wide cache */
+    if (!paddr && gst_is_dmabuf_memory (mem))
+      paddr = (guint8 *) phy_addr_from_dmabuf_memory (mem);
+    return paddr;
 }
 
 static void
@@ -1332,95 +1464,239 @@ static void imx_video_convert_update_colorimetry (GstVideoInfo * info, Imx2DVide
   imx_info->colorimetry.matrix = imx_color_matrix;
 }
 
-static GstFlowReturn imx_video_convert_transform(GstBaseTransform * trans, GstBuffer * inbuf,
-    GstBuffer * outbuf)
+/* The device configuration that only changes with the caps or the
+ * negotiated pools. The plan is rebuilt on the first frame after either
+ * changed, later frames only configure what differs from it. */
+static void
+imx_video_convert_update_plan (GstImxVideoConvert *imxvct)
 {
-  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST(trans);
-  GstImxVideoConvert *imxvct = (GstImxVideoConvert *)(trans);
-  Imx2DDevice *device = imxvct->device;
-  GstBuffer *input_buf = inbuf;
-  GstPhyMemMeta *phymemmeta = NULL;
-  GstCaps *caps;
-  GstVideoFrame temp_in_frame;
-  Imx2DFrame src = {0}, dst = {0};
-  PhyMemBlock src_mem = {0}, dst_mem = {0};
-  guint i, n_mem;
-  GstVideoCropMeta *in_crop = NULL, *out_crop = NULL;
-  GstVideoMeta *video_meta = gst_buffer_get_video_meta (inbuf);
-  GstVideoInfo in_info;
-  GstDmabufMeta *dmabuf_meta;
-  gint64 drm_modifier = 0;
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST(imxvct);
+  GstImxVideoConvertPlan *plan = &imxvct->plan;
 
-  if (!device)
-    return GST_FLOW_ERROR;
+  memset (&plan->src, 0, sizeof (Imx2DVideoInfo));
+  memset (&plan->dst, 0, sizeof (Imx2DVideoInfo));
 
-  if (!(gst_buffer_is_phymem(outbuf)
-        || gst_is_dmabuf_memory (gst_buffer_peek_memory (outbuf, 0)))) {
-    GST_ERROR ("out buffer is not phy memory or DMA Buf");
-    return GST_FLOW_ERROR;
+  plan->dst.fmt = GST_VIDEO_INFO_FORMAT(&(filter->out_info));
+  plan->dst.w = filter->out_info.width + imxvct->out_video_align.padding_left +
+                imxvct->out_video_align.padding_right;
+  plan->dst.h = filter->out_info.height + imxvct->out_video_align.padding_top +
+                imxvct->out_video_align.padding_bottom;
+  plan->dst.stride = filter->out_info.stride[0];
+
+  if (imx_2d_device_get_engine_type (imxvct->device) == IMX_2D_DEVICE_OCL) {
+    imx_video_convert_update_colorimetry (&filter->in_info, &plan->src);
+    imx_video_convert_update_colorimetry (&filter->out_info, &plan->dst);
   }
+}
 
-  in_info = filter->in_info;
-  if (video_meta) {
-    gint i;
+/* one frame on its way through the device: the input, the input pool
+ * buffer it was staged in and the fence of its conversion */
+struct _GstImxVideoConvertJob {
+  GstBuffer *inbuf;
+  GstBuffer *staged;
+  GstBuffer *outbuf;
+  GstVideoInfo in_info;
+  Imx2DFrame src;
+  Imx2DFrame dst;
+  PhyMemBlock src_mem;
+  PhyMemBlock dst_mem;
+  guint64 fence;
+  gint64 submit_time;
+};
 
-    for (i = 0; i < video_meta->n_planes; i++) {
-      in_info.offset[i] = video_meta->offset[i];
-      in_info.stride[i] = video_meta->stride[i];
-    }
-    in_info.width = video_meta->width;
-    in_info.height = video_meta->height;
+static void
+imx_video_convert_update_time (gint64 *avg, gint64 sample)
+{
+  *avg = *avg ? (*avg * 7 + sample) / 8 : sample;
+}
+
+/* With copy time c and convert time v a staged frame costs c + v when the
+ * copy waits for the device, and max (c, v) when the copy of the next frame
+ * runs while the device converts the current one. The latter keeps an
+ * output buffer across chains and adds a frame of latency, so it is only
+ * chosen for an asynchronous device and when it saves a noticeable part of
+ * the frame. */
+static void
+imx_video_convert_update_staging_depth (GstImxVideoConvert *imxvct)
+{
+  gint64 copy = imxvct->copy_time;
+  gint64 convert = imxvct->convert_time;
+
+  if (++imxvct->staging_probes < IMX_VCT_STAGING_PROBE_FRAMES)
+    return;
+
+  if (imxvct->async
+      && MIN (copy, convert) * IMX_VCT_STAGING_MIN_GAIN >= MAX (copy, convert))
+    imxvct->staging_depth = 2;
+
+  GST_INFO_OBJECT (imxvct, "input copy %" G_GINT64_FORMAT " us, conversion %"
+      G_GINT64_FORMAT " us, staging depth %u", copy, convert,
+      imxvct->staging_depth);
+
+  if (imxvct->staging_depth > 1)
+    gst_element_post_message (GST_ELEMENT (imxvct),
+        gst_message_new_latency (GST_OBJECT (imxvct)));
+}
+
+/* copy a system memory input frame into a buffer of the input pool, the
+ * slot is held by the job until its conversion completed */
+static GstFlowReturn
+imx_video_convert_stage_input (GstImxVideoConvert *imxvct,
+    GstImxVideoConvertJob *job)
+{
+  GstBuffer *inbuf = job->inbuf;
+  GstVideoFrame in_frame, temp_in_frame;
+  GstCaps *caps;
+  gint64 start;
+
+  GST_DEBUG ("copy input frame to physical continues memory");
+
+  GST_OBJECT_LOCK (imxvct);
+  imxvct->staged_frames++;
+  GST_OBJECT_UNLOCK (imxvct);
+
+  /* upstream may have allocated before it could see the proposed pool, for
+   * example when linked late, let it run the allocation query again */
+  if (!imxvct->reconfigure_sent) {
+    GST_INFO_OBJECT (imxvct, "input is system memory, request upstream "
+        "reconfiguration");
+    imxvct->reconfigure_sent = TRUE;
+    gst_pad_push_event (GST_BASE_TRANSFORM_SINK_PAD (imxvct),
+        gst_event_new_reconfigure ());
   }
 
-  /* Check if need copy input frame */
-  if (!(gst_buffer_is_phymem(inbuf)
-        || gst_is_dmabuf_memory (gst_buffer_peek_memory (inbuf, 0)))) {
-    GST_DEBUG ("copy input frame to physical continues memory");
-    caps = gst_video_info_to_caps(&in_info);
-    gst_video_info_from_caps(&in_info, caps); //update the size info
+  /* the staged layout and the pool check only depend on the input layout */
+  if (imxvct->in_pool && imxvct->plan.staged_pool == imxvct->in_pool
+      && gst_video_info_is_equal (&imxvct->plan.staged_from, &job->in_info)) {
+    job->in_info = imxvct->plan.staged_info;
+  } else {
+    imxvct->plan.staged_from = job->in_info;
+    caps = gst_video_info_to_caps(&job->in_info);
+    gst_video_info_from_caps(&job->in_info, caps); //update the size info
 
     if (!imxvct->in_pool ||
-        !imx_video_convert_buffer_pool_is_ok(imxvct->in_pool, caps, in_info.size)) {
+        !imx_video_convert_buffer_pool_is_ok(imxvct->in_pool, caps,
+            job->in_info.size)) {
       GST_IMX_CONVERT_UNREF_POOL(imxvct->in_pool);
       GST_DEBUG_OBJECT(imxvct, "creating new input pool");
       imxvct->in_pool = gst_imx_video_convert_create_bufferpool(imxvct, caps,
-          in_info.size, 1, IMX_VCT_IN_POOL_MAX_BUFFERS);
+          job->in_info.size, 1, IMX_VCT_IN_POOL_MAX_BUFFERS);
     }
 
     gst_caps_unref (caps);
+    imxvct->plan.staged_info = job->in_info;
+    imxvct->plan.staged_pool = imxvct->in_pool;
+  }
 
-    if (imxvct->in_pool && !imxvct->in_buf) {
-      gst_buffer_pool_set_active(imxvct->in_pool, TRUE);
-      GstFlowReturn ret = gst_buffer_pool_acquire_buffer(imxvct->in_pool,
-                                                  &(imxvct->in_buf), NULL);
-      if (ret != GST_FLOW_OK)
-        GST_ERROR("error acquiring input buffer: %s", gst_flow_get_name(ret));
-      else
-        GST_LOG ("created input buffer (%p)", imxvct->in_buf);
-    }
+  if (imxvct->in_pool) {
+    gst_buffer_pool_set_active(imxvct->in_pool, TRUE);
+    GstFlowReturn ret = gst_buffer_pool_acquire_buffer(imxvct->in_pool,
+                                                &job->staged, NULL);
+    if (ret != GST_FLOW_OK)
+      GST_ERROR("error acquiring input buffer: %s", gst_flow_get_name(ret));
+    else
+      GST_LOG ("staging input in buffer (%p)", job->staged);
+  }
+
+  if (!job->staged) {
+    GST_ERROR ("Can't get input buffer");
+    return GST_FLOW_ERROR;
+  }
 
-    if (imxvct->in_buf) {
-      GstVideoFrame in_frame;
+  start = g_get_monotonic_time ();
+  gst_video_frame_map (&in_frame, &job->in_info, inbuf,
+    GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
 
-      gst_video_frame_map (&in_frame, &in_info, inbuf,
-        GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
+  gst_video_frame_map(&temp_in_frame, &job->in_info, job->staged, GST_MAP_WRITE);
+  gst_video_frame_copy(&temp_in_frame, &in_frame);
+  gst_video_frame_unmap(&temp_in_frame);
+  gst_video_frame_unmap (&in_frame);
+  imx_video_convert_update_time (&imxvct->copy_time,
+      g_get_monotonic_time () - start);
 
-      gst_video_frame_map(&temp_in_frame, &in_info, imxvct->in_buf, GST_MAP_WRITE);
-      gst_video_frame_copy(&temp_in_frame, &in_frame);
-      input_buf = temp_in_frame.buffer;
-      gst_video_frame_unmap(&temp_in_frame);
-      gst_video_frame_unmap (&in_frame);
+  if (imxvct->composition_meta_enable
+          && imx_video_overlay_composition_has_meta(inbuf)) {
+    imx_video_overlay_composition_remove_meta(job->staged);
+    imx_video_overlay_composition_copy_meta(job->staged, inbuf,
+        job->in_info.width, job->in_info.height,
+        job->in_info.width, job->in_info.height);
+  }
 
-      if (imxvct->composition_meta_enable
-              && imx_video_overlay_composition_has_meta(inbuf)) {
-        imx_video_overlay_composition_remove_meta(imxvct->in_buf);
-        imx_video_overlay_composition_copy_meta(imxvct->in_buf, inbuf,
-            in_info.width, in_info.height, in_info.width, in_info.height);
-      }
-    } else {
-      GST_ERROR ("Can't get input buffer");
-      return GST_FLOW_ERROR;
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+imx_video_convert_prepare_job (GstImxVideoConvert *imxvct, GstBuffer *inbuf,
+    GstImxVideoConvertJob *job)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST(imxvct);
+  GstVideoMeta *video_meta = gst_buffer_get_video_meta (inbuf);
+
+  imxvct->frames++;
+  job->inbuf = gst_buffer_ref (inbuf);
+  job->in_info = filter->in_info;
+  if (video_meta) {
+    gint i;
+
+    for (i = 0; i < video_meta->n_planes; i++) {
+      job->in_info.offset[i] = video_meta->offset[i];
+      job->in_info.stride[i] = video_meta->stride[i];
     }
+    job->in_info.width = video_meta->width;
+    job->in_info.height = video_meta->height;
+  }
+
+  /* Check if need copy input frame */
+  if (!(gst_buffer_is_phymem(inbuf)
+        || gst_is_dmabuf_memory (gst_buffer_peek_memory (inbuf, 0))))
+    return imx_video_convert_stage_input (imxvct, job);
+
+  return GST_FLOW_OK;
+}
+
+static void
+imx_video_convert_job_clear (GstImxVideoConvertJob *job)
+{
+  GST_IMX_CONVERT_UNREF_BUFFER (job->staged);
+  GST_IMX_CONVERT_UNREF_BUFFER (job->inbuf);
+}
+
+static void
+imx_video_convert_job_free (GstImxVideoConvertJob *job)
+{
+  imx_video_convert_job_clear (job);
+  GST_IMX_CONVERT_UNREF_BUFFER (job->outbuf);
+  g_slice_free (GstImxVideoConvertJob, job);
+}
+
+/* submit the conversion of job to the device without waiting for it */
+static GstFlowReturn
+imx_video_convert_submit (GstImxVideoConvert *imxvct,
+    GstImxVideoConvertJob *job)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST(imxvct);
+  Imx2DDevice *device = imxvct->device;
+  GstBuffer *inbuf = job->inbuf;
+  GstBuffer *outbuf = job->outbuf;
+  GstBuffer *input_buf = job->staged ? job->staged : inbuf;
+  GstPhyMemMeta *phymemmeta = NULL;
+  Imx2DFrame src = {0}, dst = {0};
+  PhyMemBlock src_mem = {0}, dst_mem = {0};
+  guint i, n_mem;
+  GstVideoCropMeta *in_crop = NULL, *out_crop = NULL;
+  GstVideoMeta *video_meta = gst_buffer_get_video_meta (inbuf);
+  GstVideoInfo in_info = job->in_info;
+  GstDmabufMeta *dmabuf_meta;
+  gint64 drm_modifier = 0;
+  gint64 start = g_get_monotonic_time ();
+
+  if (!device)
+    return GST_FLOW_ERROR;
+
+  if (!(gst_buffer_is_phymem(outbuf)
+        || gst_is_dmabuf_memory (gst_buffer_peek_memory (outbuf, 0)))) {
+    GST_ERROR ("out buffer is not phy memory or DMA Buf");
+    return GST_FLOW_ERROR;
   }
 
   if (imxvct->pool_config_update) {
@@ -1486,6 +1762,7 @@ static GstFlowReturn imx_video_convert_transform(GstBaseTransform * trans, GstBu
     }
 
     imxvct->pool_config_update = FALSE;
+    imxvct->plan.valid = FALSE;
   }
 
   src.info.fmt = GST_VIDEO_INFO_FORMAT(&in_info);
@@ -1531,30 +1808,34 @@ static GstFlowReturn imx_video_convert_transform(GstBaseTransform * trans, GstBu
   if (drm_modifier == DRM_FORMAT_MOD_AMPHION_TILED)
     src.info.tile_type = IMX_2D_TILE_AMHPION;
 
-  if (device->device_type == IMX_2D_DEVICE_OCL) {
-    imx_video_convert_update_colorimetry (&filter->in_info, &src.info);
-    imx_video_convert_update_colorimetry (&filter->out_info, &dst.info);
-  }
+  if (!imxvct->plan.valid)
+    imx_video_convert_update_plan (imxvct);
 
-  gint ret = device->config_input(device, &src.info);
+  src.info.colorimetry = imxvct->plan.src.colorimetry;
+  dst.info = imxvct->plan.dst;
 
-  GST_LOG ("Input: %s, %dx%d(%d)", GST_VIDEO_FORMAT_INFO_NAME(in_info.finfo),
-      src.info.w, src.info.h, src.info.stride);
+  /* the input layout may still change per buffer with its video meta */
+  gint ret = 0;
+  if (!imxvct->plan.valid
+      || memcmp (&src.info, &imxvct->plan.src, sizeof (Imx2DVideoInfo))) {
+    ret |= device->config_input(device, &src.info);
+    imxvct->plan.src = src.info;
 
-  dst.info.fmt = GST_VIDEO_INFO_FORMAT(&(filter->out_info));
-  dst.info.w = filter->out_info.width + imxvct->out_video_align.padding_left +
-                imxvct->out_video_align.padding_right;
-  dst.info.h = filter->out_info.height + imxvct->out_video_align.padding_top +
-                imxvct->out_video_align.padding_bottom;
-  dst.info.stride = filter->out_info.stride[0];
+    GST_LOG ("Input: %s, %dx%d(%d)", GST_VIDEO_FORMAT_INFO_NAME(in_info.finfo),
+        src.info.w, src.info.h, src.info.stride);
+  }
 
-  ret |= device->config_output(device, &dst.info);
+  if (!imxvct->plan.valid) {
+    ret |= device->config_output(device, &dst.info);
 
-  GST_LOG ("Output: %s, %dx%d", GST_VIDEO_FORMAT_INFO_NAME(filter->out_info.finfo),
-      filter->out_info.width, filter->out_info.height);
+    GST_LOG ("Output: %s, %dx%d", GST_VIDEO_FORMAT_INFO_NAME(filter->out_info.finfo),
+        filter->out_info.width, filter->out_info.height);
+  }
 
-  if (ret != 0)
+  if (ret != 0) {
+    imxvct->plan.valid = FALSE;
     return GST_FLOW_ERROR;
+  }
 
   src.fd[0] = src.fd[1] =src.fd[2] = src.fd[3] = -1;
   if (gst_is_dmabuf_memory (gst_buffer_peek_memory (input_buf, 0))) {
@@ -1585,16 +1866,26 @@ static GstFlowReturn imx_video_convert_transform(GstBaseTransform * trans, GstBu
   }
 
   //rotate and de-interlace setting
-  if (device->set_rotate(device, imxvct->rotate) < 0) {
-    GST_WARNING_OBJECT (imxvct, "set rotate failed");
-    return GST_FLOW_ERROR;
+  if (!imxvct->plan.valid || imxvct->plan.rotate != imxvct->rotate) {
+    if (device->set_rotate(device, imxvct->rotate) < 0) {
+      GST_WARNING_OBJECT (imxvct, "set rotate failed");
+      imxvct->plan.valid = FALSE;
+      return GST_FLOW_ERROR;
+    }
+    imxvct->plan.rotate = imxvct->rotate;
   }
 
-  if (device->set_deinterlace(device, imxvct->deinterlace) < 0) {
-    GST_WARNING_OBJECT (imxvct, "set deinterlace mode failed");
-    return GST_FLOW_ERROR;
+  if (!imxvct->plan.valid || imxvct->plan.deinterlace != imxvct->deinterlace) {
+    if (device->set_deinterlace(device, imxvct->deinterlace) < 0) {
+      GST_WARNING_OBJECT (imxvct, "set deinterlace mode failed");
+      imxvct->plan.valid = FALSE;
+      return GST_FLOW_ERROR;
+    }
+    imxvct->plan.deinterlace = imxvct->deinterlace;
   }
 
+  imxvct->plan.valid = TRUE;
+
   switch (in_info.interlace_mode) {
     case GST_VIDEO_INTERLACE_MODE_INTERLEAVED:
       GST_TRACE("input stream is interleaved");
@@ -1664,68 +1955,361 @@ static GstFlowReturn imx_video_convert_transform(GstBaseTransform * trans, GstBu
     dst.mem->paddr = _get_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0));
 
   //convert
-  if (device->convert(device, &dst, &src) == 0) {
-    GST_TRACE ("frame conversion done");
-
-    if (!_get_cached_phyaddr (gst_buffer_peek_memory (input_buf, 0)))
-      _set_cached_phyaddr (gst_buffer_peek_memory (input_buf, 0), src.mem->paddr);
-    if (src.fd[1] >= 0 && !_get_cached_phyaddr (gst_buffer_peek_memory (input_buf, 1)))
-      _set_cached_phyaddr (gst_buffer_peek_memory (input_buf, 1), src.mem->user_data);
-    if (!_get_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0)))
-      _set_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0), dst.mem->paddr);
-
-    if (imxvct->composition_meta_enable) {
-      if (imx_video_overlay_composition_has_meta(inbuf)) {
-        VideoCompositionVideoInfo in_v, out_v;
-        memset (&in_v, 0, sizeof(VideoCompositionVideoInfo));
-        memset (&out_v, 0, sizeof(VideoCompositionVideoInfo));
-        in_v.buf = inbuf;
-        in_v.fmt = src.info.fmt;
-        in_v.width = src.info.w;
-        in_v.height = src.info.h;
-        in_v.stride = src.info.stride;
-        in_v.rotate = src.rotate;
-        in_v.crop_x = src.crop.x;
-        in_v.crop_y = src.crop.y;
-        in_v.crop_w = src.crop.w;
-        in_v.crop_h = src.crop.h;
-
-        out_v.mem = dst.mem;
-        out_v.fmt = dst.info.fmt;
-        out_v.width = dst.info.w;
-        out_v.height = dst.info.h;
-        out_v.stride = dst.info.stride;
-        out_v.rotate = IMX_2D_ROTATION_0;
-        out_v.crop_x = dst.crop.x;
-        out_v.crop_y = dst.crop.y;
-        out_v.crop_w = dst.crop.w;
-        out_v.crop_h = dst.crop.h;
-
-        memcpy(&out_v.align, &(imxvct->out_video_align),
-                sizeof(GstVideoAlignment));
-
-        gint cnt = imx_video_overlay_composition_composite(&imxvct->video_comp,
-                                                          &in_v, &out_v, FALSE);
-
-        if (cnt >= 0) {
-          imx_video_overlay_composition_remove_meta(outbuf);
-          GST_DEBUG ("processed %d video overlay composition buffers", cnt);
-        } else {
-          GST_WARNING ("video overlay composition meta handling failed");
-        }
-      }
-    } else {
-      if (imx_video_overlay_composition_has_meta(inbuf) &&
-          !imx_video_overlay_composition_has_meta(outbuf)) {
-        imx_video_overlay_composition_copy_meta(outbuf, inbuf,
-            src.crop.w, src.crop.h, dst.crop.w, dst.crop.h);
+  job->submit_time = g_get_monotonic_time ();
+  imx_video_convert_update_time (&imxvct->setup_time,
+      job->submit_time - start);
+  if (device->convert(device, &dst, &src) != 0)
+    return GST_FLOW_ERROR;
+
+  job->fence = imx_2d_device_get_fence(device);
+  GST_TRACE ("frame conversion submitted");
+
+  /* keep the frames for the completion, which may run after return */
+  job->src_mem = src_mem;
+  job->dst_mem = dst_mem;
+  job->src = src;
+  job->dst = dst;
+  if (src.mem == &src_mem)
+    job->src.mem = &job->src_mem;
+  if (dst.mem == &dst_mem)
+    job->dst.mem = &job->dst_mem;
+
+  if (!_get_cached_phyaddr (gst_buffer_peek_memory (input_buf, 0)))
+    _set_cached_phyaddr (gst_buffer_peek_memory (input_buf, 0), src.mem->paddr);
+  if (src.fd[1] >= 0 && !_get_cached_phyaddr (gst_buffer_peek_memory (input_buf, 1)))
+    _set_cached_phyaddr (gst_buffer_peek_memory (input_buf, 1), src.mem->user_data);
+  if (!_get_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0)))
+    _set_cached_phyaddr (gst_buffer_peek_memory (outbuf, 0), dst.mem->paddr);
+
+  return GST_FLOW_OK;
+}
+
+/* the overlays are blended on the shared device, which queues its work when
+ * async, so they have to land before the buffer goes downstream and the
+ * composition reuses its overlay buffers */
+static void
+imx_video_convert_finish_composition (GstImxVideoConvert *imxvct)
+{
+  Imx2DDevice *device = imxvct->device;
+
+  if (device->blend_finish && device->blend_finish (device) < 0)
+    GST_WARNING ("video overlay composition blend finish failed");
+  if (imx_2d_device_wait_fence (device, imx_2d_device_get_fence (device)) < 0)
+    GST_WARNING ("wait for video overlay composition failed");
+}
+
+/* wait for the conversion of job and finish its output buffer */
+static GstFlowReturn
+imx_video_convert_complete (GstImxVideoConvert *imxvct,
+    GstImxVideoConvertJob *job)
+{
+  GstBuffer *inbuf = job->inbuf;
+  GstBuffer *outbuf = job->outbuf;
+  Imx2DFrame src = job->src, dst = job->dst;
+
+  if (imx_2d_device_wait_fence(imxvct->device, job->fence) < 0) {
+    GST_ERROR ("wait for frame conversion failed");
+    return GST_FLOW_ERROR;
+  }
+  GST_TRACE ("frame conversion done");
+
+  if (job->staged && imxvct->staging_depth == 1
+      && imxvct->staging_probes < IMX_VCT_STAGING_PROBE_FRAMES) {
+    imx_video_convert_update_time (&imxvct->convert_time,
+        g_get_monotonic_time () - job->submit_time);
+    imx_video_convert_update_staging_depth (imxvct);
+  }
+
+  if (imxvct->composition_meta_enable) {
+    if (imx_video_overlay_composition_has_meta(inbuf)) {
+      VideoCompositionVideoInfo in_v, out_v;
+      memset (&in_v, 0, sizeof(VideoCompositionVideoInfo));
+      memset (&out_v, 0, sizeof(VideoCompositionVideoInfo));
+      in_v.buf = inbuf;
+      in_v.fmt = src.info.fmt;
+      in_v.width = src.info.w;
+      in_v.height = src.info.h;
+      in_v.stride = src.info.stride;
+      in_v.rotate = src.rotate;
+      in_v.crop_x = src.crop.x;
+      in_v.crop_y = src.crop.y;
+      in_v.crop_w = src.crop.w;
+      in_v.crop_h = src.crop.h;
+
+      out_v.mem = dst.mem;
+      out_v.fmt = dst.info.fmt;
+      out_v.width = dst.info.w;
+      out_v.height = dst.info.h;
+      out_v.stride = dst.info.stride;
+      out_v.rotate = IMX_2D_ROTATION_0;
+      out_v.crop_x = dst.crop.x;
+      out_v.crop_y = dst.crop.y;
+      out_v.crop_w = dst.crop.w;
+      out_v.crop_h = dst.crop.h;
+
+      memcpy(&out_v.align, &(imxvct->out_video_align),
+              sizeof(GstVideoAlignment));
+
+      gint cnt = imx_video_overlay_composition_composite(&imxvct->video_comp,
+                                                        &in_v, &out_v, FALSE);
+      /* the composition configured the device for its overlays */
+      imxvct->plan.valid = FALSE;
+      if (cnt > 0)
+        imx_video_convert_finish_composition (imxvct);
+
+      if (cnt >= 0) {
+        imx_video_overlay_composition_remove_meta(outbuf);
+        GST_DEBUG ("processed %d video overlay composition buffers", cnt);
+      } else {
+        GST_WARNING ("video overlay composition meta handling failed");
       }
     }
+  } else {
+    if (imx_video_overlay_composition_has_meta(inbuf) &&
+        !imx_video_overlay_composition_has_meta(outbuf)) {
+      imx_video_overlay_composition_copy_meta(outbuf, inbuf,
+          src.crop.w, src.crop.h, dst.crop.w, dst.crop.h);
+    }
+  }
 
-    return GST_FLOW_OK;
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn imx_video_convert_transform(GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstImxVideoConvert *imxvct = (GstImxVideoConvert *)(trans);
+  GstImxVideoConvertJob job;
+  GstFlowReturn ret;
+
+  memset (&job, 0, sizeof (GstImxVideoConvertJob));
+  job.outbuf = outbuf;
+
+  ret = imx_video_convert_prepare_job (imxvct, inbuf, &job);
+  if (ret == GST_FLOW_OK)
+    ret = imx_video_convert_submit (imxvct, &job);
+  if (ret == GST_FLOW_OK)
+    ret = imx_video_convert_complete (imxvct, &job);
+
+  imx_video_convert_job_clear (&job);
+  return ret;
+}
+
+/* The pipelined path outputs a frame one chain after its input was checked
+ * against the QoS earliest time and bypasses the processed/dropped counts of
+ * the base class, so it is not used while QoS is enabled. */
+static gboolean
+imx_video_convert_can_pipeline (GstImxVideoConvert *imxvct, GstBuffer *inbuf)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM_CAST (imxvct);
+
+  return imxvct->staging_depth > 1
+      && !gst_base_transform_is_qos_enabled (trans)
+      && !gst_base_transform_is_passthrough (trans)
+      && !gst_base_transform_is_in_place (trans)
+      && !(gst_buffer_is_phymem (inbuf)
+          || gst_is_dmabuf_memory (gst_buffer_peek_memory (inbuf, 0)));
+}
+
+static GstFlowReturn
+imx_video_convert_submit_staged (GstImxVideoConvert *imxvct)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM_CAST (imxvct);
+  GstBaseTransformClass *klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+  GstImxVideoConvertJob *job = imxvct->staged;
+  GstFlowReturn ret;
+
+  imxvct->staged = NULL;
+  ret = klass->prepare_output_buffer (trans, job->inbuf, &job->outbuf);
+  if (ret == GST_FLOW_OK && job->outbuf)
+    ret = imx_video_convert_submit (imxvct, job);
+  else if (ret == GST_FLOW_OK)
+    ret = GST_FLOW_ERROR;
+
+  if (ret != GST_FLOW_OK) {
+    imx_video_convert_job_free (job);
+    return ret;
   }
 
-  return GST_FLOW_ERROR;
+  imxvct->pending = job;
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+imx_video_convert_finish_pending (GstImxVideoConvert *imxvct,
+    GstBuffer ** outbuf)
+{
+  GstImxVideoConvertJob *job = imxvct->pending;
+  GstFlowReturn ret;
+
+  imxvct->pending = NULL;
+  ret = imx_video_convert_complete (imxvct, job);
+  if (ret == GST_FLOW_OK) {
+    *outbuf = job->outbuf;
+    job->outbuf = NULL;
+  }
+
+  imx_video_convert_job_free (job);
+  return ret;
+}
+
+/* System memory input is staged into input pool buffers. With a staging
+ * depth of 2 the conversion of a frame is left running when the chain
+ * returns, the next chain copies its frame into another pool buffer while
+ * the device is busy and only then waits for and outputs the previous one.
+ * Only one conversion is in flight at any time, so the element holds the
+ * same number of output buffers as the synchronous transform. */
+static GstFlowReturn
+imx_video_convert_generate_output (GstBaseTransform * trans,
+    GstBuffer ** outbuf)
+{
+  GstImxVideoConvert *imxvct = (GstImxVideoConvert *)(trans);
+  GstBuffer *inbuf = trans->queued_buf;
+  GstFlowReturn ret;
+
+  if (inbuf && gst_base_transform_is_passthrough (trans)) {
+    GST_OBJECT_LOCK (imxvct);
+    imxvct->passthrough_frames++;
+    GST_OBJECT_UNLOCK (imxvct);
+  }
+
+  if (imxvct->staged) {
+    ret = imx_video_convert_submit_staged (imxvct);
+    if (ret != GST_FLOW_OK || !trans->queued_buf)
+      return ret;
+  }
+
+  if (inbuf && imx_video_convert_can_pipeline (imxvct, inbuf)) {
+    trans->queued_buf = NULL;
+    imxvct->staged = g_slice_new0 (GstImxVideoConvertJob);
+    ret = imx_video_convert_prepare_job (imxvct, inbuf, imxvct->staged);
+    gst_buffer_unref (inbuf);
+    if (ret != GST_FLOW_OK) {
+      imx_video_convert_job_free (imxvct->staged);
+      imxvct->staged = NULL;
+      return ret;
+    }
+
+    if (!imxvct->pending)
+      return imx_video_convert_submit_staged (imxvct);
+  }
+
+  if (imxvct->pending)
+    return imx_video_convert_finish_pending (imxvct, outbuf);
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->generate_output (trans,
+      outbuf);
+}
+
+/* push what is still staged or in flight, before a serialized event */
+static void
+imx_video_convert_drain (GstImxVideoConvert *imxvct)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM_CAST (imxvct);
+  GstBuffer *outbuf = NULL;
+  GstFlowReturn ret;
+
+  while (imxvct->pending || imxvct->staged) {
+    if (!imxvct->pending
+        && imx_video_convert_submit_staged (imxvct) != GST_FLOW_OK)
+      break;
+
+    if (imx_video_convert_finish_pending (imxvct, &outbuf) != GST_FLOW_OK)
+      continue;
+
+    ret = gst_pad_push (GST_BASE_TRANSFORM_SRC_PAD (trans), outbuf);
+    if (ret != GST_FLOW_OK)
+      GST_DEBUG_OBJECT (imxvct, "push of drained buffer: %s",
+          gst_flow_get_name (ret));
+  }
+}
+
+static void
+imx_video_convert_discard (GstImxVideoConvert *imxvct)
+{
+  if (imxvct->pending) {
+    imx_2d_device_wait_fence (imxvct->device, imxvct->pending->fence);
+    imx_video_convert_job_free (imxvct->pending);
+    imxvct->pending = NULL;
+  }
+
+  if (imxvct->staged) {
+    imx_video_convert_job_free (imxvct->staged);
+    imxvct->staged = NULL;
+  }
+}
+
+static gboolean
+imx_video_convert_sink_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstImxVideoConvert *imxvct = (GstImxVideoConvert *)(trans);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
+    imx_video_convert_discard (imxvct);
+  else if (GST_EVENT_IS_SERIALIZED (event))
+    imx_video_convert_drain (imxvct);
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->sink_event (trans, event);
+}
+
+static gboolean
+imx_video_convert_query (GstBaseTransform * trans, GstPadDirection direction,
+    GstQuery * query)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST(trans);
+  GstImxVideoConvert *imxvct = (GstImxVideoConvert *)(trans);
+  GstClockTime min, max, frame;
+  gboolean live;
+
+  if (!GST_BASE_TRANSFORM_CLASS (parent_class)->query (trans, direction, query))
+    return FALSE;
+
+  if (direction == GST_PAD_SRC && GST_QUERY_TYPE (query) == GST_QUERY_LATENCY
+      && imxvct->staging_depth > 1 && !gst_base_transform_is_qos_enabled (trans)
+      && filter->out_info.fps_n > 0) {
+    /* the staged frame is output one chain later */
+    frame = gst_util_uint64_scale_int (GST_SECOND, filter->out_info.fps_d,
+        filter->out_info.fps_n);
+    gst_query_parse_latency (query, &live, &min, &max);
+    min += frame;
+    if (GST_CLOCK_TIME_IS_VALID (max))
+      max += frame;
+    gst_query_set_latency (query, live, min, max);
+  }
+
+  return TRUE;
+}
+
+/* negotiation reads the measured costs of every device, measure them here
+ * rather than from the streaming thread */
+static gboolean
+imx_video_convert_start (GstBaseTransform * trans)
+{
+#ifdef COMPARE_CONVERT_LOSS
+  GstImxVideoConvert *imxvct = (GstImxVideoConvert *)(trans);
+
+  /* measuring may take seconds, negotiation keeps to the static loss and
+   * complexity until it is done */
+  if (imxvct->device)
+    imx_2d_device_cost_prepare_async (imxvct->device->device_type);
+#endif
+  return TRUE;
+}
+
+static gboolean
+imx_video_convert_stop (GstBaseTransform * trans)
+{
+  GstImxVideoConvert *imxvct = (GstImxVideoConvert *)(trans);
+
+  imx_video_convert_discard (imxvct);
+
+  GST_INFO_OBJECT (imxvct, "%" G_GUINT64_FORMAT " frames converted, %"
+      G_GUINT64_FORMAT " passed through", imxvct->frames,
+      imxvct->passthrough_frames);
+  GST_INFO_OBJECT (imxvct, "%" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT
+      " frames needed a staging copy, frame setup %" G_GINT64_FORMAT " us",
+      imxvct->staged_frames, imxvct->frames, imxvct->setup_time);
+  return TRUE;
 }
 
 static GstFlowReturn
@@ -1827,12 +2411,16 @@ imx_video_convert_transform_ip(GstBaseTransform * trans, GstBuffer * buf)
         n_mem = gst_buffer_n_memory (buf);
         for (i = 0; i < n_mem; i++)
           out_v.fd[i] = gst_dmabuf_memory_get_fd (gst_buffer_peek_memory (buf, i));
+        src_mem.paddr = _get_cached_phyaddr (gst_buffer_peek_memory (buf, 0));
       } else
         out_v.mem = gst_buffer_query_phymem_block (buf);
       memcpy(&out_v.align, &(imxvct->in_video_align),sizeof(GstVideoAlignment));
 
       gint cnt = imx_video_overlay_composition_composite(&imxvct->video_comp,
                                                          &in_v, &out_v, TRUE);
+      imxvct->plan.valid = FALSE;
+      if (cnt > 0)
+        imx_video_convert_finish_composition (imxvct);
 
       if (cnt >= 0) {
         imx_video_overlay_composition_remove_meta(buf);
@@ -1861,7 +2449,9 @@ gst_imx_video_convert_class_init (GstImxVideoConvertClass * klass)
       g_type_get_qdata (G_OBJECT_CLASS_TYPE (klass), GST_IMX_VCT_PARAMS_QDATA);
   g_assert (in_plugin != NULL);
 
-  Imx2DDevice* dev = in_plugin->create(in_plugin->device_type);
+  /* probe through a session, it adds the software deinterlacer to devices
+   * without a deinterlace engine */
+  Imx2DDevice* dev = imx_2d_device_create(in_plugin->device_type);
   if (!dev)
     return;
 
@@ -1878,11 +2468,7 @@ gst_imx_video_convert_class_init (GstImxVideoConvertClass * klass)
   GList *list = dev->get_supported_in_fmts(dev);
   caps = imx_video_convert_caps_from_fmt_list(list);
   g_list_free(list);
-
-  if (!caps) {
-    GST_ERROR ("Couldn't create caps for device '%s'", in_plugin->name);
-    caps = gst_caps_new_empty_simple ("video/x-raw");
-  }
+  imx_video_overlay_composition_add_caps(caps);
   gst_element_class_add_pad_template (element_class,
       gst_pad_template_new ("sink", GST_PAD_SINK, GST_PAD_ALWAYS, caps));
 
@@ -1894,11 +2480,7 @@ gst_imx_video_convert_class_init (GstImxVideoConvertClass * klass)
   list = dev->get_supported_out_fmts(dev);
   caps = imx_video_convert_caps_from_fmt_list(list);
   g_list_free(list);
-
-  if (!caps) {
-    GST_ERROR ("Couldn't create caps for device '%s'", in_plugin->name);
-    caps = gst_caps_new_empty_simple ("video/x-raw");
-  }
+  imx_video_overlay_composition_add_caps(caps);
   gst_element_class_add_pad_template (element_class,
       gst_pad_template_new ("src", GST_PAD_SRC, GST_PAD_ALWAYS, caps));
 #endif
@@ -1946,7 +2528,7 @@ gst_imx_video_convert_class_init (GstImxVideoConvertClass * klass)
       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   }
 
-  if (in_plugin->device_type == IMX_2D_DEVICE_G2D) {
+  if (imx_2d_device_info_get_engine_type (in_plugin) == IMX_2D_DEVICE_G2D) {
     g_object_class_install_property (gobject_class,
         PROP_VIDEOCROP_META_ENABLE,
         g_param_spec_boolean("videocrop-meta-enable", "process buffer's videocrop meta",
@@ -1955,7 +2537,31 @@ gst_imx_video_convert_class_init (GstImxVideoConvertClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   }
 
-  in_plugin->destroy(dev);
+  g_object_class_install_property (gobject_class, PROP_DEVICE_SELECTION,
+      g_param_spec_string("device-selection", "Device selection",
+        "Output format chosen at negotiation, its measured cost and the "
+        "cheapest 2D device for the same conversion",
+        NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_STAGED_FRAMES,
+      g_param_spec_uint64("staged-frames", "Staged frames",
+        "Number of input frames in system memory that were copied to "
+        "physical memory before the conversion, 0 when zero-copy",
+        0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PASSTHROUGH_FRAMES,
+      g_param_spec_uint64("passthrough-frames", "Passthrough frames",
+        "Number of input frames pushed without a conversion, including "
+        "frames whose videocrop meta was left to downstream",
+        0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DEVICE_STATS,
+      g_param_spec_boxed("device-stats", "Device statistics",
+        "2D device session counters: operations, busy, wait and active "
+        "time in microseconds, and sessions sharing the device",
+        GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  imx_2d_device_destroy(dev);
 
   base_transform_class->src_event =
       GST_DEBUG_FUNCPTR(imx_video_convert_src_event);
@@ -1979,6 +2585,16 @@ gst_imx_video_convert_class_init (GstImxVideoConvertClass * klass)
       GST_DEBUG_FUNCPTR(imx_video_convert_transform);
   base_transform_class->transform_ip =
       GST_DEBUG_FUNCPTR(imx_video_convert_transform_ip);
+  base_transform_class->generate_output =
+      GST_DEBUG_FUNCPTR(imx_video_convert_generate_output);
+  base_transform_class->sink_event =
+      GST_DEBUG_FUNCPTR(imx_video_convert_sink_event);
+  base_transform_class->query =
+      GST_DEBUG_FUNCPTR(imx_video_convert_query);
+  base_transform_class->start =
+      GST_DEBUG_FUNCPTR(imx_video_convert_start);
+  base_transform_class->stop =
+      GST_DEBUG_FUNCPTR(imx_video_convert_stop);
 
   base_transform_class->passthrough_on_same_caps = TRUE;
 }
@@ -1990,13 +2606,12 @@ gst_imx_video_convert_init (GstImxVideoConvert * imxvct)
       (GstImxVideoConvertClass *) G_OBJECT_GET_CLASS (imxvct);
 
   if (klass->in_plugin)
-    imxvct->device = klass->in_plugin->create(klass->in_plugin->device_type);
+    imxvct->device = imx_2d_device_create(klass->in_plugin->device_type);
 
   if (imxvct->device) {
     if (imxvct->device->open(imxvct->device) < 0) {
       GST_ERROR ("Open video process device failed.");
     } else {
-      imxvct->in_buf = NULL;
       imxvct->in_pool = NULL;
       imxvct->out_pool = NULL;
       imxvct->self_out_pool = NULL;
@@ -2007,6 +2622,8 @@ gst_imx_video_convert_init (GstImxVideoConvert * imxvct)
       imxvct->in_place = GST_IMX_VIDEO_COMPOMETA_IN_PLACE_DEFAULT;
       imxvct->videocrop_meta_enable = GST_IMX_VIDEO_VIDEOCROP_META_DEFAULT;
       imx_video_overlay_composition_init(&imxvct->video_comp, imxvct->device);
+      imxvct->async = imx_2d_device_set_async(imxvct->device, TRUE);
+      imxvct->staging_depth = 1;
     }
   } else {
     GST_ERROR ("Create video process device failed.");
@@ -2028,6 +2645,7 @@ static gboolean gst_imx_video_convert_register (GstPlugin * plugin)
   };
 
   GType type;
+  guint rank;
   gchar *t_name;
 
   const Imx2DDeviceInfo *in_plugin = imx_get_2d_devices();
@@ -2049,7 +2667,11 @@ static gboolean gst_imx_video_convert_register (GstPlugin * plugin)
       g_type_set_qdata (type, GST_IMX_VCT_PARAMS_QDATA, (gpointer) in_plugin);
     }
 
-    if (!gst_element_register (plugin, t_name, IMX_GST_PLUGIN_RANK, type)) {
+    /* split and sw stand in for the real engines, never autoplug them */
+    rank = (in_plugin->device_type == IMX_2D_DEVICE_SPLIT
+        || in_plugin->device_type == IMX_2D_DEVICE_SW) ?
+        GST_RANK_NONE : IMX_GST_PLUGIN_RANK;
+    if (!gst_element_register (plugin, t_name, rank, type)) {
       GST_ERROR ("Failed to register %s", t_name);
       g_free (t_name);
       return FALSE;
@@ -2067,7 +2689,10 @@ static gboolean plugin_init (GstPlugin * plugin)
   GST_DEBUG_CATEGORY_INIT (imxvideoconvert_debug, "imxvideoconvert", 0,
       "Freescale IMX Video Convert element");
 
-  return gst_imx_video_convert_register (plugin);
+  if (!gst_imx_video_convert_register (plugin))
+    return FALSE;
+
+  return gst_imx_video_convert_multi_register (plugin);
 }
 
 IMX_GST_PLUGIN_DEFINE(imxvideoconvert, "IMX Video Convert Plugins",plugin_init);
@@ -35,6 +35,21 @@ G_BEGIN_DECLS
 
 //#define PASSTHOUGH_FOR_UNSUPPORTED_OUTPUT_FORMAT
 
+typedef struct _GstImxVideoConvertJob GstImxVideoConvertJob;
+
+/* device configuration reused across frames, see imx_video_convert_update_plan */
+typedef struct {
+  gboolean valid;
+  Imx2DVideoInfo src;
+  Imx2DVideoInfo dst;
+  Imx2DRotationMode rotate;
+  Imx2DDeinterlaceMode deinterlace;
+  /* layout of staged input frames and the input pool it was checked for */
+  GstBufferPool *staged_pool;
+  GstVideoInfo staged_from;
+  GstVideoInfo staged_info;
+} GstImxVideoConvertPlan;
+
 /* video convert object and class definition */
 typedef struct _GstImxVideoConvert {
   GstVideoFilter element;
@@ -43,7 +58,6 @@ typedef struct _GstImxVideoConvert {
   GstBufferPool *in_pool;
   GstBufferPool *out_pool;
   GstBufferPool *self_out_pool;
-  GstBuffer *in_buf;
   GstAllocator *allocator;
   GstVideoAlignment in_video_align;
   GstVideoAlignment out_video_align;
@@ -54,6 +68,23 @@ typedef struct _GstImxVideoConvert {
   gboolean composition_meta_enable;
   gboolean in_place;
   gboolean videocrop_meta_enable;
+  /* caps are unchanged, the crop meta alone may pass through */
+  gboolean crop_passthrough;
+  gchar *selection;
+  /* staging of system memory input, see imx_video_convert_generate_output */
+  gboolean async;
+  guint staging_depth;
+  guint staging_probes;
+  gint64 copy_time;
+  gint64 convert_time;
+  GstImxVideoConvertJob *staged;
+  GstImxVideoConvertJob *pending;
+  gboolean reconfigure_sent;
+  guint64 frames;
+  guint64 staged_frames;
+  guint64 passthrough_frames;
+  GstImxVideoConvertPlan plan;
+  gint64 setup_time;
 } GstImxVideoConvert;
 
 typedef struct _GstImxVideoConvertClass {
@@ -62,6 +93,14 @@ typedef struct _GstImxVideoConvertClass {
   const Imx2DDeviceInfo *in_plugin;
 } GstImxVideoConvertClass;
 
+GType gst_imx_video_convert_rotation_get_type (void);
+
+/* shared with imxvideoconvertmulti */
+GstCaps* imx_video_convert_caps_from_fmt_list(GList* list);
+gboolean imx_video_convert_obtain_allocator(Imx2DDevice *device,
+                                            GstAllocator **allocator);
+void imx_video_convert_set_pool_alignment(GstCaps *caps, GstBufferPool *pool);
+
 G_END_DECLS
 
 #endif /* __GST_IMX_VIDEO_CONVERT_H__ */
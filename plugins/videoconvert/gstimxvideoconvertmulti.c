@@ -0,0 +1,994 @@
+/* GStreamer IMX video convert plugin, multiple output converter
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* imxvideoconvertmulti_<device> converts one input into any number of
+ * outputs, one per requested src_%u pad. Each output gets its own caps from
+ * downstream and may crop a region of the input, given by the pad
+ * properties or by a GstVideoRegionOfInterestMeta of the input buffer, and
+ * rotate it. All outputs of a frame are submitted to the same device in one
+ * pass and waited for once, a system memory input is staged only once.
+ *
+ *   gst-launch-1.0 v4l2src ! imxvideoconvertmulti_g2d name=c \
+ *     c.src_0 ! video/x-raw,width=1280,height=720 ! waylandsink \
+ *     c.src_1 ! video/x-raw,format=RGBA,width=640,height=640 ! appsink \
+ *     c.src_2 ! video/x-raw,width=320,height=180 ! jpegenc ! multifilesink
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <gst/video/video.h>
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/allocators/gstallocatorphymem.h>
+#include "gstimxvideoconvert.h"
+#include "gstimxvideoconvertmulti.h"
+
+#define IMX_VCTM_IN_POOL_MAX_BUFFERS   4
+#define IMX_VCTM_OUT_POOL_MIN_BUFFERS  3
+
+#define GST_IMX_VCTM_PARAMS_QDATA \
+    g_quark_from_static_string("imxvctm-params")
+
+GST_DEBUG_CATEGORY_EXTERN (imxvideoconvert_debug);
+#define GST_CAT_DEFAULT imxvideoconvert_debug
+
+static GstElementClass *parent_class = NULL;
+
+enum {
+  PROP_PAD_0,
+  PROP_PAD_ROTATE,
+  PROP_PAD_CROP_X,
+  PROP_PAD_CROP_Y,
+  PROP_PAD_CROP_WIDTH,
+  PROP_PAD_CROP_HEIGHT,
+  PROP_PAD_ROI_TYPE
+};
+
+G_DEFINE_TYPE (GstImxVideoConvertMultiPad, gst_imx_video_convert_multi_pad,
+    GST_TYPE_PAD);
+
+static void
+gst_imx_video_convert_multi_pad_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstImxVideoConvertMultiPad *pad = GST_IMX_VIDEO_CONVERT_MULTI_PAD (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PROP_PAD_ROTATE:
+      pad->rotate = g_value_get_enum (value);
+      /* the output size may swap */
+      pad->negotiated = FALSE;
+      break;
+    case PROP_PAD_CROP_X:
+      pad->crop.x = g_value_get_int (value);
+      break;
+    case PROP_PAD_CROP_Y:
+      pad->crop.y = g_value_get_int (value);
+      break;
+    case PROP_PAD_CROP_WIDTH:
+      pad->crop.w = g_value_get_int (value);
+      break;
+    case PROP_PAD_CROP_HEIGHT:
+      pad->crop.h = g_value_get_int (value);
+      break;
+    case PROP_PAD_ROI_TYPE:
+      g_free (pad->roi_type);
+      pad->roi_type = g_value_dup_string (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static void
+gst_imx_video_convert_multi_pad_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstImxVideoConvertMultiPad *pad = GST_IMX_VIDEO_CONVERT_MULTI_PAD (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PROP_PAD_ROTATE:
+      g_value_set_enum (value, pad->rotate);
+      break;
+    case PROP_PAD_CROP_X:
+      g_value_set_int (value, pad->crop.x);
+      break;
+    case PROP_PAD_CROP_Y:
+      g_value_set_int (value, pad->crop.y);
+      break;
+    case PROP_PAD_CROP_WIDTH:
+      g_value_set_int (value, pad->crop.w);
+      break;
+    case PROP_PAD_CROP_HEIGHT:
+      g_value_set_int (value, pad->crop.h);
+      break;
+    case PROP_PAD_ROI_TYPE:
+      g_value_set_string (value, pad->roi_type);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static void
+gst_imx_video_convert_multi_pad_finalize (GObject * object)
+{
+  GstImxVideoConvertMultiPad *pad = GST_IMX_VIDEO_CONVERT_MULTI_PAD (object);
+
+  if (pad->pool) {
+    gst_buffer_pool_set_active (pad->pool, FALSE);
+    gst_object_unref (pad->pool);
+    pad->pool = NULL;
+  }
+  g_free (pad->roi_type);
+
+  G_OBJECT_CLASS (gst_imx_video_convert_multi_pad_parent_class)->finalize (object);
+}
+
+static void
+gst_imx_video_convert_multi_pad_class_init (GstImxVideoConvertMultiPadClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->set_property = gst_imx_video_convert_multi_pad_set_property;
+  gobject_class->get_property = gst_imx_video_convert_multi_pad_get_property;
+  gobject_class->finalize = gst_imx_video_convert_multi_pad_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_PAD_ROTATE,
+      g_param_spec_enum ("rotation", "Output rotation",
+        "Rotation that shall be applied to the frames of this output",
+        gst_imx_video_convert_rotation_get_type (), IMX_2D_ROTATION_0,
+        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PAD_CROP_X,
+      g_param_spec_int ("crop-x", "Crop X",
+        "Left edge of the input region converted to this output",
+        0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PAD_CROP_Y,
+      g_param_spec_int ("crop-y", "Crop Y",
+        "Top edge of the input region converted to this output",
+        0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PAD_CROP_WIDTH,
+      g_param_spec_int ("crop-width", "Crop width",
+        "Width of the input region converted to this output, 0 for the "
+        "rest of the frame",
+        0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PAD_CROP_HEIGHT,
+      g_param_spec_int ("crop-height", "Crop height",
+        "Height of the input region converted to this output, 0 for the "
+        "rest of the frame",
+        0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PAD_ROI_TYPE,
+      g_param_spec_string ("roi-type", "Region of interest type",
+        "Convert the region of interest meta of this type instead of the "
+        "crop properties, frames without such a meta use the crop properties",
+        NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_imx_video_convert_multi_pad_init (GstImxVideoConvertMultiPad * pad)
+{
+  pad->rotate = IMX_2D_ROTATION_0;
+  pad->negotiated = FALSE;
+}
+
+static GstBufferPool *
+gst_imx_video_convert_multi_create_pool (GstImxVideoConvertMulti * self,
+    GstCaps * caps, guint size, guint min, guint max,
+    const GstVideoAlignment * align)
+{
+  GstBufferPool *pool;
+  GstStructure *config;
+
+  if (!imx_video_convert_obtain_allocator (self->device, &self->allocator)) {
+    GST_ERROR_OBJECT (self, "new imx video convert allocator failed.");
+    return NULL;
+  }
+
+  pool = gst_video_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+  gst_buffer_pool_config_set_allocator (config, self->allocator, NULL);
+  gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+  if (align) {
+    gst_buffer_pool_config_add_option (config,
+        GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+    gst_buffer_pool_config_set_video_alignment (config,
+        (GstVideoAlignment *) align);
+  }
+
+  if (!gst_buffer_pool_set_config (pool, config)) {
+    GST_ERROR_OBJECT (self, "set buffer pool config failed.");
+    gst_object_unref (pool);
+    return NULL;
+  }
+
+  return pool;
+}
+
+/* the output keeps the input format, size and frame rate where downstream
+ * leaves the choice, the size being the one of the cropped region */
+static GstCaps *
+gst_imx_video_convert_multi_fixate (GstImxVideoConvertMulti * self,
+    GstImxVideoConvertMultiPad * pad, GstCaps * peer)
+{
+  GstVideoInfo *in_info = &self->in_info;
+  GstStructure *s;
+  GstCaps *caps;
+  gint w, h;
+
+  GST_OBJECT_LOCK (pad);
+  w = pad->crop.w ? pad->crop.w : in_info->width - pad->crop.x;
+  h = pad->crop.h ? pad->crop.h : in_info->height - pad->crop.y;
+  if (pad->rotate == IMX_2D_ROTATION_90 || pad->rotate == IMX_2D_ROTATION_270) {
+    gint t = w;
+    w = h;
+    h = t;
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  caps = gst_caps_make_writable (gst_caps_truncate (gst_caps_ref (peer)));
+  s = gst_caps_get_structure (caps, 0);
+
+  gst_structure_fixate_field_string (s, "format",
+      gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (in_info)));
+  gst_structure_fixate_field_nearest_int (s, "width", MAX (w, 1));
+  gst_structure_fixate_field_nearest_int (s, "height", MAX (h, 1));
+  if (gst_structure_has_field (s, "framerate"))
+    gst_structure_fixate_field_nearest_fraction (s, "framerate",
+        GST_VIDEO_INFO_FPS_N (in_info), GST_VIDEO_INFO_FPS_D (in_info));
+  else
+    gst_structure_set (s, "framerate", GST_TYPE_FRACTION,
+        GST_VIDEO_INFO_FPS_N (in_info), GST_VIDEO_INFO_FPS_D (in_info), NULL);
+  if (gst_structure_has_field (s, "pixel-aspect-ratio"))
+    gst_structure_fixate_field_nearest_fraction (s, "pixel-aspect-ratio", 1, 1);
+
+  return gst_caps_fixate (caps);
+}
+
+static gboolean
+gst_imx_video_convert_multi_negotiate (GstImxVideoConvertMulti * self,
+    GstImxVideoConvertMultiPad * pad)
+{
+  GstPad *srcpad = GST_PAD_CAST (pad);
+  GstCaps *templ, *peer, *caps;
+  GstQuery *query;
+  GstBufferPool *pool = NULL;
+  GstStructure *config;
+  GstAllocator *allocator = NULL;
+  GstEvent *segment;
+  GstVideoInfo aligned;
+  guint size = 0, min = 0, max = 0;
+
+  templ = gst_pad_get_pad_template_caps (srcpad);
+  peer = gst_pad_peer_query_caps (srcpad, templ);
+  gst_caps_unref (templ);
+
+  if (gst_caps_is_empty (peer)) {
+    GST_WARNING_OBJECT (pad, "no output caps accepted by downstream");
+    gst_caps_unref (peer);
+    return FALSE;
+  }
+
+  caps = gst_imx_video_convert_multi_fixate (self, pad, peer);
+  gst_caps_unref (peer);
+
+  if (!gst_video_info_from_caps (&pad->info, caps)) {
+    gst_caps_unref (caps);
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (pad, "output caps %" GST_PTR_FORMAT, caps);
+  if (!gst_pad_push_event (srcpad, gst_event_new_caps (caps))) {
+    GST_WARNING_OBJECT (pad, "downstream refused %" GST_PTR_FORMAT, caps);
+    gst_caps_unref (caps);
+    return FALSE;
+  }
+
+  /* the segment stored on the sink pad must follow the caps */
+  segment = gst_pad_get_sticky_event (self->sinkpad, GST_EVENT_SEGMENT, 0);
+  if (segment) {
+    gst_pad_store_sticky_event (srcpad, segment);
+    gst_event_unref (segment);
+  }
+
+  /* use the downstream pool if it allocates physical memory */
+  query = gst_query_new_allocation (caps, TRUE);
+  if (gst_pad_peer_query (srcpad, query)
+      && gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    if (pool) {
+      config = gst_buffer_pool_get_config (pool);
+      gst_buffer_pool_config_get_allocator (config, &allocator, NULL);
+      if (!allocator || !GST_IS_ALLOCATOR_PHYMEM (allocator)) {
+        gst_object_unref (pool);
+        pool = NULL;
+      }
+      gst_structure_free (config);
+    }
+  }
+  gst_query_unref (query);
+
+  memset (&pad->align, 0, sizeof (GstVideoAlignment));
+  if (!ISALIGNED (pad->info.width, ALIGNMENT)
+      || !ISALIGNED (pad->info.height, ALIGNMENT)) {
+    pad->align.padding_right = ALIGNTO (pad->info.width, ALIGNMENT)
+        - pad->info.width;
+    pad->align.padding_bottom = ALIGNTO (pad->info.height, ALIGNMENT)
+        - pad->info.height;
+  }
+
+  aligned = pad->info;
+  gst_video_info_align (&aligned, &pad->align);
+  min = MAX (min, IMX_VCTM_OUT_POOL_MIN_BUFFERS);
+
+  if (pool) {
+    /* set up for this pad's caps, as imxvideoconvert does with its
+     * downstream pool */
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, caps,
+        PAGE_ALIGN (MAX (size, aligned.size)), min, max);
+    if (!gst_buffer_pool_set_config (pool, config))
+      GST_WARNING_OBJECT (pad, "downstream pool refused the config");
+    imx_video_convert_set_pool_alignment (caps, pool);
+  } else {
+    pool = gst_imx_video_convert_multi_create_pool (self, caps,
+        PAGE_ALIGN (aligned.size), min, max, &pad->align);
+  }
+  gst_caps_unref (caps);
+
+  if (!pool || !gst_buffer_pool_set_active (pool, TRUE)) {
+    GST_ERROR_OBJECT (pad, "no output buffer pool");
+    if (pool)
+      gst_object_unref (pool);
+    return FALSE;
+  }
+
+  if (pad->pool) {
+    gst_buffer_pool_set_active (pad->pool, FALSE);
+    gst_object_unref (pad->pool);
+  }
+  pad->pool = pool;
+  pad->negotiated = TRUE;
+
+  return TRUE;
+}
+
+/* the region of the input an output converts, from the region of interest
+ * meta it follows or from its crop properties */
+static void
+gst_imx_video_convert_multi_get_crop (GstImxVideoConvertMulti * self,
+    GstImxVideoConvertMultiPad * pad, GstBuffer * inbuf, Imx2DCrop * crop)
+{
+  GstVideoRegionOfInterestMeta *roi;
+  gpointer state = NULL;
+  GstMeta *meta;
+  gint width = self->in_info.width;
+  gint height = self->in_info.height;
+
+  GST_OBJECT_LOCK (pad);
+  crop->x = pad->crop.x;
+  crop->y = pad->crop.y;
+  crop->w = pad->crop.w;
+  crop->h = pad->crop.h;
+
+  if (pad->roi_type) {
+    while ((meta = gst_buffer_iterate_meta_filtered (inbuf, &state,
+                GST_VIDEO_REGION_OF_INTEREST_META_API_TYPE))) {
+      roi = (GstVideoRegionOfInterestMeta *) meta;
+      if (g_strcmp0 (g_quark_to_string (roi->roi_type), pad->roi_type) == 0) {
+        crop->x = roi->x;
+        crop->y = roi->y;
+        crop->w = roi->w;
+        crop->h = roi->h;
+        break;
+      }
+    }
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  crop->x = CLAMP (crop->x, 0, width - 1);
+  crop->y = CLAMP (crop->y, 0, height - 1);
+  if (crop->w == 0 || crop->x + (gint) crop->w > width)
+    crop->w = width - crop->x;
+  if (crop->h == 0 || crop->y + (gint) crop->h > height)
+    crop->h = height - crop->y;
+}
+
+/* copy a system memory input into physical memory, once for all outputs */
+static GstBuffer *
+gst_imx_video_convert_multi_stage (GstImxVideoConvertMulti * self,
+    GstBuffer * inbuf, GstVideoInfo * info)
+{
+  GstVideoFrame in_frame, staged_frame;
+  GstBuffer *staged = NULL;
+  GstVideoInfo staged_info;
+  GstCaps *caps;
+
+  gst_video_info_set_format (&staged_info, GST_VIDEO_INFO_FORMAT (info),
+      info->width, info->height);
+  staged_info.interlace_mode = info->interlace_mode;
+
+  if (!self->in_pool) {
+    caps = gst_video_info_to_caps (&staged_info);
+    self->in_pool = gst_imx_video_convert_multi_create_pool (self, caps,
+        staged_info.size, 1, IMX_VCTM_IN_POOL_MAX_BUFFERS, NULL);
+    gst_caps_unref (caps);
+    if (!self->in_pool || !gst_buffer_pool_set_active (self->in_pool, TRUE))
+      return NULL;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (self->in_pool, &staged, NULL)
+      != GST_FLOW_OK)
+    return NULL;
+
+  if (!gst_video_frame_map (&in_frame, info, inbuf, GST_MAP_READ)) {
+    gst_buffer_unref (staged);
+    return NULL;
+  }
+  if (!gst_video_frame_map (&staged_frame, &staged_info, staged, GST_MAP_WRITE)) {
+    gst_video_frame_unmap (&in_frame);
+    gst_buffer_unref (staged);
+    return NULL;
+  }
+  gst_video_frame_copy (&staged_frame, &in_frame);
+  gst_video_frame_unmap (&staged_frame);
+  gst_video_frame_unmap (&in_frame);
+
+  *info = staged_info;
+  return staged;
+}
+
+static void
+gst_imx_video_convert_multi_fill_frame (Imx2DFrame * frame, PhyMemBlock * mem,
+    GstBuffer * buf)
+{
+  guint i, n_mem;
+
+  frame->fd[0] = frame->fd[1] = frame->fd[2] = frame->fd[3] = -1;
+  if (gst_is_dmabuf_memory (gst_buffer_peek_memory (buf, 0))) {
+    frame->mem = mem;
+    n_mem = gst_buffer_n_memory (buf);
+    for (i = 0; i < n_mem && i < 4; i++)
+      frame->fd[i] = gst_dmabuf_memory_get_fd (gst_buffer_peek_memory (buf, i));
+    /* the device would look the fds up on every frame */
+    mem->paddr = (guint8 *) phy_addr_from_dmabuf_memory (
+        gst_buffer_peek_memory (buf, 0));
+    if (n_mem > 1)
+      mem->user_data = (gpointer) phy_addr_from_dmabuf_memory (
+          gst_buffer_peek_memory (buf, 1));
+  } else {
+    frame->mem = gst_buffer_query_phymem_block (buf);
+  }
+  frame->alpha = 0xFF;
+}
+
+static GstFlowReturn
+gst_imx_video_convert_multi_chain (GstPad * sinkpad, GstObject * parent,
+    GstBuffer * inbuf)
+{
+  GstImxVideoConvertMulti *self = (GstImxVideoConvertMulti *) parent;
+  Imx2DDevice *device = self->device;
+  GstVideoMeta *video_meta = gst_buffer_get_video_meta (inbuf);
+  GstVideoInfo in_info = self->in_info;
+  GstBuffer *input_buf = inbuf, *staged = NULL;
+  Imx2DFrame src = {0};
+  PhyMemBlock src_mem = {0};
+  GList *pads = NULL, *l;
+  GPtrArray *outbufs;
+  GstFlowReturn ret = GST_FLOW_OK, flow;
+  guint i;
+
+  if (!device || !self->have_info) {
+    gst_buffer_unref (inbuf);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  if (video_meta) {
+    for (i = 0; i < video_meta->n_planes; i++) {
+      in_info.offset[i] = video_meta->offset[i];
+      in_info.stride[i] = video_meta->stride[i];
+    }
+  }
+
+  if (!(gst_buffer_is_phymem (inbuf)
+        || gst_is_dmabuf_memory (gst_buffer_peek_memory (inbuf, 0)))) {
+    staged = gst_imx_video_convert_multi_stage (self, inbuf, &in_info);
+    if (!staged) {
+      GST_ERROR_OBJECT (self, "Can't stage input buffer");
+      gst_buffer_unref (inbuf);
+      return GST_FLOW_ERROR;
+    }
+    input_buf = staged;
+  }
+
+  src.info.fmt = GST_VIDEO_INFO_FORMAT (&in_info);
+  src.info.w = in_info.width;
+  src.info.h = in_info.height;
+  src.info.stride = in_info.stride[0];
+  src.interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
+  gst_imx_video_convert_multi_fill_frame (&src, &src_mem, input_buf);
+
+  if (device->config_input (device, &src.info) < 0) {
+    GST_ERROR_OBJECT (self, "config input failed");
+    ret = GST_FLOW_ERROR;
+    goto done;
+  }
+
+  GST_OBJECT_LOCK (self);
+  for (l = GST_ELEMENT_CAST (self)->srcpads; l; l = l->next)
+    pads = g_list_prepend (pads, gst_object_ref (l->data));
+  GST_OBJECT_UNLOCK (self);
+  pads = g_list_reverse (pads);
+
+  /* submit every output before waiting for any of them */
+  outbufs = g_ptr_array_new ();
+  for (l = pads; l; l = l->next) {
+    GstImxVideoConvertMultiPad *pad = l->data;
+    GstBuffer *outbuf = NULL;
+    Imx2DFrame dst = {0};
+    PhyMemBlock dst_mem = {0};
+
+    if (gst_pad_check_reconfigure (GST_PAD_CAST (pad)) || !pad->negotiated) {
+      if (!gst_pad_is_linked (GST_PAD_CAST (pad))
+          || !gst_imx_video_convert_multi_negotiate (self, pad)) {
+        g_ptr_array_add (outbufs, NULL);
+        continue;
+      }
+    }
+
+    if (gst_buffer_pool_acquire_buffer (pad->pool, &outbuf, NULL)
+        != GST_FLOW_OK) {
+      g_ptr_array_add (outbufs, NULL);
+      continue;
+    }
+    gst_buffer_copy_into (outbuf, inbuf,
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+    gst_imx_video_convert_multi_get_crop (self, pad, inbuf, &src.crop);
+    GST_OBJECT_LOCK (pad);
+    src.rotate = pad->rotate;
+    GST_OBJECT_UNLOCK (pad);
+
+    dst.info.fmt = GST_VIDEO_INFO_FORMAT (&pad->info);
+    dst.info.w = pad->info.width + pad->align.padding_left
+        + pad->align.padding_right;
+    dst.info.h = pad->info.height + pad->align.padding_top
+        + pad->align.padding_bottom;
+    dst.info.stride = pad->info.stride[0];
+    dst.interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
+    dst.crop.x = 0;
+    dst.crop.y = 0;
+    dst.crop.w = pad->info.width;
+    dst.crop.h = pad->info.height;
+    gst_imx_video_convert_multi_fill_frame (&dst, &dst_mem, outbuf);
+
+    if (device->config_output (device, &dst.info) < 0
+        || device->set_rotate (device, src.rotate) < 0
+        || device->convert (device, &dst, &src) < 0) {
+      GST_WARNING_OBJECT (pad, "conversion failed");
+      gst_buffer_unref (outbuf);
+      outbuf = NULL;
+    }
+    g_ptr_array_add (outbufs, outbuf);
+  }
+
+  if (imx_2d_device_wait_fence (device, imx_2d_device_get_fence (device)) < 0) {
+    GST_ERROR_OBJECT (self, "wait for frame conversion failed");
+    for (i = 0; i < outbufs->len; i++) {
+      if (g_ptr_array_index (outbufs, i))
+        gst_buffer_unref (g_ptr_array_index (outbufs, i));
+    }
+    ret = GST_FLOW_ERROR;
+  } else {
+    for (l = pads, i = 0; l; l = l->next, i++) {
+      GstBuffer *outbuf = g_ptr_array_index (outbufs, i);
+
+      if (outbuf)
+        flow = gst_pad_push (GST_PAD_CAST (l->data), outbuf);
+      else if (gst_pad_is_linked (GST_PAD_CAST (l->data)))
+        flow = GST_FLOW_NOT_NEGOTIATED;
+      else
+        flow = GST_FLOW_NOT_LINKED;
+
+      ret = gst_flow_combiner_update_pad_flow (self->flow_combiner,
+          GST_PAD_CAST (l->data), flow);
+    }
+  }
+
+  g_ptr_array_free (outbufs, TRUE);
+  g_list_free_full (pads, gst_object_unref);
+
+done:
+  if (staged)
+    gst_buffer_unref (staged);
+  gst_buffer_unref (inbuf);
+  return ret;
+}
+
+static gboolean
+gst_imx_video_convert_multi_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstImxVideoConvertMulti *self = (GstImxVideoConvertMulti *) parent;
+  GstCaps *caps;
+  GList *l;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+      gst_event_parse_caps (event, &caps);
+      if (!gst_video_info_from_caps (&self->in_info, caps)) {
+        gst_event_unref (event);
+        return FALSE;
+      }
+      self->have_info = TRUE;
+      GST_DEBUG_OBJECT (self, "input caps %" GST_PTR_FORMAT, caps);
+
+      if (self->in_pool) {
+        gst_buffer_pool_set_active (self->in_pool, FALSE);
+        gst_object_unref (self->in_pool);
+        self->in_pool = NULL;
+      }
+
+      /* every output negotiates its own caps from the new input */
+      GST_OBJECT_LOCK (self);
+      for (l = GST_ELEMENT_CAST (self)->srcpads; l; l = l->next)
+        ((GstImxVideoConvertMultiPad *) l->data)->negotiated = FALSE;
+      GST_OBJECT_UNLOCK (self);
+
+      gst_event_unref (event);
+      return TRUE;
+    case GST_EVENT_SEGMENT:
+      /* an output without caps yet gets the segment after them at
+       * negotiation, the others right away before their next buffer */
+      GST_OBJECT_LOCK (self);
+      for (l = GST_ELEMENT_CAST (self)->srcpads; l; l = l->next) {
+        if (gst_pad_has_current_caps (GST_PAD_CAST (l->data)))
+          gst_pad_store_sticky_event (GST_PAD_CAST (l->data), event);
+      }
+      GST_OBJECT_UNLOCK (self);
+
+      gst_event_unref (event);
+      return TRUE;
+    case GST_EVENT_FLUSH_STOP:
+      gst_flow_combiner_reset (self->flow_combiner);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static gboolean
+gst_imx_video_convert_multi_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GstImxVideoConvertMulti *self = (GstImxVideoConvertMulti *) parent;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      gst_query_parse_caps (query, &filter);
+      caps = gst_pad_get_pad_template_caps (pad);
+      if (filter) {
+        GstCaps *tmp = gst_caps_intersect_full (filter, caps,
+            GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref (caps);
+        caps = tmp;
+      }
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+      return TRUE;
+    }
+    case GST_QUERY_ALLOCATION:
+      /* let upstream allocate physical memory, outputs never see its
+       * buffers so no downstream pool is proxied */
+      if (imx_video_convert_obtain_allocator (self->device, &self->allocator))
+        gst_query_add_allocation_param (query, self->allocator, NULL);
+      gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+      gst_query_add_allocation_meta (query,
+          GST_VIDEO_REGION_OF_INTEREST_META_API_TYPE, NULL);
+      return TRUE;
+    default:
+      break;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static gboolean
+gst_imx_video_convert_multi_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CAPS) {
+    GstCaps *filter, *caps;
+
+    gst_query_parse_caps (query, &filter);
+    caps = gst_pad_get_pad_template_caps (pad);
+    if (filter) {
+      GstCaps *tmp = gst_caps_intersect_full (filter, caps,
+          GST_CAPS_INTERSECT_FIRST);
+      gst_caps_unref (caps);
+      caps = tmp;
+    }
+    gst_query_set_caps_result (query, caps);
+    gst_caps_unref (caps);
+    return TRUE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static gboolean
+gst_imx_video_convert_multi_copy_sticky (GstPad * pad, GstEvent ** event,
+    gpointer user_data)
+{
+  GstPad *srcpad = GST_PAD_CAST (user_data);
+
+  /* caps and segment follow at negotiation */
+  if (GST_EVENT_TYPE (*event) != GST_EVENT_CAPS
+      && GST_EVENT_TYPE (*event) != GST_EVENT_SEGMENT)
+    gst_pad_store_sticky_event (srcpad, *event);
+
+  return TRUE;
+}
+
+static GstPad *
+gst_imx_video_convert_multi_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps)
+{
+  GstImxVideoConvertMulti *self = (GstImxVideoConvertMulti *) element;
+  GstPad *pad;
+  gchar *pad_name;
+
+  GST_OBJECT_LOCK (self);
+  if (name)
+    pad_name = g_strdup (name);
+  else
+    pad_name = g_strdup_printf ("src_%u", self->next_pad_id++);
+  GST_OBJECT_UNLOCK (self);
+
+  pad = g_object_new (GST_TYPE_IMX_VIDEO_CONVERT_MULTI_PAD, "name", pad_name,
+      "direction", GST_PAD_SRC, "template", templ, NULL);
+  g_free (pad_name);
+
+  gst_pad_set_query_function (pad,
+      GST_DEBUG_FUNCPTR (gst_imx_video_convert_multi_src_query));
+  gst_pad_use_fixed_caps (pad);
+
+  if (!gst_element_add_pad (element, pad)) {
+    gst_object_unref (pad);
+    return NULL;
+  }
+
+  gst_pad_sticky_events_foreach (self->sinkpad,
+      gst_imx_video_convert_multi_copy_sticky, pad);
+  gst_flow_combiner_add_pad (self->flow_combiner, pad);
+
+  GST_DEBUG_OBJECT (self, "added output %s", GST_PAD_NAME (pad));
+  return pad;
+}
+
+static void
+gst_imx_video_convert_multi_release_pad (GstElement * element, GstPad * pad)
+{
+  GstImxVideoConvertMulti *self = (GstImxVideoConvertMulti *) element;
+
+  GST_DEBUG_OBJECT (self, "release output %s", GST_PAD_NAME (pad));
+
+  gst_flow_combiner_remove_pad (self->flow_combiner, pad);
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
+static GstStateChangeReturn
+gst_imx_video_convert_multi_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstImxVideoConvertMulti *self = (GstImxVideoConvertMulti *) element;
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY) {
+    gst_flow_combiner_reset (self->flow_combiner);
+    self->have_info = FALSE;
+    if (self->in_pool) {
+      gst_buffer_pool_set_active (self->in_pool, FALSE);
+      gst_object_unref (self->in_pool);
+      self->in_pool = NULL;
+    }
+  }
+
+  return ret;
+}
+
+static void
+gst_imx_video_convert_multi_finalize (GObject * object)
+{
+  GstImxVideoConvertMulti *self = (GstImxVideoConvertMulti *) object;
+
+  if (self->in_pool) {
+    gst_buffer_pool_set_active (self->in_pool, FALSE);
+    gst_object_unref (self->in_pool);
+  }
+  if (self->allocator) {
+    gst_imx_2d_device_allocator_flush (self->allocator);
+    gst_object_unref (self->allocator);
+  }
+  gst_flow_combiner_free (self->flow_combiner);
+
+  if (self->device) {
+    self->device->close (self->device);
+    imx_2d_device_destroy (self->device);
+    self->device = NULL;
+  }
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_imx_video_convert_multi_class_init (GstImxVideoConvertMultiClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *element_class = (GstElementClass *) klass;
+  const Imx2DDeviceInfo *in_plugin = (const Imx2DDeviceInfo *)
+      g_type_get_qdata (G_OBJECT_CLASS_TYPE (klass), GST_IMX_VCTM_PARAMS_QDATA);
+  gchar longname[64] = {0};
+  GstCaps *caps;
+  GList *list;
+
+  g_assert (in_plugin != NULL);
+
+  Imx2DDevice *dev = imx_2d_device_create (in_plugin->device_type);
+  if (!dev)
+    return;
+
+  snprintf (longname, 64, "IMX %s Multiple Output Video Converter",
+      in_plugin->name);
+  gst_element_class_set_static_metadata (element_class, longname,
+      "Filter/Converter/Video",
+      "Video CSC/Resize/Crop/Rotate into several outputs in one pass",
+      IMX_GST_PLUGIN_AUTHOR);
+
+  list = dev->get_supported_in_fmts (dev);
+  caps = imx_video_convert_caps_from_fmt_list (list);
+  g_list_free (list);
+  gst_element_class_add_pad_template (element_class,
+      gst_pad_template_new ("sink", GST_PAD_SINK, GST_PAD_ALWAYS, caps));
+
+  list = dev->get_supported_out_fmts (dev);
+  caps = imx_video_convert_caps_from_fmt_list (list);
+  g_list_free (list);
+  gst_element_class_add_pad_template (element_class,
+      gst_pad_template_new_with_gtype ("src_%u", GST_PAD_SRC, GST_PAD_REQUEST,
+          caps, GST_TYPE_IMX_VIDEO_CONVERT_MULTI_PAD));
+
+  imx_2d_device_destroy (dev);
+
+  klass->in_plugin = in_plugin;
+  parent_class = g_type_class_peek_parent (klass);
+
+  gobject_class->finalize = gst_imx_video_convert_multi_finalize;
+  element_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_imx_video_convert_multi_request_new_pad);
+  element_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_imx_video_convert_multi_release_pad);
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_imx_video_convert_multi_change_state);
+}
+
+static void
+gst_imx_video_convert_multi_init (GstImxVideoConvertMulti * self)
+{
+  GstImxVideoConvertMultiClass *klass =
+      (GstImxVideoConvertMultiClass *) G_OBJECT_GET_CLASS (self);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  self->sinkpad = gst_pad_new_from_template (
+      gst_element_class_get_pad_template (element_class, "sink"), "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_imx_video_convert_multi_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_imx_video_convert_multi_sink_event));
+  gst_pad_set_query_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_imx_video_convert_multi_sink_query));
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->flow_combiner = gst_flow_combiner_new ();
+
+  if (klass->in_plugin)
+    self->device = imx_2d_device_create (klass->in_plugin->device_type);
+
+  if (!self->device) {
+    GST_ERROR ("Create video process device failed.");
+    return;
+  }
+
+  if (self->device->open (self->device) < 0) {
+    GST_ERROR ("Open video process device failed.");
+    imx_2d_device_destroy (self->device);
+    self->device = NULL;
+    return;
+  }
+
+  imx_2d_device_set_async (self->device, TRUE);
+}
+
+gboolean
+gst_imx_video_convert_multi_register (GstPlugin * plugin)
+{
+  GTypeInfo tinfo = {
+    sizeof (GstImxVideoConvertMultiClass),
+    NULL,
+    NULL,
+    (GClassInitFunc) gst_imx_video_convert_multi_class_init,
+    NULL,
+    NULL,
+    sizeof (GstImxVideoConvertMulti),
+    0,
+    (GInstanceInitFunc) gst_imx_video_convert_multi_init,
+  };
+
+  GType type;
+  gchar *t_name;
+
+  const Imx2DDeviceInfo *in_plugin = imx_get_2d_devices();
+
+  while (in_plugin->name) {
+    if (!in_plugin->is_exist()) {
+      in_plugin++;
+      continue;
+    }
+
+    t_name = g_strdup_printf ("imxvideoconvertmulti_%s", in_plugin->name);
+    type = g_type_from_name (t_name);
+
+    if (!type) {
+      type = g_type_register_static (GST_TYPE_ELEMENT, t_name, &tinfo, 0);
+      g_type_set_qdata (type, GST_IMX_VCTM_PARAMS_QDATA, (gpointer) in_plugin);
+    }
+
+    if (!gst_element_register (plugin, t_name, GST_RANK_NONE, type)) {
+      GST_ERROR ("Failed to register %s", t_name);
+      g_free (t_name);
+      return FALSE;
+    }
+    g_free (t_name);
+
+    in_plugin++;
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,82 @@
+/* GStreamer IMX video convert plugin, multiple output converter
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_IMX_VIDEO_CONVERT_MULTI_H__
+#define __GST_IMX_VIDEO_CONVERT_MULTI_H__
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <gst/base/gstflowcombiner.h>
+#include "gstimxcommon.h"
+#include "imx_2d_device.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_IMX_VIDEO_CONVERT_MULTI_PAD \
+        (gst_imx_video_convert_multi_pad_get_type())
+#define GST_IMX_VIDEO_CONVERT_MULTI_PAD(obj) \
+        (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_IMX_VIDEO_CONVERT_MULTI_PAD, \
+            GstImxVideoConvertMultiPad))
+#define GST_IS_IMX_VIDEO_CONVERT_MULTI_PAD(obj) \
+        (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_IMX_VIDEO_CONVERT_MULTI_PAD))
+
+/* one output of the converter, its caps come from downstream */
+typedef struct _GstImxVideoConvertMultiPad {
+  GstPad parent;
+
+  /* properties, protected by the object lock */
+  Imx2DRotationMode rotate;
+  GstVideoRectangle crop;
+  gchar *roi_type;
+
+  gboolean negotiated;
+  GstVideoInfo info;
+  GstVideoAlignment align;
+  GstBufferPool *pool;
+} GstImxVideoConvertMultiPad;
+
+typedef struct _GstImxVideoConvertMultiPadClass {
+  GstPadClass parent_class;
+} GstImxVideoConvertMultiPadClass;
+
+typedef struct _GstImxVideoConvertMulti {
+  GstElement element;
+
+  GstPad *sinkpad;
+  Imx2DDevice *device;
+  GstAllocator *allocator;
+  GstBufferPool *in_pool;
+  GstFlowCombiner *flow_combiner;
+  gboolean have_info;
+  GstVideoInfo in_info;
+  guint next_pad_id;
+} GstImxVideoConvertMulti;
+
+typedef struct _GstImxVideoConvertMultiClass {
+  GstElementClass parent_class;
+
+  const Imx2DDeviceInfo *in_plugin;
+} GstImxVideoConvertMultiClass;
+
+GType gst_imx_video_convert_multi_pad_get_type (void);
+gboolean gst_imx_video_convert_multi_register (GstPlugin * plugin);
+
+G_END_DECLS
+
+#endif /* __GST_IMX_VIDEO_CONVERT_MULTI_H__ */
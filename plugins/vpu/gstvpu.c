@@ -20,6 +20,7 @@
 #include "gstvpuenc.h"
 #include <gst/allocators/gstphysmemory.h>
 #include "gstimxcommon.h"
+#include "gstvpuslab.h"
 
 gint
 gst_vpu_find_std (GstCaps * caps)
@@ -47,7 +48,7 @@ gst_vpu_free_internal_mem (VpuInternalMem * vpu_internal_mem)
   g_list_foreach (vpu_internal_mem->internal_virt_mem, (GFunc) g_free, NULL);
   g_list_free (vpu_internal_mem->internal_virt_mem);
   vpu_internal_mem->internal_virt_mem = NULL;
-  g_list_foreach (vpu_internal_mem->internal_phy_mem, (GFunc) gst_memory_unref, NULL);
+  g_list_foreach (vpu_internal_mem->internal_phy_mem, (GFunc) gst_vpu_slab_free, NULL);
   g_list_free (vpu_internal_mem->internal_phy_mem);
   vpu_internal_mem->internal_phy_mem = NULL;
 
@@ -57,14 +58,11 @@ gst_vpu_free_internal_mem (VpuInternalMem * vpu_internal_mem)
 gboolean
 gst_vpu_allocate_internal_mem (VpuInternalMem * vpu_internal_mem)
 {
-  GstAllocationParams params;
-  GstMemory * gst_memory;
-  PhyMemBlock *memory;
+  GstVpuSlabBlock *block;
 	gint size;
   guint8 *ptr;
   gint i;
 
-	memset(&params, 0, sizeof(GstAllocationParams));
 	for (i = 0; i < vpu_internal_mem->mem_info.nSubBlockNum; ++i) {
 		size = vpu_internal_mem->mem_info.MemSubBlock[i].nAlignment \
            + vpu_internal_mem->mem_info.MemSubBlock[i].nSize;
@@ -83,17 +81,17 @@ gst_vpu_allocate_internal_mem (VpuInternalMem * vpu_internal_mem)
           ptr, vpu_internal_mem->mem_info.MemSubBlock[i].nAlignment);
       vpu_internal_mem->internal_virt_mem = g_list_append (vpu_internal_mem->internal_virt_mem, ptr);
 		} else if (vpu_internal_mem->mem_info.MemSubBlock[i].MemType == VPU_MEM_PHY) {
-      params.align = vpu_internal_mem->mem_info.MemSubBlock[i].nAlignment - 1;
-      gst_memory = gst_allocator_alloc (gst_vpu_allocator_obtain(), size, &params);
-      memory = gst_memory_query_phymem_block (gst_memory);
-      if (memory == NULL) {
+      /* carved from the shared slab, reused by the next instance */
+      block = gst_vpu_slab_alloc (vpu_internal_mem->mem_info.MemSubBlock[i].nSize, \
+          vpu_internal_mem->mem_info.MemSubBlock[i].nAlignment);
+      if (block == NULL) {
         GST_ERROR ("Could not allocate memory using VPU allocator");
         return FALSE;
       }
 
-			vpu_internal_mem->mem_info.MemSubBlock[i].pVirtAddr = memory->vaddr;
-			vpu_internal_mem->mem_info.MemSubBlock[i].pPhyAddr = memory->paddr;
-      vpu_internal_mem->internal_phy_mem = g_list_append (vpu_internal_mem->internal_phy_mem, gst_memory);
+			vpu_internal_mem->mem_info.MemSubBlock[i].pVirtAddr = block->vaddr;
+			vpu_internal_mem->mem_info.MemSubBlock[i].pPhyAddr = block->paddr;
+      vpu_internal_mem->internal_phy_mem = g_list_append (vpu_internal_mem->internal_phy_mem, block);
 		} else {
 			GST_WARNING ("sub block %d type is unknown - skipping", i);
 		}
@@ -102,63 +100,188 @@ gst_vpu_allocate_internal_mem (VpuInternalMem * vpu_internal_mem)
   return TRUE;
 }
 
+/* byte offsets of the components inside a frame and the luma/chroma strides,
+ * same for every buffer of the pool so it is computed once per registration */
+typedef struct {
+  gint stride_y;
+  gint stride_c;
+  gsize comp_offset[3];
+  gsize plane_offset[3];
+  guint n_planes;
+} VpuPlaneLayout;
+
+static void
+gst_vpu_plane_layout_init (VpuPlaneLayout * layout, GstVideoInfo * info, \
+    GstBuffer * buffer)
+{
+  GstVideoMeta *vmeta = gst_buffer_get_video_meta (buffer);
+  gsize offset[GST_VIDEO_MAX_PLANES];
+  gint stride[GST_VIDEO_MAX_PLANES];
+  guint n_comps = GST_VIDEO_INFO_N_COMPONENTS (info);
+  guint i, c;
+
+  memset (layout, 0, sizeof (VpuPlaneLayout));
+  layout->n_planes = MIN (GST_VIDEO_INFO_N_PLANES (info), 3);
+
+  /* buffers from the pool carry the aligned layout in their video meta */
+  for (i = 0; i < GST_VIDEO_INFO_N_PLANES (info); i++) {
+    if (vmeta && i < vmeta->n_planes) {
+      offset[i] = vmeta->offset[i];
+      stride[i] = vmeta->stride[i];
+    } else {
+      offset[i] = GST_VIDEO_INFO_PLANE_OFFSET (info, i);
+      stride[i] = GST_VIDEO_INFO_PLANE_STRIDE (info, i);
+    }
+  }
+
+  for (i = 0; i < layout->n_planes; i++)
+    layout->plane_offset[i] = offset[i];
+
+  for (c = 0; c < 3; c++) {
+    guint comp = MIN (c, n_comps - 1);
+    layout->comp_offset[c] = offset[GST_VIDEO_INFO_COMP_PLANE (info, comp)] \
+      + GST_VIDEO_INFO_COMP_POFFSET (info, comp);
+  }
+
+  layout->stride_y = stride[GST_VIDEO_INFO_COMP_PLANE (info, 0)];
+  layout->stride_c = stride[GST_VIDEO_INFO_COMP_PLANE (info, MIN (1, n_comps - 1))];
+}
+
+/* physical address of the buffer memory, cached on the memory as the lookup
+ * can cost an ioctl and pool buffers are registered again on every reconfig */
+static unsigned char *
+gst_vpu_get_phys_addr (GstBuffer * buffer)
+{
+  GstMemory *mem = gst_buffer_peek_memory (buffer, 0);
+  PhyMemBlock *mem_block;
+  unsigned char *paddr;
+
+  paddr = gst_mini_object_get_qdata (GST_MINI_OBJECT (mem), \
+      g_quark_from_static_string ("vpu-phys-addr"));
+  if (paddr)
+    return paddr;
+
+  if (gst_is_phys_memory (mem)) {
+    paddr = (unsigned char *) gst_phys_memory_get_phys_addr (mem);
+  } else if (gst_buffer_is_phymem (buffer)) {
+    mem_block = gst_buffer_query_phymem_block (buffer);
+    paddr = mem_block ? mem_block->paddr : NULL;
+  } else {
+    return NULL;
+  }
+
+  if (paddr)
+    gst_mini_object_set_qdata (GST_MINI_OBJECT (mem), \
+        g_quark_from_static_string ("vpu-phys-addr"), paddr, NULL);
+
+  return paddr;
+}
+
+/* buffers spread over several memories, planes aren't in one mapping */
+static gboolean
+gst_vpu_register_frame_buffer_mapped (GstBuffer * buffer, GstVideoInfo *info, \
+    VpuFrameBuffer * vpu_frame, GstMapFlags flags)
+{
+  GstVideoFrame frame;
+
+  if (!gst_video_frame_map (&frame, info, buffer, flags)) {
+    GST_ERROR ("Could not map video buffer");
+    return FALSE;
+  }
+  vpu_frame->nStrideY = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+  vpu_frame->nStrideC = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
+
+  vpu_frame->pbufY = gst_vpu_get_phys_addr (buffer);
+  vpu_frame->pbufCb = vpu_frame->pbufY + \
+    (GST_VIDEO_FRAME_COMP_DATA (&frame, 1) - GST_VIDEO_FRAME_COMP_DATA (&frame, 0));
+  vpu_frame->pbufCr = vpu_frame->pbufCb + \
+    (GST_VIDEO_FRAME_COMP_DATA (&frame, 2) - GST_VIDEO_FRAME_COMP_DATA (&frame, 1));
+
+  vpu_frame->pbufVirtY = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
+  vpu_frame->pbufVirtCb = GST_VIDEO_FRAME_PLANE_DATA (&frame, 1);
+  vpu_frame->pbufVirtCr = GST_VIDEO_FRAME_PLANE_DATA (&frame, 2);
+
+  gst_video_frame_unmap (&frame);
+
+  return TRUE;
+}
+
 gboolean
 gst_vpu_register_frame_buffer (GList * gstbuffer_in_vpudec, \
     GstVideoInfo *info, VpuFrameBuffer * vpuframebuffers)
 {
   VpuFrameBuffer *vpu_frame;
-  GstVideoFrame frame;
-  PhyMemBlock * mem_block;
+  VpuPlaneLayout layout;
+  PhyMemBlock *mem_block;
+  GstMapFlags flags;
+  GstMapInfo minfo;
+  GstMemory *mem;
+  guint8 *vaddr;
   GstBuffer *buffer;
+  GList *l;
   guint i;
+  gint64 start_time;
+
+  if (gstbuffer_in_vpudec == NULL)
+    return TRUE;
+
+  start_time = g_get_monotonic_time ();
+  flags = IS_HANTRO() ? (GST_MAP_WRITE | GST_MAP_READ) : GST_MAP_READ;
+  gst_vpu_plane_layout_init (&layout, info, gstbuffer_in_vpudec->data);
 
-  for (i=0; i<g_list_length (gstbuffer_in_vpudec); i++) {
-    buffer = g_list_nth_data (gstbuffer_in_vpudec, i);
+  for (l = gstbuffer_in_vpudec, i = 0; l; l = l->next, i++) {
+    buffer = l->data;
     GST_DEBUG ("gstbuffer index: %d get from list: %x\n", \
         i, buffer);
     vpu_frame = &(vpuframebuffers[i]);
 
-    if (IS_HANTRO()) {
-      if (!gst_video_frame_map (&frame, info, buffer, GST_MAP_WRITE | GST_MAP_READ)) {
-        GST_ERROR ("Could not map video buffer");
-        return FALSE;
-      }
-    } else {
-      if (!gst_video_frame_map (&frame, info, buffer, GST_MAP_READ)) {
-        GST_ERROR ("Could not map video buffer");
-        return FALSE;
-      }
-    }
-    vpu_frame->nStrideY = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
-    vpu_frame->nStrideC = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
-
     if (!(gst_buffer_is_phymem (buffer)
         || gst_is_phys_memory (gst_buffer_peek_memory (buffer, 0)))) {
       GST_ERROR ("isn't physical memory allocator");
-      gst_video_frame_unmap (&frame);
       return FALSE;
     }
 
-    if (gst_is_phys_memory (gst_buffer_peek_memory (buffer, 0))) {
-      vpu_frame->pbufY = gst_phys_memory_get_phys_addr(gst_buffer_peek_memory (buffer, 0));
-      GST_DEBUG ("video buffer phys add: %p", vpu_frame->pbufY);
+    if (gst_buffer_n_memory (buffer) > 1) {
+      if (!gst_vpu_register_frame_buffer_mapped (buffer, info, vpu_frame, flags))
+        return FALSE;
+      continue;
+    }
+
+    /* phymem is mapped by its allocator for the life of the memory. fd
+     * memory is only mapped for the registration, as with the frame map
+     * of multi-memory buffers, and its virtual addresses must not be used
+     * once it returns, the VPU works on the physical ones */
+    mem = gst_buffer_peek_memory (buffer, 0);
+    mem_block = gst_buffer_is_phymem (buffer) ? \
+      gst_buffer_query_phymem_block (buffer) : NULL;
+    if (mem_block && mem_block->vaddr) {
+      vaddr = mem_block->vaddr;
     } else {
-      mem_block = gst_buffer_query_phymem_block (buffer);
-      vpu_frame->pbufY = mem_block->paddr;
-      GST_DEBUG ("video buffer phys add: %p", vpu_frame->pbufY);
+      if (!gst_memory_map (mem, &minfo, flags)) {
+        GST_ERROR ("Could not map video buffer");
+        return FALSE;
+      }
+      vaddr = minfo.data;
+      gst_memory_unmap (mem, &minfo);
     }
+
+    vpu_frame->nStrideY = layout.stride_y;
+    vpu_frame->nStrideC = layout.stride_c;
+
+    vpu_frame->pbufY = gst_vpu_get_phys_addr (buffer);
     vpu_frame->pbufCb = vpu_frame->pbufY + \
-      (GST_VIDEO_FRAME_COMP_DATA (&frame, 1) - GST_VIDEO_FRAME_COMP_DATA (&frame, 0));
+      (layout.comp_offset[1] - layout.comp_offset[0]);
     vpu_frame->pbufCr = vpu_frame->pbufCb + \
-      (GST_VIDEO_FRAME_COMP_DATA (&frame, 2) - GST_VIDEO_FRAME_COMP_DATA (&frame, 1));
+      (layout.comp_offset[2] - layout.comp_offset[1]);
+    GST_DEBUG ("video buffer phys add: %p", vpu_frame->pbufY);
 
-    vpu_frame->pbufVirtY = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
-    vpu_frame->pbufVirtCb = GST_VIDEO_FRAME_PLANE_DATA (&frame, 1);
-    vpu_frame->pbufVirtCr = GST_VIDEO_FRAME_PLANE_DATA (&frame, 2);
-
-    gst_video_frame_unmap (&frame);
+    vpu_frame->pbufVirtY = vaddr + layout.plane_offset[0];
+    vpu_frame->pbufVirtCb = layout.n_planes > 1 ? vaddr + layout.plane_offset[1] : NULL;
+    vpu_frame->pbufVirtCr = layout.n_planes > 2 ? vaddr + layout.plane_offset[2] : NULL;
   }
 
+  GST_DEBUG ("registered %d frame buffers in %" G_GINT64_FORMAT " us", \
+      i, g_get_monotonic_time () - start_time);
+
   return TRUE;
 }
-
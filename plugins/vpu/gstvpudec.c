@@ -59,7 +59,12 @@ enum
   PROP_ADAPTIVE_FRAME_DROP,
   PROP_FRAMES_PLUS,
   PROP_USE_VPU_MEMORY,
-  PROP_DISABLE_REORDER
+  PROP_DISABLE_REORDER,
+  PROP_TSM_STATISTICS,
+  PROP_THUMBNAIL_WIDTH,
+  PROP_THUMBNAIL_HEIGHT,
+  PROP_THUMBNAIL_FORMAT,
+  PROP_THUMBNAIL_MODE
 };
 
 #define DEFAULT_LOW_LATENCY FALSE
@@ -67,6 +72,10 @@ enum
 #define DEFAULT_ADAPTIVE_FRAME_DROP TRUE
 #define DEFAULT_FRAMES_PLUS 3
 #define DEFAULT_DISABLE_REORDER FALSE
+#define DEFAULT_THUMBNAIL_WIDTH 0
+#define DEFAULT_THUMBNAIL_HEIGHT 0
+#define DEFAULT_THUMBNAIL_FORMAT GST_VIDEO_FORMAT_NV12
+#define DEFAULT_THUMBNAIL_MODE FALSE
 /* Default to use VPU memory for video frame buffer as all video frame buffer
  * must registe to VPU. Change video frame buffer will cause close VPU which
  * will cause video stream lost.
@@ -150,6 +159,27 @@ gst_vpu_dec_class_init (GstVpuDecClass * klass)
       g_param_spec_boolean ("disable-reorder", "disable reorder",
         "disable vpu reorder when end to end streaming",
           DEFAULT_DISABLE_REORDER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_TSM_STATISTICS,
+      g_param_spec_boxed ("tsm-statistics", "timestamp manager statistics",
+        "timestamp counters, discontinuities, jitter histogram and frame interval",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_THUMBNAIL_WIDTH,
+      g_param_spec_uint ("thumbnail-width", "thumbnail width",
+        "attach a downscaled copy of this width to each frame as meta (0: disable)",
+          0, G_MAXINT, DEFAULT_THUMBNAIL_WIDTH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_THUMBNAIL_HEIGHT,
+      g_param_spec_uint ("thumbnail-height", "thumbnail height",
+        "attach a downscaled copy of this height to each frame as meta (0: disable)",
+          0, G_MAXINT, DEFAULT_THUMBNAIL_HEIGHT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_THUMBNAIL_FORMAT,
+      g_param_spec_enum ("thumbnail-format", "thumbnail format",
+        "raw video format of the downscaled copy",
+          GST_TYPE_VIDEO_FORMAT, DEFAULT_THUMBNAIL_FORMAT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_THUMBNAIL_MODE,
+      g_param_spec_boolean ("thumbnail-mode", "thumbnail mode",
+        "decode a few key frames with minimal frame buffers, overrides frame-plus, frame-drop and disable-reorder",
+          DEFAULT_THUMBNAIL_MODE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
  
   gst_element_class_add_pad_template (element_class,
           gst_pad_template_new ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
@@ -190,6 +220,10 @@ gst_vpu_dec_init (GstVpuDec * dec)
   GST_VPU_DEC_USE_VPU_MEMORY (dec->vpu_dec_object) = DEFAULT_USE_VPU_MEMORY;
   GST_VPU_DEC_MIN_BUF_CNT (dec->vpu_dec_object) = 0;
   GST_VPU_DEC_DISABLE_REORDER (dec->vpu_dec_object) = DEFAULT_DISABLE_REORDER;
+  GST_VPU_DEC_THUMBNAIL_WIDTH (dec->vpu_dec_object) = DEFAULT_THUMBNAIL_WIDTH;
+  GST_VPU_DEC_THUMBNAIL_HEIGHT (dec->vpu_dec_object) = DEFAULT_THUMBNAIL_HEIGHT;
+  GST_VPU_DEC_THUMBNAIL_FORMAT (dec->vpu_dec_object) = DEFAULT_THUMBNAIL_FORMAT;
+  GST_VPU_DEC_THUMBNAIL_MODE (dec->vpu_dec_object) = DEFAULT_THUMBNAIL_MODE;
 
   /* As VPU can support stream mode. need call parser before decode */
   gst_video_decoder_set_packetized (GST_VIDEO_DECODER (dec), TRUE);
@@ -220,6 +254,22 @@ gst_vpu_dec_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DISABLE_REORDER:
       g_value_set_boolean (value, GST_VPU_DEC_DISABLE_REORDER (dec->vpu_dec_object));
       break;
+    case PROP_TSM_STATISTICS:
+      g_value_take_boxed (value,
+          gst_vpu_dec_object_get_tsm_statistics (dec->vpu_dec_object));
+      break;
+    case PROP_THUMBNAIL_WIDTH:
+      g_value_set_uint (value, GST_VPU_DEC_THUMBNAIL_WIDTH (dec->vpu_dec_object));
+      break;
+    case PROP_THUMBNAIL_HEIGHT:
+      g_value_set_uint (value, GST_VPU_DEC_THUMBNAIL_HEIGHT (dec->vpu_dec_object));
+      break;
+    case PROP_THUMBNAIL_FORMAT:
+      g_value_set_enum (value, GST_VPU_DEC_THUMBNAIL_FORMAT (dec->vpu_dec_object));
+      break;
+    case PROP_THUMBNAIL_MODE:
+      g_value_set_boolean (value, GST_VPU_DEC_THUMBNAIL_MODE (dec->vpu_dec_object));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -251,6 +301,18 @@ gst_vpu_dec_set_property (GObject * object, guint prop_id,
     case PROP_DISABLE_REORDER:
       GST_VPU_DEC_DISABLE_REORDER (dec->vpu_dec_object) = g_value_get_boolean (value);
       break;
+    case PROP_THUMBNAIL_WIDTH:
+      GST_VPU_DEC_THUMBNAIL_WIDTH (dec->vpu_dec_object) = g_value_get_uint (value);
+      break;
+    case PROP_THUMBNAIL_HEIGHT:
+      GST_VPU_DEC_THUMBNAIL_HEIGHT (dec->vpu_dec_object) = g_value_get_uint (value);
+      break;
+    case PROP_THUMBNAIL_FORMAT:
+      GST_VPU_DEC_THUMBNAIL_FORMAT (dec->vpu_dec_object) = g_value_get_enum (value);
+      break;
+    case PROP_THUMBNAIL_MODE:
+      GST_VPU_DEC_THUMBNAIL_MODE (dec->vpu_dec_object) = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -574,8 +636,10 @@ gst_vpu_dec_decide_allocation (GstVideoDecoder * bdec, GstQuery * query)
     dec->vpu_dec_object->use_my_pool = FALSE;
   }
 
+  /* thumbnail mode outputs every frame right away, the minimum is enough */
   max = min += GST_VPU_DEC_MIN_BUF_CNT (dec->vpu_dec_object) \
-        + GST_VPU_DEC_FRAMES_PLUS (dec->vpu_dec_object);
+        + (GST_VPU_DEC_THUMBNAIL_MODE (dec->vpu_dec_object) ? 0 \
+            : GST_VPU_DEC_FRAMES_PLUS (dec->vpu_dec_object));
   GST_VPU_DEC_ACTUAL_BUF_CNT (dec->vpu_dec_object) = min;
   params.align = GST_VPU_DEC_BUF_ALIGNMENT (dec->vpu_dec_object);
   params.flags |= GST_MEMORY_FLAG_READONLY;
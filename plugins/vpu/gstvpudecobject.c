@@ -342,7 +342,11 @@ gst_vpu_dec_object_start (GstVpuDecObject * vpu_dec_object)
     return FALSE;
   }
 
+  GST_OBJECT_LOCK (vpu_dec_object);
   vpu_dec_object->tsm = createTSManager (VPUDEC_TS_BUFFER_LENGTH_DEFAULT);
+  /* statistics can be queried from application thread */
+  setTSManagerLocking (vpu_dec_object->tsm, 1);
+  GST_OBJECT_UNLOCK (vpu_dec_object);
 
   if (!gst_vpu_dec_object_init_qos(vpu_dec_object)) {
     GST_ERROR_OBJECT(vpu_dec_object, "gst_vpu_dec_object_init_qos fail");
@@ -354,6 +358,7 @@ gst_vpu_dec_object_start (GstVpuDecObject * vpu_dec_object)
   vpu_dec_object->total_frames = 0;
   vpu_dec_object->total_time = 0;
   vpu_dec_object->vpu_hold_buffer = 0;
+  vpu_dec_object->thumbnail_failed = FALSE;
 
   vpu_dec_object->state = STATE_ALLOCATED_INTERNAL_BUFFER;
 
@@ -447,10 +452,14 @@ gst_vpu_dec_object_stop (GstVpuDecObject * vpu_dec_object)
 		vpu_dec_object->gstbuffer2frame_table = NULL;
 	}
 
+  GST_OBJECT_LOCK (vpu_dec_object);
   if (vpu_dec_object->tsm) {
     destroyTSManager (vpu_dec_object->tsm);
     vpu_dec_object->tsm = NULL;
   }
+  GST_OBJECT_UNLOCK (vpu_dec_object);
+
+  imx_thumbnail_deinit (&vpu_dec_object->thumbnail);
 
   if (vpu_dec_object->handle) {
     dec_ret = VPU_DecClose(vpu_dec_object->handle);
@@ -571,8 +580,11 @@ gst_vpu_dec_object_set_vpu_param (GstVpuDecObject * vpu_dec_object, \
     vpu_dec_object->chroma_interleaved = TRUE;
   }
 
+  /* in thumbnail mode only sync samples come in and each one must come out
+   * right away: no reorder, no frame drop and the VPU minimum frame buffer
+   * count. The properties keep the values the user set. */
   open_param->nReorderEnable = 1;
-  if (vpu_dec_object->disable_reorder) {
+  if (vpu_dec_object->disable_reorder || vpu_dec_object->thumbnail_mode) {
       open_param->nReorderEnable = 0;
   }
   open_param->nAdaptiveMode = 0;
@@ -638,6 +650,7 @@ gst_vpu_dec_object_config (GstVpuDecObject * vpu_dec_object, \
     GstVideoDecoder * bdec, GstVideoCodecState * state)
 {
   VpuDecRetCode dec_ret;
+  gint64 start_time;
 
   if (state) {
     /* Keep a copy of the input state */
@@ -674,12 +687,14 @@ gst_vpu_dec_object_config (GstVpuDecObject * vpu_dec_object, \
     vpu_dec_object->state = STATE_ALLOCATED_INTERNAL_BUFFER;
   }
 
+  start_time = g_get_monotonic_time ();
   g_list_foreach (vpu_dec_object->gstbuffer_in_vpudec, (GFunc) gst_buffer_unref, NULL);
   g_list_free (vpu_dec_object->gstbuffer_in_vpudec);
   g_list_free (vpu_dec_object->gstbuffer_in_vpudec2);
   vpu_dec_object->gstbuffer_in_vpudec = NULL;
   vpu_dec_object->gstbuffer_in_vpudec2 = NULL;
-  GST_DEBUG_OBJECT (vpu_dec_object, "gstbuffer_in_vpudec list free\n");
+  GST_DEBUG_OBJECT (vpu_dec_object, "gstbuffer_in_vpudec list free, unregister took %" \
+      G_GINT64_FORMAT " us\n", g_get_monotonic_time () - start_time);
 
   if (vpu_dec_object->state < STATE_OPENED) {
     if (!gst_vpu_dec_object_open_vpu(vpu_dec_object, bdec, state)) {
@@ -697,6 +712,7 @@ gst_vpu_dec_object_register_frame_buffer (GstVpuDecObject * vpu_dec_object, \
 {
 	VpuDecRetCode dec_ret;
   GstBuffer *buffer;
+  GList *l;
   guint i;
 
   g_hash_table_remove_all (vpu_dec_object->frame2gstbuffer_table);
@@ -708,8 +724,9 @@ gst_vpu_dec_object_register_frame_buffer (GstVpuDecObject * vpu_dec_object, \
       return FALSE;
   }
 
-  for (i=0; i<vpu_dec_object->actual_buf_cnt; i++) {
-    buffer = g_list_nth_data (vpu_dec_object->gstbuffer_in_vpudec, i);
+  for (l = vpu_dec_object->gstbuffer_in_vpudec, i = 0; \
+      l && i < vpu_dec_object->actual_buf_cnt; l = l->next, i++) {
+    buffer = l->data;
 
     g_hash_table_replace(vpu_dec_object->frame2gstbuffer_table, \
         (gpointer)(vpu_dec_object->vpuframebuffers[i].pbufVirtY), (gpointer)(buffer));
@@ -746,6 +763,7 @@ gst_vpu_dec_object_handle_reconfig(GstVpuDecObject * vpu_dec_object, \
   gint height_align;
   gint width_align;
   GstBuffer *buffer;
+  guint n_buffers;
   guint i;
 
   dec_ret = VPU_DecGetInitialInfo(vpu_dec_object->handle, &(vpu_dec_object->init_info));
@@ -872,19 +890,25 @@ gst_vpu_dec_object_handle_reconfig(GstVpuDecObject * vpu_dec_object, \
   }
 #endif
 
-  while (g_list_length (vpu_dec_object->gstbuffer_in_vpudec) \
-          < vpu_dec_object->actual_buf_cnt) {
+  /* prepend and reverse once, appending walks the whole list every time */
+  n_buffers = g_list_length (vpu_dec_object->gstbuffer_in_vpudec);
+  vpu_dec_object->gstbuffer_in_vpudec = g_list_reverse (vpu_dec_object->gstbuffer_in_vpudec);
+  vpu_dec_object->gstbuffer_in_vpudec2 = g_list_reverse (vpu_dec_object->gstbuffer_in_vpudec2);
+  while (n_buffers < vpu_dec_object->actual_buf_cnt) {
     GST_DEBUG_OBJECT (vpu_dec_object, "gst_video_decoder_allocate_output_buffer before");
     buffer = gst_video_decoder_allocate_output_buffer(bdec);
-    vpu_dec_object->gstbuffer_in_vpudec = g_list_append ( \
+    vpu_dec_object->gstbuffer_in_vpudec = g_list_prepend ( \
         vpu_dec_object->gstbuffer_in_vpudec, buffer);
-    vpu_dec_object->gstbuffer_in_vpudec2 = g_list_append ( \
+    vpu_dec_object->gstbuffer_in_vpudec2 = g_list_prepend ( \
         vpu_dec_object->gstbuffer_in_vpudec2, buffer);
+    n_buffers++;
     GST_DEBUG_OBJECT (vpu_dec_object, "gst_video_decoder_allocate_output_buffer end");
     GST_DEBUG_OBJECT (vpu_dec_object, "gstbuffer get from buffer pool: %x\n", buffer);
     GST_DEBUG_OBJECT (vpu_dec_object, "gstbuffer_in_vpudec list length: %d actual_buf_cnt: %d \n", \
-        g_list_length (vpu_dec_object->gstbuffer_in_vpudec), vpu_dec_object->actual_buf_cnt);
+        n_buffers, vpu_dec_object->actual_buf_cnt);
   }
+  vpu_dec_object->gstbuffer_in_vpudec = g_list_reverse (vpu_dec_object->gstbuffer_in_vpudec);
+  vpu_dec_object->gstbuffer_in_vpudec2 = g_list_reverse (vpu_dec_object->gstbuffer_in_vpudec2);
 
   if (!gst_vpu_dec_object_free_mv_buffer(vpu_dec_object)) {
     GST_ERROR_OBJECT(vpu_dec_object, "gst_vpu_dec_object_free_mv_buffer fail");
@@ -1034,7 +1058,8 @@ gst_vpu_dec_object_send_output (GstVpuDecObject * vpu_dec_object, \
   out_frame = gst_video_decoder_get_frame (bdec, frame_number);
   GST_LOG_OBJECT (vpu_dec_object, "gst_video_decoder_get_frame: 0x%x\n", \
       out_frame);
-  if (out_frame && vpu_dec_object->frame_drop)
+  if (out_frame && vpu_dec_object->frame_drop
+      && !vpu_dec_object->thumbnail_mode)
     gst_vpu_dec_object_process_qos (vpu_dec_object, bdec, out_frame);
  
   if (drop != TRUE) {
@@ -1155,6 +1180,22 @@ gst_vpu_dec_object_send_output (GstVpuDecObject * vpu_dec_object, \
     pmeta->rfc_chroma_offset = out_frame_info.pExtInfo->rfc_chroma_offset;
   }
 
+  /* scale the downscaled copy straight from the decoded physical frame */
+  if (vpu_dec_object->thumbnail_width && vpu_dec_object->thumbnail_height
+      && !vpu_dec_object->thumbnail_failed) {
+    if (!imx_thumbnail_is_active (&vpu_dec_object->thumbnail)
+        && !imx_thumbnail_init (&vpu_dec_object->thumbnail,
+          vpu_dec_object->thumbnail_format, vpu_dec_object->thumbnail_width,
+          vpu_dec_object->thumbnail_height)) {
+      GST_WARNING_OBJECT (vpu_dec_object, "thumbnail disabled, no usable 2D device");
+      vpu_dec_object->thumbnail_failed = TRUE;
+    } else {
+      imx_thumbnail_attach (&vpu_dec_object->thumbnail,
+          out_frame->output_buffer, &vpu_dec_object->output_state->info,
+          &vpu_dec_object->video_align);
+    }
+  }
+
 #if !GST_CHECK_VERSION(1, 18, 0)
   if (vpu_dec_object->init_info.hasHdr10Meta || vpu_dec_object->init_info.hasColorDesc) {
     GstVideoHdr10Meta *meta = gst_buffer_add_video_hdr10_meta (out_frame->output_buffer);
@@ -1199,11 +1240,12 @@ static GstFlowReturn
 gst_vpu_dec_object_get_gst_buffer (GstVideoDecoder * bdec, GstVpuDecObject * vpu_dec_object)
 {
   GstBuffer *buffer;
+  guint frame_plus = vpu_dec_object->thumbnail_mode ? 0 : vpu_dec_object->frame_plus;
 
   GST_DEBUG_OBJECT (vpu_dec_object, "min_buf_cnt: %d frame_plus: %d actual_buf_cnt: %d",
-      vpu_dec_object->min_buf_cnt, vpu_dec_object->frame_plus, vpu_dec_object->actual_buf_cnt);
+      vpu_dec_object->min_buf_cnt, frame_plus, vpu_dec_object->actual_buf_cnt);
   if (g_list_length (vpu_dec_object->gstbuffer_in_vpudec) \
-      < (vpu_dec_object->min_buf_cnt + vpu_dec_object->frame_plus)
+      < (vpu_dec_object->min_buf_cnt + frame_plus)
       || vpu_dec_object->vpu_hold_buffer > 0) {
     if (vpu_dec_object->vpu_hold_buffer > 0) {
       buffer = g_list_nth_data (vpu_dec_object->gstbuffer_in_vpudec2, 0);
@@ -1579,3 +1621,38 @@ gst_vpu_dec_object_flush (GstVideoDecoder * bdec, GstVpuDecObject * vpu_dec_obje
   return TRUE;
 }
 
+
+GstStructure *
+gst_vpu_dec_object_get_tsm_statistics (GstVpuDecObject * vpu_dec_object)
+{
+  TSMStatistics stats;
+  GValue histogram = G_VALUE_INIT;
+  GValue bucket = G_VALUE_INIT;
+  GstStructure *s;
+  gint i;
+
+  GST_OBJECT_LOCK (vpu_dec_object);
+  getTSManagerStatistics (vpu_dec_object->tsm, &stats);
+  GST_OBJECT_UNLOCK (vpu_dec_object);
+
+  s = gst_structure_new ("tsm-statistics",
+      "received", G_TYPE_UINT64, (guint64) stats.received,
+      "invalid", G_TYPE_UINT64, (guint64) stats.invalid,
+      "sent", G_TYPE_UINT64, (guint64) stats.sent,
+      "interpolated", G_TYPE_UINT64, (guint64) stats.interpolated,
+      "discontinuities", G_TYPE_UINT64, (guint64) stats.discontinuities,
+      "jitter", G_TYPE_UINT64, (guint64) stats.jitter,
+      "frame-interval", G_TYPE_UINT64, (guint64) stats.frame_interval,
+      NULL);
+
+  g_value_init (&histogram, GST_TYPE_ARRAY);
+  g_value_init (&bucket, G_TYPE_UINT64);
+  for (i = 0; i < TSM_JITTER_HISTOGRAM_SIZE; i++) {
+    g_value_set_uint64 (&bucket, stats.jitter_histogram[i]);
+    gst_value_array_append_value (&histogram, &bucket);
+  }
+  gst_structure_take_value (s, "jitter-histogram", &histogram);
+  g_value_unset (&bucket);
+
+  return s;
+}
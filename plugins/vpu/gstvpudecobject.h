@@ -23,6 +23,7 @@
 
 #include <gst/video/gstvideodecoder.h>
 #include "video-tsm/mfw_gst_ts.h"
+#include "thumbnailmeta/imxthumbnailmeta.h"
 #include "gstvpu.h"
 
 G_BEGIN_DECLS
@@ -50,6 +51,10 @@ typedef struct _GstVpuDecObjectClass GstVpuDecObjectClass;
 #define GST_VPU_DEC_BUF_ALIGNMENT(o)         ((o)->buf_align)
 #define GST_VPU_DEC_VIDEO_ALIGNMENT(o)       ((o)->video_align)
 #define GST_VPU_DEC_DISABLE_REORDER(o)       ((o)->disable_reorder)
+#define GST_VPU_DEC_THUMBNAIL_WIDTH(o)       ((o)->thumbnail_width)
+#define GST_VPU_DEC_THUMBNAIL_HEIGHT(o)      ((o)->thumbnail_height)
+#define GST_VPU_DEC_THUMBNAIL_FORMAT(o)      ((o)->thumbnail_format)
+#define GST_VPU_DEC_THUMBNAIL_MODE(o)        ((o)->thumbnail_mode)
  
 typedef enum {
   STATE_NULL    = 0,
@@ -74,6 +79,10 @@ struct _GstVpuDecObject {
   guint actual_buf_cnt;
   guint buf_align;
   GstVideoAlignment video_align;
+  guint thumbnail_width;
+  guint thumbnail_height;
+  GstVideoFormat thumbnail_format;
+  gboolean thumbnail_mode;
 
   GstVideoCodecState *input_state;
   GstVideoCodecState *output_state;
@@ -114,6 +123,8 @@ struct _GstVpuDecObject {
   gboolean vpu_need_reconfig;
   gboolean disable_reorder;
   void *tsm;
+  GstImxThumbnail thumbnail;
+  gboolean thumbnail_failed;
   TSMGR_MODE tsm_mode;
   GstClockTime last_valid_ts;
   GstClockTime last_received_ts;
@@ -146,6 +157,7 @@ gboolean gst_vpu_dec_object_config (GstVpuDecObject * vpu_dec_object, \
 GstFlowReturn gst_vpu_dec_object_decode (GstVpuDecObject * vpu_dec_object, \
     GstVideoDecoder * bdec, GstVideoCodecFrame * frame);
 gboolean gst_vpu_dec_object_flush (GstVideoDecoder * bdec, GstVpuDecObject * vpu_dec_object);
+GstStructure * gst_vpu_dec_object_get_tsm_statistics (GstVpuDecObject * vpu_dec_object);
 
 G_END_DECLS
 
@@ -28,11 +28,19 @@
 #include "gstimxcommon.h"
 #include "gstvpuenc.h"
 #include "gstvpudec.h"
+#include "gstvpuallocator.h"
+#include "gstvpuslab.h"
 
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
   if (HAS_VPU()) {
+    GstAllocator *allocator = gst_vpu_allocator_obtain ();
+
+    gst_vpu_slab_set_backend (allocator);
+    if (allocator)
+      gst_object_unref (allocator);
+
     if (!IS_HANTRO() || IS_IMX8MM() || IS_IMX8MP())
       if (!gst_vpu_enc_register (plugin))
         return FALSE;
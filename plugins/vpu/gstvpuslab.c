@@ -0,0 +1,388 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Process wide arena for VPU internal physical memory. Large chunks are
+ * reserved from the backend allocator once (the VPU allocator on target, any
+ * GstAllocatorPhyMem in host tests) and sub blocks are carved from them
+ * first fit, so short lived decoder/encoder instances reuse the same CMA
+ * area instead of allocating and freeing many small blocks each open.
+ */
+
+#include <string.h>
+#include <gst/allocators/gstallocatorphymem.h>
+#include "gstvpuslab.h"
+
+GST_DEBUG_CATEGORY_STATIC (vpu_slab_debug);
+#define GST_CAT_DEFAULT vpu_slab_debug
+
+#define VPU_SLAB_ALIGN(x, align) (((x) + (align) - 1) / (align) * (align))
+
+typedef struct
+{
+  gsize offset;
+  gsize size;
+} VpuSlabRange;
+
+typedef struct
+{
+  GstMemory *memory;
+  PhyMemBlock *block;
+  gsize size;
+  gsize used;
+  /* reserved for one block bigger than a standard chunk */
+  gboolean dedicated;
+  /* free ranges sorted by offset, neighbours are always merged */
+  GList *free_list;
+} VpuSlabChunk;
+
+static GMutex slab_lock;
+static GstAllocator *slab_backend;
+static GList *slab_chunks;
+static guint slab_blocks;
+static gsize slab_used;
+static gsize slab_high_water;
+
+static void
+gst_vpu_slab_debug_init (void)
+{
+  static gsize done = 0;
+
+  if (g_once_init_enter (&done)) {
+    GST_DEBUG_CATEGORY_INIT (vpu_slab_debug, "vpuslab", 0,
+        "VPU internal memory slab");
+    g_once_init_leave (&done, 1);
+  }
+}
+
+static VpuSlabChunk *
+gst_vpu_slab_chunk_new (gsize size)
+{
+  GstAllocationParams params;
+  VpuSlabChunk *chunk;
+  VpuSlabRange *range;
+  GstMemory *memory;
+  PhyMemBlock *block;
+
+  if (!slab_backend) {
+    GST_ERROR ("No backend allocator set");
+    return NULL;
+  }
+
+  memset (&params, 0, sizeof (GstAllocationParams));
+  memory = gst_allocator_alloc (slab_backend, size, &params);
+  if (!memory)
+    return NULL;
+
+  block = gst_memory_query_phymem_block (memory);
+  if (!block) {
+    gst_memory_unref (memory);
+    return NULL;
+  }
+
+  chunk = g_slice_new0 (VpuSlabChunk);
+  chunk->memory = memory;
+  chunk->block = block;
+  chunk->size = block->size;
+
+  range = g_slice_new (VpuSlabRange);
+  range->offset = 0;
+  range->size = chunk->size;
+  chunk->free_list = g_list_append (NULL, range);
+
+  GST_DEBUG ("reserve chunk size %" G_GSIZE_FORMAT " paddr %p", chunk->size,
+      block->paddr);
+
+  return chunk;
+}
+
+static void
+gst_vpu_slab_chunk_free (VpuSlabChunk * chunk)
+{
+  GST_DEBUG ("release chunk size %" G_GSIZE_FORMAT " paddr %p", chunk->size,
+      chunk->block->paddr);
+
+  while (chunk->free_list) {
+    g_slice_free (VpuSlabRange, chunk->free_list->data);
+    chunk->free_list = g_list_delete_link (chunk->free_list, chunk->free_list);
+  }
+  gst_memory_unref (chunk->memory);
+  g_slice_free (VpuSlabChunk, chunk);
+}
+
+/* first fit, the start is aligned on the physical address */
+static gboolean
+gst_vpu_slab_chunk_carve (VpuSlabChunk * chunk, gsize size, gsize align,
+    GstVpuSlabBlock * block)
+{
+  guintptr base = (guintptr) chunk->block->paddr;
+  GList *l;
+
+  for (l = chunk->free_list; l; l = l->next) {
+    VpuSlabRange *range = (VpuSlabRange *) l->data;
+    gsize start = VPU_SLAB_ALIGN (base + range->offset, align) - base;
+    gsize end = range->offset + range->size;
+
+    if (start + size > end)
+      continue;
+
+    block->chunk = chunk;
+    block->offset = start;
+    block->size = size;
+    block->paddr = chunk->block->paddr + start;
+    block->vaddr = chunk->block->vaddr + start;
+
+    /* keep the alignment gap in front and the tail behind as free ranges */
+    if (start + size < end) {
+      VpuSlabRange *tail = g_slice_new (VpuSlabRange);
+      tail->offset = start + size;
+      tail->size = end - tail->offset;
+      chunk->free_list = g_list_insert_before (chunk->free_list, l->next, tail);
+    }
+    if (start > range->offset) {
+      range->size = start - range->offset;
+    } else {
+      g_slice_free (VpuSlabRange, range);
+      chunk->free_list = g_list_delete_link (chunk->free_list, l);
+    }
+
+    chunk->used += size;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+static void
+gst_vpu_slab_chunk_return (VpuSlabChunk * chunk, gsize offset, gsize size)
+{
+  VpuSlabRange *range, *prev = NULL;
+  GList *l;
+
+  for (l = chunk->free_list; l; l = l->next) {
+    if (((VpuSlabRange *) l->data)->offset > offset)
+      break;
+    prev = (VpuSlabRange *) l->data;
+  }
+
+  if (prev && prev->offset + prev->size == offset) {
+    prev->size += size;
+    range = prev;
+  } else {
+    range = g_slice_new (VpuSlabRange);
+    range->offset = offset;
+    range->size = size;
+    chunk->free_list = g_list_insert_before (chunk->free_list, l, range);
+  }
+
+  if (l && range->offset + range->size == ((VpuSlabRange *) l->data)->offset) {
+    VpuSlabRange *next = (VpuSlabRange *) l->data;
+    range->size += next->size;
+    g_slice_free (VpuSlabRange, next);
+    chunk->free_list = g_list_delete_link (chunk->free_list, l);
+  }
+
+  chunk->used -= size;
+}
+
+static void
+gst_vpu_slab_collect_stats (GstVpuSlabStats * stats)
+{
+  gsize total_free = 0;
+  GList *c, *l;
+
+  memset (stats, 0, sizeof (GstVpuSlabStats));
+  stats->n_blocks = slab_blocks;
+  stats->used = slab_used;
+  stats->high_water = slab_high_water;
+
+  for (c = slab_chunks; c; c = c->next) {
+    VpuSlabChunk *chunk = (VpuSlabChunk *) c->data;
+
+    stats->n_chunks++;
+    stats->reserved += chunk->size;
+    for (l = chunk->free_list; l; l = l->next) {
+      VpuSlabRange *range = (VpuSlabRange *) l->data;
+      stats->free_ranges++;
+      total_free += range->size;
+      stats->largest_free = MAX (stats->largest_free, range->size);
+    }
+  }
+
+  if (total_free > 0)
+    stats->fragmentation = 100 - stats->largest_free * 100 / total_free;
+}
+
+static void
+gst_vpu_slab_log_stats (const gchar * what)
+{
+  GstVpuSlabStats stats;
+
+  gst_vpu_slab_collect_stats (&stats);
+  GST_INFO ("%s: %u blocks in %u chunks, used %" G_GSIZE_FORMAT
+      " reserved %" G_GSIZE_FORMAT " high water %" G_GSIZE_FORMAT
+      ", %u free ranges largest %" G_GSIZE_FORMAT " fragmentation %u%%",
+      what, stats.n_blocks, stats.n_chunks, stats.used, stats.reserved,
+      stats.high_water, stats.free_ranges, stats.largest_free,
+      stats.fragmentation);
+}
+
+gboolean
+gst_vpu_slab_set_backend (GstAllocator * allocator)
+{
+  GList *l, *next;
+
+  gst_vpu_slab_debug_init ();
+
+  g_return_val_if_fail (allocator == NULL
+      || GST_IS_ALLOCATOR_PHYMEM (allocator), FALSE);
+
+  g_mutex_lock (&slab_lock);
+
+  if (allocator == slab_backend) {
+    g_mutex_unlock (&slab_lock);
+    return TRUE;
+  }
+
+  /* the kept empty chunks belong to the old backend */
+  for (l = slab_chunks; l; l = next) {
+    next = l->next;
+    if (((VpuSlabChunk *) l->data)->used > 0)
+      continue;
+    gst_vpu_slab_chunk_free ((VpuSlabChunk *) l->data);
+    slab_chunks = g_list_delete_link (slab_chunks, l);
+  }
+
+  if (slab_chunks) {
+    g_mutex_unlock (&slab_lock);
+    GST_WARNING ("Can't change backend, %u blocks still in use", slab_blocks);
+    return FALSE;
+  }
+
+  if (slab_backend)
+    gst_object_unref (slab_backend);
+  slab_backend = allocator ? gst_object_ref (allocator) : NULL;
+  slab_high_water = 0;
+
+  g_mutex_unlock (&slab_lock);
+
+  GST_DEBUG ("backend %" GST_PTR_FORMAT, allocator);
+
+  return TRUE;
+}
+
+GstVpuSlabBlock *
+gst_vpu_slab_alloc (gsize size, gsize align)
+{
+  GstVpuSlabBlock *block;
+  VpuSlabChunk *chunk;
+  GList *l;
+
+  gst_vpu_slab_debug_init ();
+
+  if (size == 0)
+    return NULL;
+  if (align == 0)
+    align = 1;
+
+  block = g_slice_new0 (GstVpuSlabBlock);
+
+  g_mutex_lock (&slab_lock);
+
+  for (l = slab_chunks; l; l = l->next) {
+    if (gst_vpu_slab_chunk_carve ((VpuSlabChunk *) l->data, size, align, block))
+      break;
+  }
+
+  if (!l) {
+    /* big blocks get a chunk of their own */
+    chunk = gst_vpu_slab_chunk_new (MAX (GST_VPU_SLAB_CHUNK_SIZE, size + align));
+    if (!chunk || !gst_vpu_slab_chunk_carve (chunk, size, align, block)) {
+      g_mutex_unlock (&slab_lock);
+      GST_ERROR ("Could not reserve VPU memory for %" G_GSIZE_FORMAT " bytes",
+          size);
+      if (chunk)
+        gst_vpu_slab_chunk_free (chunk);
+      g_slice_free (GstVpuSlabBlock, block);
+      return NULL;
+    }
+    chunk->dedicated = size + align > GST_VPU_SLAB_CHUNK_SIZE;
+    slab_chunks = g_list_append (slab_chunks, chunk);
+  }
+
+  slab_blocks++;
+  slab_used += size;
+  if (slab_used > slab_high_water) {
+    slab_high_water = slab_used;
+    gst_vpu_slab_log_stats ("new high water");
+  }
+
+  g_mutex_unlock (&slab_lock);
+
+  GST_DEBUG ("alloc size %" G_GSIZE_FORMAT " align %" G_GSIZE_FORMAT
+      " paddr %p", size, align, block->paddr);
+
+  return block;
+}
+
+void
+gst_vpu_slab_free (GstVpuSlabBlock * block)
+{
+  VpuSlabChunk *chunk;
+  guint empty = 0;
+  GList *l, *next;
+
+  if (!block)
+    return;
+
+  g_mutex_lock (&slab_lock);
+
+  chunk = (VpuSlabChunk *) block->chunk;
+  gst_vpu_slab_chunk_return (chunk, block->offset, block->size);
+  slab_blocks--;
+  slab_used -= block->size;
+
+  /* keep a few empty standard chunks around for the next instance, give
+   * the rest and every chunk dedicated to an oversized block back to CMA */
+  for (l = slab_chunks; l; l = next) {
+    VpuSlabChunk *c = (VpuSlabChunk *) l->data;
+    next = l->next;
+    if (c->used > 0)
+      continue;
+    if (c->dedicated || ++empty > GST_VPU_SLAB_KEEP_CHUNKS) {
+      gst_vpu_slab_chunk_free (c);
+      slab_chunks = g_list_delete_link (slab_chunks, l);
+    }
+  }
+
+  if (slab_blocks == 0)
+    gst_vpu_slab_log_stats ("idle");
+
+  g_mutex_unlock (&slab_lock);
+
+  g_slice_free (GstVpuSlabBlock, block);
+}
+
+void
+gst_vpu_slab_get_stats (GstVpuSlabStats * stats)
+{
+  g_mutex_lock (&slab_lock);
+  gst_vpu_slab_collect_stats (stats);
+  g_mutex_unlock (&slab_lock);
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_VPU_SLAB_H__
+#define __GST_VPU_SLAB_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* chunks reserved from the backend allocator, sub blocks are carved from them */
+#define GST_VPU_SLAB_CHUNK_SIZE (4 * 1024 * 1024)
+/* empty chunks kept for the next decoder/encoder instance */
+#define GST_VPU_SLAB_KEEP_CHUNKS 2
+
+typedef struct _GstVpuSlabBlock GstVpuSlabBlock;
+
+struct _GstVpuSlabBlock
+{
+  guint8 *vaddr;
+  guint8 *paddr;
+  gsize size;
+
+  /* private */
+  gpointer chunk;
+  gsize offset;
+};
+
+typedef struct
+{
+  guint n_chunks;
+  guint n_blocks;
+  gsize reserved;
+  gsize used;
+  gsize high_water;
+  guint free_ranges;
+  gsize largest_free;
+  /* percentage of free bytes not usable by a single block */
+  guint fragmentation;
+} GstVpuSlabStats;
+
+/* the backend must be a GstAllocatorPhyMem, it can only be changed while no
+ * block is in use, doing so releases the kept chunks and the high water */
+gboolean gst_vpu_slab_set_backend (GstAllocator * allocator);
+GstVpuSlabBlock * gst_vpu_slab_alloc (gsize size, gsize align);
+void gst_vpu_slab_free (GstVpuSlabBlock * block);
+void gst_vpu_slab_get_stats (GstVpuSlabStats * stats);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Time per decoded frame of the min heap index against the linear scan it
+ * replaced, with the ring holding depth frames in flight. Both have to send
+ * the same timestamps, the run fails otherwise.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tsmtrace.h"
+
+#define BENCH_FRAMES 200000
+#define BENCH_DURATION 33366667
+
+typedef struct
+{
+  int ts_buf_size;
+  int depth;
+  int keyed;
+} BenchConfig;
+
+static const BenchConfig configs[] = {
+  {128, 8, 0},
+  {128, 8, 1},
+  {128, 64, 0},
+  {128, 64, 1},
+  /* vpudec's ring */
+  {1024, 16, 1},
+  {1024, 256, 0},
+  {1024, 256, 1},
+  {1024, 1000, 1},
+};
+
+
+/* presentation index of the n-th frame in decode order, 8 frame B pyramid */
+static long long
+decode_to_pts (long long n)
+{
+  static const int pyramid[8] = { 0, 7, 3, 1, 2, 5, 4, 6 };
+  return (n & ~7LL) + pyramid[n & 7];
+}
+
+
+static double
+now_ns (void)
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+
+static double
+bench_run (const TsmImpl * impl, const BenchConfig * c, long long *sum)
+{
+  long long pool = c->depth * 2 + 8;
+  long long in = 0, out = 0;
+  double start;
+  void *tsm;
+
+  tsm = impl->create (c->ts_buf_size);
+  impl->set_frame_rate (tsm, 30000, 1001);
+  *sum = 0;
+
+  start = now_ns ();
+  while (out < BENCH_FRAMES) {
+    if ((in - out < c->depth) && (in < BENCH_FRAMES)) {
+      long long pts = decode_to_pts (in);
+      if (c->keyed) {
+        impl->receive2 (tsm, pts * BENCH_DURATION, 1000);
+        impl->valid2 (tsm, 1000, tsm_trace_key (1 + pts % pool));
+      } else {
+        impl->receive (tsm, pts * BENCH_DURATION);
+      }
+      in++;
+    } else {
+      *sum += impl->send2 (tsm, c->keyed ? tsm_trace_key (1 + out % pool) :
+          TSM_KEY_NONE);
+      out++;
+    }
+  }
+  start = now_ns () - start;
+
+  impl->destroy (tsm);
+
+  return start / BENCH_FRAMES;
+}
+
+
+int
+main (int argc, char **argv)
+{
+  int i, failed = 0;
+
+  (void) argc;
+  (void) argv;
+
+  printf ("%-6s %-6s %-6s %12s %12s %8s\n", "ring", "depth", "keyed",
+      "linear ns", "heap ns", "speedup");
+
+  for (i = 0; i < (int) (sizeof (configs) / sizeof (configs[0])); i++) {
+    const BenchConfig *c = &configs[i];
+    long long sum_linear, sum_heap;
+    double linear, heap;
+
+    linear = bench_run (&tsm_impl_linear, c, &sum_linear);
+    heap = bench_run (&tsm_impl_heap, c, &sum_heap);
+
+    printf ("%-6d %-6d %-6s %12.1f %12.1f %7.1fx\n", c->ts_buf_size,
+        c->depth, c->keyed ? "yes" : "no", linear, heap, linear / heap);
+
+    if (sum_linear != sum_heap) {
+      printf ("  sent timestamps differ\n");
+      failed++;
+    }
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Replays timestamp manager call traces against the min heap index and the
+ * linear scan it replaced, every call must return the same timestamp and
+ * leave the same position, frame interval and pre buffer count.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tsmtrace.h"
+
+#define FUZZ_SEEDS 300
+#define FUZZ_OPS 4000
+
+static const char *default_traces[] = {
+  "h264-pyramid-keyed.tsm",
+  "mpeg2-ibbp-sparse.tsm",
+  "rtsp-shared-ts.tsm",
+  "fifo-reverse.tsm",
+  "ring-overflow.tsm",
+};
+
+
+static int
+replay_parity (const char *name, const TsmTrace * trace)
+{
+  void *heap, *linear;
+  int i, ret = 0;
+
+  heap = tsm_impl_heap.create (trace->ts_buf_size);
+  linear = tsm_impl_linear.create (trace->ts_buf_size);
+  if ((heap == NULL) || (linear == NULL)) {
+    fprintf (stderr, "%s: can't create timestamp manager\n", name);
+    ret = -1;
+    goto done;
+  }
+
+  for (i = 0; i < trace->n_ops; i++) {
+    const TsmTraceOp *op = &trace->ops[i];
+    TsmTraceResult h, l;
+
+    tsm_trace_step (&tsm_impl_heap, heap, op, &h);
+    tsm_trace_step (&tsm_impl_linear, linear, op, &l);
+
+    if ((h.ts != l.ts) || (h.position != l.position)
+        || (h.interval != l.interval)
+        || (h.pre_buffer_cnt != l.pre_buffer_cnt)) {
+      fprintf (stderr, "%s: op %d '%c %lld %lld' differs\n"
+          "  heap   ts %lld position %lld interval %lld prebuffer %d\n"
+          "  linear ts %lld position %lld interval %lld prebuffer %d\n",
+          name, i, op->op, op->a, op->b,
+          h.ts, h.position, h.interval, h.pre_buffer_cnt,
+          l.ts, l.position, l.interval, l.pre_buffer_cnt);
+      ret = -1;
+      break;
+    }
+  }
+
+done:
+  if (heap)
+    tsm_impl_heap.destroy (heap);
+  if (linear)
+    tsm_impl_linear.destroy (linear);
+
+  return ret;
+}
+
+
+static unsigned int
+fuzz_rand (unsigned int *state)
+{
+  *state = *state * 1103515245 + 12345;
+  return (*state >> 16) & 0x7fff;
+}
+
+
+/*
+ * Decoder like sequences: mostly increasing timestamps output with a small
+ * reorder window, plus the rare calls, invalid and repeated timestamps,
+ * keys not in the ring, resyncs and rings small enough to overflow.
+ */
+static void
+fuzz_trace (unsigned int seed, TsmTrace * trace)
+{
+  static const int sizes[] = { 4, 8, 16, 33, 128 };
+  unsigned int state = seed;
+  long long ts = 0, key = 0;
+  int i, in_flight = 0;
+
+  trace->ts_buf_size = sizes[fuzz_rand (&state) % 5];
+  trace->n_ops = FUZZ_OPS;
+  trace->ops = calloc (FUZZ_OPS, sizeof (TsmTraceOp));
+
+  for (i = 0; i < FUZZ_OPS; i++) {
+    TsmTraceOp *op = &trace->ops[i];
+    unsigned int r = fuzz_rand (&state) % 100;
+
+    if (r < 1) {
+      op->op = 'm';
+      op->a = (fuzz_rand (&state) % 8) ? MODE_AI : MODE_FIFO;
+      op->b = (fuzz_rand (&state) % 4) ? ts : TSM_TIMESTAMP_NONE;
+      in_flight = 0;
+    } else if (r < 2) {
+      op->op = 'f';
+      op->a = fuzz_rand (&state) % 120;
+      op->b = fuzz_rand (&state) % 3;
+    } else if (r < 40 || (r < 70 && in_flight < 3)) {
+      long long jitter = (long long) (fuzz_rand (&state) % 7) - 3;
+      int kind = fuzz_rand (&state) % 20;
+
+      ts += 33333333;
+      op->a = ts + jitter * 33333333;
+      if (kind == 0)
+        op->a = TSM_TIMESTAMP_NONE;
+      else if (kind == 1)
+        op->a = ts - 33333333;
+      else if (kind == 2)
+        op->a = ts + 11000000000LL;
+      if (fuzz_rand (&state) % 2) {
+        op->op = 'R';
+        op->b = fuzz_rand (&state) % 3000;
+      } else {
+        op->op = 'r';
+      }
+      in_flight++;
+    } else if (r < 55) {
+      op->op = 'v';
+      op->a = fuzz_rand (&state) % 4000;
+      key = (fuzz_rand (&state) % 10) ? (key % 24) + 1 : 0;
+      op->b = key;
+    } else if (r < 57) {
+      op->op = 'l';
+      op->a = fuzz_rand (&state) % 4000;
+    } else {
+      /* recent keys mostly, a miss now and then */
+      op->op = (fuzz_rand (&state) % 10) ? 's' : 'q';
+      if (fuzz_rand (&state) % 3)
+        op->a = 1 + (key + 24 - fuzz_rand (&state) % 6) % 24;
+      else
+        op->a = (fuzz_rand (&state) % 5) ? 0 : 99;
+      if (op->op == 's')
+        in_flight--;
+    }
+  }
+}
+
+
+int
+main (int argc, char **argv)
+{
+  char path[4096];
+  TsmTrace trace;
+  unsigned int seed;
+  int i, failed = 0;
+
+  if (argc > 1) {
+    for (i = 1; i < argc; i++) {
+      if (tsm_trace_load (argv[i], &trace) != 0) {
+        failed++;
+        continue;
+      }
+      if (replay_parity (argv[i], &trace) != 0)
+        failed++;
+      printf ("%s: %d calls\n", argv[i], trace.n_ops);
+      tsm_trace_clear (&trace);
+    }
+    return failed ? 1 : 0;
+  }
+
+  for (i = 0; i < (int) (sizeof (default_traces) / sizeof (default_traces[0]));
+      i++) {
+    snprintf (path, sizeof (path), "%s/%s", TSM_TRACE_DIR, default_traces[i]);
+    if (tsm_trace_load (path, &trace) != 0) {
+      failed++;
+      continue;
+    }
+    if (replay_parity (default_traces[i], &trace) != 0)
+      failed++;
+    printf ("%s: %d calls\n", default_traces[i], trace.n_ops);
+    tsm_trace_clear (&trace);
+  }
+
+  for (seed = 1; seed <= FUZZ_SEEDS; seed++) {
+    char name[32];
+
+    snprintf (name, sizeof (name), "fuzz seed %u", seed);
+    fuzz_trace (seed, &trace);
+    if (replay_parity (name, &trace) != 0)
+      failed++;
+    tsm_trace_clear (&trace);
+  }
+  printf ("%d fuzz sequences of %d calls\n", FUZZ_SEEDS, FUZZ_OPS);
+
+  if (failed)
+    printf ("%d replays differ\n", failed);
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "tsmtrace.h"
+
+#define TSM_LINEAR(f) tsm_linear_##f
+
+void *TSM_LINEAR (createTSManager) (int ts_buf_size);
+void TSM_LINEAR (destroyTSManager) (void *handle);
+void TSM_LINEAR (resyncTSManager) (void *handle, TSM_TIMESTAMP synctime,
+    TSMGR_MODE mode);
+void TSM_LINEAR (setTSManagerFrameRate) (void *handle, int fps_n, int fps_d);
+void TSM_LINEAR (TSManagerReceive) (void *handle, TSM_TIMESTAMP timestamp);
+void TSM_LINEAR (TSManagerReceive2) (void *handle, TSM_TIMESTAMP timestamp,
+    int size);
+void TSM_LINEAR (TSManagerValid2) (void *handle, int size, void *key);
+void TSM_LINEAR (TSManagerFlush2) (void *handle, int size);
+TSM_TIMESTAMP TSM_LINEAR (TSManagerSend2) (void *handle, void *key);
+TSM_TIMESTAMP TSM_LINEAR (TSManagerQuery2) (void *handle, void *key);
+TSM_TIMESTAMP TSM_LINEAR (getTSManagerFrameInterval) (void *handle);
+TSM_TIMESTAMP TSM_LINEAR (getTSManagerPosition) (void *handle);
+int TSM_LINEAR (getTSManagerPreBufferCnt) (void *handle);
+
+const TsmImpl tsm_impl_heap = {
+  "heap",
+  createTSManager,
+  destroyTSManager,
+  resyncTSManager,
+  setTSManagerFrameRate,
+  TSManagerReceive,
+  TSManagerReceive2,
+  TSManagerValid2,
+  TSManagerFlush2,
+  TSManagerSend2,
+  TSManagerQuery2,
+  getTSManagerFrameInterval,
+  getTSManagerPosition,
+  getTSManagerPreBufferCnt,
+};
+
+const TsmImpl tsm_impl_linear = {
+  "linear",
+  TSM_LINEAR (createTSManager),
+  TSM_LINEAR (destroyTSManager),
+  TSM_LINEAR (resyncTSManager),
+  TSM_LINEAR (setTSManagerFrameRate),
+  TSM_LINEAR (TSManagerReceive),
+  TSM_LINEAR (TSManagerReceive2),
+  TSM_LINEAR (TSManagerValid2),
+  TSM_LINEAR (TSManagerFlush2),
+  TSM_LINEAR (TSManagerSend2),
+  TSM_LINEAR (TSManagerQuery2),
+  TSM_LINEAR (getTSManagerFrameInterval),
+  TSM_LINEAR (getTSManagerPosition),
+  TSM_LINEAR (getTSManagerPreBufferCnt),
+};
+
+
+void *
+tsm_trace_key (long long key)
+{
+  /* spread like heap allocated frame buffer descriptors */
+  return (void *) (uintptr_t) (key * 0x48);
+}
+
+
+int
+tsm_trace_load (const char *path, TsmTrace * trace)
+{
+  char line[256];
+  char mode[8];
+  int alloc = 0, lineno = 0, ret = 0;
+  FILE *f;
+
+  memset (trace, 0, sizeof (TsmTrace));
+
+  f = fopen (path, "r");
+  if (f == NULL) {
+    fprintf (stderr, "%s: can't open\n", path);
+    return -1;
+  }
+
+  while (fgets (line, sizeof (line), f)) {
+    TsmTraceOp op;
+    char *p = line;
+    int n;
+
+    lineno++;
+    while ((*p == ' ') || (*p == '\t'))
+      p++;
+    if ((*p == '#') || (*p == '\n') || (*p == '\0'))
+      continue;
+
+    memset (&op, 0, sizeof (TsmTraceOp));
+    op.op = *p++;
+    switch (op.op) {
+      case 'n':
+        n = sscanf (p, "%d", &trace->ts_buf_size) - 1;
+        break;
+      case 'm':
+        n = sscanf (p, "%7s %lld", mode, &op.b) - 2;
+        if (strcmp (mode, "ai") == 0)
+          op.a = MODE_AI;
+        else if (strcmp (mode, "fifo") == 0)
+          op.a = MODE_FIFO;
+        else
+          n = -1;
+        break;
+      case 'f':
+      case 'R':
+      case 'v':
+        n = sscanf (p, "%lld %lld", &op.a, &op.b) - 2;
+        break;
+      case 'r':
+      case 'l':
+      case 's':
+      case 'q':
+        n = sscanf (p, "%lld", &op.a) - 1;
+        break;
+      default:
+        n = -1;
+        break;
+    }
+
+    if (n != 0) {
+      fprintf (stderr, "%s:%d: bad line\n", path, lineno);
+      ret = -1;
+      break;
+    }
+    if (op.op == 'n')
+      continue;
+
+    if (trace->n_ops == alloc) {
+      alloc = alloc ? alloc * 2 : 1024;
+      trace->ops = realloc (trace->ops, sizeof (TsmTraceOp) * alloc);
+    }
+    trace->ops[trace->n_ops++] = op;
+  }
+
+  fclose (f);
+
+  if ((ret == 0) && (trace->ts_buf_size <= 0)) {
+    fprintf (stderr, "%s: no buffer size\n", path);
+    ret = -1;
+  }
+  if (ret != 0)
+    tsm_trace_clear (trace);
+
+  return ret;
+}
+
+
+void
+tsm_trace_clear (TsmTrace * trace)
+{
+  free (trace->ops);
+  memset (trace, 0, sizeof (TsmTrace));
+}
+
+
+void
+tsm_trace_step (const TsmImpl * impl, void *handle, const TsmTraceOp * op,
+    TsmTraceResult * result)
+{
+  TSM_TIMESTAMP ts = TSM_TIMESTAMP_NONE;
+
+  switch (op->op) {
+    case 'm':
+      impl->resync (handle, op->b, (TSMGR_MODE) op->a);
+      break;
+    case 'f':
+      impl->set_frame_rate (handle, op->a, op->b);
+      break;
+    case 'r':
+      impl->receive (handle, op->a);
+      break;
+    case 'R':
+      impl->receive2 (handle, op->a, op->b);
+      break;
+    case 'v':
+      impl->valid2 (handle, op->a, tsm_trace_key (op->b));
+      break;
+    case 'l':
+      impl->flush2 (handle, op->a);
+      break;
+    case 's':
+      ts = impl->send2 (handle, tsm_trace_key (op->a));
+      break;
+    case 'q':
+      ts = impl->query2 (handle, tsm_trace_key (op->a));
+      break;
+    default:
+      break;
+  }
+
+  if (result) {
+    result->ts = ts;
+    result->position = impl->position (handle);
+    result->interval = impl->frame_interval (handle);
+    result->pre_buffer_cnt = impl->pre_buffer_cnt (handle);
+  }
+}
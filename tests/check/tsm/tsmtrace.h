@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __TSM_TRACE_H__
+#define __TSM_TRACE_H__
+
+#include "mfw_gst_ts.h"
+
+/*
+ * A trace is the sequence of timestamp manager calls a decoder made, one
+ * call per line, '#' starts a comment:
+ *
+ *   n <ts_buf_size>           createTSManager, first line of a trace
+ *   m <ai|fifo> <synctime>    resyncTSManager
+ *   f <fps_n> <fps_d>         setTSManagerFrameRate
+ *   r <ts>                    TSManagerReceive
+ *   R <ts> <size>             TSManagerReceive2
+ *   v <size> <key>            TSManagerValid2
+ *   l <size>                  TSManagerFlush2
+ *   s <key>                   TSManagerSend2
+ *   q <key>                   TSManagerQuery2
+ *
+ * Timestamps are in ns, -1 is TSM_TIMESTAMP_NONE. Keys stand for frame
+ * buffer pointers, 0 is TSM_KEY_NONE.
+ */
+
+typedef struct
+{
+  char op;
+  long long a;
+  long long b;
+} TsmTraceOp;
+
+typedef struct
+{
+  int ts_buf_size;
+  int n_ops;
+  TsmTraceOp *ops;
+} TsmTrace;
+
+/* one timestamp manager implementation */
+typedef struct
+{
+  const char *name;
+  void *(*create) (int ts_buf_size);
+  void (*destroy) (void *handle);
+  void (*resync) (void *handle, TSM_TIMESTAMP synctime, TSMGR_MODE mode);
+  void (*set_frame_rate) (void *handle, int fps_n, int fps_d);
+  void (*receive) (void *handle, TSM_TIMESTAMP timestamp);
+  void (*receive2) (void *handle, TSM_TIMESTAMP timestamp, int size);
+  void (*valid2) (void *handle, int size, void *key);
+  void (*flush2) (void *handle, int size);
+  TSM_TIMESTAMP (*send2) (void *handle, void *key);
+  TSM_TIMESTAMP (*query2) (void *handle, void *key);
+  TSM_TIMESTAMP (*frame_interval) (void *handle);
+  TSM_TIMESTAMP (*position) (void *handle);
+  int (*pre_buffer_cnt) (void *handle);
+} TsmImpl;
+
+/* the min heap index in libs/video-tsm and the linear scan it replaced */
+extern const TsmImpl tsm_impl_heap;
+extern const TsmImpl tsm_impl_linear;
+
+/* what a call returned and the state it left, compared between impls */
+typedef struct
+{
+  TSM_TIMESTAMP ts;
+  TSM_TIMESTAMP position;
+  TSM_TIMESTAMP interval;
+  int pre_buffer_cnt;
+} TsmTraceResult;
+
+int tsm_trace_load (const char *path, TsmTrace * trace);
+void tsm_trace_clear (TsmTrace * trace);
+void *tsm_trace_key (long long key);
+/* runs op on handle, result may be NULL */
+void tsm_trace_step (const TsmImpl * impl, void *handle,
+    const TsmTraceOp * op, TsmTraceResult * result);
+
+#endif
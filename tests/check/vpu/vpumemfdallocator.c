@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include "vpumemfdallocator.h"
+
+/* leave a hole between blocks so a slab bug can't pass by running into the
+ * neighbour's physical range */
+#define MEMFD_PADDR_BASE 0x40000000
+#define MEMFD_PADDR_GUARD 4096
+
+static int gst_vpu_memfd_alloc_phys_mem (GstAllocatorPhyMem * allocator,
+    PhyMemBlock * memory);
+static int gst_vpu_memfd_free_phys_mem (GstAllocatorPhyMem * allocator,
+    PhyMemBlock * memory);
+
+G_DEFINE_TYPE (GstVpuMemfdAllocator, gst_vpu_memfd_allocator,
+    GST_TYPE_ALLOCATOR_PHYMEM);
+
+GstAllocator *
+gst_vpu_memfd_allocator_new (void)
+{
+  return g_object_new (GST_TYPE_VPU_MEMFD_ALLOCATOR, NULL);
+}
+
+static int
+gst_vpu_memfd_alloc_phys_mem (GstAllocatorPhyMem * allocator,
+    PhyMemBlock * memory)
+{
+  GstVpuMemfdAllocator *self = GST_VPU_MEMFD_ALLOCATOR (allocator);
+  gsize page = sysconf (_SC_PAGESIZE);
+  gsize size = (memory->size + page - 1) / page * page;
+  gpointer vaddr;
+  int fd;
+
+  fd = memfd_create ("vpuslab", MFD_CLOEXEC);
+  if (fd < 0)
+    return -1;
+
+  if (ftruncate (fd, size) < 0) {
+    close (fd);
+    return -1;
+  }
+
+  vaddr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  /* the mapping keeps the memfd alive */
+  close (fd);
+  if (vaddr == MAP_FAILED)
+    return -1;
+
+  GST_OBJECT_LOCK (self);
+  memory->size = size;
+  memory->vaddr = (guint8 *) vaddr;
+  memory->paddr = (guint8 *) self->next_paddr;
+  memory->caddr = NULL;
+  self->next_paddr += size + MEMFD_PADDR_GUARD;
+  self->live++;
+  self->total++;
+  GST_OBJECT_UNLOCK (self);
+
+  return 0;
+}
+
+static int
+gst_vpu_memfd_free_phys_mem (GstAllocatorPhyMem * allocator,
+    PhyMemBlock * memory)
+{
+  GstVpuMemfdAllocator *self = GST_VPU_MEMFD_ALLOCATOR (allocator);
+
+  if (munmap (memory->vaddr, memory->size) < 0)
+    return -1;
+
+  GST_OBJECT_LOCK (self);
+  self->live--;
+  GST_OBJECT_UNLOCK (self);
+
+  return 0;
+}
+
+static void
+gst_vpu_memfd_allocator_class_init (GstVpuMemfdAllocatorClass * klass)
+{
+  GstAllocatorPhyMemClass *parent_class = GST_ALLOCATOR_PHYMEM_CLASS (klass);
+
+  parent_class->alloc_phymem = gst_vpu_memfd_alloc_phys_mem;
+  parent_class->free_phymem = gst_vpu_memfd_free_phys_mem;
+}
+
+static void
+gst_vpu_memfd_allocator_init (GstVpuMemfdAllocator * allocator)
+{
+  GstAllocator *base = GST_ALLOCATOR (allocator);
+
+  base->mem_type = GST_VPU_MEMFD_ALLOCATOR_MEM_TYPE;
+  allocator->next_paddr = MEMFD_PADDR_BASE;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_VPU_MEMFD_ALLOCATOR_H__
+#define __GST_VPU_MEMFD_ALLOCATOR_H__
+
+#include <gst/allocators/gstallocatorphymem.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Host stand in for the VPU allocator: blocks are memfd backed mappings and
+ * get fake, page aligned physical addresses that never overlap, so the slab
+ * can be exercised without VPU_DecGetMem.
+ */
+
+typedef struct _GstVpuMemfdAllocator GstVpuMemfdAllocator;
+typedef struct _GstVpuMemfdAllocatorClass GstVpuMemfdAllocatorClass;
+
+#define GST_TYPE_VPU_MEMFD_ALLOCATOR             (gst_vpu_memfd_allocator_get_type())
+#define GST_VPU_MEMFD_ALLOCATOR(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_VPU_MEMFD_ALLOCATOR, GstVpuMemfdAllocator))
+#define GST_IS_VPU_MEMFD_ALLOCATOR(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_VPU_MEMFD_ALLOCATOR))
+
+#define GST_VPU_MEMFD_ALLOCATOR_MEM_TYPE "VpuMemfdMemory"
+
+struct _GstVpuMemfdAllocator
+{
+  GstAllocatorPhyMem parent;
+
+  /* next fake physical address handed out */
+  guintptr next_paddr;
+  /* blocks currently mapped and blocks mapped since creation */
+  guint live;
+  guint total;
+};
+
+struct _GstVpuMemfdAllocatorClass
+{
+  GstAllocatorPhyMemClass parent_class;
+};
+
+GType gst_vpu_memfd_allocator_get_type (void);
+GstAllocator * gst_vpu_memfd_allocator_new (void);
+
+G_END_DECLS
+
+#endif
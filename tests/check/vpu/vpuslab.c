@@ -0,0 +1,326 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+#include <gst/check/gstcheck.h>
+#include "gstvpuslab.h"
+#include "vpumemfdallocator.h"
+
+#define KB (1024)
+#define MB (1024 * 1024)
+
+static GstAllocator *backend;
+
+static guint
+backend_live (void)
+{
+  return GST_VPU_MEMFD_ALLOCATOR (backend)->live;
+}
+
+static guint
+backend_total (void)
+{
+  return GST_VPU_MEMFD_ALLOCATOR (backend)->total;
+}
+
+static void
+setup (void)
+{
+  backend = gst_vpu_memfd_allocator_new ();
+  fail_unless (gst_vpu_slab_set_backend (backend));
+}
+
+static void
+teardown (void)
+{
+  /* fails while a test still holds a block */
+  fail_unless (gst_vpu_slab_set_backend (NULL));
+  fail_unless_equals_int (backend_live (), 0);
+  gst_object_unref (backend);
+  backend = NULL;
+}
+
+static gboolean
+blocks_overlap (GstVpuSlabBlock * a, GstVpuSlabBlock * b)
+{
+  return a->paddr < b->paddr + b->size && b->paddr < a->paddr + a->size;
+}
+
+GST_START_TEST (test_carve_aligned)
+{
+  static const gsize aligns[] = { 1, 8, 64, 256, 4096, 32768 };
+  GstVpuSlabBlock *blocks[G_N_ELEMENTS (aligns)];
+  GstVpuSlabStats stats;
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (aligns); i++) {
+    /* odd sizes so every following start needs realigning */
+    blocks[i] = gst_vpu_slab_alloc (1000 + i * 77, aligns[i]);
+    fail_unless (blocks[i] != NULL);
+    fail_unless_equals_int (blocks[i]->size, 1000 + i * 77);
+    fail_unless_equals_uint64 ((guintptr) blocks[i]->paddr % aligns[i], 0);
+    memset (blocks[i]->vaddr, i + 1, blocks[i]->size);
+  }
+
+  /* all from one chunk, vaddr and paddr moved by the same offset */
+  for (i = 1; i < G_N_ELEMENTS (aligns); i++) {
+    fail_unless_equals_pointer (blocks[i]->chunk, blocks[0]->chunk);
+    fail_unless_equals_int64 (blocks[i]->paddr - blocks[0]->paddr,
+        blocks[i]->vaddr - blocks[0]->vaddr);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (aligns); i++) {
+    for (j = i + 1; j < G_N_ELEMENTS (aligns); j++)
+      fail_if (blocks_overlap (blocks[i], blocks[j]));
+    for (j = 0; j < blocks[i]->size; j++)
+      fail_unless_equals_int (blocks[i]->vaddr[j], i + 1);
+  }
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_chunks, 1);
+  fail_unless_equals_int (stats.n_blocks, G_N_ELEMENTS (aligns));
+  fail_unless_equals_int (stats.reserved, GST_VPU_SLAB_CHUNK_SIZE);
+  /* alignment gaps stay free in front of the blocks, plus the tail */
+  fail_unless (stats.free_ranges > 1);
+
+  for (i = 0; i < G_N_ELEMENTS (aligns); i++)
+    gst_vpu_slab_free (blocks[i]);
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_blocks, 0);
+  fail_unless_equals_int (stats.used, 0);
+  fail_unless_equals_int (stats.free_ranges, 1);
+  fail_unless_equals_int (stats.largest_free, GST_VPU_SLAB_CHUNK_SIZE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_recycle_chunks)
+{
+  GstVpuSlabBlock *blocks[8];
+  GstVpuSlabStats stats;
+  guint8 *first;
+  guint i, round;
+
+  first = NULL;
+  for (round = 0; round < 4; round++) {
+    /* what a decoder instance does on open and close */
+    for (i = 0; i < G_N_ELEMENTS (blocks); i++) {
+      blocks[i] = gst_vpu_slab_alloc (256 * KB, 4096);
+      fail_unless (blocks[i] != NULL);
+    }
+    if (!first)
+      first = blocks[0]->paddr;
+    fail_unless_equals_pointer (blocks[0]->paddr, first);
+
+    for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+      gst_vpu_slab_free (blocks[i]);
+
+    /* the empty chunk is kept, nothing goes back to the backend */
+    gst_vpu_slab_get_stats (&stats);
+    fail_unless_equals_int (stats.n_chunks, 1);
+    fail_unless_equals_int (backend_live (), 1);
+    fail_unless_equals_int (backend_total (), 1);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_keep_chunks)
+{
+  GstVpuSlabBlock *blocks[GST_VPU_SLAB_KEEP_CHUNKS + 2];
+  GstVpuSlabStats stats;
+  guint i;
+
+  /* one standard chunk per block */
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++) {
+    blocks[i] = gst_vpu_slab_alloc (3 * MB, 4096);
+    fail_unless (blocks[i] != NULL);
+  }
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_chunks, G_N_ELEMENTS (blocks));
+  fail_unless_equals_int (backend_live (), G_N_ELEMENTS (blocks));
+
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+    gst_vpu_slab_free (blocks[i]);
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_chunks, GST_VPU_SLAB_KEEP_CHUNKS);
+  fail_unless_equals_int (stats.reserved,
+      GST_VPU_SLAB_KEEP_CHUNKS * GST_VPU_SLAB_CHUNK_SIZE);
+  fail_unless_equals_int (backend_live (), GST_VPU_SLAB_KEEP_CHUNKS);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_dedicated_chunk)
+{
+  GstVpuSlabBlock *small, *big;
+  GstVpuSlabStats stats;
+
+  small = gst_vpu_slab_alloc (64 * KB, 4096);
+  big = gst_vpu_slab_alloc (GST_VPU_SLAB_CHUNK_SIZE * 2, 4096);
+  fail_unless (small != NULL && big != NULL);
+  fail_if (big->chunk == small->chunk);
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_chunks, 2);
+  fail_unless (stats.reserved >= GST_VPU_SLAB_CHUNK_SIZE * 3);
+
+  /* oversized chunks are never kept */
+  gst_vpu_slab_free (big);
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_chunks, 1);
+  fail_unless_equals_int (backend_live (), 1);
+
+  gst_vpu_slab_free (small);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_fragmentation)
+{
+  GstVpuSlabBlock *blocks[4];
+  GstVpuSlabStats stats;
+  guint i;
+
+  /* fill one chunk exactly */
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++) {
+    blocks[i] = gst_vpu_slab_alloc (GST_VPU_SLAB_CHUNK_SIZE / 4, 1);
+    fail_unless (blocks[i] != NULL);
+  }
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_chunks, 1);
+  fail_unless_equals_int (stats.free_ranges, 0);
+  fail_unless_equals_int (stats.fragmentation, 0);
+
+  /* two holes of a quarter each, only one usable by a single block */
+  gst_vpu_slab_free (blocks[0]);
+  gst_vpu_slab_free (blocks[2]);
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.free_ranges, 2);
+  fail_unless_equals_int (stats.largest_free, GST_VPU_SLAB_CHUNK_SIZE / 4);
+  fail_unless_equals_int (stats.fragmentation, 50);
+
+  /* freeing the middle block merges both holes with it */
+  gst_vpu_slab_free (blocks[1]);
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.free_ranges, 1);
+  fail_unless_equals_int (stats.largest_free,
+      GST_VPU_SLAB_CHUNK_SIZE * 3 / 4);
+  fail_unless_equals_int (stats.fragmentation, 0);
+
+  /* the merged hole is reused first fit */
+  blocks[0] = gst_vpu_slab_alloc (GST_VPU_SLAB_CHUNK_SIZE / 2, 1);
+  fail_unless (blocks[0] != NULL);
+  fail_unless_equals_pointer (blocks[0]->chunk, blocks[3]->chunk);
+  fail_unless_equals_int (blocks[0]->offset, 0);
+
+  /* what is left of it is too small, a second chunk is reserved */
+  blocks[1] = gst_vpu_slab_alloc (GST_VPU_SLAB_CHUNK_SIZE / 2, 1);
+  fail_unless (blocks[1] != NULL);
+  fail_if (blocks[1]->chunk == blocks[3]->chunk);
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.n_chunks, 2);
+
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++) {
+    if (i != 2)
+      gst_vpu_slab_free (blocks[i]);
+  }
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.used, 0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_high_water)
+{
+  GstVpuSlabBlock *a, *b, *c;
+  GstVpuSlabStats stats;
+
+  a = gst_vpu_slab_alloc (1 * MB, 4096);
+  b = gst_vpu_slab_alloc (2 * MB, 4096);
+  fail_unless (a != NULL && b != NULL);
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.used, 3 * MB);
+  fail_unless_equals_int (stats.high_water, 3 * MB);
+
+  gst_vpu_slab_free (b);
+  c = gst_vpu_slab_alloc (512 * KB, 4096);
+  fail_unless (c != NULL);
+
+  /* the peak is remembered, not the current use */
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.used, 1 * MB + 512 * KB);
+  fail_unless_equals_int (stats.high_water, 3 * MB);
+
+  gst_vpu_slab_free (a);
+  gst_vpu_slab_free (c);
+
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.used, 0);
+  fail_unless_equals_int (stats.high_water, 3 * MB);
+
+  /* a new backend starts a new arena */
+  fail_unless (gst_vpu_slab_set_backend (NULL));
+  fail_unless (gst_vpu_slab_set_backend (backend));
+  gst_vpu_slab_get_stats (&stats);
+  fail_unless_equals_int (stats.high_water, 0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_backend_busy)
+{
+  GstVpuSlabBlock *block;
+
+  block = gst_vpu_slab_alloc (4 * KB, 4096);
+  fail_unless (block != NULL);
+
+  /* chunks in use can't move to another backend */
+  fail_if (gst_vpu_slab_set_backend (NULL));
+
+  gst_vpu_slab_free (block);
+}
+
+GST_END_TEST;
+
+static Suite *
+vpuslab_suite (void)
+{
+  Suite *s = suite_create ("vpuslab");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_checked_fixture (tc_chain, setup, teardown);
+  tcase_add_test (tc_chain, test_carve_aligned);
+  tcase_add_test (tc_chain, test_recycle_chunks);
+  tcase_add_test (tc_chain, test_keep_chunks);
+  tcase_add_test (tc_chain, test_dedicated_chunk);
+  tcase_add_test (tc_chain, test_fragmentation);
+  tcase_add_test (tc_chain, test_high_water);
+  tcase_add_test (tc_chain, test_backend_busy);
+
+  return s;
+}
+
+GST_CHECK_MAIN (vpuslab);
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Description: batch poster frame extraction, runs aiurdemux and vpudec in
+ * thumbnail mode over every file of a directory and reports throughput.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <gst/gst.h>
+
+#define DEFAULT_COUNT 1
+#define DEFAULT_WIDTH 320
+#define DEFAULT_HEIGHT 240
+#define DEFAULT_TIME_OUT 10
+#define DEFAULT_CONVERT "videoconvert ! videoscale"
+#define DEFAULT_ENCODER "jpegenc"
+
+typedef struct
+{
+  const gchar *in_dir;
+  const gchar *out_dir;
+  const gchar *convert;
+  const gchar *encoder;
+  guint count;
+  guint width;
+  guint height;
+  guint timeout;
+} ThumbnailOptions;
+
+typedef struct
+{
+  guint frames;
+} ThumbnailContext;
+
+static void
+print_usage (const gchar * prog)
+{
+  printf ("Usage: %s [options] <input dir> <output dir>\n", prog);
+  printf ("  -n <count>     sync samples per file (default %d)\n", DEFAULT_COUNT);
+  printf ("  -w <width>     thumbnail width (default %d)\n", DEFAULT_WIDTH);
+  printf ("  -h <height>    thumbnail height (default %d)\n", DEFAULT_HEIGHT);
+  printf ("  -c <pipeline>  converter after vpudec (default \"%s\")\n",
+      DEFAULT_CONVERT);
+  printf ("  -e <element>   image encoder (default %s)\n", DEFAULT_ENCODER);
+  printf ("  -t <seconds>   time out per file (default %d)\n", DEFAULT_TIME_OUT);
+}
+
+static gint
+parse_options (gint argc, gchar * argv[], ThumbnailOptions * opt)
+{
+  gint c;
+
+  opt->count = DEFAULT_COUNT;
+  opt->width = DEFAULT_WIDTH;
+  opt->height = DEFAULT_HEIGHT;
+  opt->timeout = DEFAULT_TIME_OUT;
+  opt->convert = DEFAULT_CONVERT;
+  opt->encoder = DEFAULT_ENCODER;
+
+  while ((c = getopt (argc, argv, "n:w:h:c:e:t:")) != -1) {
+    switch (c) {
+      case 'n':
+        opt->count = atoi (optarg);
+        break;
+      case 'w':
+        opt->width = atoi (optarg);
+        break;
+      case 'h':
+        opt->height = atoi (optarg);
+        break;
+      case 'c':
+        opt->convert = optarg;
+        break;
+      case 'e':
+        opt->encoder = optarg;
+        break;
+      case 't':
+        opt->timeout = atoi (optarg);
+        break;
+      default:
+        return -1;
+    }
+  }
+
+  if (argc - optind != 2 || opt->count == 0 || opt->width == 0
+      || opt->height == 0)
+    return -1;
+
+  opt->in_dir = argv[optind];
+  opt->out_dir = argv[optind + 1];
+  return 0;
+}
+
+static void
+demux_pad_added (GstElement * demux, GstPad * pad, gpointer user_data)
+{
+  GstElement *queue = (GstElement *) user_data;
+  GstPad *sinkpad;
+
+  if (!g_str_has_prefix (GST_PAD_NAME (pad), "video_"))
+    return;
+
+  sinkpad = gst_element_get_static_pad (queue, "sink");
+  if (!gst_pad_is_linked (sinkpad))
+    gst_pad_link (pad, sinkpad);
+  gst_object_unref (sinkpad);
+}
+
+static GstPadProbeReturn
+count_frames (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  ThumbnailContext *ctx = (ThumbnailContext *) user_data;
+
+  ctx->frames++;
+  return GST_PAD_PROBE_OK;
+}
+
+static GstElement *
+build_pipeline (ThumbnailOptions * opt, const gchar * in_file,
+    const gchar * out_pattern, ThumbnailContext * ctx)
+{
+  GstElement *pipeline, *src, *demux, *queue, *dec, *post, *sink;
+  GstPad *pad;
+  gchar *desc;
+  GError *err = NULL;
+
+  pipeline = gst_pipeline_new ("thumbnail");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("aiurdemux", NULL);
+  queue = gst_element_factory_make ("queue", NULL);
+  dec = gst_element_factory_make ("vpudec", NULL);
+  sink = gst_element_factory_make ("multifilesink", NULL);
+
+  desc = g_strdup_printf ("%s ! video/x-raw,width=%d,height=%d ! %s",
+      opt->convert, opt->width, opt->height, opt->encoder);
+  post = gst_parse_bin_from_description (desc, TRUE, &err);
+  g_free (desc);
+
+  if (!pipeline || !src || !demux || !queue || !dec || !sink || !post) {
+    printf ("create elements failed: %s\n", err ? err->message : "missing plugin");
+    g_clear_error (&err);
+    if (pipeline)
+      gst_object_unref (pipeline);
+    return NULL;
+  }
+
+  g_object_set (src, "location", in_file, NULL);
+  g_object_set (demux, "thumbnail-count", opt->count, NULL);
+  g_object_set (dec, "thumbnail-mode", TRUE, NULL);
+  g_object_set (sink, "location", out_pattern, "sync", FALSE, NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, queue, dec, post, sink,
+      NULL);
+  if (!gst_element_link (src, demux)
+      || !gst_element_link_many (queue, dec, post, sink, NULL)) {
+    printf ("link elements failed\n");
+    gst_object_unref (pipeline);
+    return NULL;
+  }
+  g_signal_connect (demux, "pad-added", G_CALLBACK (demux_pad_added), queue);
+
+  ctx->frames = 0;
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, count_frames, ctx, NULL);
+  gst_object_unref (pad);
+
+  return pipeline;
+}
+
+static gboolean
+process_file (ThumbnailOptions * opt, const gchar * in_file,
+    const gchar * out_pattern, ThumbnailContext * ctx)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  gboolean ret = FALSE;
+
+  pipeline = build_pipeline (opt, in_file, out_pattern, ctx);
+  if (!pipeline)
+    return FALSE;
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, opt->timeout * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  if (msg == NULL) {
+    printf ("  time out\n");
+  } else if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+    gst_message_parse_error (msg, &err, NULL);
+    printf ("  error: %s\n", err->message);
+    g_error_free (err);
+  } else {
+    ret = TRUE;
+  }
+
+  if (msg)
+    gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return ret;
+}
+
+int
+main (int argc, char *argv[])
+{
+  ThumbnailOptions opt;
+  ThumbnailContext ctx;
+  GDir *dir;
+  const gchar *name;
+  guint files = 0, failed = 0, frames = 0;
+  gint64 start, begin, total;
+
+  gst_init (&argc, &argv);
+
+  memset (&opt, 0, sizeof (ThumbnailOptions));
+  if (parse_options (argc, argv, &opt) < 0) {
+    print_usage (argv[0]);
+    return -1;
+  }
+
+  dir = g_dir_open (opt.in_dir, 0, NULL);
+  if (!dir) {
+    printf ("can not open %s\n", opt.in_dir);
+    return -1;
+  }
+  g_mkdir_with_parents (opt.out_dir, 0755);
+
+  begin = g_get_monotonic_time ();
+  while ((name = g_dir_read_name (dir))) {
+    gchar *in_file = g_build_filename (opt.in_dir, name, NULL);
+    gchar *base, *out_name, *out_pattern;
+
+    if (!g_file_test (in_file, G_FILE_TEST_IS_REGULAR)) {
+      g_free (in_file);
+      continue;
+    }
+
+    base = g_strdup (name);
+    if (strrchr (base, '.'))
+      *strrchr (base, '.') = '\0';
+    out_name = g_strdup_printf ("%s-%%03d.%s", base,
+        g_str_has_prefix (opt.encoder, "png") ? "png" : "jpg");
+    out_pattern = g_build_filename (opt.out_dir, out_name, NULL);
+
+    printf ("%s\n", name);
+    start = g_get_monotonic_time ();
+    if (process_file (&opt, in_file, out_pattern, &ctx)) {
+      printf ("  %u frames in %.3f ms\n", ctx.frames,
+          (g_get_monotonic_time () - start) / 1000.0);
+      frames += ctx.frames;
+    } else {
+      failed++;
+    }
+    files++;
+
+    g_free (out_pattern);
+    g_free (out_name);
+    g_free (base);
+    g_free (in_file);
+  }
+  g_dir_close (dir);
+
+  total = g_get_monotonic_time () - begin;
+  printf ("\n%u files (%u failed), %u thumbnails in %.3f s\n", files, failed,
+      frames, total / 1000000.0);
+  if (total > 0)
+    printf ("throughput: %.2f files/s, %.2f thumbnails/s\n",
+        files * 1000000.0 / total, frames * 1000000.0 / total);
+
+  return failed ? 1 : 0;
+}
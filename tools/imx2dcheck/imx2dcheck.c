@@ -0,0 +1,956 @@
+/*
+ * Copyright 2026 NXP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Description: 2D device conformance and performance check. Every available
+ * Imx2DDevice is driven through a matrix of formats, sizes, crops,
+ * rotations, alpha blending and fills. Results are compared with a
+ * reference computed by GstVideoConverter on RGBA, independent of any
+ * device, and the latency of each operation is measured. A JSON report can
+ * be written for automated runs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include "imx_2d_device.h"
+
+#define DEFAULT_RUNS 10
+#define DEFAULT_THRESHOLD 30.0
+#define DEFAULT_FORMATS "NV12,I420,YUY2,RGBA,BGRx,RGB16"
+#define DEFAULT_SIZES "320x240,1280x720"
+#define PSNR_IDENTICAL 99.0
+#define FILL_COLOR 0x3366CCFF
+
+typedef enum {
+  CHECK_CONVERT,
+  CHECK_SCALE_DOWN,
+  CHECK_SCALE_UP,
+  CHECK_CROP,
+  CHECK_ROTATE,
+  CHECK_BLEND,
+  CHECK_FILL
+} CheckOp;
+
+typedef struct
+{
+  const gchar *name;
+  CheckOp op;
+  Imx2DRotationMode rotate;
+  gint caps;
+} CheckCase;
+
+static const CheckCase check_cases[] = {
+  { "convert",    CHECK_CONVERT,    IMX_2D_ROTATION_0,     0 },
+  { "scale-down", CHECK_SCALE_DOWN, IMX_2D_ROTATION_0,     IMX_2D_DEVICE_CAP_SCALE },
+  { "scale-up",   CHECK_SCALE_UP,   IMX_2D_ROTATION_0,     IMX_2D_DEVICE_CAP_SCALE },
+  { "crop",       CHECK_CROP,       IMX_2D_ROTATION_0,     IMX_2D_DEVICE_CAP_SCALE },
+  { "rotate-90",  CHECK_ROTATE,     IMX_2D_ROTATION_90,    IMX_2D_DEVICE_CAP_ROTATE },
+  { "rotate-180", CHECK_ROTATE,     IMX_2D_ROTATION_180,   IMX_2D_DEVICE_CAP_ROTATE },
+  { "rotate-270", CHECK_ROTATE,     IMX_2D_ROTATION_270,   IMX_2D_DEVICE_CAP_ROTATE },
+  { "hflip",      CHECK_ROTATE,     IMX_2D_ROTATION_HFLIP, IMX_2D_DEVICE_CAP_ROTATE },
+  { "vflip",      CHECK_ROTATE,     IMX_2D_ROTATION_VFLIP, IMX_2D_DEVICE_CAP_ROTATE },
+  { "blend",      CHECK_BLEND,      IMX_2D_ROTATION_0,
+    IMX_2D_DEVICE_CAP_BLEND | IMX_2D_DEVICE_CAP_ALPHA | IMX_2D_DEVICE_CAP_SCALE },
+  { "fill",       CHECK_FILL,       IMX_2D_ROTATION_0,     0 },
+};
+
+typedef struct
+{
+  guint w;
+  guint h;
+} CheckSize;
+
+typedef struct
+{
+  gchar **devices;
+  GArray *formats;
+  GArray *sizes;
+  guint runs;
+  gdouble threshold;
+  const gchar *report;
+  gboolean quick;
+} CheckOptions;
+
+typedef struct
+{
+  const gchar *name;
+  Imx2DDevice *device;
+  gint caps;
+  GList *in_fmts;
+  GList *out_fmts;
+  PhyMemBlock src_mem;
+  PhyMemBlock dst_mem;
+} CheckDevice;
+
+/* geometry of one case, the same for the device and the reference */
+typedef struct
+{
+  const CheckCase *c;
+  GstVideoFormat in_fmt;
+  GstVideoFormat out_fmt;
+  guint src_w, src_h;
+  guint dst_w, dst_h;
+  Imx2DCrop src_crop;
+  Imx2DCrop dst_crop;
+} CheckSetup;
+
+typedef struct
+{
+  guint passed;
+  guint failed;
+  guint skipped;
+  guint unverified;
+  GString *json;
+  gboolean first;
+} CheckReport;
+
+static void
+print_usage (const gchar * prog)
+{
+  printf ("Usage: %s [options]\n", prog);
+  printf ("  -d <names>     devices to check, comma separated (default all)\n");
+  printf ("  -f <formats>   formats (default %s)\n", DEFAULT_FORMATS);
+  printf ("  -s <sizes>     frame sizes (default %s)\n", DEFAULT_SIZES);
+  printf ("  -n <runs>      timed runs per case (default %d)\n", DEFAULT_RUNS);
+  printf ("  -t <dB>        minimum PSNR against the reference (default %.1f)\n",
+      DEFAULT_THRESHOLD);
+  printf ("  -o <file>      write a JSON report\n");
+  printf ("  -q             quick check, first size and no rotation\n");
+}
+
+static gint
+parse_options (gint argc, gchar * argv[], CheckOptions * opt)
+{
+  const gchar *formats = DEFAULT_FORMATS;
+  const gchar *sizes = DEFAULT_SIZES;
+  gchar **tokens;
+  gint c, i;
+
+  opt->runs = DEFAULT_RUNS;
+  opt->threshold = DEFAULT_THRESHOLD;
+
+  while ((c = getopt (argc, argv, "d:f:s:n:t:o:q")) != -1) {
+    switch (c) {
+      case 'd':
+        opt->devices = g_strsplit (optarg, ",", -1);
+        break;
+      case 'f':
+        formats = optarg;
+        break;
+      case 's':
+        sizes = optarg;
+        break;
+      case 'n':
+        opt->runs = atoi (optarg);
+        break;
+      case 't':
+        opt->threshold = atof (optarg);
+        break;
+      case 'o':
+        opt->report = optarg;
+        break;
+      case 'q':
+        opt->quick = TRUE;
+        break;
+      default:
+        return -1;
+    }
+  }
+
+  if (optind != argc || opt->runs == 0)
+    return -1;
+
+  opt->formats = g_array_new (FALSE, FALSE, sizeof (GstVideoFormat));
+  tokens = g_strsplit (formats, ",", -1);
+  for (i = 0; tokens[i]; i++) {
+    GstVideoFormat fmt = gst_video_format_from_string (tokens[i]);
+    if (fmt == GST_VIDEO_FORMAT_UNKNOWN) {
+      printf ("unknown format %s\n", tokens[i]);
+      g_strfreev (tokens);
+      return -1;
+    }
+    g_array_append_val (opt->formats, fmt);
+  }
+  g_strfreev (tokens);
+
+  /* odd or unaligned sizes are left to the caller, the halved geometries
+   * of the scale and crop cases are rounded down to even values */
+  opt->sizes = g_array_new (FALSE, FALSE, sizeof (CheckSize));
+  tokens = g_strsplit (sizes, ",", -1);
+  for (i = 0; tokens[i]; i++) {
+    CheckSize size;
+    if (sscanf (tokens[i], "%ux%u", &size.w, &size.h) != 2 || size.w < 16
+        || size.h < 16) {
+      printf ("invalid size %s\n", tokens[i]);
+      g_strfreev (tokens);
+      return -1;
+    }
+    g_array_append_val (opt->sizes, size);
+    if (opt->quick)
+      break;
+  }
+  g_strfreev (tokens);
+
+  return (opt->formats->len && opt->sizes->len) ? 0 : -1;
+}
+
+static gboolean
+check_device_open (CheckDevice * dev, const Imx2DDeviceInfo * info, gsize size)
+{
+  memset (dev, 0, sizeof (CheckDevice));
+  dev->name = info->name;
+  dev->device = imx_2d_device_create (info->device_type);
+  if (!dev->device)
+    return FALSE;
+
+  if (dev->device->open (dev->device) < 0) {
+    imx_2d_device_destroy (dev->device);
+    dev->device = NULL;
+    return FALSE;
+  }
+
+  dev->src_mem.size = dev->dst_mem.size = size;
+  if (dev->device->alloc_mem (dev->device, &dev->src_mem) < 0
+      || dev->device->alloc_mem (dev->device, &dev->dst_mem) < 0) {
+    printf ("%s: allocate %" G_GSIZE_FORMAT " bytes failed\n", info->name,
+        size);
+    if (dev->src_mem.vaddr)
+      dev->device->free_mem (dev->device, &dev->src_mem);
+    dev->device->close (dev->device);
+    imx_2d_device_destroy (dev->device);
+    dev->device = NULL;
+    return FALSE;
+  }
+
+  dev->caps = dev->device->get_capabilities (dev->device);
+  dev->in_fmts = dev->device->get_supported_in_fmts (dev->device);
+  dev->out_fmts = dev->device->get_supported_out_fmts (dev->device);
+
+  return TRUE;
+}
+
+static void
+check_device_close (CheckDevice * dev)
+{
+  if (!dev->device)
+    return;
+
+  dev->device->free_mem (dev->device, &dev->src_mem);
+  dev->device->free_mem (dev->device, &dev->dst_mem);
+  dev->device->close (dev->device);
+  imx_2d_device_destroy (dev->device);
+  g_list_free (dev->in_fmts);
+  g_list_free (dev->out_fmts);
+  dev->device = NULL;
+}
+
+static gboolean
+check_device_supports (CheckDevice * dev, const CheckSetup * setup)
+{
+  if ((dev->caps & setup->c->caps) != setup->c->caps)
+    return FALSE;
+
+  if (setup->c->op != CHECK_FILL
+      && !g_list_find (dev->in_fmts, (gpointer) setup->in_fmt))
+    return FALSE;
+
+  if (setup->c->op == CHECK_FILL && !dev->device->fill)
+    return FALSE;
+
+  return g_list_find (dev->out_fmts, (gpointer) setup->out_fmt) != NULL;
+}
+
+/* wrap a device memory block for GstVideoFrame access */
+static GstBuffer *
+check_wrap_memory (PhyMemBlock * mem)
+{
+  return gst_buffer_new_wrapped_full (0, mem->vaddr, mem->size, 0, mem->size,
+      NULL, NULL);
+}
+
+/* RGBA pixels converted into fmt in a device memory block */
+static gboolean
+check_write_rgba (PhyMemBlock * mem, GstVideoFormat fmt, guint w, guint h,
+    guint8 * data)
+{
+  GstVideoInfo rgba_info, info;
+  GstVideoFrame in_frame, out_frame;
+  GstVideoConverter *convert;
+  GstBuffer *rgba, *buf;
+
+  gst_video_info_set_format (&rgba_info, GST_VIDEO_FORMAT_RGBA, w, h);
+  gst_video_info_set_format (&info, fmt, w, h);
+
+  convert = gst_video_converter_new (&rgba_info, &info, NULL);
+  if (!convert)
+    return FALSE;
+
+  rgba = gst_buffer_new_wrapped_full (0, data,
+      GST_VIDEO_INFO_SIZE (&rgba_info), 0, GST_VIDEO_INFO_SIZE (&rgba_info),
+      NULL, NULL);
+  buf = check_wrap_memory (mem);
+  gst_video_frame_map (&in_frame, &rgba_info, rgba, GST_MAP_READ);
+  gst_video_frame_map (&out_frame, &info, buf, GST_MAP_WRITE);
+  gst_video_converter_frame (convert, &in_frame, &out_frame);
+  gst_video_converter_free (convert);
+  gst_video_frame_unmap (&out_frame);
+  gst_video_frame_unmap (&in_frame);
+
+  gst_buffer_unref (buf);
+  gst_buffer_unref (rgba);
+
+  return TRUE;
+}
+
+/* gradient with a checker board, seed changes the picture and alpha is
+ * applied to every pixel */
+static gboolean
+check_write_pattern (PhyMemBlock * mem, GstVideoFormat fmt, guint w, guint h,
+    guint seed, guint8 alpha)
+{
+  guint8 *data = g_malloc (w * h * 4);
+  gboolean ret;
+  guint x, y;
+
+  for (y = 0; y < h; y++) {
+    guint8 *p = data + y * w * 4;
+    for (x = 0; x < w; x++) {
+      gboolean checker = ((x >> 4) ^ (y >> 4) ^ seed) & 1;
+      p[4 * x + 0] = (x * 255 / w) ^ (seed * 0x55);
+      p[4 * x + 1] = (y * 255 / h) ^ (seed * 0x33);
+      p[4 * x + 2] = checker ? 0xE0 : 0x20;
+      p[4 * x + 3] = alpha;
+    }
+  }
+
+  ret = check_write_rgba (mem, fmt, w, h, data);
+  g_free (data);
+
+  return ret;
+}
+
+/* device output converted to RGBA for comparison */
+static guint8 *
+check_read_rgba (PhyMemBlock * mem, GstVideoFormat fmt, guint w, guint h)
+{
+  GstVideoInfo rgba_info, info;
+  GstVideoFrame in_frame, out_frame;
+  GstVideoConverter *convert;
+  GstBuffer *buf, *rgba;
+  guint8 *data;
+
+  gst_video_info_set_format (&rgba_info, GST_VIDEO_FORMAT_RGBA, w, h);
+  gst_video_info_set_format (&info, fmt, w, h);
+
+  convert = gst_video_converter_new (&info, &rgba_info, NULL);
+  if (!convert)
+    return NULL;
+
+  data = g_malloc (GST_VIDEO_INFO_SIZE (&rgba_info));
+  rgba = gst_buffer_new_wrapped_full (0, data,
+      GST_VIDEO_INFO_SIZE (&rgba_info), 0, GST_VIDEO_INFO_SIZE (&rgba_info),
+      NULL, NULL);
+  buf = check_wrap_memory (mem);
+
+  gst_video_frame_map (&in_frame, &info, buf, GST_MAP_READ);
+  gst_video_frame_map (&out_frame, &rgba_info, rgba, GST_MAP_WRITE);
+  gst_video_converter_frame (convert, &in_frame, &out_frame);
+  gst_video_converter_free (convert);
+  gst_video_frame_unmap (&out_frame);
+  gst_video_frame_unmap (&in_frame);
+
+  gst_buffer_unref (buf);
+  gst_buffer_unref (rgba);
+
+  return data;
+}
+
+/* PSNR of the rect of two RGBA pictures w pixels wide */
+static gdouble
+check_psnr (const guint8 * a, const guint8 * b, guint w,
+    const Imx2DCrop * rect, gboolean alpha)
+{
+  guint channels = alpha ? 4 : 3;
+  gdouble sum = 0.0, mse;
+  guint x, y, c;
+
+  for (y = rect->y; y < rect->y + rect->h; y++) {
+    for (x = rect->x; x < rect->x + rect->w; x++) {
+      guint i = y * w + x;
+      for (c = 0; c < channels; c++) {
+        gint d = (gint) a[4 * i + c] - (gint) b[4 * i + c];
+        sum += d * d;
+      }
+    }
+  }
+
+  mse = sum / ((gdouble) rect->w * rect->h * channels);
+  if (mse == 0.0)
+    return PSNR_IDENTICAL;
+
+  return MIN (PSNR_IDENTICAL, 10.0 * log10 (255.0 * 255.0 / mse));
+}
+
+static void
+check_setup_frame (Imx2DFrame * frame, PhyMemBlock * mem, GstVideoFormat fmt,
+    guint w, guint h, const Imx2DCrop * crop)
+{
+  GstVideoInfo vinfo;
+
+  gst_video_info_set_format (&vinfo, fmt, w, h);
+  memset (frame, 0, sizeof (Imx2DFrame));
+  frame->mem = mem;
+  frame->fd[0] = frame->fd[1] = frame->fd[2] = frame->fd[3] = -1;
+  frame->info.fmt = fmt;
+  frame->info.w = w;
+  frame->info.h = h;
+  frame->info.stride = GST_VIDEO_INFO_PLANE_STRIDE (&vinfo, 0);
+  frame->info.tile_type = IMX_2D_TILE_NULL;
+  frame->crop = *crop;
+  frame->rotate = IMX_2D_ROTATION_0;
+  frame->interlace_type = IMX_2D_INTERLACE_PROGRESSIVE;
+  frame->alpha = 0xFF;
+}
+
+static void
+check_build_setup (CheckSetup * setup, const CheckCase * c,
+    GstVideoFormat in_fmt, GstVideoFormat out_fmt, const CheckSize * size)
+{
+  guint half_w = (size->w / 2) & ~1, half_h = (size->h / 2) & ~1;
+
+  memset (setup, 0, sizeof (CheckSetup));
+  setup->c = c;
+  setup->in_fmt = in_fmt;
+  setup->out_fmt = out_fmt;
+  setup->src_w = setup->dst_w = size->w;
+  setup->src_h = setup->dst_h = size->h;
+
+  switch (c->op) {
+    case CHECK_SCALE_DOWN:
+      setup->dst_w = half_w;
+      setup->dst_h = half_h;
+      break;
+    case CHECK_SCALE_UP:
+      setup->src_w = half_w;
+      setup->src_h = half_h;
+      break;
+    case CHECK_ROTATE:
+      if (c->rotate == IMX_2D_ROTATION_90 || c->rotate == IMX_2D_ROTATION_270) {
+        setup->dst_w = size->h;
+        setup->dst_h = size->w;
+      }
+      break;
+    default:
+      break;
+  }
+
+  setup->src_crop.w = setup->src_w;
+  setup->src_crop.h = setup->src_h;
+  setup->dst_crop.w = setup->dst_w;
+  setup->dst_crop.h = setup->dst_h;
+
+  if (c->op == CHECK_CROP) {
+    setup->src_crop.x = (size->w / 4) & ~1;
+    setup->src_crop.y = (size->h / 4) & ~1;
+    setup->src_crop.w = half_w;
+    setup->src_crop.h = half_h;
+  } else if (c->op == CHECK_BLEND || c->op == CHECK_FILL) {
+    setup->dst_crop.x = (size->w / 4) & ~1;
+    setup->dst_crop.y = (size->h / 4) & ~1;
+    setup->dst_crop.w = half_w;
+    setup->dst_crop.h = half_h;
+  }
+}
+
+/* one submission of the case, waits for completion */
+static gint
+check_submit (CheckDevice * dev, const CheckSetup * setup)
+{
+  Imx2DDevice *device = dev->device;
+  Imx2DFrame src, dst;
+  PhyMemBlock src_blk = dev->src_mem, dst_blk = dev->dst_mem;
+  gint ret;
+
+  check_setup_frame (&src, &src_blk, setup->in_fmt, setup->src_w,
+      setup->src_h, &setup->src_crop);
+  check_setup_frame (&dst, &dst_blk, setup->out_fmt, setup->dst_w,
+      setup->dst_h, &setup->dst_crop);
+
+  switch (setup->c->op) {
+    case CHECK_FILL:
+      ret = device->fill (device, &dst, FILL_COLOR);
+      break;
+    case CHECK_BLEND:
+      src.alpha = 0x80;
+      ret = device->blend (device, &dst, &src);
+      if (ret >= 0)
+        ret = device->blend_finish (device);
+      break;
+    default:
+      ret = device->convert (device, &dst, &src);
+      break;
+  }
+
+  if (ret >= 0)
+    ret = imx_2d_device_wait_fence (device, imx_2d_device_get_fence (device));
+
+  return ret;
+}
+
+static gint
+check_configure (CheckDevice * dev, const CheckSetup * setup)
+{
+  Imx2DDevice *device = dev->device;
+  Imx2DFrame src, dst;
+
+  check_setup_frame (&src, &dev->src_mem, setup->in_fmt, setup->src_w,
+      setup->src_h, &setup->src_crop);
+  check_setup_frame (&dst, &dev->dst_mem, setup->out_fmt, setup->dst_w,
+      setup->dst_h, &setup->dst_crop);
+
+  if (setup->c->op != CHECK_FILL
+      && device->config_input (device, &src.info) < 0)
+    return -1;
+
+  if (device->config_output (device, &dst.info) < 0
+      || device->set_rotate (device, setup->c->rotate) < 0
+      || device->set_deinterlace (device, IMX_2D_DEINTERLACE_NONE) < 0)
+    return -1;
+
+  return 0;
+}
+
+/* same input and destination content on every device */
+static void
+check_prepare (CheckDevice * dev, const CheckSetup * setup)
+{
+  if (setup->c->op != CHECK_FILL)
+    check_write_pattern (&dev->src_mem, setup->in_fmt, setup->src_w,
+        setup->src_h, 0, setup->c->op == CHECK_BLEND ? 0xC0 : 0xFF);
+
+  check_write_pattern (&dev->dst_mem, setup->out_fmt, setup->dst_w,
+      setup->dst_h, 1, 0xFF);
+}
+
+/* fmt content of RGBA pixels, as read back from a frame in that format */
+static guint8 *
+check_round_trip (const guint8 * rgba, GstVideoFormat fmt, guint w, guint h)
+{
+  GstVideoInfo info;
+  PhyMemBlock mem;
+  guint8 *data;
+
+  gst_video_info_set_format (&info, fmt, w, h);
+  memset (&mem, 0, sizeof (PhyMemBlock));
+  mem.size = GST_VIDEO_INFO_SIZE (&info);
+  mem.vaddr = g_malloc0 (mem.size);
+
+  data = check_write_rgba (&mem, fmt, w, h, (guint8 *) rgba) ?
+      check_read_rgba (&mem, fmt, w, h) : NULL;
+  g_free (mem.vaddr);
+
+  return data;
+}
+
+static guint8 *
+check_pattern_rgba (GstVideoFormat fmt, guint w, guint h, guint seed,
+    guint8 alpha)
+{
+  GstVideoInfo info;
+  PhyMemBlock mem;
+  guint8 *data = NULL;
+
+  gst_video_info_set_format (&info, fmt, w, h);
+  memset (&mem, 0, sizeof (PhyMemBlock));
+  mem.size = GST_VIDEO_INFO_SIZE (&info);
+  mem.vaddr = g_malloc0 (mem.size);
+
+  if (check_write_pattern (&mem, fmt, w, h, seed, alpha))
+    data = check_read_rgba (&mem, fmt, w, h);
+  g_free (mem.vaddr);
+
+  return data;
+}
+
+/* source crop rotated the way the devices do, 90 is clockwise */
+static guint8 *
+check_rotate_rgba (const guint8 * src, guint w, const Imx2DCrop * crop,
+    Imx2DRotationMode rotate, guint * out_w, guint * out_h)
+{
+  guint32 *out;
+  guint cw = crop->w, ch = crop->h, x, y, col, row;
+  gboolean swap = rotate == IMX_2D_ROTATION_90
+      || rotate == IMX_2D_ROTATION_270;
+
+  *out_w = swap ? ch : cw;
+  *out_h = swap ? cw : ch;
+  out = g_new (guint32, cw * ch);
+
+  for (y = 0; y < *out_h; y++) {
+    for (x = 0; x < *out_w; x++) {
+      switch (rotate) {
+        case IMX_2D_ROTATION_90:
+          col = y; row = ch - 1 - x;
+          break;
+        case IMX_2D_ROTATION_180:
+          col = cw - 1 - x; row = ch - 1 - y;
+          break;
+        case IMX_2D_ROTATION_270:
+          col = cw - 1 - y; row = x;
+          break;
+        case IMX_2D_ROTATION_HFLIP:
+          col = cw - 1 - x; row = y;
+          break;
+        case IMX_2D_ROTATION_VFLIP:
+          col = x; row = ch - 1 - y;
+          break;
+        default:
+          col = x; row = y;
+          break;
+      }
+      memcpy (&out[y * *out_w + x],
+          src + ((crop->y + row) * w + crop->x + col) * 4, 4);
+    }
+  }
+
+  return (guint8 *) out;
+}
+
+static guint8 *
+check_scale_rgba (guint8 * src, guint src_w, guint src_h, guint dst_w,
+    guint dst_h)
+{
+  GstVideoInfo in_info, out_info;
+  GstVideoFrame in_frame, out_frame;
+  GstVideoConverter *convert;
+  GstBuffer *in, *out;
+  guint8 *data;
+
+  gst_video_info_set_format (&in_info, GST_VIDEO_FORMAT_RGBA, src_w, src_h);
+  gst_video_info_set_format (&out_info, GST_VIDEO_FORMAT_RGBA, dst_w, dst_h);
+
+  convert = gst_video_converter_new (&in_info, &out_info,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+          GST_TYPE_VIDEO_RESAMPLER_METHOD, GST_VIDEO_RESAMPLER_METHOD_LINEAR,
+          NULL));
+  if (!convert)
+    return NULL;
+
+  data = g_malloc (GST_VIDEO_INFO_SIZE (&out_info));
+  in = gst_buffer_new_wrapped_full (0, src, GST_VIDEO_INFO_SIZE (&in_info),
+      0, GST_VIDEO_INFO_SIZE (&in_info), NULL, NULL);
+  out = gst_buffer_new_wrapped_full (0, data, GST_VIDEO_INFO_SIZE (&out_info),
+      0, GST_VIDEO_INFO_SIZE (&out_info), NULL, NULL);
+  gst_video_frame_map (&in_frame, &in_info, in, GST_MAP_READ);
+  gst_video_frame_map (&out_frame, &out_info, out, GST_MAP_WRITE);
+  gst_video_converter_frame (convert, &in_frame, &out_frame);
+  gst_video_converter_free (convert);
+  gst_video_frame_unmap (&out_frame);
+  gst_video_frame_unmap (&in_frame);
+
+  gst_buffer_unref (out);
+  gst_buffer_unref (in);
+
+  return data;
+}
+
+/* expected RGBA output of a case, NULL when GstVideoConverter can't handle
+ * one of its formats and the case has no reference */
+static guint8 *
+check_reference (const CheckSetup * setup)
+{
+  const Imx2DCrop *crop = &setup->dst_crop;
+  guint8 *dst, *src, *view, *scaled = NULL, *ret;
+  guint vw, vh, x, y, c;
+
+  dst = check_pattern_rgba (setup->out_fmt, setup->dst_w, setup->dst_h, 1,
+      0xFF);
+  if (!dst)
+    return NULL;
+
+  if (setup->c->op == CHECK_FILL) {
+    /* RGBA8888 holds R in the low byte, as the devices read it */
+    for (y = crop->y; y < crop->y + crop->h; y++) {
+      for (x = crop->x; x < crop->x + crop->w; x++) {
+        for (c = 0; c < 4; c++)
+          dst[(y * setup->dst_w + x) * 4 + c] = (FILL_COLOR >> (8 * c)) & 0xff;
+      }
+    }
+  } else {
+    src = check_pattern_rgba (setup->in_fmt, setup->src_w, setup->src_h, 0,
+        setup->c->op == CHECK_BLEND ? 0xC0 : 0xFF);
+    if (src) {
+      view = check_rotate_rgba (src, setup->src_w, &setup->src_crop,
+          setup->c->rotate, &vw, &vh);
+      scaled = check_scale_rgba (view, vw, vh, crop->w, crop->h);
+      g_free (view);
+      g_free (src);
+    }
+    if (!scaled) {
+      g_free (dst);
+      return NULL;
+    }
+
+    /* source over destination with the 0x80 global alpha of the blend */
+    for (y = 0; y < crop->h; y++) {
+      for (x = 0; x < crop->w; x++) {
+        const guint8 *s = scaled + (y * crop->w + x) * 4;
+        guint8 *d = dst + ((crop->y + y) * setup->dst_w + crop->x + x) * 4;
+        guint a;
+
+        if (setup->c->op != CHECK_BLEND) {
+          memcpy (d, s, 4);
+          continue;
+        }
+        a = (s[3] * 0x80 + 127) / 255;
+        for (c = 0; c < 3; c++)
+          d[c] = (s[c] * a + d[c] * (255 - a) + 127) / 255;
+        d[3] = (255 * a + d[3] * (255 - a) + 127) / 255;
+      }
+    }
+    g_free (scaled);
+  }
+
+  ret = check_round_trip (dst, setup->out_fmt, setup->dst_w, setup->dst_h);
+  g_free (dst);
+
+  return ret;
+}
+
+static void
+check_report_add (CheckReport * report, const gchar * device,
+    const CheckSetup * setup, const gchar * status, gdouble psnr,
+    gint64 min, gdouble avg, gint64 max)
+{
+  guint pixels = setup->dst_crop.w * setup->dst_crop.h;
+
+  if (!report->first)
+    g_string_append (report->json, ",\n");
+  report->first = FALSE;
+
+  g_string_append_printf (report->json, "    { \"device\": \"%s\", "
+      "\"case\": \"%s\", \"in\": \"%s\", \"out\": \"%s\", "
+      "\"src\": [%u, %u, %d, %d, %u, %u], \"dst\": [%u, %u, %d, %d, %u, %u], "
+      "\"status\": \"%s\"", device, setup->c->name,
+      gst_video_format_to_string (setup->in_fmt),
+      gst_video_format_to_string (setup->out_fmt),
+      setup->src_w, setup->src_h, setup->src_crop.x, setup->src_crop.y,
+      setup->src_crop.w, setup->src_crop.h,
+      setup->dst_w, setup->dst_h, setup->dst_crop.x, setup->dst_crop.y,
+      setup->dst_crop.w, setup->dst_crop.h, status);
+
+  if (psnr >= 0)
+    g_string_append_printf (report->json, ", \"psnr\": %.2f", psnr);
+  if (avg > 0)
+    g_string_append_printf (report->json, ", \"min_us\": %" G_GINT64_FORMAT
+        ", \"avg_us\": %.1f, \"max_us\": %" G_GINT64_FORMAT
+        ", \"mpix_per_s\": %.2f", min, avg, max, pixels / avg);
+  g_string_append (report->json, " }");
+}
+
+static void
+check_run_case (CheckOptions * opt, CheckDevice * dev,
+    const CheckSetup * setup, CheckReport * report)
+{
+  gint64 min = G_MAXINT64, max = 0, total = 0;
+  gdouble psnr = -1.0, avg;
+  Imx2DCrop full = { 0, 0, setup->dst_w, setup->dst_h };
+  const gchar *status;
+  guint8 *expected;
+  gchar psnr_str[16];
+  guint i;
+
+  if (!check_device_supports (dev, setup) || check_configure (dev, setup) < 0) {
+    report->skipped++;
+    check_report_add (report, dev->name, setup, "unsupported", -1, 0, 0, 0);
+    return;
+  }
+
+  check_prepare (dev, setup);
+  if (check_submit (dev, setup) < 0) {
+    report->failed++;
+    printf ("%-6s %-10s %5s -> %-5s %4ux%-4u  FAILED to submit\n", dev->name,
+        setup->c->name, gst_video_format_to_string (setup->in_fmt),
+        gst_video_format_to_string (setup->out_fmt), setup->src_w,
+        setup->src_h);
+    check_report_add (report, dev->name, setup, "error", -1, 0, 0, 0);
+    return;
+  }
+
+  /* some devices fill the whole frame, only the crop of a fill is checked */
+  expected = check_reference (setup);
+  if (expected) {
+    guint8 *out = check_read_rgba (&dev->dst_mem, setup->out_fmt,
+        setup->dst_w, setup->dst_h);
+    psnr = check_psnr (out, expected, setup->dst_w,
+        setup->c->op == CHECK_FILL ? &setup->dst_crop : &full,
+        GST_VIDEO_FORMAT_INFO_HAS_ALPHA (gst_video_format_get_info
+            (setup->out_fmt)));
+    g_free (out);
+    g_free (expected);
+  }
+
+  for (i = 0; i < opt->runs; i++) {
+    gint64 start = g_get_monotonic_time (), elapsed;
+
+    if (check_submit (dev, setup) < 0)
+      break;
+    elapsed = g_get_monotonic_time () - start;
+    min = MIN (min, elapsed);
+    max = MAX (max, elapsed);
+    total += elapsed;
+  }
+  avg = i ? (gdouble) total / i : 0;
+  if (i == 0)
+    min = 0;
+
+  if (i < opt->runs)
+    status = "error";
+  else if (psnr < 0)
+    status = "unverified";
+  else if (psnr < opt->threshold)
+    status = "mismatch";
+  else
+    status = "pass";
+
+  if (g_str_equal (status, "pass"))
+    report->passed++;
+  else if (g_str_equal (status, "unverified"))
+    report->unverified++;
+  else
+    report->failed++;
+
+  if (psnr >= 0)
+    g_snprintf (psnr_str, sizeof (psnr_str), "%.2f", psnr);
+  else
+    g_strlcpy (psnr_str, "-", sizeof (psnr_str));
+
+  printf ("%-6s %-10s %5s -> %-5s %4ux%-4u  psnr %6s  avg %9.1f us  "
+      "%8.2f Mpix/s  %s\n", dev->name, setup->c->name,
+      gst_video_format_to_string (setup->in_fmt),
+      gst_video_format_to_string (setup->out_fmt), setup->src_w, setup->src_h,
+      psnr_str, avg,
+      avg > 0 ? setup->dst_crop.w * setup->dst_crop.h / avg : 0.0, status);
+
+  check_report_add (report, dev->name, setup, status, psnr, min, avg, max);
+}
+
+static void
+check_device (CheckOptions * opt, CheckDevice * dev, CheckReport * report)
+{
+  CheckSetup setup;
+  guint s, i, j, k;
+
+  for (s = 0; s < opt->sizes->len; s++) {
+    const CheckSize *size = &g_array_index (opt->sizes, CheckSize, s);
+
+    for (k = 0; k < G_N_ELEMENTS (check_cases); k++) {
+      const CheckCase *c = &check_cases[k];
+
+      if (opt->quick && (c->op == CHECK_ROTATE || c->op == CHECK_CROP))
+        continue;
+
+      for (i = 0; i < opt->formats->len; i++) {
+        for (j = 0; j < opt->formats->len; j++) {
+          /* fill has no input, one case per output format */
+          if (c->op == CHECK_FILL && i != j)
+            continue;
+
+          check_build_setup (&setup, c,
+              g_array_index (opt->formats, GstVideoFormat, i),
+              g_array_index (opt->formats, GstVideoFormat, j), size);
+          check_run_case (opt, dev, &setup, report);
+        }
+      }
+    }
+  }
+}
+
+int
+main (int argc, char *argv[])
+{
+  CheckOptions opt;
+  CheckReport report;
+  CheckDevice dev;
+  const Imx2DDeviceInfo *info;
+  gsize mem_size = 0;
+  guint i, devices = 0;
+
+  gst_init (&argc, &argv);
+
+  memset (&opt, 0, sizeof (CheckOptions));
+  if (parse_options (argc, argv, &opt) < 0) {
+    print_usage (argv[0]);
+    return -1;
+  }
+
+  for (i = 0; i < opt.sizes->len; i++) {
+    CheckSize *size = &g_array_index (opt.sizes, CheckSize, i);
+    mem_size = MAX (mem_size, (gsize) size->w * size->h * 4);
+  }
+
+  memset (&report, 0, sizeof (CheckReport));
+  report.first = TRUE;
+  report.json = g_string_new ("{\n");
+  g_string_append_printf (report.json, "  \"runs\": %u,\n  \"threshold\": "
+      "%.2f,\n  \"results\": [\n", opt.runs, opt.threshold);
+
+  for (info = imx_get_2d_devices (); info->name; info++) {
+    if (opt.devices && !g_strv_contains ((const gchar * const *) opt.devices,
+            info->name))
+      continue;
+    if (!info->is_exist ())
+      continue;
+
+    if (check_device_open (&dev, info, mem_size)) {
+      check_device (&opt, &dev, &report);
+      check_device_close (&dev);
+    } else {
+      printf ("open %s device failed\n", info->name);
+      report.failed++;
+      continue;
+    }
+    devices++;
+  }
+
+  g_string_append_printf (report.json, "\n  ],\n  \"passed\": %u,\n  "
+      "\"failed\": %u,\n  \"skipped\": %u,\n  \"unverified\": %u\n}\n",
+      report.passed, report.failed, report.skipped, report.unverified);
+
+  printf ("\n%u devices: %u passed, %u failed, %u unsupported, "
+      "%u unverified\n", devices, report.passed, report.failed,
+      report.skipped, report.unverified);
+
+  if (opt.report && !g_file_set_contents (opt.report, report.json->str, -1,
+          NULL))
+    printf ("write report %s failed\n", opt.report);
+
+  g_string_free (report.json, TRUE);
+  g_strfreev (opt.devices);
+  g_array_free (opt.formats, TRUE);
+  g_array_free (opt.sizes, TRUE);
+
+  return report.failed ? 1 : 0;
+}